@@ -0,0 +1,80 @@
+// ----------------------------------------------------------------------------
+// 
+// AllocationCounter.cpp
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#include "AllocationCounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+
+/** Number of calls made to the global "new" operators below. */
+static std::atomic<uint64_t> sAllocationCount(0);
+
+
+uint64_t AllocationCounter::GetCount()
+{
+	return sAllocationCount.load();
+}
+
+
+/**
+  Allocates memory for the replaced "new" operators below and counts the allocation.
+  @param size Number of bytes to allocate. Zero is treated as 1, as required by the C++ standard.
+  @return Returns a pointer to the allocated memory. Returns null if out of memory.
+ */
+static void* AllocateCountedMemory(std::size_t size)
+{
+	sAllocationCount++;
+	return std::malloc(size ? size : 1);
+}
+
+void* operator new(std::size_t size)
+{
+	void* memoryPointer = AllocateCountedMemory(size);
+	if (!memoryPointer)
+	{
+		throw std::bad_alloc();
+	}
+	return memoryPointer;
+}
+
+void* operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+	return AllocateCountedMemory(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+	return AllocateCountedMemory(size);
+}
+
+void operator delete(void* memoryPointer) noexcept
+{
+	std::free(memoryPointer);
+}
+
+void operator delete[](void* memoryPointer) noexcept
+{
+	std::free(memoryPointer);
+}
+
+void operator delete(void* memoryPointer, const std::nothrow_t&) noexcept
+{
+	std::free(memoryPointer);
+}
+
+void operator delete[](void* memoryPointer, const std::nothrow_t&) noexcept
+{
+	std::free(memoryPointer);
+}
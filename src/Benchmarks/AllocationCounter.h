@@ -0,0 +1,34 @@
+// ----------------------------------------------------------------------------
+// 
+// AllocationCounter.h
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstdint>
+
+
+/**
+  Counts the heap allocations made via the global C++ "new" operators, which "AllocationCounter.cpp" replaces.
+  Used by benchmarks to verify that a code path no longer allocates memory once it has warmed up.
+
+  The count covers all threads. Benchmarks are expected to read it while no other threads are running.
+  This class only provides static members.
+ */
+class AllocationCounter
+{
+	public:
+		/**
+		  Gets the number of times a global "new" operator has been called since the application started.
+		  @return Returns the number of heap allocations made via "new" so far.
+		 */
+		static uint64_t GetCount();
+
+	private:
+		/** Constructor deleted since this class only provides static members. */
+		AllocationCounter() = delete;
+};
@@ -0,0 +1,38 @@
+// ----------------------------------------------------------------------------
+// 
+// BenchmarkMain.cpp
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#include "BenchmarkRegistry.h"
+#include <cstring>
+
+
+/**
+  Runs the plugin's benchmarks.
+
+  Usage: plugin.steamworks.benchmarks [--quick] [nameFilter]
+  The "--quick" option runs a fraction of the iterations, which is what ctest does.
+  The optional name filter only runs the benchmarks whose name contains the given string.
+  @return Returns zero if all benchmarks have passed their checks. Returns the number of failed benchmarks if not.
+ */
+int main(int argc, char* argv[])
+{
+	BenchmarkRegistry::Settings settings{};
+	const char* nameFilter = nullptr;
+	for (int index = 1; index < argc; index++)
+	{
+		if (!strcmp(argv[index], "--quick"))
+		{
+			settings.IsQuick = true;
+		}
+		else
+		{
+			nameFilter = argv[index];
+		}
+	}
+	return BenchmarkRegistry::RunAll(settings, nameFilter);
+}
@@ -0,0 +1,98 @@
+// ----------------------------------------------------------------------------
+// 
+// BenchmarkRegistry.cpp
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#include "BenchmarkRegistry.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+
+/** A benchmark added to the registry via the Add() method. */
+struct RegisteredBenchmark
+{
+	const char* Name;
+	BenchmarkRegistry::BenchmarkFunction FunctionPointer;
+};
+
+/**
+  Gets the collection of all registered benchmarks.
+  Note: Returned via a function-local static so that it's constructed before the benchmarks' static registrars use it.
+  @return Returns a reference to the collection.
+ */
+static std::vector<RegisteredBenchmark>& GetBenchmarkCollection()
+{
+	static std::vector<RegisteredBenchmark> sBenchmarkCollection;
+	return sBenchmarkCollection;
+}
+
+
+void BenchmarkRegistry::Add(const char* name, BenchmarkRegistry::BenchmarkFunction functionPointer)
+{
+	if (name && functionPointer)
+	{
+		RegisteredBenchmark benchmark;
+		benchmark.Name = name;
+		benchmark.FunctionPointer = functionPointer;
+		GetBenchmarkCollection().push_back(benchmark);
+	}
+}
+
+int BenchmarkRegistry::RunAll(const BenchmarkRegistry::Settings& settings, const char* nameFilter)
+{
+	// Run the benchmarks in a stable order, since their registration order depends on the linker.
+	auto benchmarkCollection = GetBenchmarkCollection();
+	std::sort(
+			benchmarkCollection.begin(), benchmarkCollection.end(),
+			[](const RegisteredBenchmark& x, const RegisteredBenchmark& y)->bool
+			{
+				return (strcmp(x.Name, y.Name) < 0);
+			});
+
+	// Run all benchmarks matching the given filter and tally up their failures.
+	int failureCount = 0;
+	int runCount = 0;
+	for (auto&& benchmark : benchmarkCollection)
+	{
+		if (nameFilter && !strstr(benchmark.Name, nameFilter))
+		{
+			continue;
+		}
+		runCount++;
+		printf("[ RUN  ] %s\n", benchmark.Name);
+		fflush(stdout);
+		bool hasPassed = benchmark.FunctionPointer(settings);
+		printf("[ %s ] %s\n", hasPassed ? "PASS" : "FAIL", benchmark.Name);
+		fflush(stdout);
+		if (!hasPassed)
+		{
+			failureCount++;
+		}
+	}
+
+	// Fail if the filter names a benchmark that was not built, so that a test running it cannot pass silently.
+	if (nameFilter && (0 == runCount))
+	{
+		printf("[ FAIL ] No benchmark matches '%s'. Was it left out of the build?\n", nameFilter);
+		fflush(stdout);
+		failureCount++;
+	}
+	return failureCount;
+}
+
+double BenchmarkRegistry::ToNanosecondsPerOperation(
+	std::chrono::steady_clock::duration duration, uint64_t operationCount)
+{
+	if (operationCount < 1)
+	{
+		operationCount = 1;
+	}
+	auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+	return (double)nanoseconds / (double)operationCount;
+}
@@ -0,0 +1,95 @@
+// ----------------------------------------------------------------------------
+// 
+// BenchmarkRegistry.h
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+
+/**
+  Registry of the benchmarks compiled into the "plugin.steamworks.benchmarks" executable.
+
+  Benchmarks register themselves via the PLUGIN_BENCHMARK() macro from their own source file, so that adding a
+  benchmark only requires adding its file and its name to this directory's "CMakeLists.txt" file, which runs each
+  benchmark as its own ctest test.
+  Each benchmark prints its measurements to stdout and returns false if one of its checks has failed, such as
+  an event being dropped or an unexpected heap allocation, which makes the executable usable as a ctest test.
+
+  This class only provides static members.
+ */
+class BenchmarkRegistry
+{
+	public:
+		/** Settings passed to every benchmark. */
+		struct Settings
+		{
+			/**
+			  Set true via the "--quick" command line argument to run a fraction of the iterations.
+			  Used by ctest, which only verifies the benchmarks' checks instead of their timings.
+			 */
+			bool IsQuick;
+		};
+
+		/**
+		  Function which runs a benchmark and prints its results.
+		  @param settings Provides the command line options the benchmark was run with.
+		  @return Returns true if all of the benchmark's checks have passed. Returns false if not.
+		 */
+		typedef bool(*BenchmarkFunction)(const BenchmarkRegistry::Settings& settings);
+
+		/** Adds a benchmark to the registry on construction. Used by the PLUGIN_BENCHMARK() macro. */
+		class Registrar
+		{
+			public:
+				Registrar(const char* name, BenchmarkRegistry::BenchmarkFunction functionPointer)
+				{
+					BenchmarkRegistry::Add(name, functionPointer);
+				}
+		};
+
+		/**
+		  Adds the given benchmark to the registry.
+		  @param name Unique name of the benchmark, used to filter which benchmarks get run. Cannot be null.
+		  @param functionPointer The benchmark's function. Cannot be null.
+		 */
+		static void Add(const char* name, BenchmarkRegistry::BenchmarkFunction functionPointer);
+
+		/**
+		  Runs all registered benchmarks whose name contains the given filter, sorted by name.
+		  @param settings The settings to pass to every benchmark.
+		  @param nameFilter Only benchmarks whose name contains this string are run. Set to null to run all of them.
+		  @return Returns the number of benchmarks that have failed. Returns zero if all of them have passed.
+
+		          Returns 1 if given a name filter which does not match any benchmark.
+		 */
+		static int RunAll(const BenchmarkRegistry::Settings& settings, const char* nameFilter);
+
+		/**
+		  Converts the given duration to the number of nanoseconds spent per operation.
+		  @param duration The total time spent performing the operations.
+		  @param operationCount The number of operations performed. Zero is treated as 1.
+		  @return Returns the average duration of 1 operation in nanoseconds.
+		 */
+		static double ToNanosecondsPerOperation(std::chrono::steady_clock::duration duration, uint64_t operationCount);
+
+	private:
+		/** Constructor deleted since this class only provides static members. */
+		BenchmarkRegistry() = delete;
+};
+
+
+/**
+  Defines a benchmark function having the given name and registers it with the BenchmarkRegistry.
+  The macro is expected to be followed by the function's body, which receives a "settings" argument.
+ */
+#define PLUGIN_BENCHMARK(name) \
+	static bool name(const BenchmarkRegistry::Settings& settings); \
+	static BenchmarkRegistry::Registrar s##name##Registrar(#name, &name); \
+	static bool name(const BenchmarkRegistry::Settings& settings)
@@ -0,0 +1,269 @@
+// ----------------------------------------------------------------------------
+// 
+// CallResultCallbackBenchmark.cpp
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#include "AllocationCounter.h"
+#include "BenchmarkRegistry.h"
+#include "SteamApiStubs.h"
+#include "SteamCallResultHandler.h"
+#include "SteamCallResultHandlerPool.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+/** Number of requests waiting for a Steam result at the same time. */
+static const uint32_t kInFlightRequestCount = 64;
+
+/** Leaderboard name passed to every request, as done by the plugin's leaderboard request functions. */
+static const char kLeaderboardName[] = "Feet Traveled";
+
+
+/** Stands in for the per-request LuaEventDispatcher, which needs a Lua state. Both paths share 1 instance. */
+struct FakeLuaEventDispatcher
+{
+	uint64_t DispatchedEventCount;
+};
+
+/** Stands in for the pooled dispatch task that a request's result gets copied to. */
+struct FakeDispatchEventTask
+{
+	/** ID of the request the task was acquired for. */
+	uint64_t RequestId;
+
+	/** Number of times a result has been copied to this task. */
+	uint64_t ReceivedCount;
+};
+
+/** Deleter of a "FakeTaskPointer". Does nothing, the same way a pooled task's releaser never frees it. */
+struct FakeDispatchEventTaskReleaser
+{
+	void operator()(FakeDispatchEventTask*) const
+	{
+	}
+};
+
+/** Move-only task pointer having the same size as the "DispatchEventTaskPool<T>::TaskPointer" type. */
+typedef std::unique_ptr<FakeDispatchEventTask, FakeDispatchEventTaskReleaser> FakeTaskPointer;
+
+
+/**
+  Same shape as the RuntimeContext's CallResultCallback, which is what the plugin gives to a
+  SteamCallResultHandler for every request: a context pointer, the request's task, and its request ID.
+ */
+struct InlineCallResultCallback
+{
+	FakeLuaEventDispatcher* ContextPointer;
+	FakeTaskPointer TaskPointer;
+	uint64_t RequestId;
+
+	void operator()(LeaderboardFindResult_t*, bool)
+	{
+		TaskPointer->RequestId = RequestId;
+		TaskPointer->ReceivedCount++;
+		ContextPointer->DispatchedEventCount++;
+	}
+};
+
+
+/**
+  Copy of the SteamCallResultHandler class before it stored its callback inline, which copied a
+  std::function when assigned a callback and again when invoking it.
+  Used as the baseline the current SteamCallResultHandler is compared against.
+ */
+class StdFunctionCallResultHandler
+{
+	public:
+		typedef std::function<void(LeaderboardFindResult_t*, bool)> Callback;
+
+		StdFunctionCallResultHandler()
+		{
+		}
+
+		void Handle(SteamAPICall_t callResultHandle, const Callback& callback)
+		{
+			fCallback = callback;
+			fCallResult.Set(callResultHandle, this, &StdFunctionCallResultHandler::OnReceived);
+		}
+
+	private:
+		StdFunctionCallResultHandler(const StdFunctionCallResultHandler&) = delete;
+		void operator=(const StdFunctionCallResultHandler&) = delete;
+
+		void OnReceived(LeaderboardFindResult_t* resultPointer, bool hadIOFailure)
+		{
+			if (!fCallback)
+			{
+				return;
+			}
+			auto callback = fCallback;
+			fCallback = nullptr;
+			callback(resultPointer, hadIOFailure);
+		}
+
+		CCallResult<StdFunctionCallResultHandler, LeaderboardFindResult_t> fCallResult;
+		Callback fCallback;
+};
+
+
+/**
+  Sends "kInFlightRequestCount" requests at a time and then delivers their results, for the given number of rounds,
+  the same way the plugin's request path does now: the handler is acquired from its pool and is given a
+  callback which is stored within the handler's inline buffer.
+  @param handlerPool The pool to acquire the requests' handlers from.
+  @param roundCount Number of times to start and complete all requests.
+  @param allocationCount Set to the number of heap allocations made by all rounds.
+  @return Returns the total number of results received by the requests' callbacks.
+ */
+static uint64_t RunInlineRequests(
+	SteamCallResultHandlerPool& handlerPool, uint32_t roundCount, uint64_t& allocationCount)
+{
+	std::vector<FakeDispatchEventTask> taskCollection(kInFlightRequestCount);
+	std::vector<SteamAPICall_t> callHandleCollection(kInFlightRequestCount);
+	FakeLuaEventDispatcher dispatcher = {};
+	LeaderboardFindResult_t result = {};
+
+	const uint64_t startAllocationCount = AllocationCounter::GetCount();
+	for (uint32_t round = 0; round < roundCount; round++)
+	{
+		for (uint32_t index = 0; index < kInFlightRequestCount; index++)
+		{
+			auto handlerPointer = handlerPool.Acquire<LeaderboardFindResult_t>();
+			InlineCallResultCallback callback;
+			callback.ContextPointer = &dispatcher;
+			callback.TaskPointer = FakeTaskPointer(&taskCollection[index]);
+			callback.RequestId = ((uint64_t)round * kInFlightRequestCount) + index + 1;
+			callHandleCollection[index] = SteamApiStubs::CreateCallHandle();
+			handlerPointer->Handle(callHandleCollection[index], std::move(callback));
+		}
+		for (auto&& callHandle : callHandleCollection)
+		{
+			SteamApiStubs::DeliverCallResult(callHandle, &result, false);
+		}
+	}
+	allocationCount = AllocationCounter::GetCount() - startAllocationCount;
+	return dispatcher.DispatchedEventCount;
+}
+
+/**
+  Sends "kInFlightRequestCount" requests at a time and then delivers their results, for the given number of rounds,
+  the way the plugin's request path originally did: the handler's std::function callback captures a
+  shared_ptr to the request's dispatcher and a copy of the request's std::function "QueuingEventTaskCallback",
+  which captures the leaderboard name as a std::string.
+  @param roundCount Number of times to start and complete all requests.
+  @param allocationCount Set to the number of heap allocations made by all rounds.
+  @return Returns the total number of results received by the requests' callbacks.
+ */
+static uint64_t RunStdFunctionRequests(uint32_t roundCount, uint64_t& allocationCount)
+{
+	std::vector<std::unique_ptr<StdFunctionCallResultHandler>> handlerCollection;
+	for (uint32_t index = 0; index < kInFlightRequestCount; index++)
+	{
+		handlerCollection.emplace_back(new StdFunctionCallResultHandler());
+	}
+	std::vector<FakeDispatchEventTask> taskCollection(kInFlightRequestCount);
+	std::vector<SteamAPICall_t> callHandleCollection(kInFlightRequestCount);
+	auto dispatcherPointer = std::make_shared<FakeLuaEventDispatcher>();
+	LeaderboardFindResult_t result = {};
+
+	const uint64_t startAllocationCount = AllocationCounter::GetCount();
+	for (uint32_t round = 0; round < roundCount; round++)
+	{
+		for (uint32_t index = 0; index < kInFlightRequestCount; index++)
+		{
+			// What CreateQueueingLeaderboardEventTaskCallbackWith() used to return.
+			std::string capturedLeaderboardName(kLeaderboardName);
+			std::function<void(FakeDispatchEventTask&)> settingsCallback =
+					[capturedLeaderboardName](FakeDispatchEventTask& task)
+			{
+				task.ReceivedCount += capturedLeaderboardName.empty() ? 0 : 1;
+			};
+
+			// What AddEventHandlerFor() used to give to the handler.
+			auto queuingEventTaskCallback = settingsCallback;
+			auto taskPointer = &taskCollection[index];
+			auto luaEventDispatcherPointer = dispatcherPointer;
+			auto callback =
+					[luaEventDispatcherPointer, queuingEventTaskCallback, taskPointer]
+					(LeaderboardFindResult_t*, bool) mutable
+			{
+				if (queuingEventTaskCallback)
+				{
+					queuingEventTaskCallback(*taskPointer);
+				}
+				luaEventDispatcherPointer->DispatchedEventCount++;
+			};
+			callHandleCollection[index] = SteamApiStubs::CreateCallHandle();
+			handlerCollection[index]->Handle(callHandleCollection[index], callback);
+		}
+		for (auto&& callHandle : callHandleCollection)
+		{
+			SteamApiStubs::DeliverCallResult(callHandle, &result, false);
+		}
+	}
+	allocationCount = AllocationCounter::GetCount() - startAllocationCount;
+	return dispatcherPointer->DispatchedEventCount;
+}
+
+
+/**
+  Counts the heap allocations made per request by a SteamCallResultHandler's callback, from assigning it
+  when the request is sent to invoking it once Steam's result has been received. Compares the current
+  InlineFunction callback against the original std::function callback and its nested std::function copy.
+  Fails if the current path allocates anything once its handler pool has warmed up.
+ */
+PLUGIN_BENCHMARK(CallResultCallbackAllocations)
+{
+	const uint32_t roundCount = settings.IsQuick ? 100 : 20000;
+	const uint64_t totalRequestCount = (uint64_t)roundCount * kInFlightRequestCount;
+	bool hasPassed = true;
+
+	// Warm up the handler pool, since creating its handlers is expected to allocate, then measure the current path.
+	SteamCallResultHandlerPool handlerPool;
+	uint64_t allocationCount = 0;
+	RunInlineRequests(handlerPool, 1, allocationCount);
+	auto startTime = std::chrono::steady_clock::now();
+	{
+		uint64_t receivedCount = RunInlineRequests(handlerPool, roundCount, allocationCount);
+		if (receivedCount != totalRequestCount)
+		{
+			printf("  ERROR: InlineFunction requests received %llu results.\n", (unsigned long long)receivedCount);
+			hasPassed = false;
+		}
+	}
+	auto duration = std::chrono::steady_clock::now() - startTime;
+	printf("  %-26s %6.2f allocations/request   %7.1f ns/request\n",
+			"InlineFunction callback", (double)allocationCount / (double)totalRequestCount,
+			BenchmarkRegistry::ToNanosecondsPerOperation(duration, totalRequestCount));
+	if (allocationCount > 0)
+	{
+		printf("  ERROR: The InlineFunction request path made %llu heap allocations after warming up.\n",
+				(unsigned long long)allocationCount);
+		hasPassed = false;
+	}
+
+	// Measure the baseline.
+	startTime = std::chrono::steady_clock::now();
+	{
+		uint64_t receivedCount = RunStdFunctionRequests(roundCount, allocationCount);
+		if (receivedCount != totalRequestCount)
+		{
+			printf("  ERROR: std::function requests received %llu results.\n", (unsigned long long)receivedCount);
+			hasPassed = false;
+		}
+	}
+	duration = std::chrono::steady_clock::now() - startTime;
+	printf("  %-26s %6.2f allocations/request   %7.1f ns/request\n",
+			"std::function callback", (double)allocationCount / (double)totalRequestCount,
+			BenchmarkRegistry::ToNanosecondsPerOperation(duration, totalRequestCount));
+	return hasPassed;
+}
@@ -0,0 +1,86 @@
+// ----------------------------------------------------------------------------
+// 
+// CoronaLuaShims.cpp
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+// Implements the Corona library functions used by the plugin sources built into the benchmarks on top of a plain
+// Lua 5.1 library, since Corona's own library is only available within a Corona app.
+// Only the behavior those sources rely on is provided. For example, there are no Corona coroutine threads.
+
+#include "CoronaLua.h"
+#include <cstdarg>
+#include <cstdio>
+
+
+CORONA_API int CoronaLog(const char* format, ...)
+{
+	va_list arguments;
+	va_start(arguments, format);
+	int result = vprintf(format, arguments);
+	va_end(arguments);
+	return result;
+}
+
+CORONA_API void CoronaLuaWarning(lua_State*, const char* format, ...)
+{
+	va_list arguments;
+	va_start(arguments, format);
+	printf("WARNING: ");
+	vprintf(format, arguments);
+	printf("\n");
+	va_end(arguments);
+}
+
+CORONA_API void CoronaLuaError(lua_State*, const char* format, ...)
+{
+	va_list arguments;
+	va_start(arguments, format);
+	printf("ERROR: ");
+	vprintf(format, arguments);
+	printf("\n");
+	va_end(arguments);
+}
+
+CORONA_API lua_State* CoronaLuaGetCoronaThread(lua_State* coroutine)
+{
+	return coroutine;
+}
+
+CORONA_API void CoronaLuaNewEvent(lua_State* L, const char* eventName)
+{
+	lua_createtable(L, 0, 8);
+	lua_pushstring(L, eventName);
+	lua_setfield(L, -2, "name");
+}
+
+CORONA_API int CoronaLuaIsListener(lua_State* L, int index, const char* eventName)
+{
+	if (lua_isfunction(L, index))
+	{
+		return 1;
+	}
+	if (!lua_istable(L, index))
+	{
+		return 0;
+	}
+	lua_getfield(L, index, eventName);
+	int isListener = lua_isfunction(L, -1) ? 1 : 0;
+	lua_pop(L, 1);
+	return isListener;
+}
+
+CORONA_API int CoronaLuaDoCall(lua_State* L, int narg, int nresults)
+{
+	int result = lua_pcall(L, narg, nresults, 0);
+	if (result)
+	{
+		const char* message = lua_tostring(L, -1);
+		printf("ERROR: %s\n", message ? message : "Unknown Lua error.");
+		lua_pop(L, 1);
+	}
+	return result;
+}
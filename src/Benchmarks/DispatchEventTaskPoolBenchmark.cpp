@@ -0,0 +1,163 @@
+// ----------------------------------------------------------------------------
+// 
+// DispatchEventTaskPoolBenchmark.cpp
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#include "AllocationCounter.h"
+#include "BenchmarkRegistry.h"
+#include "CoronaLua.h"
+#include "DispatchEventTask.h"
+#include "DispatchEventTaskPool.h"
+#include "LuaEventDispatcher.h"
+#include "MpscRingBuffer.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <queue>
+
+
+/** Leaderboard name long enough to not fit in std::string's small buffer, like most real leaderboard names. */
+static const char kLeaderboardName[] = "Weekly High Scores of the Hardest Level";
+
+
+/**
+  Lua memory allocator which counts the number of memory blocks Lua has allocated.
+  @param userData Pointer to the uint64_t counter to increment.
+  @return Returns the (re)allocated memory block. Returns null if freed or out of memory.
+ */
+static void* OnLuaAllocate(void* userData, void* memoryPointer, size_t, size_t newSize)
+{
+	if (0 == newSize)
+	{
+		free(memoryPointer);
+		return nullptr;
+	}
+	if (!memoryPointer)
+	{
+		(*static_cast<uint64_t*>(userData))++;
+	}
+	return realloc(memoryPointer, newSize);
+}
+
+/**
+  Prints the heap allocations made per event by a measured event path.
+  @param pathName Name of the measured path to print.
+  @param allocationCount Number of native heap allocations the path made.
+  @param eventCount Number of events sent through the path.
+  @param duration Time spent sending the events through the path.
+ */
+static void PrintResultsFor(
+	const char* pathName, uint64_t allocationCount, uint32_t eventCount, std::chrono::steady_clock::duration duration)
+{
+	printf("  %-34s %6.2f heap allocations/event %8.1f ns/event\n",
+			pathName, (double)allocationCount / (double)eventCount,
+			BenchmarkRegistry::ToNanosecondsPerOperation(duration, eventCount));
+}
+
+
+/**
+  Counts the native heap allocations made per leaderboard event by the DispatchEventTaskPool and its re-usable
+  payloads, compared to allocating a new task owned by a "std::shared_ptr" for every Steam callback.
+  Also reports the allocations made while dispatching the event to a Lua listener, which includes the Lua table.
+  Fails if the pooled path allocates once warmed up.
+ */
+PLUGIN_BENCHMARK(DispatchEventTaskAllocations)
+{
+	const uint32_t eventCount = settings.IsQuick ? 10000 : 1000000;
+	LeaderboardScoresDownloaded_t eventData{};
+	eventData.m_hSteamLeaderboard = 1;
+
+	// Measure the original path, which allocated a task, its shared_ptr control block, and its payload per event.
+	{
+		std::queue<std::shared_ptr<BaseDispatchEventTask>> taskQueue;
+		const auto allocationCount = AllocationCounter::GetCount();
+		const auto startTime = std::chrono::steady_clock::now();
+		for (uint32_t eventIndex = 0; eventIndex < eventCount; eventIndex++)
+		{
+			std::shared_ptr<DispatchLeaderboardScoresDownloadedEventTask> taskPointer(
+					new DispatchLeaderboardScoresDownloadedEventTask());
+			taskPointer->AcquireEventDataFrom(eventData);
+			taskPointer->SetLeaderboardName(kLeaderboardName);
+			taskQueue.push(taskPointer);
+			taskQueue.pop();
+		}
+		PrintResultsFor(
+				"new task + shared_ptr", AllocationCounter::GetCount() - allocationCount, eventCount,
+				std::chrono::steady_clock::now() - startTime);
+	}
+
+	// Measure the pooled path, from the Steam callback acquiring a task to the Lua thread releasing it.
+	// Note: The first event is sent before measuring, which allocates the pool's first slab and the task's payload.
+	bool hasPassed = true;
+	{
+		auto& taskPool = DispatchEventTaskPool<DispatchLeaderboardScoresDownloadedEventTask>::GetInstance();
+		MpscRingBuffer<DispatchEventTaskPointer> taskQueue(1024);
+		uint64_t allocationCount = 0;
+		uint64_t slabAllocationCount = 0;
+		auto startTime = std::chrono::steady_clock::now();
+		for (uint32_t eventIndex = 0; eventIndex <= eventCount; eventIndex++)
+		{
+			if (1 == eventIndex)
+			{
+				allocationCount = AllocationCounter::GetCount();
+				slabAllocationCount = BaseDispatchEventTaskPool::GetTotalSlabAllocationCount();
+				startTime = std::chrono::steady_clock::now();
+			}
+			auto taskPointer = taskPool.Acquire();
+			taskPointer->AcquireEventDataFrom(eventData);
+			taskPointer->SetLeaderboardName(kLeaderboardName);
+			taskQueue.TryPush(DispatchEventTaskPointer(std::move(taskPointer)));
+			DispatchEventTaskPointer poppedTaskPointer;
+			taskQueue.TryPop(poppedTaskPointer);
+		}
+		const auto duration = std::chrono::steady_clock::now() - startTime;
+		allocationCount = AllocationCounter::GetCount() - allocationCount;
+		slabAllocationCount = BaseDispatchEventTaskPool::GetTotalSlabAllocationCount() - slabAllocationCount;
+		PrintResultsFor("DispatchEventTaskPool", allocationCount, eventCount, duration);
+		if (allocationCount || slabAllocationCount)
+		{
+			printf("  ERROR: The pooled event path made %llu heap allocations after warming up.\n",
+					(unsigned long long)allocationCount);
+			hasPassed = false;
+		}
+	}
+
+	// Measure the pooled path with its Lua event dispatch, which is what Steam events cost end-to-end.
+	{
+		uint64_t luaAllocationCount = 0;
+		lua_State* luaStatePointer = lua_newstate(OnLuaAllocate, &luaAllocationCount);
+		auto dispatcherPointer = std::make_shared<LuaEventDispatcher>(luaStatePointer);
+		luaL_loadstring(luaStatePointer, "return function(event) return event.leaderboardName end");
+		lua_call(luaStatePointer, 0, 1);
+		dispatcherPointer->AddEventListener(
+				luaStatePointer, DispatchLeaderboardScoresDownloadedEventTask::kLuaEventName, -1);
+		lua_pop(luaStatePointer, 1);
+
+		auto& taskPool = DispatchEventTaskPool<DispatchLeaderboardScoresDownloadedEventTask>::GetInstance();
+		uint64_t allocationCount = AllocationCounter::GetCount();
+		luaAllocationCount = 0;
+		const auto startTime = std::chrono::steady_clock::now();
+		for (uint32_t eventIndex = 0; eventIndex < eventCount; eventIndex++)
+		{
+			auto taskPointer = taskPool.Acquire();
+			taskPointer->SetLuaEventDispatcher(dispatcherPointer);
+			taskPointer->AcquireEventDataFrom(eventData);
+			taskPointer->SetLeaderboardName(kLeaderboardName);
+			taskPointer->Execute();
+		}
+		const auto duration = std::chrono::steady_clock::now() - startTime;
+		allocationCount = AllocationCounter::GetCount() - allocationCount;
+		PrintResultsFor("DispatchEventTaskPool + Lua dispatch", allocationCount, eventCount, duration);
+		printf("  %-34s %6.2f Lua allocations/event (event table and its strings)\n",
+				"", (double)luaAllocationCount / (double)eventCount);
+		dispatcherPointer = nullptr;
+		lua_close(luaStatePointer);
+	}
+	return hasPassed;
+}
@@ -0,0 +1,141 @@
+// ----------------------------------------------------------------------------
+// 
+// LegacySteamEventDispatch.cpp
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#include "LegacySteamEventDispatch.h"
+#include "CoronaLua.h"
+#include "DispatchEventTask.h"
+#include "PluginMacros.h"
+#include <cstdint>
+#include <typeinfo>
+PLUGIN_DISABLE_STEAM_WARNINGS_BEGIN
+#	include "steam_api.h"
+PLUGIN_DISABLE_STEAM_WARNINGS_END
+
+
+/** The type queries that every event task used to provide as virtual methods. */
+class LegacyEventTaskQueries
+{
+	public:
+		virtual ~LegacyEventTaskQueries() {}
+		virtual const char* GetLuaEventName() const = 0;
+		virtual BaseDispatchEventTask::Priority GetPriority() const = 0;
+		virtual bool CopyCoalescingKeyTo(BaseDispatchEventTask::CoalescingKey& key) const = 0;
+};
+
+template<class TDispatchEventTask>
+/**
+  Event task whose type queries are virtual again, the way they were before they became base class fields.
+  Wraps the task instead of deriving from it, since the plugin's task classes are built without RTTI
+  and this file is not.
+ */
+class LegacyEventTask : public LegacyEventTaskQueries
+{
+	public:
+		virtual const char* GetLuaEventName() const override
+		{
+			return TDispatchEventTask::kLuaEventName;
+		}
+
+		virtual BaseDispatchEventTask::Priority GetPriority() const override
+		{
+			return Task.GetPriority();
+		}
+
+		virtual bool CopyCoalescingKeyTo(BaseDispatchEventTask::CoalescingKey& key) const override
+		{
+			return Task.CopyCoalescingKeyTo(key);
+		}
+
+		/** The wrapped task. */
+		TDispatchEventTask Task;
+};
+
+
+template<class TSteamResultType, class TDispatchEventTask>
+/**
+  Sends 1 CCallResult event through the legacy per-event work.
+  @param task The task to copy the result to.
+  @param result The Steam result received by the CCallResult.
+  @param luaStatePointer Lua state to push the event's Lua table to. Can be null.
+  @return Returns a checksum of the queried values.
+ */
+static uint64_t DispatchLegacyEvent(
+	LegacyEventTask<TDispatchEventTask>& task, TSteamResultType& result, lua_State* luaStatePointer)
+{
+	uint64_t checksum = 0;
+	TSteamResultType* resultPointer = &result;
+
+	// What every CCallResult callback created by AddEventHandlerFor() used to do.
+	if (typeid(*resultPointer) == typeid(LeaderboardFindResult_t))
+	{
+		auto steamUserStatsPointer = SteamUserStats();
+		auto leaderboardResultPointer = (LeaderboardFindResult_t*)resultPointer;
+		if (leaderboardResultPointer->m_bLeaderboardFound && steamUserStatsPointer)
+		{
+			checksum += (uint64_t)leaderboardResultPointer->m_hSteamLeaderboard;
+		}
+		checksum++;
+	}
+	task.Task.SetHadIOFailure(false);
+	task.Task.AcquireEventDataFrom(*resultPointer);
+
+	// What queueing, suspended event buffering, and coalescing used to query per task.
+	LegacyEventTaskQueries& queries = task;
+	BaseDispatchEventTask::CoalescingKey key{};
+	checksum += (uint64_t)(uintptr_t)queries.GetLuaEventName();
+	checksum += (uint64_t)queries.GetPriority();
+	if (queries.CopyCoalescingKeyTo(key))
+	{
+		checksum += (uint64_t)key.UserIntegerId;
+	}
+
+	// Push the event's Lua table, which was and still is a virtual call.
+	if (luaStatePointer)
+	{
+		BaseDispatchEventTask& baseTask = task.Task;
+		checksum += baseTask.PushLuaEventTableTo(luaStatePointer) ? 1 : 0;
+		lua_settop(luaStatePointer, 0);
+	}
+	return checksum;
+}
+
+uint64_t RunLegacySteamEventDispatch(lua_State* luaStatePointer, uint32_t eventCount)
+{
+	LegacyEventTask<DispatchLeaderboardFindResultEventTask> findTask;
+	LegacyEventTask<DispatchLeaderboardScoresDownloadedEventTask> downloadTask;
+	LegacyEventTask<DispatchLeaderboardScoreUploadEventTask> uploadTask;
+	LegacyEventTask<DispatchNumberOfCurrentPlayersEventTask> playerCountTask;
+	LeaderboardFindResult_t findResult{};
+	LeaderboardScoresDownloaded_t downloadResult{};
+	LeaderboardScoreUploaded_t uploadResult{};
+	NumberOfCurrentPlayers_t playerCountResult{};
+	findResult.m_bLeaderboardFound = 1;
+	playerCountResult.m_bSuccess = 1;
+
+	uint64_t checksum = 0;
+	for (uint32_t eventIndex = 0; eventIndex < eventCount; eventIndex++)
+	{
+		switch (eventIndex % 4)
+		{
+			case 0:
+				checksum += DispatchLegacyEvent(findTask, findResult, luaStatePointer);
+				break;
+			case 1:
+				checksum += DispatchLegacyEvent(downloadTask, downloadResult, luaStatePointer);
+				break;
+			case 2:
+				checksum += DispatchLegacyEvent(uploadTask, uploadResult, luaStatePointer);
+				break;
+			default:
+				checksum += DispatchLegacyEvent(playerCountTask, playerCountResult, luaStatePointer);
+				break;
+		}
+	}
+	return checksum;
+}
@@ -0,0 +1,33 @@
+// ----------------------------------------------------------------------------
+// 
+// LegacySteamEventDispatch.h
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstdint>
+
+
+// Forward declarations.
+extern "C"
+{
+	struct lua_State;
+}
+
+
+/**
+  Sends the given number of CCallResult events through the per-event work the plugin did before its event tasks
+  were selected at compile time: a typeid() check for a LeaderboardFindResult_t in every callback and virtual
+  GetLuaEventName(), GetPriority(), and CopyCoalescingKeyTo() calls while queueing and coalescing the task.
+
+  Implemented by "LegacySteamEventDispatch.cpp", which is the only benchmark source built with RTTI.
+  Used as the baseline of the "SteamEventDispatchCost" benchmark.
+  @param luaStatePointer Lua state to push each event's Lua table to. Set to null to not push Lua tables.
+  @param eventCount Number of events to send, cycling through 4 Steam result types.
+  @return Returns a checksum of the queried values, which keeps the compiler from optimizing the work away.
+ */
+uint64_t RunLegacySteamEventDispatch(lua_State* luaStatePointer, uint32_t eventCount);
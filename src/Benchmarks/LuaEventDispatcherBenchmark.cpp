@@ -0,0 +1,216 @@
+// ----------------------------------------------------------------------------
+// 
+// LuaEventDispatcherBenchmark.cpp
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#include "BenchmarkRegistry.h"
+#include "CoronaLua.h"
+#include "LuaEventDispatcher.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+
+/** Name of the event dispatched by this benchmark. */
+static const char kEventName[] = "benchmarkEvent";
+
+/**
+  Lua implementation of an event dispatcher object, the same as one created by Corona's system.newEventDispatcher():
+  dispatchEvent() walks the event's function listeners and then its table listeners, calling a table listener's
+  method named after the event, and returns true if a listener returned true.
+  Used as the baseline that the plugin's LuaEventDispatcher used to dispatch every event through.
+  Returns a function which creates a new dispatcher object.
+ */
+static const char kLuaEventDispatcherSource[] =
+		"local EventDispatcher = {}\n"
+		"EventDispatcher.__index = EventDispatcher\n"
+		"function EventDispatcher:addEventListener(eventName, listener)\n"
+		"	local key = (type(listener) == 'table') and '_tableListeners' or '_functionListeners'\n"
+		"	local listenersByName = self[key]\n"
+		"	if not listenersByName then listenersByName = {}; self[key] = listenersByName end\n"
+		"	local listeners = listenersByName[eventName]\n"
+		"	if not listeners then listeners = {}; listenersByName[eventName] = listeners end\n"
+		"	for index = 1, #listeners do if listeners[index] == listener then return false end end\n"
+		"	listeners[#listeners + 1] = listener\n"
+		"	return true\n"
+		"end\n"
+		"function EventDispatcher:dispatchEvent(event)\n"
+		"	local result = false\n"
+		"	local eventName = event.name\n"
+		"	local functionListeners = self._functionListeners and self._functionListeners[eventName]\n"
+		"	if functionListeners then\n"
+		"		for index = 1, #functionListeners do\n"
+		"			result = functionListeners[index](event) or result\n"
+		"		end\n"
+		"	end\n"
+		"	local tableListeners = self._tableListeners and self._tableListeners[eventName]\n"
+		"	if tableListeners then\n"
+		"		for index = 1, #tableListeners do\n"
+		"			local listener = tableListeners[index]\n"
+		"			local method = listener[eventName]\n"
+		"			if type(method) == 'function' then result = method(listener, event) or result end\n"
+		"		end\n"
+		"	end\n"
+		"	return result\n"
+		"end\n"
+		"return function() return setmetatable({}, EventDispatcher) end\n";
+
+/**
+  Creates the listeners used by this benchmark, which count the number of times they were called.
+  Returns 2 function listeners, 1 table listener, and a function returning the call count.
+ */
+static const char kLuaListenersSource[] =
+		"local callCount = 0\n"
+		"local tableListener = {}\n"
+		"function tableListener:benchmarkEvent(event) callCount = callCount + 1 end\n"
+		"return\n"
+		"	function(event) callCount = callCount + 1 end,\n"
+		"	function(event) callCount = callCount + 1 end,\n"
+		"	tableListener,\n"
+		"	function() return callCount end\n";
+
+
+/**
+  Runs the given Lua source code and leaves its return values on the stack.
+  @param luaStatePointer The Lua state to run the code on.
+  @param source The Lua source code to run.
+  @param resultCount The number of values the code returns.
+  @return Returns true if the code ran. Returns false if it failed, in which case nothing is pushed.
+ */
+static bool RunLuaString(lua_State* luaStatePointer, const char* source, int resultCount)
+{
+	if (luaL_loadstring(luaStatePointer, source))
+	{
+		printf("  ERROR: %s\n", lua_tostring(luaStatePointer, -1));
+		lua_pop(luaStatePointer, 1);
+		return false;
+	}
+	return (0 == CoronaLuaDoCall(luaStatePointer, 0, resultCount));
+}
+
+/**
+  Calls the listeners' call count function and returns its result.
+  @param luaStatePointer The Lua state the listeners were created on.
+  @param callCountFunctionStackIndex Absolute index to the call count function.
+  @return Returns the number of times the listeners have been called.
+ */
+static uint64_t GetListenerCallCount(lua_State* luaStatePointer, int callCountFunctionStackIndex)
+{
+	lua_pushvalue(luaStatePointer, callCountFunctionStackIndex);
+	lua_call(luaStatePointer, 0, 1);
+	uint64_t callCount = (uint64_t)lua_tonumber(luaStatePointer, -1);
+	lua_pop(luaStatePointer, 1);
+	return callCount;
+}
+
+/**
+  Prints the cost per event of a measured dispatch path.
+  @param pathName Name of the measured path to print.
+  @param listenerCount Number of listeners every event was dispatched to.
+  @param eventCount Number of events dispatched.
+  @param duration Time spent dispatching the events.
+ */
+static void PrintResultsFor(
+	const char* pathName, int listenerCount, uint32_t eventCount, std::chrono::steady_clock::duration duration)
+{
+	printf("  %-28s %d listener(s): %7.1f ns/event\n",
+			pathName, listenerCount, BenchmarkRegistry::ToNanosecondsPerOperation(duration, eventCount));
+}
+
+
+/**
+  Measures the cost per event of dispatching a Lua event table to 1 and 3 listeners via the native
+  LuaEventDispatcher registry, compared to calling the dispatchEvent() method of a Lua EventDispatcher object
+  the way the plugin used to. Both paths create the same Lua event table per event.
+  Fails if either path does not call every listener for every event.
+ */
+PLUGIN_BENCHMARK(LuaEventDispatcherCost)
+{
+	const uint32_t eventCount = settings.IsQuick ? 20000 : 2000000;
+	bool hasPassed = true;
+
+	lua_State* luaStatePointer = luaL_newstate();
+	luaL_openlibs(luaStatePointer);
+	if (!RunLuaString(luaStatePointer, kLuaEventDispatcherSource, 1) ||
+	    !RunLuaString(luaStatePointer, kLuaListenersSource, 4))
+	{
+		lua_close(luaStatePointer);
+		return false;
+	}
+	const int newDispatcherFunctionIndex = 1;
+	const int firstListenerIndex = 2;
+	const int callCountFunctionIndex = 5;
+
+	const int listenerCountCollection[] = { 1, 3 };
+	for (auto&& listenerCount : listenerCountCollection)
+	{
+		// Measure the native listener registry.
+		{
+			LuaEventDispatcher dispatcher(luaStatePointer);
+			for (int index = 0; index < listenerCount; index++)
+			{
+				dispatcher.AddEventListener(luaStatePointer, kEventName, firstListenerIndex + index);
+			}
+			const uint64_t startCallCount = GetListenerCallCount(luaStatePointer, callCountFunctionIndex);
+			const auto startTime = std::chrono::steady_clock::now();
+			for (uint32_t eventIndex = 0; eventIndex < eventCount; eventIndex++)
+			{
+				CoronaLuaNewEvent(luaStatePointer, kEventName);
+				dispatcher.DispatchEventWithoutResult(luaStatePointer, -1);
+				lua_pop(luaStatePointer, 1);
+			}
+			const auto duration = std::chrono::steady_clock::now() - startTime;
+			PrintResultsFor("native listener registry", listenerCount, eventCount, duration);
+			const uint64_t callCount = GetListenerCallCount(luaStatePointer, callCountFunctionIndex) - startCallCount;
+			if (callCount != ((uint64_t)eventCount * listenerCount))
+			{
+				printf("  ERROR: The native listener registry called its listeners %llu times.\n",
+						(unsigned long long)callCount);
+				hasPassed = false;
+			}
+		}
+
+		// Measure the Lua EventDispatcher object, which is what the plugin's dispatcher used to wrap.
+		{
+			lua_pushvalue(luaStatePointer, newDispatcherFunctionIndex);
+			lua_call(luaStatePointer, 0, 1);
+			for (int index = 0; index < listenerCount; index++)
+			{
+				lua_getfield(luaStatePointer, -1, "addEventListener");
+				lua_pushvalue(luaStatePointer, -2);
+				lua_pushstring(luaStatePointer, kEventName);
+				lua_pushvalue(luaStatePointer, firstListenerIndex + index);
+				lua_call(luaStatePointer, 3, 0);
+			}
+			const int dispatcherReferenceId = luaL_ref(luaStatePointer, LUA_REGISTRYINDEX);
+			const uint64_t startCallCount = GetListenerCallCount(luaStatePointer, callCountFunctionIndex);
+			const auto startTime = std::chrono::steady_clock::now();
+			for (uint32_t eventIndex = 0; eventIndex < eventCount; eventIndex++)
+			{
+				CoronaLuaNewEvent(luaStatePointer, kEventName);
+				lua_rawgeti(luaStatePointer, LUA_REGISTRYINDEX, dispatcherReferenceId);
+				lua_getfield(luaStatePointer, -1, "dispatchEvent");
+				lua_insert(luaStatePointer, -2);
+				lua_pushvalue(luaStatePointer, -3);
+				CoronaLuaDoCall(luaStatePointer, 2, 1);
+				lua_pop(luaStatePointer, 2);
+			}
+			const auto duration = std::chrono::steady_clock::now() - startTime;
+			PrintResultsFor("Lua EventDispatcher object", listenerCount, eventCount, duration);
+			const uint64_t callCount = GetListenerCallCount(luaStatePointer, callCountFunctionIndex) - startCallCount;
+			if (callCount != ((uint64_t)eventCount * listenerCount))
+			{
+				printf("  ERROR: The Lua EventDispatcher object called its listeners %llu times.\n",
+						(unsigned long long)callCount);
+				hasPassed = false;
+			}
+			luaL_unref(luaStatePointer, LUA_REGISTRYINDEX, dispatcherReferenceId);
+		}
+	}
+	lua_close(luaStatePointer);
+	return hasPassed;
+}
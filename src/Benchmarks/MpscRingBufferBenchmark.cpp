@@ -0,0 +1,172 @@
+// ----------------------------------------------------------------------------
+// 
+// MpscRingBufferBenchmark.cpp
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#include "BenchmarkRegistry.h"
+#include "MpscRingBuffer.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+
+/** Same capacity as the RuntimeContext's dispatch queue. */
+static const size_t kQueueCapacity = 1024;
+
+
+/**
+  Unbounded queue guarded by a mutex, which is what the RuntimeContext's original "std::queue" would have needed
+  to be pushed to from other threads. Used as the baseline the MpscRingBuffer is compared against.
+ */
+class MutexGuardedQueue
+{
+	public:
+		/** Creates an empty queue. The capacity is ignored since this queue is unbounded. */
+		explicit MutexGuardedQueue(size_t)
+		{
+		}
+
+		bool TryPush(uint64_t&& item)
+		{
+			std::lock_guard<std::mutex> scopedLock(fMutex);
+			fQueue.push(item);
+			return true;
+		}
+
+		bool TryPop(uint64_t& item)
+		{
+			std::lock_guard<std::mutex> scopedLock(fMutex);
+			if (fQueue.empty())
+			{
+				return false;
+			}
+			item = fQueue.front();
+			fQueue.pop();
+			return true;
+		}
+
+	private:
+		std::mutex fMutex;
+		std::queue<uint64_t> fQueue;
+};
+
+
+template<class TQueue>
+/**
+  Pushes items from the given number of producer threads while popping them on the calling thread, the same way
+  Steam's callbacks and worker threads feed the Lua thread. Prints the measured throughput.
+  @param queueName Name of the queue type to print.
+  @param producerCount Number of producer threads to push items from.
+  @param itemCountPerProducer Number of items each producer thread pushes.
+  @return Returns true if every item was popped in the order its producer pushed it. Returns false if not.
+ */
+static bool MeasureThroughputOf(const char* queueName, uint32_t producerCount, uint32_t itemCountPerProducer)
+{
+	TQueue queue(kQueueCapacity);
+
+	// Start the producers. Each item encodes its producer's index and sequence number to verify their order.
+	// Note: A producer retries after yielding when the queue is full, instead of dropping its item.
+	std::atomic<bool> shouldStart(false);
+	std::atomic<uint64_t> fullQueueRetryCount(0);
+	std::vector<std::thread> threadCollection;
+	for (uint32_t producerIndex = 0; producerIndex < producerCount; producerIndex++)
+	{
+		threadCollection.emplace_back([&, producerIndex]()
+		{
+			while (!shouldStart.load(std::memory_order_acquire))
+			{
+				std::this_thread::yield();
+			}
+			uint64_t retryCount = 0;
+			for (uint32_t sequence = 0; sequence < itemCountPerProducer;)
+			{
+				uint64_t item = ((uint64_t)producerIndex << 32) | sequence;
+				if (queue.TryPush(std::move(item)))
+				{
+					sequence++;
+				}
+				else
+				{
+					retryCount++;
+					std::this_thread::yield();
+				}
+			}
+			fullQueueRetryCount += retryCount;
+		});
+	}
+
+	// Pop all items on this thread, which acts as the queue's single consumer.
+	const uint64_t totalItemCount = (uint64_t)producerCount * itemCountPerProducer;
+	std::vector<uint32_t> nextSequenceCollection(producerCount, 0);
+	bool isOrdered = true;
+	uint64_t poppedItemCount = 0;
+	const auto startTime = std::chrono::steady_clock::now();
+	shouldStart.store(true, std::memory_order_release);
+	while (poppedItemCount < totalItemCount)
+	{
+		uint64_t item = 0;
+		if (queue.TryPop(item))
+		{
+			const uint32_t producerIndex = (uint32_t)(item >> 32);
+			const uint32_t sequence = (uint32_t)(item & 0xFFFFFFFF);
+			if ((producerIndex >= producerCount) || (sequence != nextSequenceCollection[producerIndex]))
+			{
+				isOrdered = false;
+			}
+			else
+			{
+				nextSequenceCollection[producerIndex]++;
+			}
+			poppedItemCount++;
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+	const auto duration = std::chrono::steady_clock::now() - startTime;
+	for (auto&& thread : threadCollection)
+	{
+		thread.join();
+	}
+
+	// Print the results.
+	const double nanosecondsPerItem = BenchmarkRegistry::ToNanosecondsPerOperation(duration, totalItemCount);
+	printf("  %-18s %u producer(s): %8.1f ns/item %9.2f M items/s %10llu full-queue retries\n",
+			queueName, producerCount, nanosecondsPerItem, 1000.0 / nanosecondsPerItem,
+			(unsigned long long)fullQueueRetryCount.load());
+	if (!isOrdered)
+	{
+		printf("  ERROR: %s popped items out of their producer's order.\n", queueName);
+	}
+	return isOrdered;
+}
+
+
+/**
+  Measures the enqueue/dequeue throughput of the RuntimeContext's MpscRingBuffer dispatch queue with 1, 4, and 8
+  producer threads, compared to a mutex guarded std::queue. Items are 64-bit integers so that only the cost of the
+  queue itself is measured, not the cost of creating dispatch tasks.
+ */
+PLUGIN_BENCHMARK(MpscRingBufferThroughput)
+{
+	const uint32_t totalItemCount = settings.IsQuick ? 100000 : 4000000;
+	bool hasPassed = true;
+	const uint32_t producerCountCollection[] = { 1, 4, 8 };
+	for (auto&& producerCount : producerCountCollection)
+	{
+		const uint32_t itemCountPerProducer = totalItemCount / producerCount;
+		hasPassed &= MeasureThroughputOf<MpscRingBuffer<uint64_t>>("MpscRingBuffer", producerCount, itemCountPerProducer);
+		hasPassed &= MeasureThroughputOf<MutexGuardedQueue>("mutex + std::queue", producerCount, itemCountPerProducer);
+	}
+	return hasPassed;
+}
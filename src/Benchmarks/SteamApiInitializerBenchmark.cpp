@@ -0,0 +1,104 @@
+// ----------------------------------------------------------------------------
+// 
+// SteamApiInitializerBenchmark.cpp
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#include "BenchmarkRegistry.h"
+#include "SteamApiInitializer.h"
+#include "SteamApiStubs.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+
+
+/**
+  Converts the given duration to milliseconds.
+  @param duration The duration to convert.
+  @return Returns the given duration in fractional milliseconds.
+ */
+static double ToMilliseconds(std::chrono::steady_clock::duration duration)
+{
+	return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+/**
+  Initializes Steam the given number of times, shutting it down in between, and prints how long the calling thread
+  was blocked for and how long it took until Steam's APIs were usable.
+  @param isAsync Set true to use InitializeAsync(). Set false to use the blocking Initialize() method.
+  @param runCount Number of times to initialize Steam.
+  @return Returns true if every initialization succeeded and an asynchronous one did not block. Returns false if not.
+ */
+static bool MeasureStartupOf(bool isAsync, uint32_t runCount)
+{
+	bool hasPassed = true;
+	std::chrono::steady_clock::duration totalBlockedDuration(0);
+	std::chrono::steady_clock::duration totalReadyDuration(0);
+	for (uint32_t runIndex = 0; runIndex < runCount; runIndex++)
+	{
+		// Initialize Steam, which is what luaopen_plugin_steamworks() does before returning the plugin's table.
+		const auto startTime = std::chrono::steady_clock::now();
+		bool wasStarted = isAsync ?
+				SteamApiInitializer::InitializeAsync(nullptr) : SteamApiInitializer::Initialize(nullptr);
+		const auto returnTime = std::chrono::steady_clock::now();
+		if (!wasStarted)
+		{
+			hasPassed = false;
+		}
+		if (isAsync && (SteamApiInitializer::GetState() != SteamApiInitializer::State::kInitializing))
+		{
+			printf("  ERROR: InitializeAsync() returned after the Steam handshake had finished.\n");
+			hasPassed = false;
+		}
+
+		// Wait for Steam's APIs to become usable, which is when parked requests get sent.
+		while (SteamApiInitializer::IsInitializing())
+		{
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+		}
+		const auto readyTime = std::chrono::steady_clock::now();
+		if (SteamApiInitializer::GetState() != SteamApiInitializer::State::kSucceeded)
+		{
+			hasPassed = false;
+		}
+		totalBlockedDuration += returnTime - startTime;
+		totalReadyDuration += readyTime - startTime;
+		SteamApiInitializer::Shutdown();
+	}
+
+	// Print the results.
+	printf("  %-18s returns to Lua after: %8.3f ms   Steam ready after: %8.3f ms\n",
+			isAsync ? "asyncInit = true" : "asyncInit = false",
+			ToMilliseconds(totalBlockedDuration) / (double)runCount,
+			ToMilliseconds(totalReadyDuration) / (double)runCount);
+	if (!hasPassed)
+	{
+		printf("  ERROR: Failed to initialize the Steam client stubs.\n");
+	}
+	return hasPassed;
+}
+
+
+/**
+  Measures how long the plugin's loader blocks the Lua thread, and therefore delays the app's first frame,
+  while connecting to Steam synchronously compared to the "asyncInit" mode. The Steam client's handshake is
+  simulated by a SteamAPI_Init() stub which sleeps. Loading "config.lua" and querying system.getInfo() still
+  happen synchronously in both modes, so they are not measured.
+ */
+PLUGIN_BENCHMARK(SteamApiInitializerStartup)
+{
+	const uint32_t handshakeDelayInMilliseconds = settings.IsQuick ? 20 : 100;
+	const uint32_t runCount = settings.IsQuick ? 2 : 10;
+	printf("  Simulated Steam client handshake: %u ms\n", handshakeDelayInMilliseconds);
+
+	SteamApiStubs::SetInitDelayInMilliseconds(handshakeDelayInMilliseconds);
+	bool hasPassed = true;
+	hasPassed &= MeasureStartupOf(false, runCount);
+	hasPassed &= MeasureStartupOf(true, runCount);
+	SteamApiStubs::SetInitDelayInMilliseconds(0);
+	return hasPassed;
+}
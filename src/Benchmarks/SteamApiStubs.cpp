@@ -0,0 +1,217 @@
+// ----------------------------------------------------------------------------
+// 
+// SteamApiStubs.cpp
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+// Implements the functions exported by the Steam client library that the plugin sources built into the benchmarks
+// call, since that library is not provided for every platform. Nothing is ever connected to a Steam client:
+// SteamAPI_Init() succeeds after an optional delay and all of Steam's interface accessors return null.
+// Async operation results and callbacks are only delivered when a benchmark asks for them via SteamApiStubs.
+
+#include "SteamApiStubs.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+
+/**
+  Number of slots in the "sCallResultSlotArray" table. Must be a power of 2.
+  Handles created by CreateCallHandle() are sequential, so they only collide once this many calls are in flight.
+ */
+static const size_t kCallResultSlotCount = 65536;
+
+/** Entry of the "sCallResultSlotArray" table. */
+struct CallResultSlot
+{
+	/** Handle of the async call the CCallResult is registered for. Zero if the slot is unused. */
+	SteamAPICall_t CallHandle;
+
+	/** The registered CCallResult. */
+	CCallbackBase* CallbackPointer;
+};
+
+/** Mutex guarding the registered CCallResult collections below. */
+static std::mutex sCallResultMutex;
+
+/**
+  Stores the CCallResult objects registered via SteamAPI_RegisterCallResult(), indexed by their call handle's
+  low bits. Unlike a node based map, registering and unregistering never allocates memory, which lets benchmarks
+  count the allocations made by the plugin's request path alone.
+ */
+static CallResultSlot sCallResultSlotArray[kCallResultSlotCount];
+
+/** Stores the registered CCallResult objects whose slot in "sCallResultSlotArray" is taken by another call. */
+static std::unordered_map<SteamAPICall_t, CCallbackBase*> sCollidingCallResultMap;
+
+/** Number of CCallResult objects stored in the above collections. */
+static size_t sRegisteredCallResultCount = 0;
+
+/** The last handle returned by SteamApiStubs::CreateCallHandle(). */
+static std::atomic<SteamAPICall_t> sLastCallHandle(k_uAPICallInvalid);
+
+/** Function called by the SteamAPI_RunCallbacks() stub. Null if not set. */
+static std::atomic<SteamApiStubs::RunCallbacksHandler> sRunCallbacksHandler(nullptr);
+
+/** Number of times SteamAPI_RunCallbacks() has been called. */
+static std::atomic<uint64_t> sRunCallbacksCallCount(0);
+
+/** Number of milliseconds the SteamAPI_Init() stub sleeps for. */
+static std::atomic<uint32_t> sInitDelayInMilliseconds(0);
+
+
+/**
+  Removes the CCallResult registered for the given async call. Must be called while holding "sCallResultMutex".
+  @param callHandle Handle of the async call to remove the CCallResult of.
+  @param expectedCallbackPointer Only removes the registered CCallResult if it is this object. Set to null for any.
+  @return Returns the removed CCallResult. Returns null if none was registered for the given call.
+ */
+static CCallbackBase* TakeCallResultFor(SteamAPICall_t callHandle, CCallbackBase* expectedCallbackPointer)
+{
+	CCallbackBase* callbackPointer = nullptr;
+	auto& slot = sCallResultSlotArray[callHandle & (kCallResultSlotCount - 1)];
+	if (slot.CallHandle == callHandle)
+	{
+		if (expectedCallbackPointer && (slot.CallbackPointer != expectedCallbackPointer))
+		{
+			return nullptr;
+		}
+		callbackPointer = slot.CallbackPointer;
+		slot.CallHandle = k_uAPICallInvalid;
+		slot.CallbackPointer = nullptr;
+	}
+	else
+	{
+		auto iterator = sCollidingCallResultMap.find(callHandle);
+		if (iterator == sCollidingCallResultMap.end())
+		{
+			return nullptr;
+		}
+		if (expectedCallbackPointer && (iterator->second != expectedCallbackPointer))
+		{
+			return nullptr;
+		}
+		callbackPointer = iterator->second;
+		sCollidingCallResultMap.erase(iterator);
+	}
+	sRegisteredCallResultCount--;
+	return callbackPointer;
+}
+
+
+SteamAPICall_t SteamApiStubs::CreateCallHandle()
+{
+	return ++sLastCallHandle;
+}
+
+bool SteamApiStubs::DeliverCallResult(SteamAPICall_t callHandle, void* resultPointer, bool hadIOFailure)
+{
+	// Unregister the CCallResult before invoking it, like Steam does, since it may register itself again.
+	CCallbackBase* callbackPointer = nullptr;
+	{
+		std::lock_guard<std::mutex> scopedLock(sCallResultMutex);
+		callbackPointer = TakeCallResultFor(callHandle, nullptr);
+	}
+	if (!callbackPointer)
+	{
+		return false;
+	}
+	callbackPointer->Run(resultPointer, hadIOFailure, callHandle);
+	return true;
+}
+
+size_t SteamApiStubs::GetRegisteredCallResultCount()
+{
+	std::lock_guard<std::mutex> scopedLock(sCallResultMutex);
+	return sRegisteredCallResultCount;
+}
+
+void SteamApiStubs::SetRunCallbacksHandler(SteamApiStubs::RunCallbacksHandler handler)
+{
+	sRunCallbacksHandler = handler;
+}
+
+uint64_t SteamApiStubs::GetRunCallbacksCallCount()
+{
+	return sRunCallbacksCallCount.load();
+}
+
+void SteamApiStubs::SetInitDelayInMilliseconds(uint32_t value)
+{
+	sInitDelayInMilliseconds = value;
+}
+
+
+S_API bool S_CALLTYPE SteamAPI_Init()
+{
+	const uint32_t delayInMilliseconds = sInitDelayInMilliseconds.load();
+	if (delayInMilliseconds > 0)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(delayInMilliseconds));
+	}
+	return true;
+}
+
+S_API void S_CALLTYPE SteamAPI_Shutdown()
+{
+}
+
+S_API HSteamUser S_CALLTYPE SteamAPI_GetHSteamUser()
+{
+	return 0;
+}
+
+S_API void* S_CALLTYPE SteamInternal_ContextInit(void* pContextInitData)
+{
+	// Steam's interface accessors dereference the returned pointer to fetch their interface.
+	// Return the accessor's own zero initialized context slot so that they all return null.
+	return &(static_cast<void**>(pContextInitData)[2]);
+}
+
+S_API void* S_CALLTYPE SteamInternal_CreateInterface(const char*)
+{
+	return nullptr;
+}
+
+S_API void* S_CALLTYPE SteamInternal_FindOrCreateUserInterface(HSteamUser, const char*)
+{
+	return nullptr;
+}
+
+S_API void S_CALLTYPE SteamAPI_RunCallbacks()
+{
+	sRunCallbacksCallCount++;
+	auto handler = sRunCallbacksHandler.load();
+	if (handler)
+	{
+		handler();
+	}
+}
+
+S_API void S_CALLTYPE SteamAPI_RegisterCallResult(CCallbackBase* callbackPointer, SteamAPICall_t callHandle)
+{
+	std::lock_guard<std::mutex> scopedLock(sCallResultMutex);
+	TakeCallResultFor(callHandle, nullptr);
+	auto& slot = sCallResultSlotArray[callHandle & (kCallResultSlotCount - 1)];
+	if (k_uAPICallInvalid == slot.CallHandle)
+	{
+		slot.CallHandle = callHandle;
+		slot.CallbackPointer = callbackPointer;
+	}
+	else
+	{
+		sCollidingCallResultMap[callHandle] = callbackPointer;
+	}
+	sRegisteredCallResultCount++;
+}
+
+S_API void S_CALLTYPE SteamAPI_UnregisterCallResult(CCallbackBase* callbackPointer, SteamAPICall_t callHandle)
+{
+	std::lock_guard<std::mutex> scopedLock(sCallResultMutex);
+	TakeCallResultFor(callHandle, callbackPointer);
+}
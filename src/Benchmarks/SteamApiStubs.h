@@ -0,0 +1,78 @@
+// ----------------------------------------------------------------------------
+// 
+// SteamApiStubs.h
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#pragma once
+
+#include "PluginMacros.h"
+PLUGIN_DISABLE_STEAM_WARNINGS_BEGIN
+#	include "steam_api.h"
+PLUGIN_DISABLE_STEAM_WARNINGS_END
+#include <cstddef>
+#include <cstdint>
+
+
+/**
+  Controls the Steam client library stubs implemented by "SteamApiStubs.cpp".
+
+  Lets benchmarks play the part of the Steam client, such as delivering an async operation's result to the
+  CCallResult object registered for it, the way SteamAPI_RunCallbacks() would.
+
+  This class only provides static members, which are thread safe.
+ */
+class SteamApiStubs
+{
+	public:
+		/** Function to be called by the SteamAPI_RunCallbacks() stub, standing in for Steam's callbacks. */
+		typedef void(*RunCallbacksHandler)();
+
+		/**
+		  Creates a new unique handle for a fake async Steam operation, to be given to a CCallResult object.
+		  @return Returns a new non-zero async operation handle.
+		 */
+		static SteamAPICall_t CreateCallHandle();
+
+		/**
+		  Invokes the CCallResult object registered for the given async operation with the given result,
+		  then unregisters it, the same way the Steam client does.
+		  @param callHandle Handle of the async operation, returned by CreateCallHandle().
+		  @param resultPointer Pointer to the Steam result struct matching the registered CCallResult's type.
+		  @param hadIOFailure Set true to simulate an I/O failure.
+		  @return Returns true if a CCallResult was registered for the given handle and has been invoked.
+		          Returns false if not.
+		 */
+		static bool DeliverCallResult(SteamAPICall_t callHandle, void* resultPointer, bool hadIOFailure);
+
+		/**
+		  Gets the number of CCallResult objects that are currently registered via SteamAPI_RegisterCallResult().
+		  @return Returns the number of registered CCallResult objects waiting for a result.
+		 */
+		static size_t GetRegisteredCallResultCount();
+
+		/**
+		  Sets the function to be called every time SteamAPI_RunCallbacks() gets called.
+		  @param handler The function to be called by SteamAPI_RunCallbacks(). Set to null to do nothing.
+		 */
+		static void SetRunCallbacksHandler(SteamApiStubs::RunCallbacksHandler handler);
+
+		/**
+		  Gets the number of times SteamAPI_RunCallbacks() has been called.
+		  @return Returns the number of calls made to SteamAPI_RunCallbacks() since the application started.
+		 */
+		static uint64_t GetRunCallbacksCallCount();
+
+		/**
+		  Sets how long SteamAPI_Init() blocks for, simulating its handshake with the Steam client.
+		  @param value The number of milliseconds SteamAPI_Init() sleeps for before succeeding. Zero by default.
+		 */
+		static void SetInitDelayInMilliseconds(uint32_t value);
+
+	private:
+		/** Constructor deleted since this class only provides static members. */
+		SteamApiStubs() = delete;
+};
@@ -0,0 +1,216 @@
+// ----------------------------------------------------------------------------
+// 
+// SteamCallResultHandlerPoolBenchmark.cpp
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#include "BenchmarkRegistry.h"
+#include "SteamApiStubs.h"
+#include "SteamCallResultHandler.h"
+#include "SteamCallResultHandlerPool.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+
+/** Number of requests waiting for a Steam result at the same time. */
+static const uint32_t kInFlightRequestCount = 10000;
+
+
+/**
+  Stores every handler in one collection and finds an idle handler by scanning all of them for one of the
+  requested type, which is what the RuntimeContext's AddEventHandlerFor() method used to do.
+  Used as the baseline the SteamCallResultHandlerPool is compared against.
+
+  The original compared typeid() values, which the benchmarks can't use since they're built without RTTI like
+  the plugin. The handler's virtual GetTypeIndex() method is compared instead, which is no more expensive.
+ */
+class LinearScanHandlerCollection
+{
+	public:
+		LinearScanHandlerCollection()
+		{
+		}
+
+		~LinearScanHandlerCollection()
+		{
+			for (auto nextHandlerPointer : fHandlerCollection)
+			{
+				delete nextHandlerPointer;
+			}
+		}
+
+		template<class TSteamResult>
+		SteamCallResultHandler<TSteamResult>* Acquire()
+		{
+			const size_t typeIndex = SteamCallResultHandler<TSteamResult>::GetStaticTypeIndex();
+			for (auto nextHandlerPointer : fHandlerCollection)
+			{
+				if (nextHandlerPointer->IsNotWaitingForResult() && (nextHandlerPointer->GetTypeIndex() == typeIndex))
+				{
+					return static_cast<SteamCallResultHandler<TSteamResult>*>(nextHandlerPointer);
+				}
+			}
+			auto handlerPointer = new SteamCallResultHandler<TSteamResult>();
+			fHandlerCollection.push_back(handlerPointer);
+			return handlerPointer;
+		}
+
+		size_t GetHandlerCount() const
+		{
+			return fHandlerCollection.size();
+		}
+
+	private:
+		std::vector<BaseSteamCallResultHandler*> fHandlerCollection;
+};
+
+
+/**
+  Result struct large enough to be passed to a handler of any of the result types used by this benchmark.
+  The handlers' callbacks never read it.
+ */
+union AnySteamResult
+{
+	LeaderboardFindResult_t LeaderboardFindResult;
+	LeaderboardScoresDownloaded_t LeaderboardScoresDownloaded;
+	LeaderboardScoreUploaded_t LeaderboardScoreUploaded;
+	NumberOfCurrentPlayers_t NumberOfCurrentPlayers;
+	GlobalStatsReceived_t GlobalStatsReceived;
+};
+
+
+template<class TSteamResult, class THandlerCollection>
+/**
+  Acquires a handler for the given Steam result type from the given collection and starts waiting for the
+  result of the given async operation, the same way the plugin's request functions do.
+  @param handlerCollection The pool or baseline collection to acquire the handler from.
+  @param callHandle Handle of the fake async Steam operation to wait for.
+  @param receivedCount Incremented by the handler's callback once the result has been received.
+  @return Returns true if a handler was acquired. Returns false if not.
+ */
+static bool StartRequestVia(
+	THandlerCollection& handlerCollection, SteamAPICall_t callHandle, uint64_t& receivedCount)
+{
+	auto handlerPointer = handlerCollection.template Acquire<TSteamResult>();
+	if (!handlerPointer)
+	{
+		return false;
+	}
+	handlerPointer->Handle(callHandle, [&receivedCount](TSteamResult*, bool)
+	{
+		receivedCount++;
+	});
+	return true;
+}
+
+
+template<class THandlerCollection>
+/**
+  Starts "kInFlightRequestCount" requests cycling through 5 Steam result types, then delivers all of their results,
+  for the given number of rounds. Prints the measured cost per request.
+  @param collectionName Name of the handler collection type to print.
+  @param handlerCollection The pool or baseline collection to acquire handlers from.
+  @param roundCount Number of times to start and complete all requests.
+  @return Returns true if every request received its result. Returns false if not.
+ */
+static bool MeasureRequestsVia(const char* collectionName, THandlerCollection& handlerCollection, uint32_t roundCount)
+{
+	std::vector<SteamAPICall_t> callHandleCollection(kInFlightRequestCount);
+	AnySteamResult result = {};
+	uint64_t receivedCount = 0;
+	bool wasAcquired = true;
+	std::chrono::steady_clock::duration acquireDuration(0);
+	std::chrono::steady_clock::duration deliverDuration(0);
+	for (uint32_t round = 0; round < roundCount; round++)
+	{
+		// Start all requests. Every handler acquired here stays in flight until all of them have been started.
+		auto startTime = std::chrono::steady_clock::now();
+		for (uint32_t index = 0; index < kInFlightRequestCount; index++)
+		{
+			const SteamAPICall_t callHandle = SteamApiStubs::CreateCallHandle();
+			callHandleCollection[index] = callHandle;
+			switch (index % 5)
+			{
+				case 0:
+					wasAcquired &= StartRequestVia<LeaderboardFindResult_t>(handlerCollection, callHandle, receivedCount);
+					break;
+				case 1:
+					wasAcquired &= StartRequestVia<LeaderboardScoresDownloaded_t>(
+							handlerCollection, callHandle, receivedCount);
+					break;
+				case 2:
+					wasAcquired &= StartRequestVia<LeaderboardScoreUploaded_t>(
+							handlerCollection, callHandle, receivedCount);
+					break;
+				case 3:
+					wasAcquired &= StartRequestVia<NumberOfCurrentPlayers_t>(handlerCollection, callHandle, receivedCount);
+					break;
+				default:
+					wasAcquired &= StartRequestVia<GlobalStatsReceived_t>(handlerCollection, callHandle, receivedCount);
+					break;
+			}
+		}
+		acquireDuration += std::chrono::steady_clock::now() - startTime;
+
+		// Deliver all results, which releases their handlers.
+		startTime = std::chrono::steady_clock::now();
+		for (auto&& callHandle : callHandleCollection)
+		{
+			SteamApiStubs::DeliverCallResult(callHandle, &result, false);
+		}
+		deliverDuration += std::chrono::steady_clock::now() - startTime;
+	}
+
+	// Print the results.
+	const uint64_t totalRequestCount = (uint64_t)kInFlightRequestCount * roundCount;
+	printf("  %-28s acquire: %8.1f ns/request   result: %6.1f ns/request   %zu handlers\n",
+			collectionName,
+			BenchmarkRegistry::ToNanosecondsPerOperation(acquireDuration, totalRequestCount),
+			BenchmarkRegistry::ToNanosecondsPerOperation(deliverDuration, totalRequestCount),
+			handlerCollection.GetHandlerCount());
+	if (!wasAcquired || (receivedCount != totalRequestCount) || (SteamApiStubs::GetRegisteredCallResultCount() > 0))
+	{
+		printf("  ERROR: %s received %llu out of %llu results.\n",
+				collectionName, (unsigned long long)receivedCount, (unsigned long long)totalRequestCount);
+		return false;
+	}
+	return true;
+}
+
+
+/**
+  Measures the cost of acquiring a CCallResult handler with 10k requests in flight across 5 Steam result types,
+  using the SteamCallResultHandlerPool's per-type free lists compared to a linear scan of all handlers.
+  Both include the cost of registering the CCallResult with the Steam client stubs, which is the same for both.
+ */
+PLUGIN_BENCHMARK(SteamCallResultHandlerPoolAcquire)
+{
+	const uint32_t roundCount = settings.IsQuick ? 2 : 20;
+	bool hasPassed = true;
+
+	// Measure the pool. Handlers created by the first round are expected to be re-used by every later round.
+	{
+		SteamCallResultHandlerPool handlerPool;
+		hasPassed &= MeasureRequestsVia("SteamCallResultHandlerPool", handlerPool, roundCount);
+		if ((handlerPool.GetHandlerCount() != kInFlightRequestCount) || (handlerPool.GetActiveHandlerCount() > 0) ||
+		    (handlerPool.GetPeakActiveHandlerCount() != kInFlightRequestCount))
+		{
+			printf("  ERROR: The pool has %zu handlers, %zu active, and a peak of %zu active handlers.\n",
+					handlerPool.GetHandlerCount(), handlerPool.GetActiveHandlerCount(),
+					handlerPool.GetPeakActiveHandlerCount());
+			hasPassed = false;
+		}
+	}
+
+	// Measure the baseline.
+	{
+		LinearScanHandlerCollection handlerCollection;
+		hasPassed &= MeasureRequestsVia("linear scan", handlerCollection, roundCount);
+	}
+	return hasPassed;
+}
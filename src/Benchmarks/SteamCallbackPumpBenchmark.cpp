@@ -0,0 +1,204 @@
+// ----------------------------------------------------------------------------
+// 
+// SteamCallbackPumpBenchmark.cpp
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#include "BenchmarkRegistry.h"
+#include "SteamApiStubs.h"
+#include "SteamCallbackPump.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/** Duration of 1 frame at 60 FPS, which is the rate Corona dispatches "enterFrame" events at by default. */
+static const std::chrono::microseconds kFrameInterval(16667);
+
+/** Mutex guarding the "sPostedEventTimeCollection" and "sLatencyCollection" collections. */
+static std::mutex sEventMutex;
+
+/** Times at which the simulated Steam client has received events that have not been polled for yet. */
+static std::vector<std::chrono::steady_clock::time_point> sPostedEventTimeCollection;
+
+/** Time between each event being received by the simulated Steam client and it being polled for. */
+static std::vector<std::chrono::steady_clock::duration> sLatencyCollection;
+
+
+/** Polling configuration measured by the MeasureLatencyOf() function. */
+struct Scenario
+{
+	/** Description of the scenario to print. */
+	const char* Name;
+
+	/** Frequency to run the SteamCallbackPump's thread at. Set to zero to poll via "enterFrame" instead. */
+	uint32_t PumpFrequencyInHertz;
+
+	/** Every Nth frame stalls for "StallDuration", such as while loading a scene. Set to zero to never stall. */
+	uint32_t StallEveryNthFrame;
+
+	/** Amount of time a stalled frame takes in addition to the frame interval. */
+	std::chrono::milliseconds StallDuration;
+};
+
+
+/**
+  Called by the SteamAPI_RunCallbacks() stub. Delivers all events received by the simulated Steam client,
+  the way Steam invokes its callbacks, and records how long each event has waited to be polled for.
+ */
+static void OnRunCallbacks()
+{
+	const auto currentTime = std::chrono::steady_clock::now();
+	std::lock_guard<std::mutex> scopedLock(sEventMutex);
+	for (auto&& postedTime : sPostedEventTimeCollection)
+	{
+		sLatencyCollection.push_back(currentTime - postedTime);
+	}
+	sPostedEventTimeCollection.clear();
+}
+
+/**
+  Converts the given duration to milliseconds.
+  @param duration The duration to convert.
+  @return Returns the given duration in fractional milliseconds.
+ */
+static double ToMilliseconds(std::chrono::steady_clock::duration duration)
+{
+	return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+/**
+  Simulates a Steam client receiving events at irregular intervals on another thread while polling for them
+  on this thread's simulated "enterFrame" events or via the SteamCallbackPump. Prints the measured latency.
+  @param scenario The polling configuration to measure.
+  @param runDuration Amount of time to post events for.
+  @return Returns true if every posted event was polled for. Returns false if not.
+ */
+static bool MeasureLatencyOf(const Scenario& scenario, std::chrono::milliseconds runDuration)
+{
+	{
+		std::lock_guard<std::mutex> scopedLock(sEventMutex);
+		sPostedEventTimeCollection.clear();
+		sLatencyCollection.clear();
+	}
+	SteamApiStubs::SetRunCallbacksHandler(&OnRunCallbacks);
+	if (scenario.PumpFrequencyInHertz > 0)
+	{
+		if (!SteamCallbackPump::Start(scenario.PumpFrequencyInHertz))
+		{
+			printf("  ERROR: Failed to start the SteamCallbackPump.\n");
+			SteamApiStubs::SetRunCallbacksHandler(nullptr);
+			return false;
+		}
+	}
+
+	// Post events from another thread every 1 to 4 milliseconds, which is not aligned to any poll interval.
+	std::atomic<bool> wasStopRequested(false);
+	uint64_t postedEventCount = 0;
+	std::thread eventThread([&]()
+	{
+		uint32_t sequence = 0;
+		while (!wasStopRequested.load())
+		{
+			{
+				std::lock_guard<std::mutex> scopedLock(sEventMutex);
+				sPostedEventTimeCollection.push_back(std::chrono::steady_clock::now());
+			}
+			postedEventCount++;
+			sequence = (sequence * 1103515245u) + 12345u;
+			std::this_thread::sleep_for(std::chrono::microseconds(1000 + ((sequence >> 16) % 3000)));
+		}
+	});
+
+	// Run the simulated frame loop, which polls via the RuntimeContext's "enterFrame" path.
+	// This does nothing while the pump is running, which matches what the plugin does.
+	uint64_t lastObservedPollCount = 0;
+	uint32_t frameCount = 0;
+	const auto startTime = std::chrono::steady_clock::now();
+	auto nextFrameTime = startTime;
+	while ((std::chrono::steady_clock::now() - startTime) < runDuration)
+	{
+		SteamCallbackPump::PollFromFrame(lastObservedPollCount);
+		frameCount++;
+		nextFrameTime += kFrameInterval;
+		if ((scenario.StallEveryNthFrame > 0) && ((frameCount % scenario.StallEveryNthFrame) == 0))
+		{
+			nextFrameTime += scenario.StallDuration;
+		}
+		std::this_thread::sleep_until(nextFrameTime);
+	}
+	wasStopRequested = true;
+	eventThread.join();
+	SteamCallbackPump::Stop();
+
+	// Collect the measurements. Events posted after the last poll are counted but not measured.
+	size_t unpolledEventCount = 0;
+	std::vector<std::chrono::steady_clock::duration> latencyCollection;
+	{
+		std::lock_guard<std::mutex> scopedLock(sEventMutex);
+		unpolledEventCount = sPostedEventTimeCollection.size();
+		sPostedEventTimeCollection.clear();
+		latencyCollection.swap(sLatencyCollection);
+	}
+	SteamApiStubs::SetRunCallbacksHandler(nullptr);
+
+	// Print the results.
+	if (latencyCollection.empty())
+	{
+		printf("  ERROR: %s did not poll for any events.\n", scenario.Name);
+		return false;
+	}
+	std::sort(latencyCollection.begin(), latencyCollection.end());
+	std::chrono::steady_clock::duration totalLatency(0);
+	for (auto&& latency : latencyCollection)
+	{
+		totalLatency += latency;
+	}
+	const size_t count = latencyCollection.size();
+	printf("  %-44s mean: %6.2f ms   p50: %6.2f ms   p99: %6.2f ms   max: %7.2f ms\n",
+			scenario.Name,
+			ToMilliseconds(totalLatency) / (double)count,
+			ToMilliseconds(latencyCollection[count / 2]),
+			ToMilliseconds(latencyCollection[std::min(count - 1, (count * 99) / 100)]),
+			ToMilliseconds(latencyCollection.back()));
+	if ((count + unpolledEventCount) != postedEventCount)
+	{
+		printf("  ERROR: %llu events were posted, but %llu were polled for.\n",
+				(unsigned long long)postedEventCount, (unsigned long long)count);
+		return false;
+	}
+	return true;
+}
+
+
+/**
+  Measures the time between the Steam client receiving an event and SteamAPI_RunCallbacks() delivering it,
+  polling once per 60 FPS frame compared to polling on the SteamCallbackPump's dedicated thread.
+  The stalled scenarios simulate a 100 ms hitch every 30 frames, which delays frame polling but not the pump.
+ */
+PLUGIN_BENCHMARK(SteamCallbackPumpLatency)
+{
+	const std::chrono::milliseconds runDuration(settings.IsQuick ? 250 : 5000);
+	const std::chrono::milliseconds stallDuration(100);
+	const Scenario scenarioCollection[] =
+	{
+		{ "enterFrame polling at 60 FPS", 0, 0, stallDuration },
+		{ "enterFrame polling at 60 FPS with stalls", 0, 30, stallDuration },
+		{ "pump thread at 100 Hz, 60 FPS with stalls", 100, 30, stallDuration },
+		{ "pump thread at 250 Hz, 60 FPS with stalls", 250, 30, stallDuration },
+	};
+	bool hasPassed = true;
+	for (auto&& scenario : scenarioCollection)
+	{
+		hasPassed &= MeasureLatencyOf(scenario, runDuration);
+	}
+	return hasPassed;
+}
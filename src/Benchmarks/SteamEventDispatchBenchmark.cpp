@@ -0,0 +1,174 @@
+// ----------------------------------------------------------------------------
+// 
+// SteamEventDispatchBenchmark.cpp
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#include "BenchmarkRegistry.h"
+#include "CoronaLua.h"
+#include "DispatchEventTask.h"
+#include "LegacySteamEventDispatch.h"
+#include "SteamApiInitializer.h"
+#include "SteamEventTraits.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+
+/**
+  Same as the RuntimeContext's OnReceivedCallResult() method for a LeaderboardFindResult_t, which caches the
+  found leaderboard's handle. Only reads the Steam interface, since there is no RuntimeContext to cache it in.
+  @param result The Steam result received by the CCallResult.
+  @return Returns a checksum of the read values.
+ */
+static uint64_t OnReceivedCallResult(const LeaderboardFindResult_t& result)
+{
+	uint64_t checksum = 0;
+	auto steamUserStatsPointer = SteamApiInitializer::GetUserStats();
+	if (result.m_bLeaderboardFound && steamUserStatsPointer)
+	{
+		checksum += (uint64_t)result.m_hSteamLeaderboard;
+	}
+	return checksum + 1;
+}
+
+template<class TSteamResultType>
+/** Overload of the above function for all other CCallResult types, which does nothing. */
+static uint64_t OnReceivedCallResult(const TSteamResultType&)
+{
+	return 0;
+}
+
+template<class TSteamResultType>
+/**
+  Sends 1 CCallResult event through the plugin's current per-event work: the task type and post-processing
+  are selected at compile time, and the task's type queries read fields set by its constructor.
+  @param task The task to copy the result to.
+  @param result The Steam result received by the CCallResult.
+  @param luaStatePointer Lua state to push the event's Lua table to. Can be null.
+  @return Returns a checksum of the queried values.
+ */
+static uint64_t DispatchEvent(
+	typename SteamEventTraits<TSteamResultType>::DispatchEventTask& task,
+	TSteamResultType& result, lua_State* luaStatePointer)
+{
+	uint64_t checksum = OnReceivedCallResult(result);
+	task.SetHadIOFailure(false);
+	task.AcquireEventDataFrom(result);
+
+	// What queueing, suspended event buffering, and coalescing query per task.
+	BaseDispatchEventTask::CoalescingKey key{};
+	checksum += (uint64_t)(uintptr_t)task.GetLuaEventName();
+	checksum += (uint64_t)task.GetPriority();
+	if (task.CopyCoalescingKeyTo(key))
+	{
+		checksum += (uint64_t)key.UserIntegerId;
+	}
+
+	// Push the event's Lua table via its virtual method, the same way the baseline does.
+	if (luaStatePointer)
+	{
+		BaseDispatchEventTask& baseTask = task;
+		checksum += baseTask.PushLuaEventTableTo(luaStatePointer) ? 1 : 0;
+		lua_settop(luaStatePointer, 0);
+	}
+	return checksum;
+}
+
+/**
+  Sends the given number of CCallResult events through the plugin's current per-event work,
+  cycling through the same 4 Steam result types as the RunLegacySteamEventDispatch() baseline.
+  @param luaStatePointer Lua state to push each event's Lua table to. Set to null to not push Lua tables.
+  @param eventCount Number of events to send.
+  @return Returns a checksum of the queried values, which keeps the compiler from optimizing the work away.
+ */
+static uint64_t RunSteamEventDispatch(lua_State* luaStatePointer, uint32_t eventCount)
+{
+	DispatchLeaderboardFindResultEventTask findTask;
+	DispatchLeaderboardScoresDownloadedEventTask downloadTask;
+	DispatchLeaderboardScoreUploadEventTask uploadTask;
+	DispatchNumberOfCurrentPlayersEventTask playerCountTask;
+	LeaderboardFindResult_t findResult{};
+	LeaderboardScoresDownloaded_t downloadResult{};
+	LeaderboardScoreUploaded_t uploadResult{};
+	NumberOfCurrentPlayers_t playerCountResult{};
+	findResult.m_bLeaderboardFound = 1;
+	playerCountResult.m_bSuccess = 1;
+
+	uint64_t checksum = 0;
+	for (uint32_t eventIndex = 0; eventIndex < eventCount; eventIndex++)
+	{
+		switch (eventIndex % 4)
+		{
+			case 0:
+				checksum += DispatchEvent(findTask, findResult, luaStatePointer);
+				break;
+			case 1:
+				checksum += DispatchEvent(downloadTask, downloadResult, luaStatePointer);
+				break;
+			case 2:
+				checksum += DispatchEvent(uploadTask, uploadResult, luaStatePointer);
+				break;
+			default:
+				checksum += DispatchEvent(playerCountTask, playerCountResult, luaStatePointer);
+				break;
+		}
+	}
+	return checksum;
+}
+
+/**
+  Measures the given event path and prints its cost per event.
+  @param pathName Name of the measured path to print.
+  @param runFunction The function sending events through the path.
+  @param luaStatePointer Lua state to push each event's Lua table to. Can be null.
+  @param eventCount Number of events to send.
+  @return Returns the path's checksum.
+ */
+static uint64_t MeasureEventPath(
+	const char* pathName, uint64_t(*runFunction)(lua_State*, uint32_t),
+	lua_State* luaStatePointer, uint32_t eventCount)
+{
+	const auto startTime = std::chrono::steady_clock::now();
+	const uint64_t checksum = runFunction(luaStatePointer, eventCount);
+	const auto duration = std::chrono::steady_clock::now() - startTime;
+	printf("  %-44s %7.1f ns/event\n", pathName, BenchmarkRegistry::ToNanosecondsPerOperation(duration, eventCount));
+	return checksum;
+}
+
+
+/**
+  Measures the CPU cost per CCallResult event of selecting its task and post-processing at compile time and
+  reading its type queries from fields, compared to the original typeid() check and virtual type queries.
+  Measured with and without pushing the event's Lua table, which costs the same for both.
+  Fails if both paths do not compute the same checksum, which means they did not do the same work.
+ */
+PLUGIN_BENCHMARK(SteamEventDispatchCost)
+{
+	const uint32_t eventCount = settings.IsQuick ? 20000 : 4000000;
+	bool hasPassed = true;
+
+	// Measure the native per-event work alone.
+	uint64_t checksum = MeasureEventPath("compile-time dispatch", &RunSteamEventDispatch, nullptr, eventCount);
+	uint64_t legacyChecksum = MeasureEventPath(
+			"typeid() + virtual queries", &RunLegacySteamEventDispatch, nullptr, eventCount);
+	hasPassed &= (checksum == legacyChecksum);
+
+	// Measure it again, pushing each event's Lua table, which is the rest of the work done per event.
+	lua_State* luaStatePointer = luaL_newstate();
+	checksum = MeasureEventPath(
+			"compile-time dispatch + Lua event table", &RunSteamEventDispatch, luaStatePointer, eventCount);
+	legacyChecksum = MeasureEventPath(
+			"typeid() + virtual queries + Lua event table", &RunLegacySteamEventDispatch, luaStatePointer, eventCount);
+	hasPassed &= (checksum == legacyChecksum);
+	lua_close(luaStatePointer);
+
+	if (!hasPassed)
+	{
+		printf("  ERROR: The compile-time and legacy paths did not do the same work.\n");
+	}
+	return hasPassed;
+}
@@ -0,0 +1,359 @@
+// ----------------------------------------------------------------------------
+//
+// SteamRequestReplayBenchmark.cpp
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#include "BenchmarkRegistry.h"
+#include "SteamApiStubs.h"
+#include "SteamParkedRequest.h"
+#include "SteamRequestCategory.h"
+#include "SteamRequestReplayQueue.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+
+/** Replay backoff delay expected after Steam reconnects for the first time, matching SteamRequestReplayQueue.cpp. */
+static const uint32_t kExpectedReplayBaseDelayInMilliseconds = 250;
+
+/** Upper limit of the replay backoff delay expected while Steam's connection keeps flapping. */
+static const uint32_t kExpectedReplayMaxDelayInMilliseconds = 16000;
+
+
+/**
+  Creates a request record the way the RuntimeContext's SendRequestFor() method does, without a task.
+  Its send callback records the request's ID and returns a stubbed Steam async call handle.
+  @param requestId Unique ID to assign to the request.
+  @param sentRequestIds Collection the request's ID is added to every time its Steam call is made.
+  @return Returns the new request record.
+ */
+static SteamParkedRequest CreateRequest(uint64_t requestId, std::vector<uint64_t>& sentRequestIds)
+{
+	auto sentRequestIdsPointer = &sentRequestIds;
+	SteamParkedRequest request;
+	request.RequestId = requestId;
+	request.SendCallback = [sentRequestIdsPointer, requestId]()->SteamAPICall_t
+	{
+		sentRequestIdsPointer->push_back(requestId);
+		return SteamApiStubs::CreateCallHandle();
+	};
+	request.ReplayFunctionPointer = nullptr;
+	request.HasSingleFlightKey = false;
+	request.HasTimeout = false;
+	request.IsReplayScheduled = false;
+	request.CategoryIndex = SteamRequestCategory::kLeaderboardFind.GetIndex();
+	request.AttemptCount = 0;
+	return request;
+}
+
+/**
+  Removes all parked requests which have expired at the given time, like the RuntimeContext's
+  TimeOutExpiredRequests() method does.
+  @param queue The queue to remove expired requests from.
+  @param currentTime The time to compare the requests' expiration time against.
+  @param timedOutRequestIds Collection the IDs of the removed requests are added to, in the order they were removed.
+ */
+static void TimeOutExpiredRequestsIn(
+	SteamRequestReplayQueue& queue, std::chrono::steady_clock::time_point currentTime,
+	std::vector<uint64_t>& timedOutRequestIds)
+{
+	queue.RemoveParkedRequestsIf([currentTime, &timedOutRequestIds](SteamParkedRequest& request)->bool
+	{
+		if (!request.HasTimeout || (currentTime < request.ExpirationTime))
+		{
+			return false;
+		}
+		timedOutRequestIds.push_back(request.RequestId);
+		return true;
+	});
+}
+
+/**
+  Sends all parked requests whose replay time has been reached at the given time, like the RuntimeContext's
+  ReplayParkedRequests() method does while Steam is connected.
+  @param queue The queue to replay requests from.
+  @param currentTime The simulated time to compare the requests' replay time against.
+  @return Returns the number of requests whose Steam call failed to be made.
+ */
+static uint32_t ReplayParkedRequestsIn(
+	SteamRequestReplayQueue& queue, std::chrono::steady_clock::time_point currentTime)
+{
+	uint32_t failedRequestCount = 0;
+	queue.RemoveParkedRequestsIf([currentTime, &failedRequestCount](SteamParkedRequest& parkedRequest)->bool
+	{
+		if (!parkedRequest.IsReplayScheduled || (currentTime < parkedRequest.ReplayTime))
+		{
+			return false;
+		}
+		SteamParkedRequest request(std::move(parkedRequest));
+		request.AttemptCount++;
+		if (!request.SendCallback())
+		{
+			failedRequestCount++;
+		}
+		return true;
+	});
+	return failedRequestCount;
+}
+
+/**
+  Verifies that all parked requests have been scheduled to be replayed within the given backoff delay after Steam
+  reconnected, and that their replay times were jittered instead of all being the same.
+  @param queue The queue whose parked requests are to be verified.
+  @param reconnectStartTime Time fetched right before calling the queue's OnSteamReconnected() method.
+  @param reconnectEndTime Time fetched right after calling the queue's OnSteamReconnected() method.
+  @param maxDelayInMilliseconds The expected backoff delay. Replays are expected within its 2nd half.
+  @return Returns true if all parked requests are scheduled as expected. Returns false if not.
+ */
+static bool AreReplaysScheduledWithin(
+	SteamRequestReplayQueue& queue, std::chrono::steady_clock::time_point reconnectStartTime,
+	std::chrono::steady_clock::time_point reconnectEndTime, uint32_t maxDelayInMilliseconds)
+{
+	const auto minReplayTime = reconnectStartTime + std::chrono::milliseconds(maxDelayInMilliseconds / 2);
+	const auto maxReplayTime = reconnectEndTime + std::chrono::milliseconds(maxDelayInMilliseconds);
+	uint32_t unexpectedRequestCount = 0;
+	bool wasJittered = false;
+	bool hasFirstReplayTime = false;
+	std::chrono::steady_clock::time_point firstReplayTime;
+	queue.RemoveParkedRequestsIf([&](SteamParkedRequest& request)->bool
+	{
+		if (!request.IsReplayScheduled || (request.ReplayTime < minReplayTime) || (request.ReplayTime > maxReplayTime))
+		{
+			unexpectedRequestCount++;
+		}
+		if (!hasFirstReplayTime)
+		{
+			firstReplayTime = request.ReplayTime;
+			hasFirstReplayTime = true;
+		}
+		else if (request.ReplayTime != firstReplayTime)
+		{
+			wasJittered = true;
+		}
+		return false;
+	});
+	printf("  reconnect:  replays scheduled within [%u, %u] ms\n",
+			maxDelayInMilliseconds / 2, maxDelayInMilliseconds);
+	if (unexpectedRequestCount > 0)
+	{
+		printf("  ERROR: %u parked requests were not scheduled within the expected backoff delay.\n",
+				unexpectedRequestCount);
+		return false;
+	}
+	if (!wasJittered && (queue.GetParkedRequestCount() > 1))
+	{
+		printf("  ERROR: All parked requests were scheduled to be replayed at the same time.\n");
+		return false;
+	}
+	return true;
+}
+
+/**
+  Determines if the given request IDs match the expected ones, printing an error if not.
+  @param description Describes the requests being compared, used by the error message.
+  @param requestIds The request IDs to verify.
+  @param expectedRequestIds The expected request IDs, in the expected order.
+  @return Returns true if both collections match. Returns false if not.
+ */
+static bool AreRequestIdsEqual(
+	const char* description, const std::vector<uint64_t>& requestIds, const std::vector<uint64_t>& expectedRequestIds)
+{
+	if (requestIds == expectedRequestIds)
+	{
+		return true;
+	}
+	printf("  ERROR: Unexpected %s requests:", description);
+	for (auto&& requestId : requestIds)
+	{
+		printf(" %llu", (unsigned long long)requestId);
+	}
+	printf(" (expected");
+	for (auto&& requestId : expectedRequestIds)
+	{
+		printf(" %llu", (unsigned long long)requestId);
+	}
+	printf(")\n");
+	return false;
+}
+
+/**
+  Parks requests while Steam is disconnected, times out the expired ones, and replays the others after Steam
+  reconnects. Verifies that nothing is replayed while disconnected, that the replay backoff delay is jittered and
+  doubles while the connection flaps, and that requests are replayed in the order they were parked.
+  @return Returns true if all checks have passed. Returns false if not.
+ */
+static bool CheckParkAndReplay()
+{
+	bool hasPassed = true;
+	SteamRequestReplayQueue queue;
+	std::vector<uint64_t> sentRequestIds;
+	std::vector<uint64_t> timedOutRequestIds;
+
+	// Park requests while Steam is disconnected. Requests 3 and 6 have already expired.
+	const uint64_t requestCount = 8;
+	auto currentTime = std::chrono::steady_clock::now();
+	for (uint64_t requestId = 1; requestId <= requestCount; requestId++)
+	{
+		auto request = CreateRequest(requestId, sentRequestIds);
+		if ((3 == requestId) || (6 == requestId))
+		{
+			request.HasTimeout = true;
+			request.ExpirationTime = currentTime - std::chrono::milliseconds(1);
+		}
+		queue.Park(request);
+	}
+	const auto farFutureTime = currentTime + std::chrono::hours(1);
+	ReplayParkedRequestsIn(queue, farFutureTime);
+	if (!sentRequestIds.empty() || (queue.GetParkedRequestCount() != requestCount))
+	{
+		printf("  ERROR: Requests parked while disconnected were replayed before Steam reconnected.\n");
+		hasPassed = false;
+	}
+
+	// Time out the expired requests, which must keep the order of the others.
+	TimeOutExpiredRequestsIn(queue, currentTime, timedOutRequestIds);
+	hasPassed &= AreRequestIdsEqual("timed out", timedOutRequestIds, { 3, 6 });
+
+	// Reconnect and verify the replay schedule.
+	auto reconnectStartTime = std::chrono::steady_clock::now();
+	queue.OnSteamReconnected();
+	auto reconnectEndTime = std::chrono::steady_clock::now();
+	hasPassed &= AreReplaysScheduledWithin(
+			queue, reconnectStartTime, reconnectEndTime, kExpectedReplayBaseDelayInMilliseconds);
+
+	// Nothing is due before the backoff delay's 1st half has elapsed. Everything is due after all of it.
+	// Requests are expected to be replayed in the order they were parked.
+	ReplayParkedRequestsIn(
+			queue, reconnectStartTime + std::chrono::milliseconds((kExpectedReplayBaseDelayInMilliseconds / 2) - 1));
+	if (!sentRequestIds.empty())
+	{
+		printf("  ERROR: Requests were replayed before their backoff delay.\n");
+		hasPassed = false;
+	}
+	uint32_t failedRequestCount = ReplayParkedRequestsIn(
+			queue, reconnectEndTime + std::chrono::milliseconds(kExpectedReplayBaseDelayInMilliseconds));
+	hasPassed &= AreRequestIdsEqual("replayed", sentRequestIds, { 1, 2, 4, 5, 7, 8 });
+	if ((failedRequestCount > 0) || (queue.GetParkedRequestCount() != 0))
+	{
+		printf("  ERROR: %u replays failed and %u requests are still parked.\n",
+				failedRequestCount, queue.GetParkedRequestCount());
+		hasPassed = false;
+	}
+
+	// Park more requests and let the connection flap. Every reconnect shortly after the last one doubles the
+	// backoff delay up to its max, and every disconnect stops the replay until the next reconnect.
+	sentRequestIds.clear();
+	for (uint64_t requestId = requestCount + 1; requestId <= (requestCount + 4); requestId++)
+	{
+		auto request = CreateRequest(requestId, sentRequestIds);
+		queue.Park(request);
+	}
+	uint32_t maxDelayInMilliseconds = kExpectedReplayBaseDelayInMilliseconds;
+	for (uint32_t reconnectCount = 1; reconnectCount <= 8; reconnectCount++)
+	{
+		maxDelayInMilliseconds *= 2;
+		if (maxDelayInMilliseconds > kExpectedReplayMaxDelayInMilliseconds)
+		{
+			maxDelayInMilliseconds = kExpectedReplayMaxDelayInMilliseconds;
+		}
+		reconnectStartTime = std::chrono::steady_clock::now();
+		queue.OnSteamReconnected();
+		reconnectEndTime = std::chrono::steady_clock::now();
+		hasPassed &= AreReplaysScheduledWithin(queue, reconnectStartTime, reconnectEndTime, maxDelayInMilliseconds);
+		queue.OnSteamDisconnected();
+		ReplayParkedRequestsIn(queue, farFutureTime);
+		if (!sentRequestIds.empty())
+		{
+			printf("  ERROR: Requests were replayed after Steam disconnected.\n");
+			hasPassed = false;
+			break;
+		}
+	}
+
+	// Replay the remaining requests right away, such as once Steam has finished initializing.
+	queue.ScheduleImmediateReplay();
+	ReplayParkedRequestsIn(queue, std::chrono::steady_clock::now());
+	hasPassed &= AreRequestIdsEqual("immediately replayed", sentRequestIds, { 9, 10, 11, 12 });
+	if ((queue.GetParkedRequestCount() != 0) || (queue.GetTotalParkedRequestCount() != (requestCount + 4)))
+	{
+		printf("  ERROR: %u requests are still parked and %llu requests were parked in total.\n",
+				queue.GetParkedRequestCount(), (unsigned long long)queue.GetTotalParkedRequestCount());
+		hasPassed = false;
+	}
+	return hasPassed;
+}
+
+/**
+  Measures the cost of parking requests, scheduling their replay once Steam reconnects and replaying them.
+  @param requestCount Number of requests to park per round.
+  @param roundCount Number of times to park and replay the requests.
+  @return Returns true if every parked request was replayed. Returns false if not.
+ */
+static bool MeasureParkAndReplay(uint32_t requestCount, uint32_t roundCount)
+{
+	SteamRequestReplayQueue queue;
+	std::vector<uint64_t> sentRequestIds;
+	sentRequestIds.reserve(requestCount);
+	std::chrono::steady_clock::duration parkDuration(0);
+	std::chrono::steady_clock::duration reconnectDuration(0);
+	std::chrono::steady_clock::duration replayDuration(0);
+	uint64_t lastRequestId = 0;
+	bool hasPassed = true;
+	for (uint32_t round = 0; round < roundCount; round++)
+	{
+		sentRequestIds.clear();
+		auto startTime = std::chrono::steady_clock::now();
+		for (uint32_t index = 0; index < requestCount; index++)
+		{
+			auto request = CreateRequest(++lastRequestId, sentRequestIds);
+			queue.Park(request);
+		}
+		auto endTime = std::chrono::steady_clock::now();
+		parkDuration += endTime - startTime;
+
+		startTime = endTime;
+		queue.OnSteamReconnected();
+		endTime = std::chrono::steady_clock::now();
+		reconnectDuration += endTime - startTime;
+
+		startTime = endTime;
+		ReplayParkedRequestsIn(queue, endTime + std::chrono::milliseconds(kExpectedReplayMaxDelayInMilliseconds));
+		replayDuration += std::chrono::steady_clock::now() - startTime;
+		if (sentRequestIds.size() != requestCount)
+		{
+			hasPassed = false;
+		}
+	}
+
+	const uint64_t totalRequestCount = (uint64_t)requestCount * roundCount;
+	printf("  park: %6.1f ns/request   reconnect: %6.1f ns/request   replay: %6.1f ns/request\n",
+			BenchmarkRegistry::ToNanosecondsPerOperation(parkDuration, totalRequestCount),
+			BenchmarkRegistry::ToNanosecondsPerOperation(reconnectDuration, totalRequestCount),
+			BenchmarkRegistry::ToNanosecondsPerOperation(replayDuration, totalRequestCount));
+	if (!hasPassed)
+	{
+		printf("  ERROR: Not all parked requests were replayed.\n");
+	}
+	return hasPassed;
+}
+
+
+/**
+  Verifies the SteamRequestReplayQueue's behavior while Steam disconnects and reconnects: parked requests time out,
+  get replayed in the order they were parked after a jittered backoff delay, and are not replayed while disconnected.
+  Also measures the cost of parking and replaying a request.
+ */
+PLUGIN_BENCHMARK(SteamRequestReplayQueueReplay)
+{
+	const uint32_t requestCount = 100;
+	const uint32_t roundCount = settings.IsQuick ? 10 : 1000;
+	bool hasPassed = true;
+	hasPassed &= CheckParkAndReplay();
+	hasPassed &= MeasureParkAndReplay(requestCount, roundCount);
+	return hasPassed;
+}
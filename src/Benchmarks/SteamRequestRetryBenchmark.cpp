@@ -0,0 +1,535 @@
+// ----------------------------------------------------------------------------
+//
+// SteamRequestRetryBenchmark.cpp
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#include "BenchmarkRegistry.h"
+#include "SteamApiStubs.h"
+#include "SteamCallResultHandler.h"
+#include "SteamCallResultHandlerPool.h"
+#include "SteamParkedRequest.h"
+#include "SteamRequestCategory.h"
+#include "SteamRequestReplayQueue.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+
+/** Final outcome of a request, as it would be dispatched to the request's Lua listener and its followers. */
+struct CompletedRequest
+{
+	/** ID of the request. */
+	uint64_t RequestId;
+
+	/** Number of times the request's Steam call was made, as given to the request's and its followers' tasks. */
+	uint32_t AttemptCount;
+
+	/** Set true if the request's last Steam call had an I/O failure. */
+	bool HadIOFailure;
+};
+
+/** Stands in for the RuntimeContext which sends, retries and completes the requests of the retry checks. */
+struct RetryCheckContext
+{
+	/** Parks the requests to be retried and decides when to retry them. */
+	SteamRequestReplayQueue ReplayQueue;
+
+	/** Provides the CCallResult handlers receiving the results of the requests' stubbed Steam calls. */
+	SteamCallResultHandlerPool HandlerPool;
+
+	/** Set false to simulate Steam being disconnected when a request's Steam call fails. */
+	bool IsSteamConnected;
+
+	/** IDs of the requests whose Steam call was made, in the order the calls were made. */
+	std::vector<uint64_t> SentRequestIds;
+
+	/** Handles of the Steam calls made by the requests' send callbacks, in the order the calls were made. */
+	std::vector<SteamAPICall_t> SentCallHandles;
+
+	/** Requests that have received their final outcome, in the order they completed. */
+	std::vector<CompletedRequest> CompletedRequestCollection;
+};
+
+
+/**
+  Handles a request's Steam call result the way the RuntimeContext's OnHandleCallResult() method does.
+  Parks the request for a retry if its call had an I/O failure and its category's retry policy and budget allow it.
+  Otherwise completes the request with the number of attempts it made.
+  Note: The RuntimeContext also requires the request to still have a task, which these checks do not use.
+  @param context The context which sent the request.
+  @param requestId ID of the request whose result was received.
+  @param resultPointer Pointer to the received result. Null if the request was aborted.
+  @param hadIOFailure Set true if the Steam call had an I/O failure.
+ */
+static void OnHandleCallResult(
+	RetryCheckContext& context, uint64_t requestId, LeaderboardFindResult_t* resultPointer, bool hadIOFailure)
+{
+	uint32_t attemptCount = 1;
+	SteamParkedRequest request;
+	if (context.ReplayQueue.TakeRetryableRequest(requestId, request))
+	{
+		attemptCount = request.AttemptCount;
+		if (resultPointer && hadIOFailure && context.ReplayQueue.TryConsumeRetryFor(request))
+		{
+			context.ReplayQueue.ParkForRetry(request, context.IsSteamConnected);
+			return;
+		}
+	}
+	CompletedRequest completedRequest;
+	completedRequest.RequestId = requestId;
+	completedRequest.AttemptCount = attemptCount;
+	completedRequest.HadIOFailure = hadIOFailure;
+	context.CompletedRequestCollection.push_back(completedRequest);
+}
+
+/**
+  Makes a request's Steam call and listens for its result the way the RuntimeContext's ReplayParkedRequest()
+  method does, keeping the request's record if its category retries I/O failures.
+  @param context The context sending the request.
+  @param request The request to send, which is moved into the context's replay queue if retryable.
+ */
+static void SendRequest(RetryCheckContext& context, SteamParkedRequest& request)
+{
+	auto callHandle = request.SendCallback();
+	auto handlerPointer = context.HandlerPool.Acquire<LeaderboardFindResult_t>();
+	if ((k_uAPICallInvalid == callHandle) || !handlerPointer)
+	{
+		printf("  ERROR: Failed to send request %llu.\n", (unsigned long long)request.RequestId);
+		return;
+	}
+	request.AttemptCount++;
+	auto contextPointer = &context;
+	auto requestId = request.RequestId;
+	handlerPointer->Handle(
+			callHandle, [contextPointer, requestId](LeaderboardFindResult_t* resultPointer, bool hadIOFailure)
+	{
+		OnHandleCallResult(*contextPointer, requestId, resultPointer, hadIOFailure);
+	});
+	if (context.ReplayQueue.IsRetryEnabledIn(request.CategoryIndex))
+	{
+		context.ReplayQueue.AddRetryableRequest(request);
+	}
+}
+
+/**
+  Creates a request record the way the RuntimeContext's SendRequestFor() method does, without a task.
+  Its send callback makes a stubbed Steam call and records it in the given context.
+  @param context The context which is to send the request.
+  @param requestId Unique ID to assign to the request.
+  @return Returns the new request record.
+ */
+static SteamParkedRequest CreateRequest(RetryCheckContext& context, uint64_t requestId)
+{
+	auto contextPointer = &context;
+	SteamParkedRequest request;
+	request.RequestId = requestId;
+	request.SendCallback = [contextPointer, requestId]()->SteamAPICall_t
+	{
+		auto callHandle = SteamApiStubs::CreateCallHandle();
+		contextPointer->SentRequestIds.push_back(requestId);
+		contextPointer->SentCallHandles.push_back(callHandle);
+		return callHandle;
+	};
+	request.ReplayFunctionPointer = nullptr;
+	request.HasSingleFlightKey = false;
+	request.HasTimeout = false;
+	request.IsReplayScheduled = false;
+	request.CategoryIndex = SteamRequestCategory::kLeaderboardFind.GetIndex();
+	request.AttemptCount = 0;
+	return request;
+}
+
+/**
+  Sends all parked requests whose retry time has been reached at the given time, like the RuntimeContext's
+  ReplayParkedRequests() method does while Steam is connected.
+  @param context The context whose parked requests are to be sent.
+  @param currentTime The simulated time to compare the requests' replay time against.
+  @return Returns the number of requests sent.
+ */
+static uint32_t ReplayParkedRequestsIn(RetryCheckContext& context, std::chrono::steady_clock::time_point currentTime)
+{
+	uint32_t sentRequestCount = 0;
+	auto sendIfDue = [&context, currentTime, &sentRequestCount](SteamParkedRequest& parkedRequest)->bool
+	{
+		if (!parkedRequest.IsReplayScheduled || (currentTime < parkedRequest.ReplayTime))
+		{
+			return false;
+		}
+		SteamParkedRequest request(std::move(parkedRequest));
+		SendRequest(context, request);
+		sentRequestCount++;
+		return true;
+	};
+	context.ReplayQueue.RemoveParkedRequestsIf(sendIfDue);
+	return sentRequestCount;
+}
+
+/**
+  Delivers the given result to the given Steam call, as Steam would via SteamAPI_RunCallbacks().
+  @param callHandle Handle of the Steam call to receive the result.
+  @param hadIOFailure Set true to simulate an I/O failure.
+  @return Returns true if the call's CCallResult handler received the result. Returns false if not.
+ */
+static bool DeliverCallResult(SteamAPICall_t callHandle, bool hadIOFailure)
+{
+	LeaderboardFindResult_t result = {};
+	if (!SteamApiStubs::DeliverCallResult(callHandle, &result, hadIOFailure))
+	{
+		printf("  ERROR: No CCallResult handler was waiting for Steam call %llu.\n", (unsigned long long)callHandle);
+		return false;
+	}
+	return true;
+}
+
+/**
+  Delivers the given result to the last Steam call made by the given context's requests.
+  @param context The context whose last Steam call is to receive the result.
+  @param hadIOFailure Set true to simulate an I/O failure.
+  @return Returns true if the call's CCallResult handler received the result. Returns false if not.
+ */
+static bool DeliverLastCallResult(RetryCheckContext& context, bool hadIOFailure)
+{
+	if (context.SentCallHandles.empty())
+	{
+		printf("  ERROR: No Steam call was made.\n");
+		return false;
+	}
+	return DeliverCallResult(context.SentCallHandles.back(), hadIOFailure);
+}
+
+/**
+  Verifies that the given request is parked for a retry within the given delay after its Steam call failed.
+  @param context The context whose replay queue is to be checked.
+  @param requestId ID of the request expected to be parked.
+  @param failureStartTime Time fetched right before delivering the failed result.
+  @param failureEndTime Time fetched right after delivering the failed result.
+  @param maxDelayInMilliseconds The expected retry delay. Retries are expected within its 2nd half.
+  @return Returns true if the request is parked and scheduled as expected. Returns false if not.
+ */
+static bool IsRetryScheduledWithin(
+	RetryCheckContext& context, uint64_t requestId, std::chrono::steady_clock::time_point failureStartTime,
+	std::chrono::steady_clock::time_point failureEndTime, uint32_t maxDelayInMilliseconds)
+{
+	auto requestPointer = context.ReplayQueue.FindParkedRequest(requestId);
+	if (!requestPointer || !requestPointer->IsReplayScheduled)
+	{
+		printf("  ERROR: Request %llu was not scheduled to be retried.\n", (unsigned long long)requestId);
+		return false;
+	}
+	const auto minRetryTime = failureStartTime + std::chrono::milliseconds(maxDelayInMilliseconds / 2);
+	const auto maxRetryTime = failureEndTime + std::chrono::milliseconds(maxDelayInMilliseconds);
+	if ((requestPointer->ReplayTime < minRetryTime) || (requestPointer->ReplayTime > maxRetryTime))
+	{
+		printf("  ERROR: Request %llu was not scheduled to be retried within [%u, %u] ms.\n",
+				(unsigned long long)requestId, maxDelayInMilliseconds / 2, maxDelayInMilliseconds);
+		return false;
+	}
+	printf("  attempt %u failed:  retry scheduled within [%u, %u] ms\n",
+			requestPointer->AttemptCount, maxDelayInMilliseconds / 2, maxDelayInMilliseconds);
+	return true;
+}
+
+/**
+  Determines if the given context's last completed request matches the expected outcome, printing an error if not.
+  @param context The context whose last completed request is to be checked.
+  @param requestId The expected request ID.
+  @param attemptCount The expected number of attempts.
+  @param hadIOFailure The expected I/O failure flag.
+  @return Returns true if the outcome matches. Returns false if not.
+ */
+static bool WasLastRequestCompletedWith(
+	const RetryCheckContext& context, uint64_t requestId, uint32_t attemptCount, bool hadIOFailure)
+{
+	if (!context.CompletedRequestCollection.empty())
+	{
+		const auto& completedRequest = context.CompletedRequestCollection.back();
+		if ((completedRequest.RequestId == requestId) && (completedRequest.AttemptCount == attemptCount) &&
+		    (completedRequest.HadIOFailure == hadIOFailure))
+		{
+			return true;
+		}
+	}
+	printf("  ERROR: Request %llu was expected to complete after %u attempts%s.\n",
+			(unsigned long long)requestId, attemptCount, hadIOFailure ? " with an I/O failure" : "");
+	return false;
+}
+
+/**
+  Fails a request's Steam call until it runs out of attempts, and fails another one once before succeeding.
+  Verifies the doubling retry delay and the attempt count the requests complete with.
+  @return Returns true if all checks have passed. Returns false if not.
+ */
+static bool CheckRetryUntilMaxAttempts()
+{
+	const uint32_t categoryIndex = SteamRequestCategory::kLeaderboardFind.GetIndex();
+	bool hasPassed = true;
+	RetryCheckContext context;
+	context.IsSteamConnected = true;
+	const auto policy = context.ReplayQueue.GetRetryPolicyFor(categoryIndex);
+
+	// Fail every attempt of the 1st request. Each retry is expected to wait twice as long as the last one.
+	auto request = CreateRequest(context, 1);
+	SendRequest(context, request);
+	uint32_t maxDelayInMilliseconds = policy.BaseDelayInMilliseconds;
+	for (uint32_t attemptCount = 1; attemptCount < policy.MaxAttemptCount; attemptCount++)
+	{
+		auto failureStartTime = std::chrono::steady_clock::now();
+		hasPassed &= DeliverLastCallResult(context, true);
+		auto failureEndTime = std::chrono::steady_clock::now();
+		if (!IsRetryScheduledWithin(context, 1, failureStartTime, failureEndTime, maxDelayInMilliseconds))
+		{
+			return false;
+		}
+		if (ReplayParkedRequestsIn(context, failureStartTime + std::chrono::milliseconds(maxDelayInMilliseconds / 2 - 1)))
+		{
+			printf("  ERROR: Request 1 was retried before its retry delay.\n");
+			hasPassed = false;
+		}
+		ReplayParkedRequestsIn(context, failureEndTime + std::chrono::milliseconds(maxDelayInMilliseconds));
+		maxDelayInMilliseconds *= 2;
+		if (maxDelayInMilliseconds > policy.MaxDelayInMilliseconds)
+		{
+			maxDelayInMilliseconds = policy.MaxDelayInMilliseconds;
+		}
+	}
+
+	// The last failure is final. It is expected to be dispatched with all attempts made, which is also the
+	// attempt count the RuntimeContext gives the requests attached to the call.
+	hasPassed &= DeliverLastCallResult(context, true);
+	hasPassed &= WasLastRequestCompletedWith(context, 1, policy.MaxAttemptCount, true);
+	if ((context.SentRequestIds.size() != policy.MaxAttemptCount) || (context.ReplayQueue.GetParkedRequestCount() > 0))
+	{
+		printf("  ERROR: Request 1 made %zu Steam calls instead of %u.\n",
+				context.SentRequestIds.size(), policy.MaxAttemptCount);
+		hasPassed = false;
+	}
+
+	// Fail the 2nd request once. Its retry is expected to succeed with 2 attempts.
+	request = CreateRequest(context, 2);
+	SendRequest(context, request);
+	hasPassed &= DeliverLastCallResult(context, true);
+	ReplayParkedRequestsIn(context, std::chrono::steady_clock::now() + std::chrono::hours(1));
+	hasPassed &= DeliverLastCallResult(context, false);
+	hasPassed &= WasLastRequestCompletedWith(context, 2, 2, false);
+
+	// A request whose timeout has elapsed is not retried.
+	request = CreateRequest(context, 3);
+	request.HasTimeout = true;
+	request.ExpirationTime = std::chrono::steady_clock::now() - std::chrono::milliseconds(1);
+	SendRequest(context, request);
+	hasPassed &= DeliverLastCallResult(context, true);
+	hasPassed &= WasLastRequestCompletedWith(context, 3, 1, true);
+
+	// Verify the retry metrics. Request 1 was retried twice and request 2 once.
+	const uint64_t totalRetryCount = context.ReplayQueue.GetTotalRetryCountFor(categoryIndex);
+	printf("  max attempts:      %zu requests completed after %llu retries\n",
+			context.CompletedRequestCollection.size(), (unsigned long long)totalRetryCount);
+	if ((totalRetryCount != policy.MaxAttemptCount) ||
+	    (context.ReplayQueue.GetTotalRetryBudgetExhaustedCountFor(categoryIndex) != 0))
+	{
+		printf("  ERROR: Unexpected retry metrics.\n");
+		hasPassed = false;
+	}
+	return hasPassed;
+}
+
+/**
+  Fails more requests than the category's per-minute retry budget allows and verifies that only the budgeted
+  number of them are retried, with the rest completing with their I/O failure right away.
+  @return Returns true if all checks have passed. Returns false if not.
+ */
+static bool CheckRetryBudget()
+{
+	const uint32_t categoryIndex = SteamRequestCategory::kLeaderboardFind.GetIndex();
+	const uint32_t requestCount = 10;
+	bool hasPassed = true;
+	RetryCheckContext context;
+	context.IsSteamConnected = true;
+	auto policy = context.ReplayQueue.GetRetryPolicyFor(categoryIndex);
+	policy.MaxAttemptCount = 2;
+	policy.BudgetPerMinute = 5;
+	context.ReplayQueue.SetRetryPolicyFor(categoryIndex, policy);
+
+	// Fail all requests once. The ones exceeding the budget are expected to complete right away.
+	for (uint64_t requestId = 1; requestId <= requestCount; requestId++)
+	{
+		auto request = CreateRequest(context, requestId);
+		SendRequest(context, request);
+		hasPassed &= DeliverLastCallResult(context, true);
+	}
+	const auto retryCount = context.ReplayQueue.GetTotalRetryCountFor(categoryIndex);
+	const auto exhaustedCount = context.ReplayQueue.GetTotalRetryBudgetExhaustedCountFor(categoryIndex);
+	printf("  budget of %u/min:   %llu retried, %llu not retried\n",
+			policy.BudgetPerMinute, (unsigned long long)retryCount, (unsigned long long)exhaustedCount);
+	if ((retryCount != policy.BudgetPerMinute) || (exhaustedCount != (requestCount - policy.BudgetPerMinute)) ||
+	    (context.ReplayQueue.GetParkedRequestCount() != policy.BudgetPerMinute) ||
+	    (context.CompletedRequestCollection.size() != (requestCount - policy.BudgetPerMinute)))
+	{
+		printf("  ERROR: The retry budget was not honored.\n");
+		hasPassed = false;
+	}
+	for (auto&& completedRequest : context.CompletedRequestCollection)
+	{
+		if ((completedRequest.AttemptCount != 1) || !completedRequest.HadIOFailure)
+		{
+			printf("  ERROR: Request %llu exceeding the retry budget did not fail after 1 attempt.\n",
+					(unsigned long long)completedRequest.RequestId);
+			hasPassed = false;
+		}
+	}
+
+	// Let the retries succeed. They are expected to complete after 2 attempts.
+	context.CompletedRequestCollection.clear();
+	context.SentCallHandles.clear();
+	ReplayParkedRequestsIn(context, std::chrono::steady_clock::now() + std::chrono::hours(1));
+	for (auto&& callHandle : context.SentCallHandles)
+	{
+		hasPassed &= DeliverCallResult(callHandle, false);
+	}
+	if (context.CompletedRequestCollection.size() != policy.BudgetPerMinute)
+	{
+		printf("  ERROR: %zu of %u retried requests completed.\n",
+				context.CompletedRequestCollection.size(), policy.BudgetPerMinute);
+		hasPassed = false;
+	}
+	for (auto&& completedRequest : context.CompletedRequestCollection)
+	{
+		if ((completedRequest.AttemptCount != 2) || completedRequest.HadIOFailure)
+		{
+			printf("  ERROR: Retried request %llu did not succeed on its 2nd attempt.\n",
+					(unsigned long long)completedRequest.RequestId);
+			hasPassed = false;
+		}
+	}
+	return hasPassed;
+}
+
+/**
+  Fails a request's Steam call while Steam is disconnected and verifies that its retry waits for Steam to reconnect.
+  @return Returns true if all checks have passed. Returns false if not.
+ */
+static bool CheckRetryWhileDisconnected()
+{
+	bool hasPassed = true;
+	RetryCheckContext context;
+	context.IsSteamConnected = false;
+
+	// Fail the request while disconnected. Its retry is expected to stay parked no matter how much time passes.
+	auto request = CreateRequest(context, 1);
+	SendRequest(context, request);
+	hasPassed &= DeliverLastCallResult(context, true);
+	const auto farFutureTime = std::chrono::steady_clock::now() + std::chrono::hours(1);
+	auto requestPointer = context.ReplayQueue.FindParkedRequest(1);
+	if (!requestPointer || requestPointer->IsReplayScheduled || ReplayParkedRequestsIn(context, farFutureTime))
+	{
+		printf("  ERROR: A request that failed while Steam was disconnected was retried before it reconnected.\n");
+		hasPassed = false;
+	}
+
+	// Reconnect. The retry is expected to be scheduled and to succeed with 2 attempts.
+	context.IsSteamConnected = true;
+	context.ReplayQueue.OnSteamReconnected();
+	requestPointer = context.ReplayQueue.FindParkedRequest(1);
+	if (!requestPointer || !requestPointer->IsReplayScheduled || (ReplayParkedRequestsIn(context, farFutureTime) != 1))
+	{
+		printf("  ERROR: A parked retry was not sent after Steam reconnected.\n");
+		return false;
+	}
+	hasPassed &= DeliverLastCallResult(context, false);
+	hasPassed &= WasLastRequestCompletedWith(context, 1, 2, false);
+	printf("  disconnected:      retry sent after reconnecting, completed after %u attempts\n",
+			context.CompletedRequestCollection.empty() ? 0 : context.CompletedRequestCollection.back().AttemptCount);
+	return hasPassed;
+}
+
+/**
+  Measures the cost of retrying a request after an I/O failure: handling the failed result, parking the request,
+  and making its Steam call again.
+  @param requestCount Number of requests to fail and retry per round.
+  @param roundCount Number of rounds to run.
+  @return Returns true if every request was retried once and then succeeded. Returns false if not.
+ */
+static bool MeasureRetries(uint32_t requestCount, uint32_t roundCount)
+{
+	const uint32_t categoryIndex = SteamRequestCategory::kLeaderboardFind.GetIndex();
+	RetryCheckContext context;
+	context.IsSteamConnected = true;
+	auto policy = context.ReplayQueue.GetRetryPolicyFor(categoryIndex);
+	policy.BudgetPerMinute = 0;
+	context.ReplayQueue.SetRetryPolicyFor(categoryIndex, policy);
+	std::chrono::steady_clock::duration failureDuration(0);
+	std::chrono::steady_clock::duration retryDuration(0);
+	uint64_t lastRequestId = 0;
+	bool hasPassed = true;
+	for (uint32_t round = 0; round < roundCount; round++)
+	{
+		// Send all requests and fail them.
+		context.SentRequestIds.clear();
+		context.SentCallHandles.clear();
+		for (uint32_t index = 0; index < requestCount; index++)
+		{
+			auto request = CreateRequest(context, ++lastRequestId);
+			SendRequest(context, request);
+		}
+		auto startTime = std::chrono::steady_clock::now();
+		for (auto&& callHandle : context.SentCallHandles)
+		{
+			hasPassed &= DeliverCallResult(callHandle, true);
+		}
+		auto endTime = std::chrono::steady_clock::now();
+		failureDuration += endTime - startTime;
+
+		// Retry all of them and let them succeed.
+		context.SentCallHandles.clear();
+		startTime = endTime;
+		ReplayParkedRequestsIn(context, endTime + std::chrono::milliseconds(policy.MaxDelayInMilliseconds));
+		retryDuration += std::chrono::steady_clock::now() - startTime;
+		for (auto&& callHandle : context.SentCallHandles)
+		{
+			hasPassed &= DeliverCallResult(callHandle, false);
+		}
+	}
+
+	const uint64_t totalRequestCount = (uint64_t)requestCount * roundCount;
+	printf("  failure: %6.1f ns/request   retry: %6.1f ns/request\n",
+			BenchmarkRegistry::ToNanosecondsPerOperation(failureDuration, totalRequestCount),
+			BenchmarkRegistry::ToNanosecondsPerOperation(retryDuration, totalRequestCount));
+	if (!hasPassed || (context.CompletedRequestCollection.size() != totalRequestCount) ||
+	    (context.ReplayQueue.GetTotalRetryCountFor(categoryIndex) != totalRequestCount))
+	{
+		printf("  ERROR: %zu of %llu requests completed after being retried.\n",
+				context.CompletedRequestCollection.size(), (unsigned long long)totalRequestCount);
+		return false;
+	}
+	return true;
+}
+
+
+/**
+  Verifies that Steam calls failing with an I/O failure are retried as allowed by their category's retry policy,
+  using the stubbed CCallResult path: the doubling retry delay, the max attempt count and the attempt count the
+  request completes with, the per-minute retry budget, and retries waiting for Steam to reconnect.
+  Also measures the cost of retrying a request.
+ */
+PLUGIN_BENCHMARK(SteamRequestRetryPolicy)
+{
+	const uint32_t requestCount = 100;
+	const uint32_t roundCount = settings.IsQuick ? 10 : 1000;
+	bool hasPassed = true;
+	hasPassed &= CheckRetryUntilMaxAttempts();
+	hasPassed &= CheckRetryBudget();
+	hasPassed &= CheckRetryWhileDisconnected();
+	hasPassed &= MeasureRetries(requestCount, roundCount);
+	if (SteamApiStubs::GetRegisteredCallResultCount() > 0)
+	{
+		printf("  ERROR: %zu CCallResult handlers are still waiting for a result.\n",
+				SteamApiStubs::GetRegisteredCallResultCount());
+		hasPassed = false;
+	}
+	return hasPassed;
+}
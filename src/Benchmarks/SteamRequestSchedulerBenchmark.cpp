@@ -0,0 +1,321 @@
+// ----------------------------------------------------------------------------
+//
+// SteamRequestSchedulerBenchmark.cpp
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#include "BenchmarkRegistry.h"
+#include "SteamParkedRequest.h"
+#include "SteamRequestCategory.h"
+#include "SteamRequestScheduler.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+
+
+/** Number of requests a category floods the scheduler with when measuring how it shares sends. */
+static const uint32_t kFloodRequestCount = 1000;
+
+
+/**
+  Creates a request record the way the RuntimeContext's SendRequestFor() method does, without a task or callback.
+  @param requestId Unique ID to assign to the request.
+  @param category The category the request is scheduled in.
+  @return Returns the new request record.
+ */
+static SteamParkedRequest CreateRequestIn(uint64_t requestId, const SteamRequestCategory& category)
+{
+	SteamParkedRequest request;
+	request.RequestId = requestId;
+	request.ReplayFunctionPointer = nullptr;
+	request.HasSingleFlightKey = false;
+	request.HasTimeout = false;
+	request.IsReplayScheduled = false;
+	request.CategoryIndex = category.GetIndex();
+	request.AttemptCount = 0;
+	return request;
+}
+
+/**
+  Adds the given number of requests to the back of the given category's queue.
+  @param scheduler The scheduler to queue the requests in.
+  @param category The category to queue the requests in.
+  @param count Number of requests to queue.
+  @param lastRequestId The ID of the last created request, which is incremented for every queued request.
+  @return Returns true if all requests were queued. Returns false if not.
+ */
+static bool EnqueueRequestsIn(
+	SteamRequestScheduler& scheduler, const SteamRequestCategory& category, uint32_t count, uint64_t& lastRequestId)
+{
+	bool wereQueued = true;
+	for (uint32_t index = 0; index < count; index++)
+	{
+		auto request = CreateRequestIn(++lastRequestId, category);
+		wereQueued &= scheduler.Enqueue(request);
+	}
+	return wereQueued;
+}
+
+/**
+  Dequeues the given number of requests and counts how many of them belong to the given category.
+  @param scheduler The scheduler to dequeue the requests from.
+  @param category The category whose requests are to be counted.
+  @param count Max number of requests to dequeue.
+  @param maxConsecutiveCount Assigned the longest run of the category's requests dequeued in a row.
+  @return Returns the number of dequeued requests belonging to the given category.
+ */
+static uint32_t DequeueAndCountRequestsIn(
+	SteamRequestScheduler& scheduler, const SteamRequestCategory& category, uint32_t count,
+	uint32_t& maxConsecutiveCount)
+{
+	uint32_t categoryCount = 0;
+	uint32_t consecutiveCount = 0;
+	maxConsecutiveCount = 0;
+	for (uint32_t index = 0; index < count; index++)
+	{
+		SteamParkedRequest request;
+		if (!scheduler.TryDequeue(request))
+		{
+			break;
+		}
+		if (request.CategoryIndex == category.GetIndex())
+		{
+			categoryCount++;
+			consecutiveCount++;
+			if (consecutiveCount > maxConsecutiveCount)
+			{
+				maxConsecutiveCount = consecutiveCount;
+			}
+		}
+		else
+		{
+			consecutiveCount = 0;
+		}
+	}
+	return categoryCount;
+}
+
+/**
+  Sends requests of 1 category the way the RuntimeContext does, queueing the ones exceeding its concurrency limit,
+  then completes them one at a time and verifies that every completion sends the oldest queued request.
+  @return Returns true if the limit was honored and all queued requests were sent in order. Returns false if not.
+ */
+static bool CheckConcurrencyLimit()
+{
+	const auto& category = SteamRequestCategory::kLeaderboardDownload;
+	const uint32_t categoryIndex = category.GetIndex();
+	const uint32_t concurrencyLimit = 2;
+	const uint32_t requestCount = 10;
+	bool hasPassed = true;
+
+	// Send all requests. Only the first ones fitting within the limit are expected to be sent right away.
+	SteamRequestScheduler scheduler;
+	scheduler.SetConcurrencyLimitFor(categoryIndex, concurrencyLimit);
+	uint32_t sentCount = 0;
+	for (uint64_t requestId = 1; requestId <= requestCount; requestId++)
+	{
+		auto request = CreateRequestIn(requestId, category);
+		if (scheduler.CanSendNowIn(categoryIndex))
+		{
+			scheduler.OnRequestStarted(categoryIndex);
+			sentCount++;
+		}
+		else if (!scheduler.Enqueue(request))
+		{
+			printf("  ERROR: Failed to queue request %llu.\n", (unsigned long long)requestId);
+			hasPassed = false;
+		}
+	}
+	auto statistics = scheduler.GetStatisticsFor(categoryIndex);
+	SteamParkedRequest dequeuedRequest;
+	if ((sentCount != concurrencyLimit) || (statistics.ActiveRequestCount != concurrencyLimit) ||
+	    (statistics.QueuedRequestCount != (requestCount - concurrencyLimit)) || scheduler.TryDequeue(dequeuedRequest))
+	{
+		printf("  ERROR: Sent %u requests with a limit of %u. %u are active and %u are queued.\n",
+				sentCount, concurrencyLimit, statistics.ActiveRequestCount, statistics.QueuedRequestCount);
+		hasPassed = false;
+	}
+
+	// Complete the sent requests one at a time. Each completion is expected to free a slot for the oldest request.
+	const auto queueWaitDuration = std::chrono::milliseconds(2);
+	std::this_thread::sleep_for(queueWaitDuration);
+	uint64_t expectedRequestId = concurrencyLimit + 1;
+	for (uint32_t index = 0; index < requestCount; index++)
+	{
+		scheduler.OnRequestEnded(categoryIndex);
+		if (scheduler.TryDequeue(dequeuedRequest))
+		{
+			if (dequeuedRequest.RequestId != expectedRequestId)
+			{
+				printf("  ERROR: Dequeued request %llu while expecting request %llu.\n",
+						(unsigned long long)dequeuedRequest.RequestId, (unsigned long long)expectedRequestId);
+				hasPassed = false;
+			}
+			expectedRequestId++;
+			scheduler.OnRequestStarted(categoryIndex);
+		}
+	}
+
+	// Verify that the queue has been drained and that its wait time metrics were recorded.
+	statistics = scheduler.GetStatisticsFor(categoryIndex);
+	const auto minWaitTimeInMicroseconds =
+			(uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(queueWaitDuration).count();
+	printf("  concurrency limit %u:  %u sent, %llu queued, peak %u queued, max wait %.3f ms\n",
+			concurrencyLimit, sentCount, (unsigned long long)statistics.TotalQueuedRequestCount,
+			statistics.PeakQueuedRequestCount, (double)statistics.MaxQueueWaitTimeInMicroseconds / 1000.0);
+	if ((expectedRequestId != (requestCount + 1)) || (statistics.ActiveRequestCount != 0) ||
+	    (statistics.QueuedRequestCount != 0) || !scheduler.CanSendNowIn(categoryIndex))
+	{
+		printf("  ERROR: Queued requests were not drained. %u are active and %u are still queued.\n",
+				statistics.ActiveRequestCount, statistics.QueuedRequestCount);
+		hasPassed = false;
+	}
+	if ((statistics.TotalQueuedRequestCount != (requestCount - concurrencyLimit)) ||
+	    (statistics.TotalDequeuedRequestCount != statistics.TotalQueuedRequestCount) ||
+	    (statistics.PeakQueuedRequestCount != (requestCount - concurrencyLimit)) ||
+	    (statistics.MaxQueueWaitTimeInMicroseconds < minWaitTimeInMicroseconds) ||
+	    (statistics.TotalQueueWaitTimeInMicroseconds < statistics.MaxQueueWaitTimeInMicroseconds))
+	{
+		printf("  ERROR: Unexpected queue metrics.\n");
+		hasPassed = false;
+	}
+	return hasPassed;
+}
+
+/**
+  Floods 1 category with requests and then queues a few requests in another category having the same weight.
+  Verifies that the other category's requests are sent alternately with the flood instead of waiting behind it,
+  including when it only starts queueing after the flood has been partially sent.
+  @return Returns true if the other category was not starved. Returns false if not.
+ */
+static bool CheckStarvation()
+{
+	const auto& floodCategory = SteamRequestCategory::kLeaderboardDownload;
+	const auto& otherCategory = SteamRequestCategory::kLeaderboardFind;
+	const uint32_t otherRequestCount = 10;
+	bool hasPassed = true;
+
+	// Queue the other category's requests right behind the flood.
+	{
+		SteamRequestScheduler scheduler;
+		scheduler.SetWeightFor(floodCategory.GetIndex(), 1);
+		scheduler.SetWeightFor(otherCategory.GetIndex(), 1);
+		uint64_t lastRequestId = 0;
+		hasPassed &= EnqueueRequestsIn(scheduler, floodCategory, kFloodRequestCount, lastRequestId);
+		hasPassed &= EnqueueRequestsIn(scheduler, otherCategory, otherRequestCount, lastRequestId);
+		uint32_t maxConsecutiveCount = 0;
+		uint32_t sentCount =
+				DequeueAndCountRequestsIn(scheduler, otherCategory, otherRequestCount * 2, maxConsecutiveCount);
+		printf("  queued behind flood:   %u of %u requests sent within the next %u sends\n",
+				sentCount, otherRequestCount, otherRequestCount * 2);
+		if (sentCount != otherRequestCount)
+		{
+			printf("  ERROR: A flood of '%s' requests starved the '%s' requests.\n",
+					floodCategory.GetCoronaStringId(), otherCategory.GetCoronaStringId());
+			hasPassed = false;
+		}
+	}
+
+	// Queue the other category's requests after half of the flood was sent.
+	// Its requests must neither be starved nor make up for the time it was idle with a burst.
+	{
+		SteamRequestScheduler scheduler;
+		scheduler.SetWeightFor(floodCategory.GetIndex(), 1);
+		scheduler.SetWeightFor(otherCategory.GetIndex(), 1);
+		uint64_t lastRequestId = 0;
+		uint32_t maxConsecutiveCount = 0;
+		hasPassed &= EnqueueRequestsIn(scheduler, floodCategory, kFloodRequestCount, lastRequestId);
+		DequeueAndCountRequestsIn(scheduler, otherCategory, kFloodRequestCount / 2, maxConsecutiveCount);
+		hasPassed &= EnqueueRequestsIn(scheduler, otherCategory, otherRequestCount, lastRequestId);
+		uint32_t sentCount =
+				DequeueAndCountRequestsIn(scheduler, otherCategory, otherRequestCount * 2, maxConsecutiveCount);
+		printf("  queued mid-flood:      %u of %u requests sent within the next %u sends, max %u in a row\n",
+				sentCount, otherRequestCount, otherRequestCount * 2, maxConsecutiveCount);
+		if ((sentCount != otherRequestCount) || (maxConsecutiveCount > 2))
+		{
+			printf("  ERROR: A category that started queueing mid-flood was not given its fair share.\n");
+			hasPassed = false;
+		}
+	}
+	return hasPassed;
+}
+
+/**
+  Floods 2 categories weighted 1:4 with requests and verifies that sends are shared in proportion to their weights.
+  Prints the cost of queueing and dequeueing a request.
+  @param roundCount Number of times to queue and drain both floods.
+  @return Returns true if the heavier category received its share of sends. Returns false if not.
+ */
+static bool CheckWeightedShare(uint32_t roundCount)
+{
+	const auto& lightCategory = SteamRequestCategory::kLeaderboardDownload;
+	const auto& heavyCategory = SteamRequestCategory::kLeaderboardUpload;
+	const uint32_t sampleCount = 100;
+	bool hasPassed = true;
+	SteamRequestScheduler scheduler;
+	scheduler.SetWeightFor(lightCategory.GetIndex(), 1);
+	scheduler.SetWeightFor(heavyCategory.GetIndex(), 4);
+	uint64_t lastRequestId = 0;
+	uint32_t heavySentCount = 0;
+	std::chrono::steady_clock::duration enqueueDuration(0);
+	std::chrono::steady_clock::duration dequeueDuration(0);
+	for (uint32_t round = 0; round < roundCount; round++)
+	{
+		// Flood both categories.
+		auto startTime = std::chrono::steady_clock::now();
+		hasPassed &= EnqueueRequestsIn(scheduler, lightCategory, kFloodRequestCount, lastRequestId);
+		hasPassed &= EnqueueRequestsIn(scheduler, heavyCategory, kFloodRequestCount, lastRequestId);
+		enqueueDuration += std::chrono::steady_clock::now() - startTime;
+
+		// Sample the share of the first sends, while both categories still have queued requests.
+		// Then drain the rest.
+		startTime = std::chrono::steady_clock::now();
+		uint32_t maxConsecutiveCount = 0;
+		heavySentCount += DequeueAndCountRequestsIn(scheduler, heavyCategory, sampleCount, maxConsecutiveCount);
+		DequeueAndCountRequestsIn(scheduler, heavyCategory, kFloodRequestCount * 2, maxConsecutiveCount);
+		dequeueDuration += std::chrono::steady_clock::now() - startTime;
+	}
+
+	// Print the results and verify the share. The heavier category is expected to get 4 out of every 5 sends.
+	const uint64_t totalRequestCount = (uint64_t)kFloodRequestCount * 2 * roundCount;
+	const uint32_t expectedHeavySentCount = ((sampleCount * 4) / 5) * roundCount;
+	printf("  weights 1:4:           %u of %u sends went to the heavier category (expected %u)\n",
+			heavySentCount, sampleCount * roundCount, expectedHeavySentCount);
+	printf("  enqueue: %6.1f ns/request   dequeue: %6.1f ns/request\n",
+			BenchmarkRegistry::ToNanosecondsPerOperation(enqueueDuration, totalRequestCount),
+			BenchmarkRegistry::ToNanosecondsPerOperation(dequeueDuration, totalRequestCount));
+	if ((heavySentCount + roundCount < expectedHeavySentCount) ||
+	    (heavySentCount > expectedHeavySentCount + roundCount))
+	{
+		printf("  ERROR: Sends were not shared in proportion to the categories' weights.\n");
+		hasPassed = false;
+	}
+	auto statistics = scheduler.GetStatisticsFor(heavyCategory.GetIndex());
+	if ((statistics.QueuedRequestCount != 0) ||
+	    (statistics.TotalDequeuedRequestCount != statistics.TotalQueuedRequestCount))
+	{
+		printf("  ERROR: The scheduler still has %u queued requests.\n", statistics.QueuedRequestCount);
+		hasPassed = false;
+	}
+	return hasPassed;
+}
+
+
+/**
+  Verifies the SteamRequestScheduler's behavior: per-category concurrency limits, sending queued requests in order
+  as slots free up, weighted fair sharing between flooded categories, and its queue wait time metrics.
+  Also measures the cost of queueing and dequeueing a request.
+ */
+PLUGIN_BENCHMARK(SteamRequestSchedulerFairness)
+{
+	const uint32_t roundCount = settings.IsQuick ? 10 : 1000;
+	bool hasPassed = true;
+	hasPassed &= CheckConcurrencyLimit();
+	hasPassed &= CheckStarvation();
+	hasPassed &= CheckWeightedShare(roundCount);
+	return hasPassed;
+}
@@ -8,9 +8,18 @@
 // ----------------------------------------------------------------------------
 
 #include "BaseSteamCallResultHandler.h"
+#include "SteamCallResultHandlerPool.h"
+#include <atomic>
+
+
+/** Number of type indexes reserved by the ReserveTypeIndex() method. */
+static std::atomic<size_t> sTypeIndexCount(0);
 
 
 BaseSteamCallResultHandler::BaseSteamCallResultHandler()
+:	fPoolPointer(nullptr),
+	fIsIdleInPool(false),
+	fPoolCollectionIndex(0)
 {
 }
 
@@ -22,3 +31,21 @@ bool BaseSteamCallResultHandler::IsNotWaitingForResult() const
 {
 	return !IsWaitingForResult();
 }
+
+SteamCallResultHandlerPool* BaseSteamCallResultHandler::GetPool() const
+{
+	return fPoolPointer;
+}
+
+void BaseSteamCallResultHandler::ReleaseToPool()
+{
+	if (fPoolPointer)
+	{
+		fPoolPointer->Release(this);
+	}
+}
+
+size_t BaseSteamCallResultHandler::ReserveTypeIndex()
+{
+	return sTypeIndexCount.fetch_add(1);
+}
@@ -9,6 +9,12 @@
 
 #pragma once
 
+#include <cstddef>
+
+
+// Forward declarations.
+class SteamCallResultHandlerPool;
+
 
 /**
   Abstract class whose derived "SteamCallResultHandler" class wraps a Steam "CCallResult" object,
@@ -50,10 +56,58 @@ class BaseSteamCallResultHandler
 		/** Aborts the last Handle() operation, unregistering its Steam result listener and assigned callback. */
 		virtual void Abort() = 0;
 
+		/**
+		  Aborts the last Handle() operation and then invokes its assigned callback with a null result
+		  and an I/O failure flag, making this handler available to handle another async operation.
+		  Expected to be called when the caller no longer wants to wait for Steam's result.
+		 */
+		virtual void TimeOut() = 0;
+
+		/**
+		  Gets the unique index assigned to the derived class' Steam result type.
+		  Used by a SteamCallResultHandlerPool to store idle handlers in a separate free list per result type.
+		  @return Returns a zero based index which is unique to the derived class' template type.
+		 */
+		virtual size_t GetTypeIndex() const = 0;
+
+		/**
+		  Gets the pool that this handler was acquired from.
+		  @return Returns a pointer to the pool that owns this handler. Returns null if it does not belong to a pool.
+		 */
+		SteamCallResultHandlerPool* GetPool() const;
+
+	protected:
+		/**
+		  Returns this handler to the pool that it was acquired from, making it available to handle another
+		  Steam async operation. To be called by the derived class once it is no longer waiting for a result.
+		  Does nothing if this handler does not belong to a pool or has already been released.
+		 */
+		void ReleaseToPool();
+
+		/**
+		  Reserves a new unique index for a derived class' Steam result type.
+		  Expected to be called once per template type by the derived class' GetTypeIndex() method.
+		  @return Returns a new zero based index.
+		 */
+		static size_t ReserveTypeIndex();
+
 	private:
 		/** Copy constructor deleted to prevent it from being called. */
 		BaseSteamCallResultHandler(const BaseSteamCallResultHandler&) = delete;
 
 		/** Copy operator deleted to prevent it from being called. */
 		void operator=(const BaseSteamCallResultHandler&) = delete;
+
+
+		/** Allows the pool to assign itself to this handler and to flag it as idle. */
+		friend class SteamCallResultHandlerPool;
+
+		/** Pool that this handler was acquired from. Null if it does not belong to a pool. */
+		SteamCallResultHandlerPool* fPoolPointer;
+
+		/** Set true if this handler is currently stored in its pool's free list. */
+		bool fIsIdleInPool;
+
+		/** Index of this handler within its pool's collection of all handlers. Allows constant time removal. */
+		size_t fPoolCollectionIndex;
 };
@@ -9,20 +9,91 @@
 
 #include "DispatchEventTask.h"
 #include "CoronaLua.h"
+#include "DispatchEventTaskPool.h"
+#include "SteamApiInitializer.h"
+#include <cstring>
 #include <sstream>
 #include <string>
+extern "C"
+{
+#	include "lua.h"
+#	include "lauxlib.h"
+}
+
+
+//---------------------------------------------------------------------------------
+// DispatchEventTaskReleaser Struct Members
+//---------------------------------------------------------------------------------
+
+void DispatchEventTaskReleaser::operator()(BaseDispatchEventTask* taskPointer) const
+{
+	// Validate.
+	if (!taskPointer)
+	{
+		return;
+	}
+
+	// Return the task to the pool it was acquired from. Otherwise, delete it.
+	auto poolPointer = taskPointer->GetPool();
+	if (poolPointer)
+	{
+		poolPointer->Release(taskPointer);
+	}
+	else
+	{
+		delete taskPointer;
+	}
+}
+
+
+//---------------------------------------------------------------------------------
+// BaseDispatchEventTask::CoalescingKey Struct Members
+//---------------------------------------------------------------------------------
+
+bool BaseDispatchEventTask::CoalescingKey::operator==(const BaseDispatchEventTask::CoalescingKey& value) const
+{
+	if (UserIntegerId != value.UserIntegerId)
+	{
+		return false;
+	}
+	if (LuaEventName == value.LuaEventName)
+	{
+		return true;
+	}
+	if (!LuaEventName || !value.LuaEventName)
+	{
+		return false;
+	}
+	return (strcmp(LuaEventName, value.LuaEventName) == 0);
+}
+
+bool BaseDispatchEventTask::CoalescingKey::operator!=(const BaseDispatchEventTask::CoalescingKey& value) const
+{
+	return !(*this == value);
+}
 
 
 //---------------------------------------------------------------------------------
 // BaseDispatchEventTask Class Members
 //---------------------------------------------------------------------------------
 
-BaseDispatchEventTask::BaseDispatchEventTask()
+BaseDispatchEventTask::BaseDispatchEventTask(
+	const char* luaEventName, BaseDispatchEventTask::Priority priority, bool isCoalescable)
+:	fLuaCoroutinePointer(nullptr),
+	fLuaCoroutineReferenceId(LUA_NOREF),
+	fPoolPointer(nullptr),
+	fLuaEventName(luaEventName),
+	fPriority(priority),
+	fIsCoalescable(isCoalescable),
+	fUserIntegerId(0),
+	fAchievementName(nullptr),
+	fRequestId(0)
 {
 }
 
 BaseDispatchEventTask::~BaseDispatchEventTask()
 {
+	ReleaseLuaCoroutine();
 }
 
 std::shared_ptr<LuaEventDispatcher> BaseDispatchEventTask::GetLuaEventDispatcher() const
@@ -35,8 +106,103 @@ void BaseDispatchEventTask::SetLuaEventDispatcher(const std::shared_ptr<LuaEvent
 	fLuaEventDispatcherPointer = dispatcherPointer;
 }
 
+void BaseDispatchEventTask::SetLuaCoroutine(lua_State* luaStatePointer, int luaCoroutineStackIndex)
+{
+	// Release the last coroutine given to this task, if any.
+	ReleaseLuaCoroutine();
+
+	// Validate.
+	if (!luaStatePointer || !lua_isthread(luaStatePointer, luaCoroutineStackIndex))
+	{
+		return;
+	}
+
+	// Store a reference to the given coroutine in the Lua registry to prevent it from being garbage collected.
+	fLuaCoroutinePointer = lua_tothread(luaStatePointer, luaCoroutineStackIndex);
+	lua_pushvalue(luaStatePointer, luaCoroutineStackIndex);
+	fLuaCoroutineReferenceId = luaL_ref(luaStatePointer, LUA_REGISTRYINDEX);
+}
+
+const char* BaseDispatchEventTask::GetLuaEventName() const
+{
+	return fLuaEventName;
+}
+
+bool BaseDispatchEventTask::CopyCoalescingKeyTo(BaseDispatchEventTask::CoalescingKey& key) const
+{
+	// Tasks cannot be coalesced by default. A derived class must opt-in via this class' constructor.
+	if (!fIsCoalescable)
+	{
+		return false;
+	}
+	key.LuaEventName = fLuaEventName;
+	key.UserIntegerId = fUserIntegerId;
+	return true;
+}
+
+void BaseDispatchEventTask::CopyFilterFieldsTo(LuaEventFilter::EventFields& eventFields) const
+{
+	eventFields.UserIntegerId = fUserIntegerId;
+	eventFields.AchievementName = fAchievementName;
+}
+
+BaseDispatchEventTask::Priority BaseDispatchEventTask::GetPriority() const
+{
+	return fPriority;
+}
+
+uint64_t BaseDispatchEventTask::GetRequestId() const
+{
+	return fRequestId;
+}
+
+void BaseDispatchEventTask::SetRequestId(uint64_t value)
+{
+	fRequestId = value;
+}
+
+void BaseDispatchEventTask::SetUserIntegerId(uint64 value)
+{
+	fUserIntegerId = value;
+}
+
+void BaseDispatchEventTask::SetAchievementName(const char* name)
+{
+	fAchievementName = name;
+}
+
+BaseDispatchEventTaskPool* BaseDispatchEventTask::GetPool() const
+{
+	return fPoolPointer;
+}
+
+void BaseDispatchEventTask::SetPool(BaseDispatchEventTaskPool* poolPointer)
+{
+	fPoolPointer = poolPointer;
+}
+
+void BaseDispatchEventTask::Reset()
+{
+	fLuaEventDispatcherPointer = nullptr;
+	ReleaseLuaCoroutine();
+	fUserIntegerId = 0;
+	fAchievementName = nullptr;
+	fRequestId = 0;
+}
+
 bool BaseDispatchEventTask::Execute()
 {
+	// If a coroutine is awaiting this event, then resume it with the event table.
+	// Note: The table is pushed straight to the coroutine's stack to be returned by the function it yielded from.
+	if (fLuaCoroutinePointer)
+	{
+		if ((lua_status(fLuaCoroutinePointer) != LUA_YIELD) || !PushLuaEventTableTo(fLuaCoroutinePointer))
+		{
+			return false;
+		}
+		return ResumeLuaCoroutine();
+	}
+
 	// Do not continue if not assigned a Lua event dispatcher.
 	if (!fLuaEventDispatcherPointer)
 	{
@@ -50,6 +216,15 @@ bool BaseDispatchEventTask::Execute()
 		return false;
 	}
 
+	// Do not build an event table if no Lua listener wants this event, such as when all of its listeners
+	// have filters that this event does not match.
+	LuaEventFilter::EventFields eventFields;
+	CopyFilterFieldsTo(eventFields);
+	if (!fLuaEventDispatcherPointer->HasEventListenersFor(fLuaEventName, eventFields))
+	{
+		return false;
+	}
+
 	// Push the derived class' event table to the top of the Lua stack.
 	bool wasPushed = PushLuaEventTableTo(luaStatePointer);
 	if (!wasPushed)
@@ -57,8 +232,9 @@ bool BaseDispatchEventTask::Execute()
 		return false;
 	}
 
-	// Dispatch the event to all subscribed Lua listeners.
-	bool wasDispatched = fLuaEventDispatcherPointer->DispatchEventWithoutResult(luaStatePointer, -1);
+	// Dispatch the event to all subscribed Lua listeners whose filters match it.
+	bool wasDispatched = fLuaEventDispatcherPointer->DispatchEventWithoutResult(
+			luaStatePointer, -1, fLuaEventName, eventFields);
 
 	// Pop the event table pushed above from the Lua stack.
 	// Note: The DispatchEventWithoutResult() method above does not pop off this table.
@@ -68,13 +244,86 @@ bool BaseDispatchEventTask::Execute()
 	return wasDispatched;
 }
 
+bool BaseDispatchEventTask::DispatchLuaEventTable(lua_State* luaStatePointer, int luaEventTableStackIndex)
+{
+	// Validate.
+	if (!luaStatePointer)
+	{
+		return false;
+	}
+
+	// If a coroutine is awaiting this event, then move a copy of the event table to its stack and resume it.
+	if (fLuaCoroutinePointer)
+	{
+		if (lua_status(fLuaCoroutinePointer) != LUA_YIELD)
+		{
+			return false;
+		}
+		lua_pushvalue(luaStatePointer, luaEventTableStackIndex);
+		lua_xmove(luaStatePointer, fLuaCoroutinePointer, 1);
+		return ResumeLuaCoroutine();
+	}
+
+	// Dispatch the event to all subscribed Lua listeners whose filters match it.
+	if (!fLuaEventDispatcherPointer)
+	{
+		return false;
+	}
+	LuaEventFilter::EventFields eventFields;
+	CopyFilterFieldsTo(eventFields);
+	return fLuaEventDispatcherPointer->DispatchEventWithoutResult(
+			luaStatePointer, luaEventTableStackIndex, fLuaEventName, eventFields);
+}
+
+bool BaseDispatchEventTask::ResumeLuaCoroutine()
+{
+	// Validate.
+	auto luaCoroutinePointer = fLuaCoroutinePointer;
+	if (!luaCoroutinePointer)
+	{
+		return false;
+	}
+
+	// Resume the coroutine. It will run until it finishes or yields again, such as when awaiting another request.
+	// Note: Errors cannot be propagated to a Lua caller since we're the one resuming it, so log them instead.
+	int resumeStatus = lua_resume(luaCoroutinePointer, 1);
+	if ((resumeStatus != 0) && (resumeStatus != LUA_YIELD))
+	{
+		const char* errorMessage = lua_tostring(luaCoroutinePointer, -1);
+		CoronaLuaError(
+				luaCoroutinePointer, "Coroutine awaiting a '%s' event failed: %s",
+				fLuaEventName ? fLuaEventName : "", errorMessage ? errorMessage : "Unknown error");
+		lua_settop(luaCoroutinePointer, 0);
+	}
+	else if (0 == resumeStatus)
+	{
+		// The coroutine has finished. Pop off its return values since nothing will receive them.
+		lua_settop(luaCoroutinePointer, 0);
+	}
+	return true;
+}
+
+void BaseDispatchEventTask::ReleaseLuaCoroutine()
+{
+	if (fLuaCoroutinePointer && (fLuaCoroutineReferenceId != LUA_NOREF))
+	{
+		luaL_unref(fLuaCoroutinePointer, LUA_REGISTRYINDEX, fLuaCoroutineReferenceId);
+	}
+	fLuaCoroutinePointer = nullptr;
+	fLuaCoroutineReferenceId = LUA_NOREF;
+}
+
 
 //---------------------------------------------------------------------------------
 // BaseDispatchCallResultEventTask Class Members
 //---------------------------------------------------------------------------------
 
-BaseDispatchCallResultEventTask::BaseDispatchCallResultEventTask()
-:	fHadIOFailure(false)
+BaseDispatchCallResultEventTask::BaseDispatchCallResultEventTask(
+	const char* luaEventName, BaseDispatchEventTask::Priority priority)
+:	BaseDispatchEventTask(luaEventName, priority, false),
+	fHadIOFailure(false),
+	fIsTimedOut(false),
+	fAttemptCount(1)
 {
 }
 
@@ -92,13 +341,44 @@ void BaseDispatchCallResultEventTask::SetHadIOFailure(bool value)
 	fHadIOFailure = value;
 }
 
+bool BaseDispatchCallResultEventTask::IsTimedOut() const
+{
+	return fIsTimedOut;
+}
+
+void BaseDispatchCallResultEventTask::SetTimedOut(bool value)
+{
+	fIsTimedOut = value;
+}
+
+uint32_t BaseDispatchCallResultEventTask::GetAttemptCount() const
+{
+	return fAttemptCount;
+}
+
+void BaseDispatchCallResultEventTask::SetAttemptCount(uint32_t value)
+{
+	fAttemptCount = value;
+}
+
+void BaseDispatchCallResultEventTask::Reset()
+{
+	BaseDispatchEventTask::Reset();
+	fHadIOFailure = false;
+	fIsTimedOut = false;
+	fAttemptCount = 1;
+}
+
 
 //---------------------------------------------------------------------------------
 // BaseDispatchLeaderboardEventTask Class Members
 //---------------------------------------------------------------------------------
 
-BaseDispatchLeaderboardEventTask::BaseDispatchLeaderboardEventTask()
+BaseDispatchLeaderboardEventTask::BaseDispatchLeaderboardEventTask(const char* luaEventName)
+:	BaseDispatchCallResultEventTask(luaEventName, BaseDispatchEventTask::Priority::kBulk)
 {
+	// Note: Leaderboard results can be large and numerous, which is why they're given a bulk priority.
+	//       This lets latency sensitive events go first.
 }
 
 BaseDispatchLeaderboardEventTask::~BaseDispatchLeaderboardEventTask()
@@ -122,6 +402,65 @@ void BaseDispatchLeaderboardEventTask::SetLeaderboardName(const char* name)
 	}
 }
 
+void BaseDispatchLeaderboardEventTask::Reset()
+{
+	// Note: Clearing the string keeps its memory capacity, which avoids a heap allocation when this task is re-used.
+	BaseDispatchCallResultEventTask::Reset();
+	fLeaderboardName.clear();
+}
+
+
+//---------------------------------------------------------------------------------
+// DispatchConnectionStatusEventTask Class Members
+//---------------------------------------------------------------------------------
+
+const char DispatchConnectionStatusEventTask::kLuaEventName[] = "connectionStatus";
+
+DispatchConnectionStatusEventTask::DispatchConnectionStatusEventTask()
+:	BaseDispatchEventTask(kLuaEventName, BaseDispatchEventTask::Priority::kCritical, true),
+	fParkedRequestCount(0)
+{
+	// Note: Only the newest connection state is relevant to Lua, which is why this event is coalesced.
+}
+
+DispatchConnectionStatusEventTask::~DispatchConnectionStatusEventTask()
+{
+}
+
+void DispatchConnectionStatusEventTask::SetConnectionState(const SteamConnectionState& state)
+{
+	fConnectionState = state;
+}
+
+void DispatchConnectionStatusEventTask::SetParkedRequestCount(uint32_t count)
+{
+	fParkedRequestCount = count;
+}
+
+bool DispatchConnectionStatusEventTask::PushLuaEventTableTo(lua_State* luaStatePointer) const
+{
+	// Validate.
+	if (!luaStatePointer)
+	{
+		return false;
+	}
+
+	// Push the event data to Lua.
+	CoronaLuaNewEvent(luaStatePointer, kLuaEventName);
+	lua_pushstring(luaStatePointer, fConnectionState.GetCoronaStringId());
+	lua_setfield(luaStatePointer, -2, "phase");
+	lua_pushinteger(luaStatePointer, (lua_Integer)fParkedRequestCount);
+	lua_setfield(luaStatePointer, -2, "parkedRequestCount");
+	return true;
+}
+
+void DispatchConnectionStatusEventTask::Reset()
+{
+	BaseDispatchEventTask::Reset();
+	fConnectionState = SteamConnectionState::kUnknown;
+	fParkedRequestCount = 0;
+}
+
 
 //---------------------------------------------------------------------------------
 // DispatchGameOverlayActivatedEventTask Class Members
@@ -130,8 +469,11 @@ void BaseDispatchLeaderboardEventTask::SetLeaderboardName(const char* name)
 const char DispatchGameOverlayActivatedEventTask::kLuaEventName[] = "overlayStatus";
 
 DispatchGameOverlayActivatedEventTask::DispatchGameOverlayActivatedEventTask()
-:	fWasActivated(false)
+:	BaseDispatchEventTask(kLuaEventName, BaseDispatchEventTask::Priority::kCritical, true),
+	fWasActivated(false)
 {
+	// Note: Overlay changes are dispatched promptly so that the app can pause/resume in sync with the overlay.
+	//       Only the overlay's newest shown/hidden state is relevant to Lua, which is why this event is coalesced.
 }
 
 DispatchGameOverlayActivatedEventTask::~DispatchGameOverlayActivatedEventTask()
@@ -143,11 +485,6 @@ void DispatchGameOverlayActivatedEventTask::AcquireEventDataFrom(const GameOverl
 	fWasActivated = steamEventData.m_bActive ? true : false;
 }
 
-const char* DispatchGameOverlayActivatedEventTask::GetLuaEventName() const
-{
-	return kLuaEventName;
-}
-
 bool DispatchGameOverlayActivatedEventTask::PushLuaEventTableTo(lua_State* luaStatePointer) const
 {
 	// Validate.
@@ -171,7 +508,8 @@ bool DispatchGameOverlayActivatedEventTask::PushLuaEventTableTo(lua_State* luaSt
 const char DispatchLeaderboardScoresDownloadedEventTask::kLuaEventName[] = "leaderboardEntries";
 
 DispatchLeaderboardScoresDownloadedEventTask::DispatchLeaderboardScoresDownloadedEventTask()
-:	fLeaderboardHandle(0)
+:	BaseDispatchLeaderboardEventTask(kLuaEventName),
+	fLeaderboardHandle(0)
 {
 }
 
@@ -188,7 +526,7 @@ void DispatchLeaderboardScoresDownloadedEventTask::AcquireEventDataFrom(
 	SetLeaderboardName(nullptr);
 
 	// Fetch the Steam interface needed to read leaderboard info.
-	auto steamUserStatsPointer = SteamUserStats();
+	auto steamUserStatsPointer = SteamApiInitializer::GetUserStats();
 	if (!steamUserStatsPointer)
 	{
 		return;
@@ -218,9 +556,12 @@ void DispatchLeaderboardScoresDownloadedEventTask::AcquireEventDataFrom(
 	}
 }
 
-const char* DispatchLeaderboardScoresDownloadedEventTask::GetLuaEventName() const
+void DispatchLeaderboardScoresDownloadedEventTask::Reset()
 {
-	return kLuaEventName;
+	// Note: Clearing the vector keeps its memory capacity, which avoids a heap allocation when this task is re-used.
+	BaseDispatchLeaderboardEventTask::Reset();
+	fLeaderboardHandle = 0;
+	fEntryCollection.clear();
 }
 
 bool DispatchLeaderboardScoresDownloadedEventTask::PushLuaEventTableTo(lua_State* luaStatePointer) const
@@ -237,6 +578,14 @@ bool DispatchLeaderboardScoresDownloadedEventTask::PushLuaEventTableTo(lua_State
 		lua_pushboolean(luaStatePointer, HadIOFailure() ? 1 : 0);
 		lua_setfield(luaStatePointer, -2, "isError");
 	}
+	{
+		lua_pushboolean(luaStatePointer, IsTimedOut() ? 1 : 0);
+		lua_setfield(luaStatePointer, -2, "timedOut");
+	}
+	{
+		lua_pushinteger(luaStatePointer, (lua_Integer)GetAttemptCount());
+		lua_setfield(luaStatePointer, -2, "attemptCount");
+	}
 	{
 		auto name = GetLeaderboardName();
 		lua_pushstring(luaStatePointer, name ? name : "");
@@ -287,6 +636,7 @@ bool DispatchLeaderboardScoresDownloadedEventTask::PushLuaEventTableTo(lua_State
 const char DispatchLeaderboardFindResultEventTask::kLuaEventName[] = "leaderboardInfo";
 
 DispatchLeaderboardFindResultEventTask::DispatchLeaderboardFindResultEventTask()
+:	BaseDispatchLeaderboardEventTask(kLuaEventName)
 {
 	ClearEventData();
 }
@@ -301,7 +651,7 @@ void DispatchLeaderboardFindResultEventTask::AcquireEventDataFrom(const Leaderbo
 	ClearEventData();
 
 	// Fetch the Steam interface needed to read leaderboard info.
-	auto steamUserStatsPointer = SteamUserStats();
+	auto steamUserStatsPointer = SteamApiInitializer::GetUserStats();
 	if (!steamUserStatsPointer)
 	{
 		return;
@@ -329,11 +679,6 @@ void DispatchLeaderboardFindResultEventTask::ClearEventData()
 	SetLeaderboardName(nullptr);
 }
 
-const char* DispatchLeaderboardFindResultEventTask::GetLuaEventName() const
-{
-	return kLuaEventName;
-}
-
 bool DispatchLeaderboardFindResultEventTask::PushLuaEventTableTo(lua_State* luaStatePointer) const
 {
 	// Validate.
@@ -352,6 +697,14 @@ bool DispatchLeaderboardFindResultEventTask::PushLuaEventTableTo(lua_State* luaS
 		lua_pushboolean(luaStatePointer, isError ? 1 : 0);
 		lua_setfield(luaStatePointer, -2, "isError");
 	}
+	{
+		lua_pushboolean(luaStatePointer, IsTimedOut() ? 1 : 0);
+		lua_setfield(luaStatePointer, -2, "timedOut");
+	}
+	{
+		lua_pushinteger(luaStatePointer, (lua_Integer)GetAttemptCount());
+		lua_setfield(luaStatePointer, -2, "attemptCount");
+	}
 	{
 		auto name = GetLeaderboardName();
 		lua_pushstring(luaStatePointer, name ? name : "");
@@ -426,6 +779,7 @@ bool DispatchLeaderboardFindResultEventTask::PushLuaEventTableTo(lua_State* luaS
 const char DispatchLeaderboardScoreUploadEventTask::kLuaEventName[] = "setHighScore";
 
 DispatchLeaderboardScoreUploadEventTask::DispatchLeaderboardScoreUploadEventTask()
+:	BaseDispatchLeaderboardEventTask(kLuaEventName)
 {
 	ClearEventData();
 }
@@ -440,7 +794,7 @@ void DispatchLeaderboardScoreUploadEventTask::AcquireEventDataFrom(const Leaderb
 	ClearEventData();
 
 	// Fetch the Steam interface needed to read leaderboard info.
-	auto steamUserStatsPointer = SteamUserStats();
+	auto steamUserStatsPointer = SteamApiInitializer::GetUserStats();
 	if (!steamUserStatsPointer)
 	{
 		return;
@@ -468,11 +822,6 @@ void DispatchLeaderboardScoreUploadEventTask::ClearEventData()
 	SetLeaderboardName(nullptr);
 }
 
-const char* DispatchLeaderboardScoreUploadEventTask::GetLuaEventName() const
-{
-	return kLuaEventName;
-}
-
 bool DispatchLeaderboardScoreUploadEventTask::PushLuaEventTableTo(lua_State* luaStatePointer) const
 {
 	// Validate.
@@ -491,6 +840,14 @@ bool DispatchLeaderboardScoreUploadEventTask::PushLuaEventTableTo(lua_State* lua
 		lua_pushboolean(luaStatePointer, isError ? 1 : 0);
 		lua_setfield(luaStatePointer, -2, "isError");
 	}
+	{
+		lua_pushboolean(luaStatePointer, IsTimedOut() ? 1 : 0);
+		lua_setfield(luaStatePointer, -2, "timedOut");
+	}
+	{
+		lua_pushinteger(luaStatePointer, (lua_Integer)GetAttemptCount());
+		lua_setfield(luaStatePointer, -2, "attemptCount");
+	}
 	{
 		std::stringstream stringStream;
 		stringStream.imbue(std::locale::classic());
@@ -532,9 +889,11 @@ bool DispatchLeaderboardScoreUploadEventTask::PushLuaEventTableTo(lua_State* lua
 const char DispatchMicrotransactionAuthorizationResponseEventTask::kLuaEventName[] = "microtransactionAuthorization";
 
 DispatchMicrotransactionAuthorizationResponseEventTask::DispatchMicrotransactionAuthorizationResponseEventTask()
-:	fWasAuthorized(false),
+:	BaseDispatchEventTask(kLuaEventName, BaseDispatchEventTask::Priority::kCritical, false),
+	fWasAuthorized(false),
 	fOrderId(0)
 {
+	// Note: Purchase confirmations must never wait behind bulk events, which is why they're given a critical priority.
 }
 
 DispatchMicrotransactionAuthorizationResponseEventTask::~DispatchMicrotransactionAuthorizationResponseEventTask()
@@ -548,11 +907,6 @@ void DispatchMicrotransactionAuthorizationResponseEventTask::AcquireEventDataFro
 	fOrderId = steamEventData.m_ulOrderID;
 }
 
-const char* DispatchMicrotransactionAuthorizationResponseEventTask::GetLuaEventName() const
-{
-	return kLuaEventName;
-}
-
 bool DispatchMicrotransactionAuthorizationResponseEventTask::PushLuaEventTableTo(lua_State* luaStatePointer) const
 {
 	// Validate.
@@ -586,7 +940,8 @@ bool DispatchMicrotransactionAuthorizationResponseEventTask::PushLuaEventTableTo
 const char DispatchNumberOfCurrentPlayersEventTask::kLuaEventName[] = "activePlayerCount";
 
 DispatchNumberOfCurrentPlayersEventTask::DispatchNumberOfCurrentPlayersEventTask()
-:	fIsError(true),
+:	BaseDispatchCallResultEventTask(kLuaEventName, BaseDispatchEventTask::Priority::kNormal),
+	fIsError(true),
 	fPlayerCount(0)
 {
 }
@@ -601,11 +956,6 @@ void DispatchNumberOfCurrentPlayersEventTask::AcquireEventDataFrom(const NumberO
 	fPlayerCount = steamEventData.m_cPlayers;
 }
 
-const char* DispatchNumberOfCurrentPlayersEventTask::GetLuaEventName() const
-{
-	return kLuaEventName;
-}
-
 bool DispatchNumberOfCurrentPlayersEventTask::PushLuaEventTableTo(lua_State* luaStatePointer) const
 {
 	// Validate.
@@ -624,6 +974,14 @@ bool DispatchNumberOfCurrentPlayersEventTask::PushLuaEventTableTo(lua_State* lua
 		lua_pushboolean(luaStatePointer, isError ? 1 : 0);
 		lua_setfield(luaStatePointer, -2, "isError");
 	}
+	{
+		lua_pushboolean(luaStatePointer, IsTimedOut() ? 1 : 0);
+		lua_setfield(luaStatePointer, -2, "timedOut");
+	}
+	{
+		lua_pushinteger(luaStatePointer, (lua_Integer)GetAttemptCount());
+		lua_setfield(luaStatePointer, -2, "attemptCount");
+	}
 	if (!isError)
 	{
 		lua_pushinteger(luaStatePointer, fPlayerCount);
@@ -632,6 +990,90 @@ bool DispatchNumberOfCurrentPlayersEventTask::PushLuaEventTableTo(lua_State* lua
 	return true;
 }
 
+//---------------------------------------------------------------------------------
+// DispatchSuspendedEventsDroppedEventTask Class Members
+//---------------------------------------------------------------------------------
+
+const char DispatchSuspendedEventsDroppedEventTask::kLuaEventName[] = "suspendedEventsDropped";
+
+DispatchSuspendedEventsDroppedEventTask::DispatchSuspendedEventsDroppedEventTask()
+:	BaseDispatchEventTask(kLuaEventName, BaseDispatchEventTask::Priority::kBulk, false)
+{
+	// Note: Given a bulk priority since it must be dispatched after all of the events buffered while suspended.
+}
+
+DispatchSuspendedEventsDroppedEventTask::~DispatchSuspendedEventsDroppedEventTask()
+{
+}
+
+void DispatchSuspendedEventsDroppedEventTask::AddDroppedEventCount(const char* luaEventName, uint32_t count)
+{
+	// Validate.
+	if (!luaEventName || (count <= 0))
+	{
+		return;
+	}
+
+	// Add the given count to the event name's existing entry, if it exists.
+	for (auto&& entry : fDroppedEventCountCollection)
+	{
+		if (entry.LuaEventName && !strcmp(entry.LuaEventName, luaEventName))
+		{
+			entry.Count += count;
+			return;
+		}
+	}
+
+	// Add a new entry for the given event name.
+	DroppedEventCountEntry entry;
+	entry.LuaEventName = luaEventName;
+	entry.Count = count;
+	fDroppedEventCountCollection.push_back(entry);
+}
+
+uint32_t DispatchSuspendedEventsDroppedEventTask::GetTotalDroppedEventCount() const
+{
+	uint32_t totalCount = 0;
+	for (auto&& entry : fDroppedEventCountCollection)
+	{
+		totalCount += entry.Count;
+	}
+	return totalCount;
+}
+
+bool DispatchSuspendedEventsDroppedEventTask::PushLuaEventTableTo(lua_State* luaStatePointer) const
+{
+	// Validate.
+	if (!luaStatePointer)
+	{
+		return false;
+	}
+
+	// Push the event data to Lua.
+	CoronaLuaNewEvent(luaStatePointer, kLuaEventName);
+	{
+		lua_createtable(luaStatePointer, 0, (int)fDroppedEventCountCollection.size());
+		for (auto&& entry : fDroppedEventCountCollection)
+		{
+			lua_pushinteger(luaStatePointer, (lua_Integer)entry.Count);
+			lua_setfield(luaStatePointer, -2, entry.LuaEventName);
+		}
+		lua_setfield(luaStatePointer, -2, "droppedEventCounts");
+	}
+	{
+		lua_pushinteger(luaStatePointer, (lua_Integer)GetTotalDroppedEventCount());
+		lua_setfield(luaStatePointer, -2, "totalDroppedEventCount");
+	}
+	return true;
+}
+
+void DispatchSuspendedEventsDroppedEventTask::Reset()
+{
+	BaseDispatchEventTask::Reset();
+	fDroppedEventCountCollection.clear();
+}
+
+
 //---------------------------------------------------------------------------------
 // DispatchUserAchievementStoredEventTask Class Members
 //---------------------------------------------------------------------------------
@@ -639,7 +1081,8 @@ bool DispatchNumberOfCurrentPlayersEventTask::PushLuaEventTableTo(lua_State* lua
 const char DispatchUserAchievementStoredEventTask::kLuaEventName[] = "achievementInfoUpdate";
 
 DispatchUserAchievementStoredEventTask::DispatchUserAchievementStoredEventTask()
-:	fIsGroup(false),
+:	BaseDispatchEventTask(kLuaEventName, BaseDispatchEventTask::Priority::kNormal, false),
+	fIsGroup(false),
 	fCurrentProgress(0),
 	fMaxProgress(0)
 {
@@ -655,11 +1098,7 @@ void DispatchUserAchievementStoredEventTask::AcquireEventDataFrom(const UserAchi
 	fIsGroup = steamEventData.m_bGroupAchievement;
 	fCurrentProgress = steamEventData.m_nCurProgress;
 	fMaxProgress = steamEventData.m_nMaxProgress;
-}
-
-const char* DispatchUserAchievementStoredEventTask::GetLuaEventName() const
-{
-	return kLuaEventName;
+	SetAchievementName(fAchievementName.c_str());
 }
 
 bool DispatchUserAchievementStoredEventTask::PushLuaEventTableTo(lua_State* luaStatePointer) const
@@ -702,7 +1141,8 @@ bool DispatchUserAchievementStoredEventTask::PushLuaEventTableTo(lua_State* luaS
 const char DispatchUserStatsReceivedEventTask::kLuaEventName[] = "userProgressUpdate";
 
 DispatchUserStatsReceivedEventTask::DispatchUserStatsReceivedEventTask()
-:	fUserIntegerId(0),
+:	BaseDispatchEventTask(kLuaEventName, BaseDispatchEventTask::Priority::kNormal, true),
+	fUserIntegerId(0),
 	fSteamResultCode(k_EResultFail)
 {
 }
@@ -715,11 +1155,9 @@ void DispatchUserStatsReceivedEventTask::AcquireEventDataFrom(const UserStatsRec
 {
 	fUserIntegerId = steamEventData.m_steamIDUser.ConvertToUint64();
 	fSteamResultCode = steamEventData.m_eResult;
-}
 
-const char* DispatchUserStatsReceivedEventTask::GetLuaEventName() const
-{
-	return kLuaEventName;
+	// Only the newest result for the same user is relevant to Lua.
+	SetUserIntegerId(fUserIntegerId);
 }
 
 bool DispatchUserStatsReceivedEventTask::PushLuaEventTableTo(lua_State* luaStatePointer) const
@@ -759,7 +1197,8 @@ bool DispatchUserStatsReceivedEventTask::PushLuaEventTableTo(lua_State* luaState
 const char DispatchUserStatsStoredEventTask::kLuaEventName[] = "userProgressSave";
 
 DispatchUserStatsStoredEventTask::DispatchUserStatsStoredEventTask()
-:	fUserIntegerId(0),
+:	BaseDispatchEventTask(kLuaEventName, BaseDispatchEventTask::Priority::kNormal, true),
+	fUserIntegerId(0),
 	fSteamResultCode(k_EResultFail)
 {
 }
@@ -775,16 +1214,14 @@ void DispatchUserStatsStoredEventTask::AcquireEventDataFrom(const UserStatsStore
 
 	// Fetch the current user's ID.
 	fUserIntegerId = 0;
-	auto steamUserPointer = SteamUser();
+	auto steamUserPointer = SteamApiInitializer::GetUser();
 	if (steamUserPointer)
 	{
 		fUserIntegerId = steamUserPointer->GetSteamID().ConvertToUint64();
 	}
-}
 
-const char* DispatchUserStatsStoredEventTask::GetLuaEventName() const
-{
-	return kLuaEventName;
+	// Only the newest result for the same user is relevant to Lua.
+	SetUserIntegerId(fUserIntegerId);
 }
 
 bool DispatchUserStatsStoredEventTask::PushLuaEventTableTo(lua_State* luaStatePointer) const
@@ -824,7 +1261,8 @@ bool DispatchUserStatsStoredEventTask::PushLuaEventTableTo(lua_State* luaStatePo
 const char DispatchUserStatsUnloadedEventTask::kLuaEventName[] = "userProgressUnload";
 
 DispatchUserStatsUnloadedEventTask::DispatchUserStatsUnloadedEventTask()
-:	fUserIntegerId(0)
+:	BaseDispatchEventTask(kLuaEventName, BaseDispatchEventTask::Priority::kNormal, false),
+	fUserIntegerId(0)
 {
 }
 
@@ -835,11 +1273,7 @@ DispatchUserStatsUnloadedEventTask::~DispatchUserStatsUnloadedEventTask()
 void DispatchUserStatsUnloadedEventTask::AcquireEventDataFrom(const UserStatsUnloaded_t& steamEventData)
 {
 	fUserIntegerId = steamEventData.m_steamIDUser.ConvertToUint64();
-}
-
-const char* DispatchUserStatsUnloadedEventTask::GetLuaEventName() const
-{
-	return kLuaEventName;
+	SetUserIntegerId(fUserIntegerId);
 }
 
 bool DispatchUserStatsUnloadedEventTask::PushLuaEventTableTo(lua_State* luaStatePointer) const
@@ -10,7 +10,9 @@
 #pragma once
 
 #include "LuaEventDispatcher.h"
+#include "LuaEventFilter.h"
 #include "PluginMacros.h"
+#include "SteamConnectionState.h"
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -21,12 +23,27 @@ PLUGIN_DISABLE_STEAM_WARNINGS_END
 
 
 // Forward declarations.
+class BaseDispatchEventTask;
+class BaseDispatchEventTaskPool;
 extern "C"
 {
 	struct lua_State;
 }
 
 
+/**
+  Deleter used by the "DispatchEventTaskPointer" smart pointer type.
+  Returns the task to the DispatchEventTaskPool it was acquired from or deletes it if it does not belong to a pool.
+ */
+struct DispatchEventTaskReleaser
+{
+	void operator()(BaseDispatchEventTask* taskPointer) const;
+};
+
+/** Smart pointer which uniquely owns a task and returns it to its pool when destroyed. */
+typedef std::unique_ptr<BaseDispatchEventTask, DispatchEventTaskReleaser> DispatchEventTaskPointer;
+
+
 /**
   Abstract class used to dispatch an event table to Lua.
 
@@ -37,17 +54,140 @@ extern "C"
 class BaseDispatchEventTask
 {
 	public:
-		BaseDispatchEventTask();
+		/**
+		  Identifies queued tasks that are allowed to be collapsed into 1 task, where only the newest is dispatched.
+		  Provided by the CopyCoalescingKeyTo() method of tasks constructed as coalescable.
+		 */
+		struct CoalescingKey
+		{
+			/** Name of the Lua event. Expected to be the derived class' static "kLuaEventName" string. */
+			const char* LuaEventName;
+
+			/** Integer form of the Steam user ID the event belongs to. Set to zero if not applicable. */
+			uint64 UserIntegerId;
+
+			bool operator==(const CoalescingKey& value) const;
+			bool operator!=(const CoalescingKey& value) const;
+		};
+
+		/**
+		  Indicates which lane a task is dispatched in. Pending tasks in a higher priority lane are always
+		  dispatched to Lua before tasks in a lower priority lane, even if they were received later.
+		  Tasks within the same lane are dispatched in the order they were received.
+		 */
+		enum class Priority
+		{
+			/** Latency sensitive events such as purchase authorizations and overlay changes. */
+			kCritical,
+
+			/** Default priority for events that are neither latency sensitive nor high volume. */
+			kNormal,
+
+			/** High volume events that can afford to wait a few frames, such as leaderboard results. */
+			kBulk
+		};
+
+		/** Number of values in the "Priority" enum. Used to size a collection of lanes indexed by priority. */
+		static const size_t kPriorityCount = 3;
+
+		/**
+		  Creates a new task.
+		  @param luaEventName Name of the Lua event this task dispatches. Expected to be the derived class'
+		                      static "kLuaEventName" string.
+		  @param priority The lane this task is dispatched in.
+		  @param isCoalescable Set true if only the newest queued task having the same event name and
+		                       coalescing user ID should be dispatched.
+		 */
+		BaseDispatchEventTask(const char* luaEventName, BaseDispatchEventTask::Priority priority, bool isCoalescable);
 		virtual ~BaseDispatchEventTask();
 
 		std::shared_ptr<LuaEventDispatcher> GetLuaEventDispatcher() const;
 		void SetLuaEventDispatcher(const std::shared_ptr<LuaEventDispatcher>& dispatcherPointer);
-		virtual const char* GetLuaEventName() const = 0;
+
+		/**
+		  Sets up this task to resume a suspended Lua coroutine with its event table, instead of dispatching
+		  the event via a Lua event dispatcher. Used to implement request*() Lua functions awaited by coroutines.
+		  Keeps a Lua registry reference to the coroutine until this task is reset or destroyed.
+		  Must only be called on the Lua thread.
+		  @param luaStatePointer Pointer to the Lua state that the "luaCoroutineStackIndex" argument references.
+		  @param luaCoroutineStackIndex Index to the Lua coroutine (ie: thread) to be resumed by the Execute() method.
+		 */
+		void SetLuaCoroutine(lua_State* luaStatePointer, int luaCoroutineStackIndex);
+		const char* GetLuaEventName() const;
 		virtual bool PushLuaEventTableTo(lua_State* luaStatePointer) const = 0;
+		bool CopyCoalescingKeyTo(BaseDispatchEventTask::CoalescingKey& key) const;
+		void CopyFilterFieldsTo(LuaEventFilter::EventFields& eventFields) const;
+		BaseDispatchEventTask::Priority GetPriority() const;
+
+		/**
+		  Gets the unique ID of the request this task delivers the result of.
+		  @return Returns the ID assigned by RuntimeContext::AddEventHandlerFor(). Returns zero for global events.
+		 */
+		uint64_t GetRequestId() const;
+
+		/**
+		  Sets the unique ID of the request this task delivers the result of. Cleared by the Reset() method.
+		  @param value The ID assigned by RuntimeContext::AddEventHandlerFor().
+		 */
+		void SetRequestId(uint64_t value);
+
 		bool Execute();
 
+		/**
+		  Delivers an event table which was already pushed via PushLuaEventTableTo() to this task's Lua listeners,
+		  or resumes the Lua coroutine given to SetLuaCoroutine() with it.
+		  Allows the caller to keep using the same event table afterwards, such as to settle a request's promise.
+		  @param luaStatePointer Pointer to the Lua state that the "luaEventTableStackIndex" argument references.
+		  @param luaEventTableStackIndex Index to the event table. Must be a positive index.
+		  @return Returns true if the event was delivered. Returns false if this task has no listener to deliver to.
+		 */
+		bool DispatchLuaEventTable(lua_State* luaStatePointer, int luaEventTableStackIndex);
+		BaseDispatchEventTaskPool* GetPool() const;
+		void SetPool(BaseDispatchEventTaskPool* poolPointer);
+
+		/**
+		  Releases the Lua event dispatcher and clears the event data copied into this task without freeing
+		  the memory used to store it. Called by a DispatchEventTaskPool before re-using this task.
+		 */
+		virtual void Reset();
+
+	protected:
+		/**
+		  Sets the Steam user ID that the event belongs to. Used to coalesce tasks constructed as coalescable
+		  and to match the event against Lua listener filters.
+		  To be called by a derived class when acquiring its event data. Cleared by the Reset() method.
+		  @param value Integer form of the Steam user ID the event belongs to.
+		 */
+		void SetUserIntegerId(uint64 value);
+
+		/**
+		  Sets the name of the achievement that the event belongs to. Used to match the event against Lua listener filters.
+		  To be called by a derived class when acquiring its event data. Cleared by the Reset() method.
+		  @param name The achievement's unique name. Must remain valid until the Reset() method gets called,
+		              which is why it is expected to reference a string member of the derived class.
+		 */
+		void SetAchievementName(const char* name);
+
 	private:
+		/**
+		  Resumes the "fLuaCoroutinePointer" with the event table at the top of the coroutine's stack.
+		  Called by the Execute() and DispatchLuaEventTable() methods.
+		 */
+		bool ResumeLuaCoroutine();
+
+		/** Releases this task's Lua registry reference to the coroutine given to SetLuaCoroutine(), if any. */
+		void ReleaseLuaCoroutine();
+
 		std::shared_ptr<LuaEventDispatcher> fLuaEventDispatcherPointer;
+		lua_State* fLuaCoroutinePointer;
+		int fLuaCoroutineReferenceId;
+		BaseDispatchEventTaskPool* fPoolPointer;
+		const char* fLuaEventName;
+		BaseDispatchEventTask::Priority fPriority;
+		bool fIsCoalescable;
+		uint64 fUserIntegerId;
+		const char* fAchievementName;
+		uint64_t fRequestId;
 };
 
 
@@ -57,18 +197,28 @@ class BaseDispatchEventTask
   Provides SetHadIOFailure() and HadIOFailure() methods used to determine if there was a Steam I/O failure.
   The RuntimeContext::AddEventHandlerFor() method will automatically set this I/O failure flag.
   It is up to the derived class to call HadIOFailure() within the PushLuaEventTableTo() method to use it, if relevant.
+
+  Also provides SetAttemptCount() and GetAttemptCount() methods indicating how many times the RuntimeContext made
+  the Steam call, which is more than 1 if it was automatically retried after I/O failures.
  */
 class BaseDispatchCallResultEventTask : public BaseDispatchEventTask
 {
 	public:
-		BaseDispatchCallResultEventTask();
+		BaseDispatchCallResultEventTask(const char* luaEventName, BaseDispatchEventTask::Priority priority);
 		virtual ~BaseDispatchCallResultEventTask();
 
 		bool HadIOFailure() const;
 		void SetHadIOFailure(bool value);
+		bool IsTimedOut() const;
+		void SetTimedOut(bool value);
+		uint32_t GetAttemptCount() const;
+		void SetAttemptCount(uint32_t value);
+		virtual void Reset();
 
 	private:
 		bool fHadIOFailure;
+		bool fIsTimedOut;
+		uint32_t fAttemptCount;
 };
 
 
@@ -81,17 +231,41 @@ class BaseDispatchCallResultEventTask : public BaseDispatchEventTask
 class BaseDispatchLeaderboardEventTask : public BaseDispatchCallResultEventTask
 {
 	public:
-		BaseDispatchLeaderboardEventTask();
+		BaseDispatchLeaderboardEventTask(const char* luaEventName);
 		virtual ~BaseDispatchLeaderboardEventTask();
 
 		const char* GetLeaderboardName() const;
 		void SetLeaderboardName(const char* name);
+		virtual void Reset();
 
 	private:
 		std::string fLeaderboardName;
 };
 
 
+/**
+  Dispatches a plugin defined event to Lua indicating that the RuntimeContext's Steam connection state has changed,
+  such as after receiving a Steam "SteamServersDisconnected_t" or "SteamServersConnected_t" event.
+ */
+class DispatchConnectionStatusEventTask : public BaseDispatchEventTask
+{
+	public:
+		static const char kLuaEventName[];
+
+		DispatchConnectionStatusEventTask();
+		virtual ~DispatchConnectionStatusEventTask();
+
+		void SetConnectionState(const SteamConnectionState& state);
+		void SetParkedRequestCount(uint32_t count);
+		virtual bool PushLuaEventTableTo(lua_State* luaStatePointer) const;
+		virtual void Reset();
+
+	private:
+		SteamConnectionState fConnectionState;
+		uint32_t fParkedRequestCount;
+};
+
+
 /** Dispatches a Steam "GameOverlayActivated_t" event and its data to Lua. */
 class DispatchGameOverlayActivatedEventTask : public BaseDispatchEventTask
 {
@@ -102,7 +276,6 @@ class DispatchGameOverlayActivatedEventTask : public BaseDispatchEventTask
 		virtual ~DispatchGameOverlayActivatedEventTask();
 
 		void AcquireEventDataFrom(const GameOverlayActivated_t& steamEventData);
-		virtual const char* GetLuaEventName() const;
 		virtual bool PushLuaEventTableTo(lua_State* luaStatePointer) const;
 
 	private:
@@ -120,8 +293,8 @@ class DispatchLeaderboardScoresDownloadedEventTask : public BaseDispatchLeaderbo
 		virtual ~DispatchLeaderboardScoresDownloadedEventTask();
 
 		void AcquireEventDataFrom(const LeaderboardScoresDownloaded_t& steamEventData);
-		virtual const char* GetLuaEventName() const;
 		virtual bool PushLuaEventTableTo(lua_State* luaStatePointer) const;
+		virtual void Reset();
 
 	private:
 		SteamLeaderboard_t fLeaderboardHandle;
@@ -140,7 +313,6 @@ class DispatchLeaderboardFindResultEventTask : public BaseDispatchLeaderboardEve
 
 		void AcquireEventDataFrom(const LeaderboardFindResult_t& steamEventData);
 		void ClearEventData();
-		virtual const char* GetLuaEventName() const;
 		virtual bool PushLuaEventTableTo(lua_State* luaStatePointer) const;
 
 	private:
@@ -163,7 +335,6 @@ class DispatchLeaderboardScoreUploadEventTask : public BaseDispatchLeaderboardEv
 
 		void AcquireEventDataFrom(const LeaderboardScoreUploaded_t& steamEventData);
 		void ClearEventData();
-		virtual const char* GetLuaEventName() const;
 		virtual bool PushLuaEventTableTo(lua_State* luaStatePointer) const;
 
 	private:
@@ -185,7 +356,6 @@ class DispatchMicrotransactionAuthorizationResponseEventTask : public BaseDispat
 		virtual ~DispatchMicrotransactionAuthorizationResponseEventTask();
 
 		void AcquireEventDataFrom(const MicroTxnAuthorizationResponse_t& steamEventData);
-		virtual const char* GetLuaEventName() const;
 		virtual bool PushLuaEventTableTo(lua_State* luaStatePointer) const;
 
 	private:
@@ -204,7 +374,6 @@ class DispatchNumberOfCurrentPlayersEventTask : public BaseDispatchCallResultEve
 		virtual ~DispatchNumberOfCurrentPlayersEventTask();
 
 		void AcquireEventDataFrom(const NumberOfCurrentPlayers_t& steamEventData);
-		virtual const char* GetLuaEventName() const;
 		virtual bool PushLuaEventTableTo(lua_State* luaStatePointer) const;
 
 	private:
@@ -213,6 +382,38 @@ class DispatchNumberOfCurrentPlayersEventTask : public BaseDispatchCallResultEve
 };
 
 
+/**
+  Dispatches a plugin defined event to Lua indicating how many global Steam events of each type were
+  dropped while the Corona runtime was suspended, due to a RuntimeContext's suspended event buffer being full.
+ */
+class DispatchSuspendedEventsDroppedEventTask : public BaseDispatchEventTask
+{
+	public:
+		static const char kLuaEventName[];
+
+		DispatchSuspendedEventsDroppedEventTask();
+		virtual ~DispatchSuspendedEventsDroppedEventTask();
+
+		void AddDroppedEventCount(const char* luaEventName, uint32_t count);
+		uint32_t GetTotalDroppedEventCount() const;
+		virtual bool PushLuaEventTableTo(lua_State* luaStatePointer) const;
+		virtual void Reset();
+
+	private:
+		/** Stores the number of dropped events for 1 Lua event name. */
+		struct DroppedEventCountEntry
+		{
+			/** Name of the dropped Lua event. Expected to be a task class' static "kLuaEventName" string. */
+			const char* LuaEventName;
+
+			/** Number of events dropped having the above name. */
+			uint32_t Count;
+		};
+
+		std::vector<DroppedEventCountEntry> fDroppedEventCountCollection;
+};
+
+
 /** Dispatches a Steam "UserAchievementStored_t" event and its data to Lua. */
 class DispatchUserAchievementStoredEventTask : public BaseDispatchEventTask
 {
@@ -223,7 +424,6 @@ class DispatchUserAchievementStoredEventTask : public BaseDispatchEventTask
 		virtual ~DispatchUserAchievementStoredEventTask();
 
 		void AcquireEventDataFrom(const UserAchievementStored_t& steamEventData);
-		virtual const char* GetLuaEventName() const;
 		virtual bool PushLuaEventTableTo(lua_State* luaStatePointer) const;
 
 	private:
@@ -244,7 +444,6 @@ class DispatchUserStatsReceivedEventTask : public BaseDispatchEventTask
 		virtual ~DispatchUserStatsReceivedEventTask();
 
 		void AcquireEventDataFrom(const UserStatsReceived_t& steamEventData);
-		virtual const char* GetLuaEventName() const;
 		virtual bool PushLuaEventTableTo(lua_State* luaStatePointer) const;
 
 	private:
@@ -263,7 +462,6 @@ class DispatchUserStatsStoredEventTask : public BaseDispatchEventTask
 		virtual ~DispatchUserStatsStoredEventTask();
 
 		void AcquireEventDataFrom(const UserStatsStored_t& steamEventData);
-		virtual const char* GetLuaEventName() const;
 		virtual bool PushLuaEventTableTo(lua_State* luaStatePointer) const;
 
 	private:
@@ -282,7 +480,6 @@ class DispatchUserStatsUnloadedEventTask : public BaseDispatchEventTask
 		virtual ~DispatchUserStatsUnloadedEventTask();
 
 		void AcquireEventDataFrom(const UserStatsUnloaded_t& steamEventData);
-		virtual const char* GetLuaEventName() const;
 		virtual bool PushLuaEventTableTo(lua_State* luaStatePointer) const;
 
 	private:
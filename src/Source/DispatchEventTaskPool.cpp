@@ -0,0 +1,32 @@
+// ----------------------------------------------------------------------------
+// 
+// DispatchEventTaskPool.cpp
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#include "DispatchEventTaskPool.h"
+
+
+std::atomic<uint64_t> BaseDispatchEventTaskPool::sTotalSlabAllocationCount(0);
+
+
+BaseDispatchEventTaskPool::BaseDispatchEventTaskPool()
+{
+}
+
+BaseDispatchEventTaskPool::~BaseDispatchEventTaskPool()
+{
+}
+
+uint64_t BaseDispatchEventTaskPool::GetTotalSlabAllocationCount()
+{
+	return sTotalSlabAllocationCount.load(std::memory_order_relaxed);
+}
+
+void BaseDispatchEventTaskPool::OnSlabAllocated()
+{
+	sTotalSlabAllocationCount.fetch_add(1, std::memory_order_relaxed);
+}
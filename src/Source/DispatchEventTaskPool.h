@@ -0,0 +1,168 @@
+// ----------------------------------------------------------------------------
+// 
+// DispatchEventTaskPool.h
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#pragma once
+
+#include "DispatchEventTask.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+
+/**
+  Abstract class whose derived "DispatchEventTaskPool" class stores re-usable task objects of 1 type.
+
+  Tasks acquired from a pool remember which pool they came from, which allows the DispatchEventTaskReleaser
+  to hand a task back to its pool via this abstract class' Release() method without knowing its concrete type.
+ */
+class BaseDispatchEventTaskPool
+{
+	public:
+		/** Creates a new task pool. */
+		BaseDispatchEventTaskPool();
+
+		/** Destroys this pool. */
+		virtual ~BaseDispatchEventTaskPool();
+
+		/**
+		  Resets the given task's event data and returns it to this pool to be re-used by a later Acquire() call.
+		  This method is thread safe.
+		  @param taskPointer The task to be returned to this pool. Must have been acquired from this pool.
+		 */
+		virtual void Release(BaseDispatchEventTask* taskPointer) = 0;
+
+		/**
+		  Gets the total number of slabs allocated by all task pools in the application.
+		  Expected to stop increasing once the application's event traffic reaches a steady state.
+		  @return Returns the number of slab heap allocations made by all task pools.
+		 */
+		static uint64_t GetTotalSlabAllocationCount();
+
+	protected:
+		/** To be called by a derived class when it has allocated a new slab of tasks. */
+		static void OnSlabAllocated();
+
+	private:
+		/** Copy constructor deleted to prevent it from being called. */
+		BaseDispatchEventTaskPool(const BaseDispatchEventTaskPool&) = delete;
+
+		/** Copy operator deleted to prevent it from being called. */
+		void operator=(const BaseDispatchEventTaskPool&) = delete;
+
+		/** Number of slabs allocated by all task pools. */
+		static std::atomic<uint64_t> sTotalSlabAllocationCount;
+};
+
+
+template<class TDispatchEventTask>
+/**
+  Thread safe pool of re-usable "TDispatchEventTask" objects.
+
+  Tasks are allocated in fixed size slabs and are never freed until the pool is destroyed. Released tasks
+  keep their payload's memory capacity, such as a leaderboard entry vector, which means that once the pool
+  has grown to the application's peak event traffic, acquiring and releasing tasks no longer allocates memory.
+
+  There is only 1 pool per task type, which is shared by all RuntimeContext instances and fetched via the
+  static GetInstance() method.
+ */
+class DispatchEventTaskPool : public BaseDispatchEventTaskPool
+{
+	public:
+		/** Smart pointer type returned by the Acquire() method. Returns the task to this pool when destroyed. */
+		typedef std::unique_ptr<TDispatchEventTask, DispatchEventTaskReleaser> TaskPointer;
+
+		/** Creates a new empty pool. */
+		DispatchEventTaskPool()
+		{
+			// Triggers a compiler error if "TDispatchEventTask" does not derive from "BaseDispatchEventTask".
+			static_assert(
+					std::is_base_of<BaseDispatchEventTask, TDispatchEventTask>::value,
+					"DispatchEventTaskPool<TDispatchEventTask> class' 'TDispatchEventTask' type "
+					"must be set to a class type derived from the 'BaseDispatchEventTask' class.");
+		}
+
+		/** Deletes all slabs of tasks. All tasks are expected to have been released by now. */
+		virtual ~DispatchEventTaskPool()
+		{
+		}
+
+		/**
+		  Fetches an unused task from the pool. Allocates a new slab of tasks if the pool has run out.
+		  This method is thread safe.
+		  @return Returns a task in its default state, which will be released back to this pool when
+		          the returned smart pointer is destroyed.
+		 */
+		TaskPointer Acquire()
+		{
+			std::lock_guard<std::mutex> scopedLock(fMutex);
+
+			// If all tasks are in use, then allocate another slab.
+			// Note: Reserve enough free list capacity up front so that Release() never has to allocate.
+			if (fFreeTaskCollection.empty())
+			{
+				std::unique_ptr<TDispatchEventTask[]> slabPointer(new TDispatchEventTask[kTasksPerSlab]);
+				fFreeTaskCollection.reserve((fSlabCollection.size() + 1) * kTasksPerSlab);
+				for (size_t index = 0; index < kTasksPerSlab; index++)
+				{
+					slabPointer[index].SetPool(this);
+					fFreeTaskCollection.push_back(&slabPointer[index]);
+				}
+				fSlabCollection.push_back(std::move(slabPointer));
+				OnSlabAllocated();
+			}
+
+			// Pop the most recently released task, which is the most likely to still be in the CPU's cache.
+			TDispatchEventTask* taskPointer = fFreeTaskCollection.back();
+			fFreeTaskCollection.pop_back();
+			return TaskPointer(taskPointer);
+		}
+
+		virtual void Release(BaseDispatchEventTask* taskPointer)
+		{
+			// Validate.
+			if (!taskPointer)
+			{
+				return;
+			}
+
+			// Reset the task outside of the lock since it might release a Lua event dispatcher.
+			taskPointer->Reset();
+
+			// Push the task back into the free list.
+			std::lock_guard<std::mutex> scopedLock(fMutex);
+			fFreeTaskCollection.push_back(static_cast<TDispatchEventTask*>(taskPointer));
+		}
+
+		/**
+		  Gets the one and only pool for the "TDispatchEventTask" type.
+		  @return Returns a reference to this task type's pool.
+		 */
+		static DispatchEventTaskPool<TDispatchEventTask>& GetInstance()
+		{
+			static DispatchEventTaskPool<TDispatchEventTask> sPool;
+			return sPool;
+		}
+
+	private:
+		/** Number of tasks allocated at a time when the pool has run out of unused tasks. */
+		static const size_t kTasksPerSlab = 32;
+
+
+		/** Mutex used to synchronize access to this pool's collections. */
+		std::mutex fMutex;
+
+		/** Slabs of tasks allocated by this pool, which owns them. */
+		std::vector<std::unique_ptr<TDispatchEventTask[]>> fSlabCollection;
+
+		/** Stack of tasks that are not in use. Its capacity always matches the total number of tasks allocated. */
+		std::vector<TDispatchEventTask*> fFreeTaskCollection;
+};
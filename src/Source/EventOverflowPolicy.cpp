@@ -0,0 +1,67 @@
+// ----------------------------------------------------------------------------
+// 
+// EventOverflowPolicy.cpp
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#include "EventOverflowPolicy.h"
+#include <string>
+#include <unordered_map>
+
+
+static std::unordered_map<std::string, const EventOverflowPolicy*> sEventOverflowPolicyMap;
+
+const EventOverflowPolicy EventOverflowPolicy::kUnknown;
+const EventOverflowPolicy EventOverflowPolicy::kDropOldest("dropOldest");
+const EventOverflowPolicy EventOverflowPolicy::kDropNewest("dropNewest");
+const EventOverflowPolicy EventOverflowPolicy::kCollapseToLatest("collapseToLatest");
+
+
+EventOverflowPolicy::EventOverflowPolicy()
+:	fCoronaStringId(nullptr)
+{
+}
+
+EventOverflowPolicy::EventOverflowPolicy(const char* coronaStringId)
+:	fCoronaStringId(coronaStringId)
+{
+	if (fCoronaStringId)
+	{
+		sEventOverflowPolicyMap[std::string(fCoronaStringId)] = this;
+	}
+}
+
+EventOverflowPolicy::~EventOverflowPolicy()
+{
+}
+
+const char* EventOverflowPolicy::GetCoronaStringId() const
+{
+	return fCoronaStringId ? fCoronaStringId : "unknown";
+}
+
+bool EventOverflowPolicy::operator==(const EventOverflowPolicy& policy) const
+{
+	return (fCoronaStringId == policy.fCoronaStringId);
+}
+
+bool EventOverflowPolicy::operator!=(const EventOverflowPolicy& policy) const
+{
+	return (fCoronaStringId != policy.fCoronaStringId);
+}
+
+EventOverflowPolicy EventOverflowPolicy::FromCoronaStringId(const char* stringId)
+{
+	if (stringId)
+	{
+		auto iterator = sEventOverflowPolicyMap.find(std::string(stringId));
+		if (iterator != sEventOverflowPolicyMap.end())
+		{
+			return *(iterator->second);
+		}
+	}
+	return EventOverflowPolicy::kUnknown;
+}
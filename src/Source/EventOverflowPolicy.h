@@ -0,0 +1,84 @@
+// ----------------------------------------------------------------------------
+// 
+// EventOverflowPolicy.h
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#pragma once
+
+
+/**
+  Indicates which events are discarded when a bounded event buffer is full, such as the buffers a
+  RuntimeContext stores global Steam events in while the Corona runtime is suspended.
+  Provides predefined constants kDropOldest, kDropNewest, and kCollapseToLatest for identifying the policy
+  which also provide Corona plugin defined string IDs intended to be used by the "config.lua" file.
+  Also provides static function FromCoronaStringId() for converting a string ID back to a predefined constant.
+ */
+class EventOverflowPolicy final
+{
+	private:
+		/**
+		  Creates a new overflow policy using the given unique string ID.
+		  This constructor is private and is only used to create this class' predefined
+		  constants such as kDropOldest, kDropNewest, and kCollapseToLatest.
+		  @param coronaStringId Unique string ID assigned to the policy.
+		 */
+		EventOverflowPolicy(const char* coronaStringId);
+
+	public:
+		/** Indicates that the overflow policy is unknown. */
+		static const EventOverflowPolicy kUnknown;
+
+		/** Indicates that the oldest buffered event is discarded to make room for the new event. */
+		static const EventOverflowPolicy kDropOldest;
+
+		/** Indicates that the new event is discarded, keeping all of the events already buffered. */
+		static const EventOverflowPolicy kDropNewest;
+
+		/** Indicates that all buffered events are discarded, keeping only the new event. */
+		static const EventOverflowPolicy kCollapseToLatest;
+
+		/** Creates a policy initialized to unknown. */
+		EventOverflowPolicy();
+
+		/** Destroys this object. */
+		virtual ~EventOverflowPolicy();
+
+		/**
+		  Gets a unique string ID used to identify this overflow policy.
+		  @return Returns the policy's unique string ID.
+		 */
+		const char* GetCoronaStringId() const;
+
+		/**
+		  Determines if this policy matches the given policy.
+		  @param policy The policy to be compared with.
+		  @return Returns true if the policies match. Returns false if they don't match.
+		 */
+		bool operator==(const EventOverflowPolicy& policy) const;
+
+		/**
+		  Determines if this policy does not match the given policy.
+		  @param policy The policy to be compared with.
+		  @return Returns true if the policies do not match. Returns false if they do.
+		 */
+		bool operator!=(const EventOverflowPolicy& policy) const;
+
+		/**
+		  Returns a new instance of this class matching the given string ID.
+		  @param stringId Unique string ID identifying the policy such as
+		                  "dropOldest", "dropNewest", or "collapseToLatest".
+		  @return Returns a new policy instance matching the string ID such as
+		          kDropOldest, kDropNewest, or kCollapseToLatest.
+
+		          Returns kUnknown if given an unknown string ID or null.
+		 */
+		static EventOverflowPolicy FromCoronaStringId(const char* stringId);
+
+	private:
+		/** Unique string ID assigned to the policy such as "dropOldest", "dropNewest", etc. */
+		const char* fCoronaStringId;
+};
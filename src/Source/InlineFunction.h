@@ -0,0 +1,217 @@
+// ----------------------------------------------------------------------------
+//
+// InlineFunction.h
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+
+template<class TSignature, size_t kCapacity>
+class InlineFunction;
+
+template<class TResult, class... TArguments, size_t kCapacity>
+/**
+  Move-only alternative to std::function which stores its callable object within a fixed size buffer
+  inside of this object instead of on the heap.
+
+  Assigning a callable, such as a lambda, that does not fit within "kCapacity" bytes triggers a compiler error.
+  This guarantees that storing and invoking a callback never allocates memory, which makes this class suitable
+  for callbacks that get re-assigned on every request, such as a SteamCallResultHandler's callback.
+
+  Unlike std::function, the stored callable does not need to be copyable, which allows it to capture
+  move-only objects such as a std::unique_ptr.
+ */
+class InlineFunction<TResult(TArguments...), kCapacity>
+{
+	public:
+		/** Creates an empty function which cannot be invoked. */
+		InlineFunction()
+		:	fOperationsPointer(nullptr)
+		{
+		}
+
+		/** Creates an empty function which cannot be invoked. */
+		InlineFunction(std::nullptr_t)
+		:	fOperationsPointer(nullptr)
+		{
+		}
+
+		/**
+		  Creates a function which moves or copies the given callable into its inline buffer.
+		  @param callable The lambda or function object to be invoked by this function's call operator.
+		 */
+		template<
+			class TCallable,
+			class = typename std::enable_if<
+					!std::is_same<typename std::decay<TCallable>::type, InlineFunction>::value>::type>
+		InlineFunction(TCallable&& callable)
+		:	fOperationsPointer(nullptr)
+		{
+			typedef typename std::decay<TCallable>::type CallableType;
+			static_assert(
+					sizeof(CallableType) <= kCapacity,
+					"InlineFunction's callable is too big. Increase the 'kCapacity' template argument.");
+			static_assert(
+					alignof(CallableType) <= alignof(StorageType),
+					"InlineFunction's callable requires a stricter alignment than its inline buffer provides.");
+			new (&fStorage) CallableType(std::forward<TCallable>(callable));
+			fOperationsPointer = GetOperationsFor<CallableType>();
+		}
+
+		/**
+		  Moves the given function's callable into this function, leaving the given function empty.
+		  @param function The function to move the callable from.
+		 */
+		InlineFunction(InlineFunction&& function)
+		:	fOperationsPointer(nullptr)
+		{
+			MoveFrom(function);
+		}
+
+		/** Destroys the stored callable, if any. */
+		~InlineFunction()
+		{
+			Reset();
+		}
+
+		/**
+		  Destroys this function's current callable and moves the given function's callable into this function.
+		  @param function The function to move the callable from. Will be left empty.
+		  @return Returns a reference to this function.
+		 */
+		InlineFunction& operator=(InlineFunction&& function)
+		{
+			if (&function != this)
+			{
+				Reset();
+				MoveFrom(function);
+			}
+			return *this;
+		}
+
+		/**
+		  Destroys this function's current callable, making this function empty.
+		  @return Returns a reference to this function.
+		 */
+		InlineFunction& operator=(std::nullptr_t)
+		{
+			Reset();
+			return *this;
+		}
+
+		/**
+		  Determines if this function stores a callable.
+		  @return Returns true if this function can be invoked. Returns false if empty.
+		 */
+		explicit operator bool() const
+		{
+			return (fOperationsPointer != nullptr);
+		}
+
+		/**
+		  Invokes the stored callable. Must not be called on an empty function.
+		  @param arguments The arguments to be passed to the callable.
+		  @return Returns the callable's return value.
+		 */
+		TResult operator()(TArguments... arguments)
+		{
+			return fOperationsPointer->Invoke(&fStorage, std::forward<TArguments>(arguments)...);
+		}
+
+		/** Destroys the stored callable, if any, making this function empty. */
+		void Reset()
+		{
+			if (fOperationsPointer)
+			{
+				fOperationsPointer->Destroy(&fStorage);
+				fOperationsPointer = nullptr;
+			}
+		}
+
+	private:
+		/** Copy constructor deleted since the stored callable might not be copyable. */
+		InlineFunction(const InlineFunction&) = delete;
+
+		/** Copy operator deleted since the stored callable might not be copyable. */
+		void operator=(const InlineFunction&) = delete;
+
+		/** Type of the inline buffer that the callable is constructed in. */
+		typedef typename std::aligned_storage<kCapacity, alignof(std::max_align_t)>::type StorageType;
+
+		/** Table of functions used to invoke, move, and destroy a callable of 1 type stored in the inline buffer. */
+		struct Operations
+		{
+			TResult(*Invoke)(void* storagePointer, TArguments&&... arguments);
+			void(*MoveTo)(void* sourceStoragePointer, void* destinationStoragePointer);
+			void(*Destroy)(void* storagePointer);
+		};
+
+		template<class TCallable>
+		/** Implements the "Operations" table for the given callable type. */
+		struct CallableOperations
+		{
+			static TResult Invoke(void* storagePointer, TArguments&&... arguments)
+			{
+				return (*static_cast<TCallable*>(storagePointer))(std::forward<TArguments>(arguments)...);
+			}
+
+			static void MoveTo(void* sourceStoragePointer, void* destinationStoragePointer)
+			{
+				auto sourceCallablePointer = static_cast<TCallable*>(sourceStoragePointer);
+				new (destinationStoragePointer) TCallable(std::move(*sourceCallablePointer));
+				sourceCallablePointer->~TCallable();
+			}
+
+			static void Destroy(void* storagePointer)
+			{
+				static_cast<TCallable*>(storagePointer)->~TCallable();
+			}
+		};
+
+		template<class TCallable>
+		/**
+		  Gets the one and only "Operations" table for the given callable type.
+		  @return Returns a pointer to a statically allocated table.
+		 */
+		static const Operations* GetOperationsFor()
+		{
+			static const Operations sOperations =
+			{
+				&CallableOperations<TCallable>::Invoke,
+				&CallableOperations<TCallable>::MoveTo,
+				&CallableOperations<TCallable>::Destroy
+			};
+			return &sOperations;
+		}
+
+		/**
+		  Moves the given function's callable into this function's buffer, leaving the given function empty.
+		  This function is expected to be empty before calling this method.
+		  @param function The function to move the callable from.
+		 */
+		void MoveFrom(InlineFunction& function)
+		{
+			if (function.fOperationsPointer)
+			{
+				function.fOperationsPointer->MoveTo(&function.fStorage, &fStorage);
+				fOperationsPointer = function.fOperationsPointer;
+				function.fOperationsPointer = nullptr;
+			}
+		}
+
+
+		/** Inline buffer which the callable is constructed in. */
+		StorageType fStorage;
+
+		/** Table of functions used to manage the callable in "fStorage". Null if this function is empty. */
+		const Operations* fOperationsPointer;
+};
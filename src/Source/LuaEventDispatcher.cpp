@@ -24,8 +24,7 @@ LuaEventDispatcher::LuaEventDispatcher(const LuaEventDispatcher&)
 }
 
 LuaEventDispatcher::LuaEventDispatcher(lua_State* luaStatePointer)
-:	fLuaStatePointer(luaStatePointer),
-	fLuaRegistryReferenceId(LUA_NOREF)
+:	fLuaStatePointer(luaStatePointer)
 {
 	// Validate.
 	if (!luaStatePointer)
@@ -38,36 +37,23 @@ LuaEventDispatcher::LuaEventDispatcher(lua_State* luaStatePointer)
 	lua_State* mainLuaStatePointer = CoronaLuaGetCoronaThread(luaStatePointer);
 	if (mainLuaStatePointer && (mainLuaStatePointer != luaStatePointer))
 	{
-		luaStatePointer = mainLuaStatePointer;
 		fLuaStatePointer = mainLuaStatePointer;
 	}
+}
 
-	// Create a new Corona "EventDispatcher" by calling the Lua system.newEventDispatcher() function.
-	// Store it under the Lua registry to prevent the object from being garbage collected.
-	int luaStackCount = lua_gettop(luaStatePointer);
-	lua_getglobal(luaStatePointer, "system");
-	if (lua_istable(luaStatePointer, -1))
+LuaEventDispatcher::~LuaEventDispatcher()
+{
+	// Release our references to all added listeners.
+	if (fLuaStatePointer)
 	{
-		lua_getfield(luaStatePointer, -1, "newEventDispatcher");
-		if (lua_isfunction(luaStatePointer, -1))
+		for (auto&& collection : fEventListenerCollections)
 		{
-			CoronaLuaDoCall(luaStatePointer, 0, 1);
-			if (lua_istable(luaStatePointer, -1))
+			for (auto&& listenerReference : collection.ListenerReferences)
 			{
-				fLuaRegistryReferenceId = luaL_ref(luaStatePointer, LUA_REGISTRYINDEX);
+				luaL_unref(fLuaStatePointer, LUA_REGISTRYINDEX, listenerReference.LuaRegistryReferenceId);
 			}
 		}
 	}
-	lua_settop(luaStatePointer, luaStackCount);
-}
-
-LuaEventDispatcher::~LuaEventDispatcher()
-{
-	// Release our reference to the Lua EventDispatcher created by this class' constructor.
-	if (fLuaStatePointer && (fLuaRegistryReferenceId != LUA_NOREF))
-	{
-		luaL_unref(fLuaStatePointer, LUA_REGISTRYINDEX, fLuaRegistryReferenceId);
-	}
 }
 
 lua_State* LuaEventDispatcher::GetLuaState() const
@@ -78,14 +64,14 @@ lua_State* LuaEventDispatcher::GetLuaState() const
 bool LuaEventDispatcher::AddEventListener(
 	lua_State* luaStatePointer, const char* eventName, int luaListenerStackIndex)
 {
-	// Validate arguments.
-	if (!luaStatePointer || !eventName || !luaListenerStackIndex)
-	{
-		return false;
-	}
+	return AddEventListener(luaStatePointer, eventName, luaListenerStackIndex, LuaEventFilter());
+}
 
-	// Do not continue if we've failed to create an EventDispatcher object in Lua.
-	if (LUA_NOREF == fLuaRegistryReferenceId)
+bool LuaEventDispatcher::AddEventListener(
+	lua_State* luaStatePointer, const char* eventName, int luaListenerStackIndex, const LuaEventFilter& filter)
+{
+	// Validate arguments.
+	if (!luaStatePointer || !eventName || !luaListenerStackIndex || !fLuaStatePointer)
 	{
 		return false;
 	}
@@ -102,23 +88,28 @@ bool LuaEventDispatcher::AddEventListener(
 		luaListenerStackIndex += lua_gettop(luaStatePointer) + 1;
 	}
 
-	// Add the given Lua listener to this object's EventDispatcher.
-	lua_rawgeti(luaStatePointer, LUA_REGISTRYINDEX, fLuaRegistryReferenceId);
-	if (!lua_istable(luaStatePointer, -1))
+	// Fetch the event's listener collection, creating it if this is the event's first listener.
+	auto collectionPointer = GetEventListenerCollectionFor(eventName);
+	if (!collectionPointer)
 	{
-		lua_pop(luaStatePointer, 1);
-		return false;
+		EventListenerCollection collection;
+		collection.EventName = eventName;
+		fEventListenerCollections.push_back(collection);
+		collectionPointer = &fEventListenerCollections.back();
 	}
-	lua_getfield(luaStatePointer, -1, "addEventListener");
-	if (!lua_isfunction(luaStatePointer, -1))
+
+	// Do not add the same listener for the same event twice.
+	if (IndexOfEventListener(luaStatePointer, *collectionPointer, luaListenerStackIndex) >= 0)
 	{
-		lua_pop(luaStatePointer, 2);
 		return false;
 	}
-	lua_insert(luaStatePointer, -2);
-	lua_pushstring(luaStatePointer, eventName);
+
+	// Store the given listener in the Lua registry to be invoked directly when dispatching events.
+	ListenerReference listenerReference;
 	lua_pushvalue(luaStatePointer, luaListenerStackIndex);
-	CoronaLuaDoCall(luaStatePointer, 3, 0);
+	listenerReference.LuaRegistryReferenceId = luaL_ref(luaStatePointer, LUA_REGISTRYINDEX);
+	listenerReference.Filter = filter;
+	collectionPointer->ListenerReferences.push_back(listenerReference);
 	return true;
 }
 
@@ -126,13 +117,7 @@ bool LuaEventDispatcher::RemoveEventListener(
 	lua_State* luaStatePointer, const char* eventName, int luaListenerStackIndex)
 {
 	// Validate arguments.
-	if (!luaStatePointer || !eventName || !luaListenerStackIndex)
-	{
-		return false;
-	}
-
-	// Do not continue if we've failed to create an EventDispatcher object in Lua.
-	if (LUA_NOREF == fLuaRegistryReferenceId)
+	if (!luaStatePointer || !eventName || !luaListenerStackIndex || !fLuaStatePointer)
 	{
 		return false;
 	}
@@ -149,30 +134,102 @@ bool LuaEventDispatcher::RemoveEventListener(
 		luaListenerStackIndex += lua_gettop(luaStatePointer) + 1;
 	}
 
-	// Remove the given Lua listener from this object's EventDispatcher.
-	lua_rawgeti(luaStatePointer, LUA_REGISTRYINDEX, fLuaRegistryReferenceId);
-	if (!lua_istable(luaStatePointer, -1))
+	// Do not continue if the given listener was never added for the given event.
+	auto collectionPointer = GetEventListenerCollectionFor(eventName);
+	if (!collectionPointer)
 	{
-		lua_pop(luaStatePointer, 1);
 		return false;
 	}
-	lua_getfield(luaStatePointer, -1, "removeEventListener");
-	if (!lua_isfunction(luaStatePointer, -1))
+	int listenerIndex = IndexOfEventListener(luaStatePointer, *collectionPointer, luaListenerStackIndex);
+	if (listenerIndex < 0)
 	{
-		lua_pop(luaStatePointer, 2);
 		return false;
 	}
-	lua_insert(luaStatePointer, -2);
-	lua_pushstring(luaStatePointer, eventName);
-	lua_pushvalue(luaStatePointer, luaListenerStackIndex);
-	CoronaLuaDoCall(luaStatePointer, 3, 0);
+
+	// Release our reference to the removed listener.
+	// Note: An event being dispatched keeps the listener on the Lua stack, so it is still safely invoked.
+	auto& listenerReferences = collectionPointer->ListenerReferences;
+	luaL_unref(luaStatePointer, LUA_REGISTRYINDEX, listenerReferences[listenerIndex].LuaRegistryReferenceId);
+	listenerReferences.erase(listenerReferences.begin() + listenerIndex);
 	return true;
 }
 
+int LuaEventDispatcher::GetEventListenerCount(const char* eventName) const
+{
+	auto collectionPointer = GetEventListenerCollectionFor(eventName);
+	return collectionPointer ? (int)collectionPointer->ListenerReferences.size() : 0;
+}
+
+bool LuaEventDispatcher::HasEventListenersFor(
+	const char* eventName, const LuaEventFilter::EventFields& eventFields) const
+{
+	auto collectionPointer = GetEventListenerCollectionFor(eventName);
+	if (collectionPointer)
+	{
+		for (auto&& listenerReference : collectionPointer->ListenerReferences)
+		{
+			if (listenerReference.Filter.IsMatch(eventFields))
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+LuaEventDispatcher::EventListenerCollection* LuaEventDispatcher::GetEventListenerCollectionFor(const char* eventName)
+{
+	if (eventName)
+	{
+		for (auto&& collection : fEventListenerCollections)
+		{
+			if (collection.EventName == eventName)
+			{
+				return &collection;
+			}
+		}
+	}
+	return nullptr;
+}
+
+const LuaEventDispatcher::EventListenerCollection* LuaEventDispatcher::GetEventListenerCollectionFor(
+	const char* eventName) const
+{
+	if (eventName)
+	{
+		for (auto&& collection : fEventListenerCollections)
+		{
+			if (collection.EventName == eventName)
+			{
+				return &collection;
+			}
+		}
+	}
+	return nullptr;
+}
+
+int LuaEventDispatcher::IndexOfEventListener(
+	lua_State* luaStatePointer, const LuaEventDispatcher::EventListenerCollection& collection,
+	int luaListenerStackIndex) const
+{
+	for (size_t index = 0; index < collection.ListenerReferences.size(); index++)
+	{
+		auto& listenerReference = collection.ListenerReferences[index];
+		lua_rawgeti(luaStatePointer, LUA_REGISTRYINDEX, listenerReference.LuaRegistryReferenceId);
+		bool isEqual = lua_rawequal(luaStatePointer, -1, luaListenerStackIndex) ? true : false;
+		lua_pop(luaStatePointer, 1);
+		if (isEqual)
+		{
+			return (int)index;
+		}
+	}
+	return -1;
+}
+
 bool LuaEventDispatcher::DispatchEventWithResult(lua_State* luaStatePointer, const char* eventName)
 {
 	// Validate arguments.
-	if (!fLuaStatePointer || !eventName)
+	if (!luaStatePointer || !fLuaStatePointer || !eventName)
 	{
 		return false;
 	}
@@ -195,13 +252,7 @@ bool LuaEventDispatcher::DispatchEventWithResult(lua_State* luaStatePointer, con
 bool LuaEventDispatcher::DispatchEventWithResult(lua_State* luaStatePointer, int luaEventTableStackIndex)
 {
 	// Validate arguments.
-	if (!fLuaStatePointer || !luaEventTableStackIndex)
-	{
-		return false;
-	}
-
-	// Do not continue if we've failed to create an EventDispatcher object in Lua.
-	if (LUA_NOREF == fLuaRegistryReferenceId)
+	if (!luaStatePointer || !fLuaStatePointer || !luaEventTableStackIndex)
 	{
 		return false;
 	}
@@ -211,24 +262,29 @@ bool LuaEventDispatcher::DispatchEventWithResult(lua_State* luaStatePointer, int
 	{
 		luaEventTableStackIndex += lua_gettop(luaStatePointer) + 1;
 	}
-
-	// Dispatch the given Lua event table.
-	// Note: This does not pop the given event table off of the stack.
-	lua_rawgeti(fLuaStatePointer, LUA_REGISTRYINDEX, fLuaRegistryReferenceId);
-	if (!lua_istable(fLuaStatePointer, -1))
+	if (!lua_istable(luaStatePointer, luaEventTableStackIndex))
 	{
-		lua_pop(fLuaStatePointer, 1);
 		return false;
 	}
-	lua_getfield(fLuaStatePointer, -1, "dispatchEvent");
-	if (!lua_isfunction(fLuaStatePointer, -1))
+
+	// Dispatch the given event table to the unfiltered listeners of the event it names.
+	// Note: The name string is kept on the stack while dispatching to keep it from being garbage collected.
+	//       Event fields are left empty, which filtered listeners never match.
+	const int luaStackCount = lua_gettop(luaStatePointer);
+	bool wasHandled = false;
+	lua_getfield(luaStatePointer, luaEventTableStackIndex, "name");
+	if (lua_type(luaStatePointer, -1) == LUA_TSTRING)
 	{
-		lua_pop(fLuaStatePointer, 2);
-		return false;
+		LuaEventFilter::EventFields eventFields;
+		eventFields.UserIntegerId = 0;
+		eventFields.AchievementName = nullptr;
+		InvokeEventListenersFor(
+				luaStatePointer, luaEventTableStackIndex, lua_tostring(luaStatePointer, -1), eventFields, wasHandled);
 	}
-	lua_insert(fLuaStatePointer, -2);
-	lua_pushvalue(luaStatePointer, luaEventTableStackIndex);
-	CoronaLuaDoCall(fLuaStatePointer, 2, 1);
+	lua_settop(luaStatePointer, luaStackCount);
+
+	// Push the result to the top of the stack, like a Lua EventDispatcher's dispatchEvent() function would.
+	lua_pushboolean(luaStatePointer, wasHandled ? 1 : 0);
 	return true;
 }
 
@@ -261,3 +317,101 @@ bool LuaEventDispatcher::DispatchEventWithoutResult(lua_State* luaStatePointer,
 	// Returns true if given event was successfully dispatched to Lua.
 	return wasDispatched;
 }
+
+bool LuaEventDispatcher::DispatchEventWithoutResult(
+	lua_State* luaStatePointer, int luaEventTableStackIndex, const char* eventName,
+	const LuaEventFilter::EventFields& eventFields)
+{
+	// Validate arguments.
+	if (!luaStatePointer || !fLuaStatePointer || !luaEventTableStackIndex || !eventName)
+	{
+		return false;
+	}
+
+	// Convert the given Lua stack index from a relative index to an absolute index.
+	if ((luaEventTableStackIndex < 0) && (luaEventTableStackIndex > LUA_REGISTRYINDEX))
+	{
+		luaEventTableStackIndex += lua_gettop(luaStatePointer) + 1;
+	}
+
+	// Invoke all listeners whose filters match the event.
+	// Returns true if given event was dispatched to at least 1 listener.
+	bool wasHandled = false;
+	return (InvokeEventListenersFor(luaStatePointer, luaEventTableStackIndex, eventName, eventFields, wasHandled) > 0);
+}
+
+int LuaEventDispatcher::InvokeEventListenersFor(
+	lua_State* luaStatePointer, int luaEventTableStackIndex, const char* eventName,
+	const LuaEventFilter::EventFields& eventFields, bool& wasHandled)
+{
+	// Fetch the event's listeners.
+	auto collectionPointer = GetEventListenerCollectionFor(eventName);
+	if (!collectionPointer || collectionPointer->ListenerReferences.empty())
+	{
+		return 0;
+	}
+
+	// Make sure the Lua stack has room for all of the listeners plus the arguments needed to invoke them.
+	// Note: Do not report the event as dispatched if it could not be delivered to any of its listeners.
+	if (!lua_checkstack(luaStatePointer, (int)collectionPointer->ListenerReferences.size() + 3))
+	{
+		CoronaLuaWarning(luaStatePointer, "Failed to dispatch event '%s' due to a Lua stack overflow.", eventName);
+		return 0;
+	}
+
+	// Push all listeners that want the event to the Lua stack, in the order that they were added.
+	// Pushing them first allows listeners to safely add or remove listeners while being invoked.
+	const int luaStackCount = lua_gettop(luaStatePointer);
+	int listenerCount = 0;
+	for (auto&& listenerReference : collectionPointer->ListenerReferences)
+	{
+		if (listenerReference.Filter.IsMatch(eventFields))
+		{
+			lua_rawgeti(luaStatePointer, LUA_REGISTRYINDEX, listenerReference.LuaRegistryReferenceId);
+			listenerCount++;
+		}
+	}
+
+	// Invoke the pushed listeners.
+	for (int index = 1; index <= listenerCount; index++)
+	{
+		if (InvokeEventListener(luaStatePointer, luaStackCount + index, eventName, luaEventTableStackIndex))
+		{
+			wasHandled = true;
+		}
+	}
+	lua_settop(luaStatePointer, luaStackCount);
+	return listenerCount;
+}
+
+bool LuaEventDispatcher::InvokeEventListener(
+	lua_State* luaStatePointer, int luaListenerStackIndex, const char* eventName, int luaEventTableStackIndex)
+{
+	// Call the listener in protected mode via Corona's error handler.
+	// Note: A listener raising an error does not push a return value, so the stack is restored to its original size.
+	const int luaStackCount = lua_gettop(luaStatePointer);
+	bool wasCalled = false;
+	if (lua_isfunction(luaStatePointer, luaListenerStackIndex))
+	{
+		// Call the listener function.
+		lua_pushvalue(luaStatePointer, luaListenerStackIndex);
+		lua_pushvalue(luaStatePointer, luaEventTableStackIndex);
+		CoronaLuaDoCall(luaStatePointer, 1, 1);
+		wasCalled = true;
+	}
+	else if (lua_istable(luaStatePointer, luaListenerStackIndex))
+	{
+		// Call the table listener's method having the same name as the event.
+		lua_getfield(luaStatePointer, luaListenerStackIndex, eventName);
+		if (lua_isfunction(luaStatePointer, -1))
+		{
+			lua_pushvalue(luaStatePointer, luaListenerStackIndex);
+			lua_pushvalue(luaStatePointer, luaEventTableStackIndex);
+			CoronaLuaDoCall(luaStatePointer, 2, 1);
+			wasCalled = true;
+		}
+	}
+	bool wasHandled = wasCalled && (lua_gettop(luaStatePointer) > luaStackCount) && lua_toboolean(luaStatePointer, -1);
+	lua_settop(luaStatePointer, luaStackCount);
+	return wasHandled;
+}
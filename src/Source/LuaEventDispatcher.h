@@ -9,6 +9,10 @@
 
 #pragma once
 
+#include "LuaEventFilter.h"
+#include <string>
+#include <vector>
+
 
 // Forward declarations.
 extern "C"
@@ -18,8 +22,13 @@ extern "C"
 
 
 /**
-  Creates a Lua "EventDispatcher" object and provides easy access to its addEventListener(), removeEventListener(),
-  and dispatchEvent() Lua functions via this object's methods in C++.
+  Native registry of Lua event listeners, keyed by event name, which dispatches events the same way that a
+  Corona Lua "EventDispatcher" object created via system.newEventDispatcher() would.
+
+  Listeners are stored as Lua registry references and are invoked directly from C++, which avoids calling into
+  the Lua EventDispatcher's dispatchEvent() function and its listener table traversal for every event.
+  Function listeners are called with the event table. Table listeners have their method matching the event's
+  name called with the table itself and the event table, like a Lua EventDispatcher does.
  */
 class LuaEventDispatcher
 {
@@ -29,138 +38,262 @@ class LuaEventDispatcher
 
 	public:
 		/**
-		  Creates a new Lua "EventDispatcher" object via a call to Corona's system.newEventDispatcher() Lua function.
-		  @param luaStatePointer Pointer to the Lua state to create the EventDispatcher object on.
+		  Creates a new dispatcher having no listeners.
+		  @param luaStatePointer Pointer to the Lua state that listeners will be added to and invoked on.
+		                         If it belongs to a coroutine, then the coroutine's main Lua state is used instead.
 		 */
 		LuaEventDispatcher(lua_State* luaStatePointer);
 
-		/** Removes this instance's reference to the Lua "EventDispatcher" object. */
+		/** Releases this instance's Lua registry references to all of its listeners. */
 		virtual ~LuaEventDispatcher();
 
 
 		/**
-		  Gets a pointer to the Lua state that the Lua "EventDispatcher" object was created in.
-		  @return Returns a pointer to the Lua state that the Lua "EventDispatcher" object was created in.
-		  
+		  Gets a pointer to the Lua state that this dispatcher's listeners are stored in.
+		  @return Returns a pointer to the Lua state that this dispatcher's listeners are stored in.
+
 		          Returns null if the constructor was given a null pointer.
 		 */
 		lua_State* GetLuaState() const;
 
 		/**
-		  Calls the Lua EventDispatcher object's addEventListener() Lua function with the given arguments.
+		  Adds a Lua listener which is invoked for all events having the given name.
 		  @param luaStatePointer Pointer to the Lua state that the "luaListenerStackIndex" argument references.
-		                         Must be the same Lua state that the EventDispatcher Lua object was created in
+		                         Must be the same Lua state given to this object's constructor
 		                         or an associated coroutine's Lua state.
 		  @param eventName Name of the event to add a listener for.
 		  @param luaListenerStackIndex Index to the Lua function or table that to be registered as a listener.
-		  @return Returns true if the listener was successfully added to the event dispatcher.
+		  @return Returns true if the listener was successfully added to this dispatcher.
 
-		          Returns false if given invalid arguments or if this object's constructor was unable to create
-		          an event dispatcher in Lua.
+		          Returns false if given invalid arguments or if the listener was already added for the given event.
 		 */
 		bool AddEventListener(lua_State* luaStatePointer, const char* eventName, int luaListenerStackIndex);
 
 		/**
-		  Calls the Lua EventDispatcher object's removeEventListener() Lua function with the given arguments.
+		  Adds a Lua listener which is only invoked for events matching the given filter.
+
+		  Filtered listeners are only invoked by the DispatchEventWithoutResult() method taking event fields,
+		  which checks their filters natively. Events dispatched without event fields never match them.
+		  If the given filter is empty, then this behaves exactly like the AddEventListener() method without a filter.
 		  @param luaStatePointer Pointer to the Lua state that the "luaListenerStackIndex" argument references.
-		                         Must be the same Lua state that the EventDispatcher Lua object was created in
+		                         Must be the same Lua state given to this object's constructor
+		                         or an associated coroutine's Lua state.
+		  @param eventName Name of the event to add a listener for.
+		  @param luaListenerStackIndex Index to the Lua function or table that to be registered as a listener.
+		  @param filter Determines which events are delivered to the listener. Copied by this method.
+		  @return Returns true if the listener was successfully added to this dispatcher.
+
+		          Returns false if given invalid arguments or if the listener was already added for the given event.
+		 */
+		bool AddEventListener(
+				lua_State* luaStatePointer, const char* eventName, int luaListenerStackIndex,
+				const LuaEventFilter& filter);
+
+		/**
+		  Removes a Lua listener that was added via the AddEventListener() method.
+		  Can be safely called by a listener while an event is being dispatched to it.
+		  @param luaStatePointer Pointer to the Lua state that the "luaListenerStackIndex" argument references.
+		                         Must be the same Lua state given to this object's constructor
 		                         or an associated coroutine's Lua state.
 		  @param eventName Name of the event to remove a listener from.
 		  @param luaListenerStackIndex Index to the Lua function or table that was registered as a listener.
-		  @return Returns true if the listener was successfully removed from the event dispatcher.
+		  @return Returns true if the listener was successfully removed from this dispatcher.
 
-		          Returns false if given invalid arguments or if this object's constructor was unable to create
-		          an event dispatcher in Lua.
+		          Returns false if given invalid arguments or if the listener was not added for the given event.
 		 */
 		bool RemoveEventListener(lua_State* luaStatePointer, const char* eventName, int luaListenerStackIndex);
 
 		/**
-		  Calls the Lua EventDispatcher object's dispatchEvent() Lua function.
+		  Gets the number of listeners added to this dispatcher via the AddEventListener() method for the given event.
+		  Must only be called on the Lua thread.
+		  @param eventName Name of the event to count listeners for.
+		  @return Returns the number of listeners added for the given event. Returns zero if given null.
+		 */
+		int GetEventListenerCount(const char* eventName) const;
 
-		  Dispatches a simple event table containing only 1 field, the event name.
+		/**
+		  Determines if at least 1 listener wants the given event, taking listener filters into account.
+		  Intended to be called before building an event's Lua table. Must only be called on the Lua thread.
+		  @param eventName Name of the event to check.
+		  @param eventFields The event's fields to be checked against each listener's filter.
+		  @return Returns true if the event has an unfiltered listener or a listener whose filter matches it.
+
+		          Returns false if no listener wants the given event or if given a null event name.
+		 */
+		bool HasEventListenersFor(const char* eventName, const LuaEventFilter::EventFields& eventFields) const;
 
-		  1 Lua return value will be pushed to the top of the Lua stack if successfully called.
-		  It is the caller's responsibilty to pop the return value from the Lua stack.
+		/**
+		  Dispatches a simple event table containing only 1 field, the event name, to all unfiltered listeners.
+
+		  1 Lua return value will be pushed to the top of the Lua stack if successfully called, which is true
+		  if at least 1 listener returned true. It is the caller's responsibilty to pop the return value from the Lua stack.
 		  @param luaStatePointer The Lua state to dispatch the event on.
-		                         Must be the same Lua state that the EventDispatcher Lua object was created in
+		                         Must be the same Lua state given to this object's constructor
 		                         or an associated coroutine's Lua state.
 		  @param eventName The unique name of the event to be dispatched to Lua.
-		  @return Returns true if the Lua dispatchEvent() function was successfully invoked and 1 Lua return value
-		          was pushed to the top of the stack. It is the caller's responsibility to pop this return value
-		          from the Lua stack.
+		  @return Returns true if the event was dispatched and 1 Lua return value was pushed to the top of the stack.
+		          It is the caller's responsibility to pop this return value from the Lua stack.
 
-		          Returns false if given invalid arguments or if this object's constructor was unable to create
-		          an event dispatcher in Lua. A Lua return value will not be pushed onto the stack in this case.
+		          Returns false if given invalid arguments. A Lua return value will not be pushed onto the stack
+		          in this case.
 		 */
 		bool DispatchEventWithResult(lua_State* luaStatePointer, const char* eventName);
 
 		/**
-		  Calls the Lua EventDispatcher object's dispatchEvent() Lua function.
+		  Dispatches the given Lua event table to all unfiltered listeners of the event named by its "name" field.
 
-		  Dispatches the given Lua event table, which is not popped from the stack after calling this function.
+		  The given event table is not popped from the stack after calling this function.
 		  This allows Lua listeners to provide feedback to the caller by assigning values to the event table's fields.
-		
-		  1 Lua return value will be pushed to the top of the Lua stack if successfully called.
-		  It is the caller's responsibilty to pop the return value from the Lua stack.
+
+		  1 Lua return value will be pushed to the top of the Lua stack if successfully called, which is true
+		  if at least 1 listener returned true. It is the caller's responsibilty to pop the return value from the Lua stack.
 		  @param luaStatePointer The Lua state to dispatch the event on.
-		                         Must be the same Lua state that the EventDispatcher Lua object was created in
+		                         Must be the same Lua state given to this object's constructor
 		                         or an associated coroutine's Lua state.
 		  @param luaEventTableStackIndex Index to the Lua event table to be dispatched.
-		  @return Returns true if the Lua dispatchEvent() function was successfully invoked and 1 Lua return value
-		          was pushed to the top of the stack. It is the caller's responsibility to pop this return value
-		          from the Lua stack.
+		  @return Returns true if the event was dispatched and 1 Lua return value was pushed to the top of the stack.
+		          It is the caller's responsibility to pop this return value from the Lua stack.
 
-		          Returns false if given invalid arguments or if this object's constructor was unable to create
-		          an event dispatcher in Lua. A Lua return value will not be pushed onto the stack in this case.
+		          Returns false if given invalid arguments. A Lua return value will not be pushed onto the stack
+		          in this case.
 		 */
 		bool DispatchEventWithResult(lua_State* luaStatePointer, int luaEventTableStackIndex);
 
 		/**
-		  Calls the Lua EventDispatcher object's dispatchEvent() Lua function.
-
-		  Dispatches a simple event table containing only 1 field, the event name.
+		  Dispatches a simple event table containing only 1 field, the event name, to all unfiltered listeners.
 
 		  A Lua listener's return value is ignored and is not pushed to the top of the Lua stack.
 		  @param luaStatePointer The Lua state to dispatch the event on.
-		                         Must be the same Lua state that the EventDispatcher Lua object was created in
+		                         Must be the same Lua state given to this object's constructor
 		                         or an associated coroutine's Lua state.
 		  @param eventName The unique name of the event to be dispatched to Lua.
-		  @return Returns true if the Lua dispatchEvent() function was successfully invoked.
+		  @return Returns true if the event was dispatched.
 
-		          Returns false if given invalid arguments or if this object's constructor was unable to create
-		          an event dispatcher in Lua.
+		          Returns false if given invalid arguments.
 		 */
 		bool DispatchEventWithoutResult(lua_State* luaStatePointer, const char* eventName);
 
 		/**
-		  Calls the Lua EventDispatcher object's dispatchEvent() Lua function.
+		  Dispatches the given Lua event table to all unfiltered listeners of the event named by its "name" field.
 
-		  Dispatches the given Lua event table, which is not popped from the stack after calling this function.
+		  The given event table is not popped from the stack after calling this function.
 		  This allows Lua listeners to provide feedback to the caller by assigning values to the event table's fields.
-		
+
 		  A Lua listener's return value is ignored and is not pushed to the top of the Lua stack.
 		  @param luaStatePointer The Lua state to dispatch the event on.
-		                         Must be the same Lua state that the EventDispatcher Lua object was created in
+		                         Must be the same Lua state given to this object's constructor
 		                         or an associated coroutine's Lua state.
 		  @param luaEventTableStackIndex Index to the Lua event table to be dispatched.
-		  @return Returns true if the Lua dispatchEvent() function was successfully invoked.
+		  @return Returns true if the event was dispatched.
 
-		          Returns false if given invalid arguments or if this object's constructor was unable to create
-		          an event dispatcher in Lua.
+		          Returns false if given invalid arguments.
 		 */
 		bool DispatchEventWithoutResult(lua_State* luaStatePointer, int luaEventTableStackIndex);
 
+		/**
+		  Dispatches the given Lua event table to all unfiltered listeners and to all filtered listeners
+		  whose filter matches the given event fields, in the order that they were added.
+
+		  The given event table is not popped from the stack and a listener's return value is ignored.
+		  @param luaStatePointer The Lua state to dispatch the event on.
+		                         Must be the same Lua state given to this object's constructor
+		                         or an associated coroutine's Lua state.
+		  @param luaEventTableStackIndex Index to the Lua event table to be dispatched.
+		  @param eventName Name of the event to be dispatched. Must match the event table's "name" field.
+		  @param eventFields The event's fields to be checked against each listener's filter.
+		  @return Returns true if the event was dispatched to at least 1 listener.
+
+		          Returns false if given invalid arguments or if no listener wants the given event.
+		 */
+		bool DispatchEventWithoutResult(
+				lua_State* luaStatePointer, int luaEventTableStackIndex, const char* eventName,
+				const LuaEventFilter::EventFields& eventFields);
+
+		/**
+		  Invokes 1 Lua listener with the given event table, the same way that a Lua EventDispatcher would.
+		  Calls the listener if it is a function. Calls the listener's method matching the event name if it is a table.
+		  @param luaStatePointer The Lua state that the given stack indexes reference.
+		  @param luaListenerStackIndex Absolute index to the Lua function or table to invoke.
+		                              Does not need to have been added to this dispatcher.
+		  @param eventName Name of the event being dispatched.
+		  @param luaEventTableStackIndex Absolute index to the Lua event table to pass to the listener.
+		  @return Returns true if the listener was invoked and returned true.
+
+		          Returns false if the listener returned a false value, raised an error, or could not be invoked.
+		 */
+		bool InvokeEventListener(
+				lua_State* luaStatePointer, int luaListenerStackIndex, const char* eventName,
+				int luaEventTableStackIndex);
+
 	private:
+		/** Identifies 1 Lua listener added via the AddEventListener() method. */
+		struct ListenerReference
+		{
+			/** Unique ID to the Lua listener stored in the Lua registry. */
+			int LuaRegistryReferenceId;
+
+			/** Determines which events are delivered to the listener. Matches all events if empty. */
+			LuaEventFilter Filter;
+		};
+
+		/** Listeners added for 1 event name, in the order that they were added. */
+		struct EventListenerCollection
+		{
+			/** Name of the event the listeners were added for. */
+			std::string EventName;
+
+			/** References to the event's listeners. */
+			std::vector<ListenerReference> ListenerReferences;
+		};
+
+
 		/** Copy operator made private to prevent it from being called. */
 		void operator=(const LuaEventDispatcher&) {}
 
+		/**
+		  Finds the listener collection for the given event name in the "fEventListenerCollections".
+		  @param eventName Name of the event to search for.
+		  @return Returns a pointer to the event's listener collection. Returns null if not found or if given null.
+		 */
+		LuaEventDispatcher::EventListenerCollection* GetEventListenerCollectionFor(const char* eventName);
+		const LuaEventDispatcher::EventListenerCollection* GetEventListenerCollectionFor(const char* eventName) const;
+
+		/**
+		  Finds the given listener in the given event's listener collection.
+		  @param luaStatePointer Pointer to the Lua state that the "luaListenerStackIndex" argument references.
+		  @param collection The event's listener collection to search.
+		  @param luaListenerStackIndex Absolute index to the Lua function or table to search for.
+		  @return Returns the index of the listener's entry in the collection. Returns -1 if not found.
+		 */
+		int IndexOfEventListener(
+				lua_State* luaStatePointer, const LuaEventDispatcher::EventListenerCollection& collection,
+				int luaListenerStackIndex) const;
+
+		/**
+		  Invokes all listeners of the given event whose filters match the given event fields.
+		  The listeners are pushed to the Lua stack before any of them are invoked, which allows listeners
+		  to safely add or remove listeners while being invoked.
+		  @param luaStatePointer The Lua state to dispatch the event on.
+		  @param luaEventTableStackIndex Absolute index to the Lua event table to pass to the listeners.
+		  @param eventName Name of the event being dispatched.
+		  @param eventFields The event's fields to be checked against each listener's filter.
+		  @param wasHandled Set true if at least 1 invoked listener returned true. Left unchanged otherwise.
+		  @return Returns the number of listeners that were invoked.
+
+		          Returns zero if the Lua stack could not grow enough to invoke the listeners, which is logged.
+		 */
+		int InvokeEventListenersFor(
+				lua_State* luaStatePointer, int luaEventTableStackIndex, const char* eventName,
+				const LuaEventFilter::EventFields& eventFields, bool& wasHandled);
+
 
-		/** The Lua state that the Lua EventDispatcher object was created */
+		/** The Lua state that the listeners' registry references are stored in. */
 		lua_State* fLuaStatePointer;
 
 		/**
-		  Unique ID to the Lua EventDispatcher object stored in the Lua registry.
-		  Set to LUA_NOREF if no longer stored under the registry.
+		  All added listeners, grouped by event name.
+		  Note: There are only a handful of event names, which is why a vector is linearly searched.
+		        Collections are not removed once empty since the same events tend to be listened to again.
 		 */
-		int fLuaRegistryReferenceId;
+		std::vector<EventListenerCollection> fEventListenerCollections;
 };
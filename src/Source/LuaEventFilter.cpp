@@ -0,0 +1,59 @@
+// ----------------------------------------------------------------------------
+// 
+// LuaEventFilter.cpp
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#include "LuaEventFilter.h"
+
+
+LuaEventFilter::LuaEventFilter()
+:	fHasUserIntegerId(false),
+	fUserIntegerId(0),
+	fHasAchievementName(false)
+{
+}
+
+bool LuaEventFilter::IsEmpty() const
+{
+	return !fHasUserIntegerId && !fHasAchievementName;
+}
+
+bool LuaEventFilter::IsMatch(const LuaEventFilter::EventFields& eventFields) const
+{
+	if (fHasUserIntegerId && (eventFields.UserIntegerId != fUserIntegerId))
+	{
+		return false;
+	}
+	if (fHasAchievementName)
+	{
+		if (!eventFields.AchievementName || (fAchievementName != eventFields.AchievementName))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void LuaEventFilter::SetUserIntegerId(uint64_t value)
+{
+	fUserIntegerId = value;
+	fHasUserIntegerId = true;
+}
+
+void LuaEventFilter::SetAchievementName(const char* name)
+{
+	if (name)
+	{
+		fAchievementName = name;
+		fHasAchievementName = true;
+	}
+	else
+	{
+		fAchievementName.clear();
+		fHasAchievementName = false;
+	}
+}
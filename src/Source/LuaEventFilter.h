@@ -0,0 +1,74 @@
+// ----------------------------------------------------------------------------
+// 
+// LuaEventFilter.h
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+
+/**
+  Native predicate attached to a Lua event listener, which determines if an event should be delivered to it.
+
+  Created from the optional filter table passed to the plugin's Lua addEventListener() function.
+  Filters are checked against an event task's native fields before its Lua event table is built,
+  which avoids creating event tables and calling into Lua for events that no listener wants.
+
+  An empty filter, which is the default, matches all events. Otherwise, an event must match every field
+  that was set on the filter. An event which does not provide a filtered field never matches.
+ */
+class LuaEventFilter
+{
+	public:
+		/** Fields of 1 event to be checked against a filter via the IsMatch() method. */
+		struct EventFields
+		{
+			/** Integer form of the Steam user ID the event belongs to. Set to zero if not applicable. */
+			uint64_t UserIntegerId;
+
+			/** Unique name of the achievement the event belongs to. Set to null if not applicable. */
+			const char* AchievementName;
+		};
+
+		/** Creates an empty filter which matches all events. */
+		LuaEventFilter();
+
+		/**
+		  Determines if this filter has no fields set.
+		  @return Returns true if this filter matches all events. Returns false if at least 1 field has been set.
+		 */
+		bool IsEmpty() const;
+
+		/**
+		  Determines if the given event should be delivered to the listener this filter belongs to.
+		  @param eventFields The event's fields to be checked against this filter.
+		  @return Returns true if the given event matches all of this filter's fields or if this filter is empty.
+
+		          Returns false if the given event does not match or does not provide a filtered field.
+		 */
+		bool IsMatch(const LuaEventFilter::EventFields& eventFields) const;
+
+		/**
+		  Only matches events belonging to the given Steam user.
+		  @param value Integer form of the Steam user ID to match.
+		 */
+		void SetUserIntegerId(uint64_t value);
+
+		/**
+		  Only matches events belonging to the given achievement.
+		  @param name The achievement's unique name. Clears this filter field if set to null.
+		 */
+		void SetAchievementName(const char* name);
+
+	private:
+		bool fHasUserIntegerId;
+		uint64_t fUserIntegerId;
+		bool fHasAchievementName;
+		std::string fAchievementName;
+};
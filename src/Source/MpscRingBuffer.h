@@ -0,0 +1,228 @@
+// ----------------------------------------------------------------------------
+// 
+// MpscRingBuffer.h
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+
+template<class TItem>
+/**
+  Bounded lock-free multi-producer/single-consumer FIFO queue.
+
+  Any number of threads may push items into this queue via the TryPush() method at the same time.
+  Only 1 thread, such as the Lua thread that owns a RuntimeContext, may pop items via the TryPop() method.
+
+  The queue's capacity is fixed on construction and is rounded up to the next power of 2.
+  Pushing into a full queue will fail instead of blocking or allocating more memory.
+
+  Each slot in the ring stores a sequence number which is used to hand off ownership of the slot between
+  producers and the consumer without a lock. This is based on Dmitry Vyukov's bounded MPMC queue algorithm,
+  simplified for a single consumer.
+ */
+class MpscRingBuffer
+{
+	public:
+		/**
+		  Creates a new empty queue.
+		  @param capacity The maximum number of items this queue can store at the same time.
+		                  Will be rounded up to the next power of 2. Values less than 2 are treated as 2.
+		 */
+		explicit MpscRingBuffer(size_t capacity)
+		:	fEnqueuePosition(0),
+			fDequeuePosition(0)
+		{
+			// Round up the given capacity to the next power of 2.
+			// This allows us to wrap positions via a bitwise AND instead of a modulo.
+			size_t powerOfTwoCapacity = 2;
+			while (powerOfTwoCapacity < capacity)
+			{
+				powerOfTwoCapacity <<= 1;
+			}
+			fIndexMask = powerOfTwoCapacity - 1;
+
+			// Allocate all of the ring's slots up front.
+			// Each slot's sequence number is initialized to its index, flagging it as writable by a producer.
+			fSlots.resize(powerOfTwoCapacity);
+			for (size_t index = 0; index < powerOfTwoCapacity; index++)
+			{
+				fSlots[index].Sequence.store(index, std::memory_order_relaxed);
+			}
+		}
+
+		/** Destroys this queue and all items remaining in it. */
+		virtual ~MpscRingBuffer()
+		{
+		}
+
+		/**
+		  Gets the maximum number of items this queue can store at the same time.
+		  @return Returns the capacity given to the constructor, rounded up to the next power of 2.
+		 */
+		size_t GetCapacity() const
+		{
+			return fIndexMask + 1;
+		}
+
+		/**
+		  Gets the number of items currently in the queue.
+
+		  The returned value is only a snapshot since producers on other threads may be pushing items
+		  while this method is being called. It is exact when called by the consumer thread while
+		  no other threads are pushing items.
+		  @return Returns the number of items currently stored in the queue.
+		 */
+		size_t GetCount() const
+		{
+			size_t dequeuePosition = fDequeuePosition.load(std::memory_order_acquire);
+			size_t enqueuePosition = fEnqueuePosition.load(std::memory_order_acquire);
+			return (enqueuePosition >= dequeuePosition) ? (enqueuePosition - dequeuePosition) : 0;
+		}
+
+		/**
+		  Determines if the queue currently has no items. Same snapshot semantics as GetCount().
+		  @return Returns true if the queue is empty. Returns false if it contains at least 1 item.
+		 */
+		bool IsEmpty() const
+		{
+			return (GetCount() == 0);
+		}
+
+		/**
+		  Pushes the given item to the back of the queue.
+
+		  This method is thread safe and can be called by multiple producer threads at the same time.
+		  @param item The item to be moved into the queue. Left unchanged if this method fails.
+		  @return Returns true if the item was pushed into the queue.
+
+		          Returns false if the queue is full.
+		 */
+		bool TryPush(TItem&& item)
+		{
+			// Claim the next writable slot by incrementing the enqueue position.
+			Slot* slotPointer = nullptr;
+			size_t position = fEnqueuePosition.load(std::memory_order_relaxed);
+			for (;;)
+			{
+				slotPointer = &fSlots[position & fIndexMask];
+				size_t sequence = slotPointer->Sequence.load(std::memory_order_acquire);
+				intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+				if (0 == difference)
+				{
+					// The slot is writable. Attempt to claim it.
+					// Note: On failure, the "position" variable will be updated to the latest enqueue position.
+					if (fEnqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+					{
+						break;
+					}
+				}
+				else if (difference < 0)
+				{
+					// The slot still holds an item that the consumer has not popped yet. The queue is full.
+					return false;
+				}
+				else
+				{
+					// Another producer has claimed this slot. Try again with the latest position.
+					position = fEnqueuePosition.load(std::memory_order_relaxed);
+				}
+			}
+
+			// Store the item and then publish the slot to the consumer.
+			slotPointer->Item = std::move(item);
+			slotPointer->Sequence.store(position + 1, std::memory_order_release);
+			return true;
+		}
+
+		/**
+		  Pushes a copy of the given item to the back of the queue.
+
+		  This method is thread safe and can be called by multiple producer threads at the same time.
+		  @param item The item to be copied into the queue.
+		  @return Returns true if the item was pushed into the queue.
+
+		          Returns false if the queue is full.
+		 */
+		bool TryPush(const TItem& item)
+		{
+			TItem itemCopy(item);
+			return TryPush(std::move(itemCopy));
+		}
+
+		/**
+		  Pops the item at the front of the queue.
+
+		  Must only be called by the single consumer thread.
+		  @param item Reference to receive the popped item. Left unchanged if this method fails.
+		  @return Returns true if an item was popped and moved into the given argument.
+
+		          Returns false if the queue is empty or if the next item is still being written by a producer.
+		 */
+		bool TryPop(TItem& item)
+		{
+			// Determine if the slot at the front of the queue has been published by a producer.
+			size_t position = fDequeuePosition.load(std::memory_order_relaxed);
+			Slot& slot = fSlots[position & fIndexMask];
+			size_t sequence = slot.Sequence.load(std::memory_order_acquire);
+			if ((intptr_t)sequence - (intptr_t)(position + 1) < 0)
+			{
+				return false;
+			}
+
+			// Move the item out of the slot and hand the slot back to the producers for the next lap around the ring.
+			// Note: We reset the slot's item so that we don't hold on to its resources until it gets overwritten.
+			item = std::move(slot.Item);
+			slot.Item = TItem();
+			slot.Sequence.store(position + fIndexMask + 1, std::memory_order_release);
+			fDequeuePosition.store(position + 1, std::memory_order_release);
+			return true;
+		}
+
+	private:
+		/** Copy constructor deleted to prevent it from being called. */
+		MpscRingBuffer(const MpscRingBuffer<TItem>&) = delete;
+
+		/** Copy operator deleted to prevent it from being called. */
+		void operator=(const MpscRingBuffer<TItem>&) = delete;
+
+		/** Stores 1 item in the ring and the sequence number used to synchronize access to it. */
+		struct Slot
+		{
+			Slot() : Sequence(0) {}
+			Slot(const Slot&) : Sequence(0) {}
+			std::atomic<size_t> Sequence;
+			TItem Item;
+		};
+
+		/** Size of a CPU cache line. Used to keep the producer and consumer positions from false sharing. */
+		static const size_t kCacheLineSize = 64;
+
+
+		/** Fixed size array of slots, sized to a power of 2. */
+		std::vector<Slot> fSlots;
+
+		/** Bit mask used to convert an ever increasing queue position to an index within "fSlots". */
+		size_t fIndexMask;
+
+		/** Padding used to keep the enqueue position on a separate cache line from the members above. */
+		char fPadding1[kCacheLineSize];
+
+		/** Position that the next pushed item will be written to. Shared by all producer threads. */
+		std::atomic<size_t> fEnqueuePosition;
+
+		/** Padding used to keep the enqueue and dequeue positions on separate cache lines. */
+		char fPadding2[kCacheLineSize];
+
+		/** Position of the next item to be popped. Only written to by the consumer thread. */
+		std::atomic<size_t> fDequeuePosition;
+};
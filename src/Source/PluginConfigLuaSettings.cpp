@@ -13,7 +13,78 @@
 #include <string>
 
 
+/** Default max number of idle CCallResult handlers to keep around once the handler pool gets trimmed. */
+static const uint32_t kDefaultIdleRequestHandlerLimit = 8;
+
+/** Default number of frames without a new request before the CCallResult handler pool gets trimmed. */
+static const uint32_t kDefaultRequestHandlerTrimDelayInFrames = 600;
+
+/** Default max number of global Steam events of each type to buffer while the app is suspended. */
+static const uint32_t kDefaultSuspendedEventCapacity = 32;
+
+
+/**
+  Fetches a non-negative integer field from the Lua table at the top of the stack.
+  @param luaStatePointer Pointer to the Lua state whose top of the stack is the table to read from.
+  @param fieldName The name of the table field to read.
+  @param value Reference to receive the field's value. Left unchanged if the field is not a number.
+               Negative numbers are clamped to zero.
+ */
+static void CopyUInt32FieldTo(lua_State* luaStatePointer, const char* fieldName, uint32_t& value)
+{
+	lua_getfield(luaStatePointer, -1, fieldName);
+	if (lua_type(luaStatePointer, -1) == LUA_TNUMBER)
+	{
+		auto numberValue = lua_tonumber(luaStatePointer, -1);
+		value = (numberValue > 0) ? (uint32_t)numberValue : 0;
+	}
+	lua_pop(luaStatePointer, 1);
+}
+
+/**
+  Fetches all non-negative integer fields from the Lua table at the top of the stack.
+  @param luaStatePointer Pointer to the Lua state whose top of the stack is the table to read from.
+  @param valueMap Receives the table's string keyed number values. Negative numbers are clamped to zero.
+ */
+static void CopyUInt32TableTo(lua_State* luaStatePointer, std::unordered_map<std::string, uint32_t>& valueMap)
+{
+	for (lua_pushnil(luaStatePointer); lua_next(luaStatePointer, -2); lua_pop(luaStatePointer, 1))
+	{
+		if ((lua_type(luaStatePointer, -2) == LUA_TSTRING) && (lua_type(luaStatePointer, -1) == LUA_TNUMBER))
+		{
+			auto numberValue = lua_tonumber(luaStatePointer, -1);
+			valueMap[std::string(lua_tostring(luaStatePointer, -2))] = (numberValue > 0) ? (uint32_t)numberValue : 0;
+		}
+	}
+}
+
+/**
+  Fetches all non-negative integer fields from a Lua table field of the table at the top of the stack,
+  such as a table of per-category settings keyed by category name.
+  @param luaStatePointer Pointer to the Lua state whose top of the stack is the table to read from.
+  @param fieldName The name of the table field to read. Ignored if not a table.
+  @param valueMap Receives the table's string keyed number values. Negative numbers are clamped to zero.
+ */
+static void CopyUInt32TableFieldTo(
+	lua_State* luaStatePointer, const char* fieldName, std::unordered_map<std::string, uint32_t>& valueMap)
+{
+	lua_getfield(luaStatePointer, -1, fieldName);
+	if (lua_istable(luaStatePointer, -1))
+	{
+		CopyUInt32TableTo(luaStatePointer, valueMap);
+	}
+	lua_pop(luaStatePointer, 1);
+}
+
+
 PluginConfigLuaSettings::PluginConfigLuaSettings()
+:	fDispatchTimeBudgetInMicroseconds(0),
+	fMaxPendingRequestCount(0),
+	fIdleRequestHandlerLimit(kDefaultIdleRequestHandlerLimit),
+	fRequestHandlerTrimDelayInFrames(kDefaultRequestHandlerTrimDelayInFrames),
+	fCallbackPumpFrequencyInHertz(0),
+	fSuspendedEventCapacity(kDefaultSuspendedEventCapacity),
+	fIsAsyncInitEnabled(false)
 {
 }
 
@@ -38,9 +109,147 @@ void PluginConfigLuaSettings::SetStringAppId(const char* stringId)
 	}
 }
 
+uint32_t PluginConfigLuaSettings::GetDispatchTimeBudgetInMicroseconds() const
+{
+	return fDispatchTimeBudgetInMicroseconds;
+}
+
+void PluginConfigLuaSettings::SetDispatchTimeBudgetInMicroseconds(uint32_t value)
+{
+	fDispatchTimeBudgetInMicroseconds = value;
+}
+
+uint32_t PluginConfigLuaSettings::GetMaxPendingRequestCount() const
+{
+	return fMaxPendingRequestCount;
+}
+
+void PluginConfigLuaSettings::SetMaxPendingRequestCount(uint32_t value)
+{
+	fMaxPendingRequestCount = value;
+}
+
+uint32_t PluginConfigLuaSettings::GetIdleRequestHandlerLimit() const
+{
+	return fIdleRequestHandlerLimit;
+}
+
+void PluginConfigLuaSettings::SetIdleRequestHandlerLimit(uint32_t value)
+{
+	fIdleRequestHandlerLimit = value;
+}
+
+uint32_t PluginConfigLuaSettings::GetRequestHandlerTrimDelayInFrames() const
+{
+	return fRequestHandlerTrimDelayInFrames;
+}
+
+void PluginConfigLuaSettings::SetRequestHandlerTrimDelayInFrames(uint32_t value)
+{
+	fRequestHandlerTrimDelayInFrames = value;
+}
+
+uint32_t PluginConfigLuaSettings::GetCallbackPumpFrequencyInHertz() const
+{
+	return fCallbackPumpFrequencyInHertz;
+}
+
+void PluginConfigLuaSettings::SetCallbackPumpFrequencyInHertz(uint32_t value)
+{
+	fCallbackPumpFrequencyInHertz = value;
+}
+
+uint32_t PluginConfigLuaSettings::GetSuspendedEventCapacity() const
+{
+	return fSuspendedEventCapacity;
+}
+
+void PluginConfigLuaSettings::SetSuspendedEventCapacity(uint32_t value)
+{
+	fSuspendedEventCapacity = value;
+}
+
+const char* PluginConfigLuaSettings::GetSuspendedEventOverflowPolicyName() const
+{
+	return fSuspendedEventOverflowPolicyName.c_str();
+}
+
+void PluginConfigLuaSettings::SetSuspendedEventOverflowPolicyName(const char* name)
+{
+	if (name)
+	{
+		fSuspendedEventOverflowPolicyName = name;
+	}
+	else
+	{
+		fSuspendedEventOverflowPolicyName.clear();
+	}
+}
+
+bool PluginConfigLuaSettings::IsAsyncInitEnabled() const
+{
+	return fIsAsyncInitEnabled;
+}
+
+void PluginConfigLuaSettings::SetAsyncInitEnabled(bool value)
+{
+	fIsAsyncInitEnabled = value;
+}
+
+const std::unordered_map<std::string, uint32_t>& PluginConfigLuaSettings::GetRequestConcurrencyLimits() const
+{
+	return fRequestConcurrencyLimits;
+}
+
+void PluginConfigLuaSettings::SetRequestConcurrencyLimit(const char* categoryName, uint32_t value)
+{
+	if (categoryName)
+	{
+		fRequestConcurrencyLimits[std::string(categoryName)] = value;
+	}
+}
+
+const std::unordered_map<std::string, uint32_t>& PluginConfigLuaSettings::GetRequestWeights() const
+{
+	return fRequestWeights;
+}
+
+void PluginConfigLuaSettings::SetRequestWeight(const char* categoryName, uint32_t value)
+{
+	if (categoryName)
+	{
+		fRequestWeights[std::string(categoryName)] = value;
+	}
+}
+
+const std::unordered_map<std::string, std::unordered_map<std::string, uint32_t>>&
+PluginConfigLuaSettings::GetRequestRetrySettings() const
+{
+	return fRequestRetrySettings;
+}
+
+void PluginConfigLuaSettings::SetRequestRetrySetting(const char* categoryName, const char* settingName, uint32_t value)
+{
+	if (categoryName && settingName)
+	{
+		fRequestRetrySettings[std::string(categoryName)][std::string(settingName)] = value;
+	}
+}
+
 void PluginConfigLuaSettings::Reset()
 {
 	fStringAppId.clear();
+	fDispatchTimeBudgetInMicroseconds = 0;
+	fMaxPendingRequestCount = 0;
+	fIdleRequestHandlerLimit = kDefaultIdleRequestHandlerLimit;
+	fRequestHandlerTrimDelayInFrames = kDefaultRequestHandlerTrimDelayInFrames;
+	fCallbackPumpFrequencyInHertz = 0;
+	fSuspendedEventCapacity = kDefaultSuspendedEventCapacity;
+	fSuspendedEventOverflowPolicyName.clear();
+	fIsAsyncInitEnabled = false;
+	fRequestConcurrencyLimits.clear();
+	fRequestWeights.clear();
+	fRequestRetrySettings.clear();
 }
 
 bool PluginConfigLuaSettings::LoadFrom(lua_State* luaStatePointer)
@@ -123,6 +332,65 @@ bool PluginConfigLuaSettings::LoadFrom(lua_State* luaStatePointer)
 				}
 				lua_pop(luaStatePointer, 1);
 
+				// Fetch the max number of microseconds per frame the plugin may spend dispatching events to Lua.
+				// A value of zero (the default) means unlimited.
+				CopyUInt32FieldTo(luaStatePointer, "dispatchTimeBudget", fDispatchTimeBudgetInMicroseconds);
+
+				// Fetch the max number of async Steam requests that can be waiting for a result at the same time.
+				// A value of zero (the default) means unlimited.
+				CopyUInt32FieldTo(luaStatePointer, "maxPendingRequests", fMaxPendingRequestCount);
+
+				// Fetch how many idle request handlers to keep and how many frames without a new request
+				// must elapse before the rest are deleted.
+				CopyUInt32FieldTo(luaStatePointer, "idleRequestHandlerLimit", fIdleRequestHandlerLimit);
+				CopyUInt32FieldTo(luaStatePointer, "requestHandlerTrimDelay", fRequestHandlerTrimDelayInFrames);
+
+				// Fetch the number of times per second to poll Steam for events on a dedicated thread.
+				// A value of zero (the default) means Steam is polled on the Lua thread every "enterFrame" instead.
+				CopyUInt32FieldTo(luaStatePointer, "callbackPumpFrequency", fCallbackPumpFrequencyInHertz);
+
+				// Fetch how many global events of each type to buffer while the app is suspended
+				// and which events to drop once a buffer is full.
+				CopyUInt32FieldTo(luaStatePointer, "suspendedEventCapacity", fSuspendedEventCapacity);
+				lua_getfield(luaStatePointer, -1, "suspendedEventOverflowPolicy");
+				if (lua_type(luaStatePointer, -1) == LUA_TSTRING)
+				{
+					auto stringValue = lua_tostring(luaStatePointer, -1);
+					if (stringValue)
+					{
+						fSuspendedEventOverflowPolicyName = stringValue;
+					}
+				}
+				lua_pop(luaStatePointer, 1);
+
+				// Fetch whether SteamAPI_Init() should be called on another thread instead of blocking startup.
+				lua_getfield(luaStatePointer, -1, "asyncInit");
+				if (lua_type(luaStatePointer, -1) == LUA_TBOOLEAN)
+				{
+					fIsAsyncInitEnabled = lua_toboolean(luaStatePointer, -1) ? true : false;
+				}
+				lua_pop(luaStatePointer, 1);
+
+				// Fetch the per-category request concurrency limits and weighted fair queuing weights.
+				// These are tables keyed by request category name, such as "leaderboardDownload".
+				CopyUInt32TableFieldTo(luaStatePointer, "requestConcurrency", fRequestConcurrencyLimits);
+				CopyUInt32TableFieldTo(luaStatePointer, "requestWeights", fRequestWeights);
+
+				// Fetch the per-category retry policies, which are tables of settings keyed by category name.
+				lua_getfield(luaStatePointer, -1, "requestRetry");
+				if (lua_istable(luaStatePointer, -1))
+				{
+					for (lua_pushnil(luaStatePointer); lua_next(luaStatePointer, -2); lua_pop(luaStatePointer, 1))
+					{
+						if ((lua_type(luaStatePointer, -2) == LUA_TSTRING) && lua_istable(luaStatePointer, -1))
+						{
+							auto categoryName = lua_tostring(luaStatePointer, -2);
+							CopyUInt32TableTo(luaStatePointer, fRequestRetrySettings[std::string(categoryName)]);
+						}
+					}
+				}
+				lua_pop(luaStatePointer, 1);
+
 				// *** In the future, other "config.lua" plugin settings can be loaded here. ***
 			}
 			lua_pop(luaStatePointer, 1);
@@ -9,7 +9,9 @@
 
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include <unordered_map>
 extern "C"
 {
 #	include "lua.h"
@@ -30,9 +32,42 @@ class PluginConfigLuaSettings
 
 		const char* GetStringAppId() const;
 		void SetStringAppId(const char* stringId);
+		uint32_t GetDispatchTimeBudgetInMicroseconds() const;
+		void SetDispatchTimeBudgetInMicroseconds(uint32_t value);
+		uint32_t GetMaxPendingRequestCount() const;
+		void SetMaxPendingRequestCount(uint32_t value);
+		uint32_t GetIdleRequestHandlerLimit() const;
+		void SetIdleRequestHandlerLimit(uint32_t value);
+		uint32_t GetRequestHandlerTrimDelayInFrames() const;
+		void SetRequestHandlerTrimDelayInFrames(uint32_t value);
+		uint32_t GetCallbackPumpFrequencyInHertz() const;
+		void SetCallbackPumpFrequencyInHertz(uint32_t value);
+		uint32_t GetSuspendedEventCapacity() const;
+		void SetSuspendedEventCapacity(uint32_t value);
+		const char* GetSuspendedEventOverflowPolicyName() const;
+		void SetSuspendedEventOverflowPolicyName(const char* name);
+		bool IsAsyncInitEnabled() const;
+		void SetAsyncInitEnabled(bool value);
+		const std::unordered_map<std::string, uint32_t>& GetRequestConcurrencyLimits() const;
+		void SetRequestConcurrencyLimit(const char* categoryName, uint32_t value);
+		const std::unordered_map<std::string, uint32_t>& GetRequestWeights() const;
+		void SetRequestWeight(const char* categoryName, uint32_t value);
+		const std::unordered_map<std::string, std::unordered_map<std::string, uint32_t>>& GetRequestRetrySettings() const;
+		void SetRequestRetrySetting(const char* categoryName, const char* settingName, uint32_t value);
 		void Reset();
 		bool LoadFrom(lua_State* luaStatePointer);
 
 	private:
 		std::string fStringAppId;
+		uint32_t fDispatchTimeBudgetInMicroseconds;
+		uint32_t fMaxPendingRequestCount;
+		uint32_t fIdleRequestHandlerLimit;
+		uint32_t fRequestHandlerTrimDelayInFrames;
+		uint32_t fCallbackPumpFrequencyInHertz;
+		uint32_t fSuspendedEventCapacity;
+		std::string fSuspendedEventOverflowPolicyName;
+		bool fIsAsyncInitEnabled;
+		std::unordered_map<std::string, uint32_t> fRequestConcurrencyLimits;
+		std::unordered_map<std::string, uint32_t> fRequestWeights;
+		std::unordered_map<std::string, std::unordered_map<std::string, uint32_t>> fRequestRetrySettings;
 };
@@ -10,184 +10,2168 @@
 #include "RuntimeContext.h"
 #include "CoronaLua.h"
 #include "DispatchEventTask.h"
+#include "SteamApiInitializer.h"
 #include "SteamCallResultHandler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <exception>
 #include <memory>
-#include <unordered_set>
+#include <unordered_map>
 extern "C"
 {
 #	include "lua.h"
+#	include "lauxlib.h"
 }
 
 
-/** Stores a collection of all RuntimeContext instances that currently exist in the application. */
-static std::unordered_set<RuntimeContext*> sRuntimeContextCollection;
+/**
+  Maximum number of tasks that can be waiting in a RuntimeContext's lock-free dispatch queue at the same time.
+  Request results pushed into a full queue go to a mutex guarded overflow queue instead, while global events
+  are dropped. Either should only happen if the Lua thread has stalled.
+ */
+static const size_t kDispatchEventTaskQueueCapacity = 1024;
+
+/** Default max number of global Steam events of each type to buffer while the Corona runtime is suspended. */
+static const uint32_t kDefaultSuspendedEventCapacity = 32;
+
+/**
+  Stores a collection of all RuntimeContext instances that currently exist in the application,
+  keyed by the main Lua state of the Corona runtime they belong to.
+  Only modified while holding the SteamCallbackPump's mutex since the SteamGlobalEventRelay iterates it.
+ */
+static std::unordered_map<lua_State*, RuntimeContext*> sRuntimeContextCollection;
+
+
+/**
+  Process-wide listener for Steam's global events, such as "GameOverlayActivated_t".
+
+  Steam's STEAM_CALLBACK handlers are global. Registering them per RuntimeContext would make Steam invoke
+  N handlers per event when N Corona runtimes exist. Instead, this class registers them once and forwards
+  each received event to every RuntimeContext instance in the "sRuntimeContextCollection".
+
+  Only 1 instance exists while at least 1 RuntimeContext exists. It is created and destroyed by the
+  RuntimeContext class while holding the SteamCallbackPump's mutex, which Steam's handlers are invoked under.
+ */
+class SteamGlobalEventRelay
+{
+	public:
+		SteamGlobalEventRelay() {}
+
+	private:
+		template<class TSteamResultType>
+		/**
+		  Forwards the given Steam event to the given handler method of every RuntimeContext instance.
+		  @param eventDataPointer Pointer to the Steam event data received. Can be null.
+		  @param handlerMethodPointer The RuntimeContext method to invoke with the given event data.
+		 */
+		void ForwardToAll(
+			TSteamResultType* eventDataPointer, void(RuntimeContext::*handlerMethodPointer)(TSteamResultType*))
+		{
+			for (auto&& pair : sRuntimeContextCollection)
+			{
+				(pair.second->*handlerMethodPointer)(eventDataPointer);
+			}
+		}
+
+		/** Set up global Steam event handlers via their macros. */
+		STEAM_CALLBACK(SteamGlobalEventRelay, OnSteamGameOverlayActivated, GameOverlayActivated_t);
+		STEAM_CALLBACK(
+				SteamGlobalEventRelay, OnSteamMicrotransactionAuthorizationReceived, MicroTxnAuthorizationResponse_t);
+		STEAM_CALLBACK(SteamGlobalEventRelay, OnSteamUserAchievementStored, UserAchievementStored_t);
+		STEAM_CALLBACK(SteamGlobalEventRelay, OnSteamUserStatsReceived, UserStatsReceived_t);
+		STEAM_CALLBACK(SteamGlobalEventRelay, OnSteamUserStatsStored, UserStatsStored_t);
+		STEAM_CALLBACK(SteamGlobalEventRelay, OnSteamUserStatsUnloaded, UserStatsUnloaded_t);
+		STEAM_CALLBACK(SteamGlobalEventRelay, OnSteamServersConnected, SteamServersConnected_t);
+		STEAM_CALLBACK(SteamGlobalEventRelay, OnSteamServersDisconnected, SteamServersDisconnected_t);
+};
+
+void SteamGlobalEventRelay::OnSteamGameOverlayActivated(GameOverlayActivated_t* eventDataPointer)
+{
+	ForwardToAll(eventDataPointer, &RuntimeContext::OnSteamGameOverlayActivated);
+}
+
+void SteamGlobalEventRelay::OnSteamMicrotransactionAuthorizationReceived(
+	MicroTxnAuthorizationResponse_t* eventDataPointer)
+{
+	ForwardToAll(eventDataPointer, &RuntimeContext::OnSteamMicrotransactionAuthorizationReceived);
+}
+
+void SteamGlobalEventRelay::OnSteamUserAchievementStored(UserAchievementStored_t* eventDataPointer)
+{
+	ForwardToAll(eventDataPointer, &RuntimeContext::OnSteamUserAchievementStored);
+}
+
+void SteamGlobalEventRelay::OnSteamUserStatsReceived(UserStatsReceived_t* eventDataPointer)
+{
+	ForwardToAll(eventDataPointer, &RuntimeContext::OnSteamUserStatsReceived);
+}
+
+void SteamGlobalEventRelay::OnSteamUserStatsStored(UserStatsStored_t* eventDataPointer)
+{
+	ForwardToAll(eventDataPointer, &RuntimeContext::OnSteamUserStatsStored);
+}
+
+void SteamGlobalEventRelay::OnSteamUserStatsUnloaded(UserStatsUnloaded_t* eventDataPointer)
+{
+	ForwardToAll(eventDataPointer, &RuntimeContext::OnSteamUserStatsUnloaded);
+}
+
+void SteamGlobalEventRelay::OnSteamServersConnected(SteamServersConnected_t* eventDataPointer)
+{
+	ForwardToAll(eventDataPointer, &RuntimeContext::OnSteamServersConnected);
+}
+
+void SteamGlobalEventRelay::OnSteamServersDisconnected(SteamServersDisconnected_t* eventDataPointer)
+{
+	ForwardToAll(eventDataPointer, &RuntimeContext::OnSteamServersDisconnected);
+}
+
+
+/** The one and only global Steam event listener. Null if no RuntimeContext instances exist. */
+static std::unique_ptr<SteamGlobalEventRelay> sGlobalEventRelayPointer;
 
 
 RuntimeContext::RuntimeContext(lua_State* luaStatePointer)
 :	fLuaEnterFrameCallback(this, &RuntimeContext::OnCoronaEnterFrame, luaStatePointer),
-	fWasRenderRequested(false)
+	fLuaSystemEventCallback(this, &RuntimeContext::OnCoronaSystemEvent, luaStatePointer),
+	fDispatchEventTaskQueue(kDispatchEventTaskQueueCapacity),
+	fOverflowDispatchEventTaskCount(0),
+	fIsSuspended(false),
+	fSuspendedEventCapacity(kDefaultSuspendedEventCapacity),
+	fSuspendedEventOverflowPolicy(EventOverflowPolicy::kDropOldest),
+	fTotalDroppedSuspendedEventCount(0),
+	fLuaBatchListenerCount(0),
+	fTotalUnobservedEventCount(0),
+	fWasRenderRequested(false),
+	fDispatchTimeBudgetInMicroseconds(0),
+	fLastCarriedOverEventCount(0),
+	fTotalCarriedOverEventCount(0),
+	fTotalCoalescedEventCount(0),
+	fRejectedRequestCount(0),
+	fTimedPendingRequestCount(0),
+	fLastRequestId(0),
+	fTotalTimedOutRequestCount(0),
+	fLastObservedPollCount(0),
+	fTotalSingleFlightRequestCount(0),
+	fConnectionState(SteamConnectionState::kConnected),
+	fStartupDurationInMicroseconds(0),
+	fLastRequestPromiseAggregateId(0)
 {
 	// Validate.
 	if (!luaStatePointer)
 	{
-		throw std::exception();
+		throw std::exception();
+	}
+
+	// If the given Lua state belongs to a coroutine, then use the main Lua state instead.
+	{
+		auto mainLuaStatePointer = CoronaLuaGetCoronaThread(luaStatePointer);
+		if (mainLuaStatePointer && (mainLuaStatePointer != luaStatePointer))
+		{
+			luaStatePointer = mainLuaStatePointer;
+		}
+	}
+
+	// Create the native registry of Lua listeners.
+	// Used to dispatch global events to listeners
+	fLuaEventDispatcherPointer = std::make_shared<LuaEventDispatcher>(luaStatePointer);
+
+	// Reserve enough memory up front for each priority lane to hold a full queue's worth of pending tasks.
+	for (auto&& taskCollection : fPendingDispatchEventTaskLanes)
+	{
+		taskCollection.reserve(kDispatchEventTaskQueueCapacity);
+	}
+
+	// Add Corona runtime event listeners.
+	fLuaEnterFrameCallback.AddToRuntimeEventListeners("enterFrame");
+	fLuaSystemEventCallback.AddToRuntimeEventListeners("system");
+
+	// Add this class instance to the global collection and start listening to Steam's global events
+	// if this is the first instance. Blocks the SteamCallbackPump's thread, if running, while doing so.
+	{
+		std::lock_guard<std::recursive_mutex> scopedLock(SteamCallbackPump::GetMutex());
+		sRuntimeContextCollection[luaStatePointer] = this;
+		if (!sGlobalEventRelayPointer)
+		{
+			sGlobalEventRelayPointer.reset(new SteamGlobalEventRelay());
+		}
+	}
+}
+
+RuntimeContext::~RuntimeContext()
+{
+	// Remove our Corona runtime event listeners.
+	fLuaEnterFrameCallback.RemoveFromRuntimeEventListeners("enterFrame");
+	fLuaSystemEventCallback.RemoveFromRuntimeEventListeners("system");
+
+	// Release our Lua batch listener, request promise, and promise aggregate references.
+	{
+		auto luaStatePointer = GetMainLuaState();
+		if (luaStatePointer)
+		{
+			for (auto&& batchListener : fLuaBatchListenerCollection)
+			{
+				luaL_unref(luaStatePointer, LUA_REGISTRYINDEX, batchListener.LuaReferenceId);
+			}
+			while (!fRequestPromiseCollection.empty())
+			{
+				RemoveRequestPromise(luaStatePointer, fRequestPromiseCollection.begin()->first);
+			}
+			for (auto&& pair : fRequestPromiseAggregateCollection)
+			{
+				luaL_unref(luaStatePointer, LUA_REGISTRYINDEX, pair.second.LuaListenerReferenceId);
+				luaL_unref(luaStatePointer, LUA_REGISTRYINDEX, pair.second.LuaHandleArrayReferenceId);
+				luaL_unref(luaStatePointer, LUA_REGISTRYINDEX, pair.second.LuaEventArrayReferenceId);
+			}
+		}
+		fLuaBatchListenerCollection.clear();
+		fRequestPromiseCollection.clear();
+		fRequestPromiseAggregateCollection.clear();
+	}
+
+	// Unregister all of our CCallResult handlers from Steam and remove this class instance from the global
+	// collection so that Steam's global events are no longer forwarded to it.
+	// Stop listening to Steam's global events altogether if this was the last instance.
+	{
+		std::lock_guard<std::recursive_mutex> scopedLock(SteamCallbackPump::GetMutex());
+		fSteamCallResultHandlerPool.Clear();
+		fPendingRequestCollection.clear();
+		fInFlightRequestCollection.clear();
+		fRequestReplayQueue.Clear();
+		fRequestScheduler.Clear();
+		fLastStateEventTaskCollection.clear();
+		fTimedPendingRequestCount = 0;
+		auto iterator = sRuntimeContextCollection.find(GetMainLuaState());
+		if ((iterator != sRuntimeContextCollection.end()) && (iterator->second == this))
+		{
+			sRuntimeContextCollection.erase(iterator);
+		}
+		if (sRuntimeContextCollection.empty())
+		{
+			sGlobalEventRelayPointer = nullptr;
+		}
+	}
+}
+
+lua_State* RuntimeContext::GetMainLuaState() const
+{
+	if (fLuaEventDispatcherPointer)
+	{
+		return fLuaEventDispatcherPointer->GetLuaState();
+	}
+	return nullptr;
+}
+
+std::shared_ptr<LuaEventDispatcher> RuntimeContext::GetLuaEventDispatcher() const
+{
+	return fLuaEventDispatcherPointer;
+}
+
+bool RuntimeContext::AddLuaEventListener(
+	lua_State* luaStatePointer, const char* eventName, int luaListenerStackIndex, const LuaEventFilter& filter,
+	bool shouldReplayLastEvent)
+{
+	if (!fLuaEventDispatcherPointer)
+	{
+		return false;
+	}
+	bool wasAdded = fLuaEventDispatcherPointer->AddEventListener(
+			luaStatePointer, eventName, luaListenerStackIndex, filter);
+	if (wasAdded)
+	{
+		UpdateLuaEventListenerCountFor(eventName);
+		if (shouldReplayLastEvent)
+		{
+			ReplayLastStateEventsTo(luaStatePointer, eventName, luaListenerStackIndex, filter);
+		}
+	}
+	return wasAdded;
+}
+
+bool RuntimeContext::RemoveLuaEventListener(
+	lua_State* luaStatePointer, const char* eventName, int luaListenerStackIndex)
+{
+	if (!fLuaEventDispatcherPointer)
+	{
+		return false;
+	}
+	bool wasRemoved = fLuaEventDispatcherPointer->RemoveEventListener(luaStatePointer, eventName, luaListenerStackIndex);
+	if (wasRemoved)
+	{
+		UpdateLuaEventListenerCountFor(eventName);
+	}
+	return wasRemoved;
+}
+
+uint64_t RuntimeContext::GetTotalUnobservedEventCount() const
+{
+	return fTotalUnobservedEventCount;
+}
+
+bool RuntimeContext::AddLuaBatchListener(
+	lua_State* luaStatePointer, int luaListenerStackIndex, const LuaEventFilter& filter)
+{
+	// Validate.
+	if (!luaStatePointer || !lua_isfunction(luaStatePointer, luaListenerStackIndex))
+	{
+		return false;
+	}
+
+	// Do not add the same function twice. This matches the behavior of Corona's addEventListener() function.
+	if (IndexOfLuaBatchListener(luaStatePointer, luaListenerStackIndex) >= 0)
+	{
+		return false;
+	}
+
+	// Store a reference to the function in the Lua registry to prevent it from being garbage collected.
+	lua_pushvalue(luaStatePointer, luaListenerStackIndex);
+	LuaBatchListener batchListener;
+	batchListener.LuaReferenceId = luaL_ref(luaStatePointer, LUA_REGISTRYINDEX);
+	batchListener.Filter = filter;
+	batchListener.EventCount = 0;
+	fLuaBatchListenerCollection.push_back(batchListener);
+	{
+		std::lock_guard<std::recursive_mutex> scopedLock(SteamCallbackPump::GetMutex());
+		fLuaBatchListenerCount = fLuaBatchListenerCollection.size();
+	}
+	return true;
+}
+
+bool RuntimeContext::RemoveLuaBatchListener(lua_State* luaStatePointer, int luaListenerStackIndex)
+{
+	// Validate.
+	if (!luaStatePointer || !lua_isfunction(luaStatePointer, luaListenerStackIndex))
+	{
+		return false;
+	}
+
+	// Find the given function's registry reference and release it.
+	int index = IndexOfLuaBatchListener(luaStatePointer, luaListenerStackIndex);
+	if (index < 0)
+	{
+		return false;
+	}
+	luaL_unref(luaStatePointer, LUA_REGISTRYINDEX, fLuaBatchListenerCollection[index].LuaReferenceId);
+	fLuaBatchListenerCollection.erase(fLuaBatchListenerCollection.begin() + index);
+	{
+		std::lock_guard<std::recursive_mutex> scopedLock(SteamCallbackPump::GetMutex());
+		fLuaBatchListenerCount = fLuaBatchListenerCollection.size();
+	}
+	return true;
+}
+
+SteamLeaderboardEntries_t RuntimeContext::GetCachedLeaderboardHandleByName(const char* name) const
+{
+	if (name)
+	{
+		std::lock_guard<std::recursive_mutex> scopedLock(SteamCallbackPump::GetMutex());
+		auto iterator = fLeaderboardNameHandleMap.find(std::string(name));
+		if (iterator != fLeaderboardNameHandleMap.end())
+		{
+			return iterator->second;
+		}
+	}
+	return 0;
+}
+
+bool RuntimeContext::QueueDispatchEventTask(DispatchEventTaskPointer&& taskPointer)
+{
+	// Validate.
+	if (!taskPointer)
+	{
+		return false;
+	}
+
+	// Only coalescable global events can be dropped, since a newer event having the same key describes the same state.
+	// Request results and one-shot events, such as purchase authorizations, must always reach Lua.
+	BaseDispatchEventTask::CoalescingKey coalescingKey;
+	const bool canDrop = (0 == taskPointer->GetRequestId()) && taskPointer->CopyCoalescingKeyTo(coalescingKey);
+
+	// Push the given task to the lock-free queue. Safe to do from any thread.
+	// Note: If the queue is full, then the task is left in the given smart pointer.
+	//       Undroppable tasks skip the queue while older ones are waiting in the overflow queue to keep their order.
+	if (canDrop || (0 == fOverflowDispatchEventTaskCount.load(std::memory_order_acquire)))
+	{
+		if (fDispatchEventTaskQueue.TryPush(std::move(taskPointer)))
+		{
+			return true;
+		}
+	}
+
+	// The queue is full. Never drop an undroppable task, since its listeners, awaiting coroutine, and promise
+	// would otherwise never receive it. Store it in the unbounded overflow queue instead.
+	if (!canDrop)
+	{
+		std::lock_guard<std::mutex> scopedLock(fOverflowDispatchEventTaskMutex);
+		fOverflowDispatchEventTasks.push_back(std::move(taskPointer));
+		fOverflowDispatchEventTaskCount.store(fOverflowDispatchEventTasks.size(), std::memory_order_release);
+		return true;
+	}
+
+	// Drop the coalescable event, since a newer one will describe the same state.
+	CoronaLog("WARNING: [Steam] Event queue is full. Dropping '%s' event.", taskPointer->GetLuaEventName());
+	DiscardDispatchEventTask(std::move(taskPointer));
+	return false;
+}
+
+void RuntimeContext::MoveQueuedDispatchEventTasksToPendingLanes()
+{
+	// Move the tasks in the lock-free queue first.
+	DispatchEventTaskPointer dispatchEventTaskPointer;
+	while (fDispatchEventTaskQueue.TryPop(dispatchEventTaskPointer))
+	{
+		AddPendingDispatchEventTask(std::move(dispatchEventTaskPointer));
+	}
+
+	// Move the undroppable tasks that did not fit in the above queue, if any.
+	if (fOverflowDispatchEventTaskCount.load(std::memory_order_acquire) > 0)
+	{
+		std::lock_guard<std::mutex> scopedLock(fOverflowDispatchEventTaskMutex);
+		for (auto&& taskPointer : fOverflowDispatchEventTasks)
+		{
+			AddPendingDispatchEventTask(std::move(taskPointer));
+		}
+		fOverflowDispatchEventTasks.clear();
+		fOverflowDispatchEventTaskCount.store(0, std::memory_order_release);
+	}
+}
+
+uint32_t RuntimeContext::GetDispatchTimeBudgetInMicroseconds() const
+{
+	return fDispatchTimeBudgetInMicroseconds;
+}
+
+void RuntimeContext::SetDispatchTimeBudgetInMicroseconds(uint32_t value)
+{
+	fDispatchTimeBudgetInMicroseconds = value;
+}
+
+uint32_t RuntimeContext::GetLastCarriedOverEventCount() const
+{
+	return fLastCarriedOverEventCount;
+}
+
+uint64_t RuntimeContext::GetTotalCarriedOverEventCount() const
+{
+	return fTotalCarriedOverEventCount;
+}
+
+uint64_t RuntimeContext::GetTotalCoalescedEventCount() const
+{
+	return fTotalCoalescedEventCount;
+}
+
+SteamCallResultHandlerPool& RuntimeContext::GetSteamCallResultHandlerPool()
+{
+	return fSteamCallResultHandlerPool;
+}
+
+uint32_t RuntimeContext::GetSuspendedEventCapacity()
+{
+	std::lock_guard<std::mutex> scopedLock(fSuspendedEventBufferMutex);
+	return fSuspendedEventCapacity;
+}
+
+void RuntimeContext::SetSuspendedEventCapacity(uint32_t value)
+{
+	std::lock_guard<std::mutex> scopedLock(fSuspendedEventBufferMutex);
+	fSuspendedEventCapacity = (value > 0) ? value : 1;
+}
+
+EventOverflowPolicy RuntimeContext::GetSuspendedEventOverflowPolicy()
+{
+	std::lock_guard<std::mutex> scopedLock(fSuspendedEventBufferMutex);
+	return fSuspendedEventOverflowPolicy;
+}
+
+void RuntimeContext::SetSuspendedEventOverflowPolicy(const EventOverflowPolicy& policy)
+{
+	if (policy != EventOverflowPolicy::kUnknown)
+	{
+		std::lock_guard<std::mutex> scopedLock(fSuspendedEventBufferMutex);
+		fSuspendedEventOverflowPolicy = policy;
+	}
+}
+
+uint64_t RuntimeContext::GetTotalDroppedSuspendedEventCount()
+{
+	std::lock_guard<std::mutex> scopedLock(fSuspendedEventBufferMutex);
+	return fTotalDroppedSuspendedEventCount;
+}
+
+uint64_t RuntimeContext::GetRejectedRequestCount() const
+{
+	return fRejectedRequestCount;
+}
+
+uint64_t RuntimeContext::GetTotalTimedOutRequestCount() const
+{
+	return fTotalTimedOutRequestCount;
+}
+
+bool RuntimeContext::CancelRequest(uint64_t requestId)
+{
+	std::lock_guard<std::recursive_mutex> scopedLock(SteamCallbackPump::GetMutex());
+
+	// Do not continue if the request was already canceled and is only kept for the requests attached to its call.
+	if (IsCanceledLeaderRequest(requestId))
+	{
+		return false;
+	}
+
+	// If the request is parked, then remove it before it gets sent to Steam and release its task.
+	// Unless it's waiting to retry a Steam call that other requests are attached to, which is kept for them.
+	auto parkedRequestPointer = fRequestReplayQueue.FindParkedRequest(requestId);
+	if (parkedRequestPointer)
+	{
+		if (CancelUnsentLeaderRequest(requestId))
+		{
+			return true;
+		}
+		DiscardDispatchEventTask(std::move(parkedRequestPointer->TaskPointer));
+		fRequestReplayQueue.RemoveParkedRequest(requestId);
+		return true;
+	}
+
+	// If the request is queued behind its category's concurrency limit, then remove it and release its task.
+	auto queuedRequestPointer = fRequestScheduler.FindQueuedRequest(requestId);
+	if (queuedRequestPointer)
+	{
+		if (CancelUnsentLeaderRequest(requestId))
+		{
+			return true;
+		}
+		DiscardDispatchEventTask(std::move(queuedRequestPointer->TaskPointer));
+		fRequestScheduler.RemoveQueuedRequest(requestId);
+		return true;
+	}
+
+	// If the request is attached to another request's Steam call, then detach it and release its task.
+	for (auto&& inFlightRequest : fInFlightRequestCollection)
+	{
+		auto& followerCollection = inFlightRequest.FollowerCollection;
+		for (auto iterator = followerCollection.begin(); iterator != followerCollection.end(); ++iterator)
+		{
+			if (iterator->RequestId == requestId)
+			{
+				DiscardDispatchEventTask(std::move(iterator->TaskPointer));
+				followerCollection.erase(iterator);
+				ReleaseCanceledLeaderRequestIfUnused(inFlightRequest.LeaderRequestId);
+				return true;
+			}
+		}
+	}
+
+	// If other requests are attached to this request's Steam call, then keep the call alive for them.
+	// Its pending entry is kept too, so that the call still times out and still counts against its category's
+	// concurrency limit. Only this request's own event will be skipped once the result has been received.
+	auto inFlightRequestPointer = FindInFlightRequestLedBy(requestId);
+	if (inFlightRequestPointer && !inFlightRequestPointer->FollowerCollection.empty())
+	{
+		inFlightRequestPointer->WasLeaderCanceled = true;
+		return true;
+	}
+
+	// Fetch the request's CCallResult handler, if still pending.
+	auto handlerPointer = RemovePendingRequest(requestId);
+	if (!handlerPointer)
+	{
+		return false;
+	}
+	if (inFlightRequestPointer)
+	{
+		InFlightRequest inFlightRequest;
+		TakeInFlightRequest(requestId, inFlightRequest);
+	}
+
+	// Unregister the handler's CCallResult and return it to the pool.
+	// Note: This destroys the handler's callback without invoking it, which releases its task and Lua listener.
+	fRequestReplayQueue.RemoveRetryableRequest(requestId);
+	handlerPointer->Abort();
+	return true;
+}
+
+bool RuntimeContext::IsRequestPending(uint64_t requestId)
+{
+	std::lock_guard<std::recursive_mutex> scopedLock(SteamCallbackPump::GetMutex());
+	if (IsCanceledLeaderRequest(requestId))
+	{
+		return false;
+	}
+	for (auto&& request : fPendingRequestCollection)
+	{
+		if (request.RequestId == requestId)
+		{
+			return true;
+		}
+	}
+	if (fRequestReplayQueue.FindParkedRequest(requestId) || fRequestScheduler.FindQueuedRequest(requestId))
+	{
+		return true;
+	}
+	for (auto&& inFlightRequest : fInFlightRequestCollection)
+	{
+		for (auto&& followerRequest : inFlightRequest.FollowerCollection)
+		{
+			if (followerRequest.RequestId == requestId)
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+RuntimeContext::RequestCategoryStatistics RuntimeContext::GetRequestCategoryStatisticsFor(
+	const SteamRequestCategory& category) const
+{
+	if (category.GetIndex() >= SteamRequestCategory::kCount)
+	{
+		return RequestCategoryStatistics{};
+	}
+	std::lock_guard<std::recursive_mutex> scopedLock(SteamCallbackPump::GetMutex());
+	RequestCategoryStatistics statistics{};
+	static_cast<SteamRequestScheduler::CategoryStatistics&>(statistics) =
+			fRequestScheduler.GetStatisticsFor(category.GetIndex());
+	statistics.TotalRetryCount = fRequestReplayQueue.GetTotalRetryCountFor(category.GetIndex());
+	statistics.TotalRetryBudgetExhaustedCount =
+			fRequestReplayQueue.GetTotalRetryBudgetExhaustedCountFor(category.GetIndex());
+	return statistics;
+}
+
+void RuntimeContext::SetRequestConcurrencyLimitFor(const SteamRequestCategory& category, uint32_t value)
+{
+	if (category.GetIndex() >= SteamRequestCategory::kCount)
+	{
+		return;
+	}
+	std::lock_guard<std::recursive_mutex> scopedLock(SteamCallbackPump::GetMutex());
+	fRequestScheduler.SetConcurrencyLimitFor(category.GetIndex(), value);
+}
+
+void RuntimeContext::SetRequestWeightFor(const SteamRequestCategory& category, uint32_t value)
+{
+	if (category.GetIndex() >= SteamRequestCategory::kCount)
+	{
+		return;
+	}
+	std::lock_guard<std::recursive_mutex> scopedLock(SteamCallbackPump::GetMutex());
+	fRequestScheduler.SetWeightFor(category.GetIndex(), value);
+}
+
+RuntimeContext::RequestRetryPolicy RuntimeContext::GetRequestRetryPolicyFor(const SteamRequestCategory& category) const
+{
+	std::lock_guard<std::recursive_mutex> scopedLock(SteamCallbackPump::GetMutex());
+	return fRequestReplayQueue.GetRetryPolicyFor(category.GetIndex());
+}
+
+void RuntimeContext::SetRequestRetryPolicyFor(
+	const SteamRequestCategory& category, const RuntimeContext::RequestRetryPolicy& policy)
+{
+	if (category.GetIndex() >= SteamRequestCategory::kCount)
+	{
+		return;
+	}
+	std::lock_guard<std::recursive_mutex> scopedLock(SteamCallbackPump::GetMutex());
+	fRequestReplayQueue.SetRetryPolicyFor(category.GetIndex(), policy);
+}
+
+uint64_t RuntimeContext::GetTotalSingleFlightRequestCount() const
+{
+	return fTotalSingleFlightRequestCount;
+}
+
+SteamConnectionState RuntimeContext::GetConnectionState() const
+{
+	std::lock_guard<std::recursive_mutex> scopedLock(SteamCallbackPump::GetMutex());
+	return fConnectionState;
+}
+
+void RuntimeContext::WaitForSteamInitialization()
+{
+	std::lock_guard<std::recursive_mutex> scopedLock(SteamCallbackPump::GetMutex());
+	if (SteamApiInitializer::IsInitializing())
+	{
+		SetConnectionState(SteamConnectionState::kInitializing);
+	}
+}
+
+uint64_t RuntimeContext::GetStartupDurationInMicroseconds() const
+{
+	return fStartupDurationInMicroseconds;
+}
+
+void RuntimeContext::SetStartupDurationInMicroseconds(uint64_t value)
+{
+	fStartupDurationInMicroseconds = value;
+}
+
+uint32_t RuntimeContext::GetParkedRequestCount() const
+{
+	std::lock_guard<std::recursive_mutex> scopedLock(SteamCallbackPump::GetMutex());
+	return fRequestReplayQueue.GetParkedRequestCount();
+}
+
+uint64_t RuntimeContext::GetTotalParkedRequestCount() const
+{
+	std::lock_guard<std::recursive_mutex> scopedLock(SteamCallbackPump::GetMutex());
+	return fRequestReplayQueue.GetTotalParkedRequestCount();
+}
+
+bool RuntimeContext::AddRequestPromise(uint64_t requestId)
+{
+	// Validate.
+	if (!requestId)
+	{
+		return false;
+	}
+
+	// Create an unsettled promise for the given request, if not done already.
+	RequestPromise promise;
+	promise.IsSettled = false;
+	promise.IsError = false;
+	promise.LuaEventReferenceId = LUA_NOREF;
+	return fRequestPromiseCollection.emplace(requestId, std::move(promise)).second;
+}
+
+void RuntimeContext::RemoveRequestPromise(lua_State* luaStatePointer, uint64_t requestId)
+{
+	// Fetch the given request's promise.
+	auto iterator = fRequestPromiseCollection.find(requestId);
+	if (iterator == fRequestPromiseCollection.end())
+	{
+		return;
+	}
+
+	// Release the promise's event table and the callbacks that were never called.
+	if (luaStatePointer)
+	{
+		auto& promise = iterator->second;
+		luaL_unref(luaStatePointer, LUA_REGISTRYINDEX, promise.LuaEventReferenceId);
+		for (auto&& referenceId : promise.LuaCallbackReferenceIds)
+		{
+			luaL_unref(luaStatePointer, LUA_REGISTRYINDEX, referenceId);
+		}
+	}
+	fRequestPromiseCollection.erase(iterator);
+}
+
+void RuntimeContext::MoveRequestPromise(lua_State* luaStatePointer, uint64_t fromRequestId, uint64_t toRequestId)
+{
+	// Do not continue if the IDs match. Nothing to move.
+	if (fromRequestId == toRequestId)
+	{
+		return;
+	}
+
+	// Remove the destination request's own promise, which nothing is expected to observe.
+	RemoveRequestPromise(luaStatePointer, toRequestId);
+
+	// Re-key the source request's promise, if it has one.
+	// Note: Aggregates reference the promise by their own ID and index, so they do not need to be updated.
+	auto iterator = fRequestPromiseCollection.find(fromRequestId);
+	if (iterator != fRequestPromiseCollection.end())
+	{
+		RequestPromise promise = std::move(iterator->second);
+		fRequestPromiseCollection.erase(iterator);
+		fRequestPromiseCollection.emplace(toRequestId, std::move(promise));
+	}
+}
+
+bool RuntimeContext::AddRequestPromiseCallback(
+	lua_State* luaStatePointer, uint64_t requestId, int luaCallbackStackIndex)
+{
+	// Validate.
+	if (!luaStatePointer || !lua_isfunction(luaStatePointer, luaCallbackStackIndex))
+	{
+		return false;
+	}
+
+	// Fetch the given request's promise.
+	auto iterator = fRequestPromiseCollection.find(requestId);
+	if (iterator == fRequestPromiseCollection.end())
+	{
+		return false;
+	}
+
+	// If the promise has already settled, then call the given function with its event table now.
+	auto& promise = iterator->second;
+	if (promise.IsSettled)
+	{
+		lua_pushvalue(luaStatePointer, luaCallbackStackIndex);
+		lua_rawgeti(luaStatePointer, LUA_REGISTRYINDEX, promise.LuaEventReferenceId);
+		CoronaLuaDoCall(luaStatePointer, 1, 0);
+		return true;
+	}
+
+	// Otherwise, store a reference to the function to be called once the promise settles.
+	lua_pushvalue(luaStatePointer, luaCallbackStackIndex);
+	promise.LuaCallbackReferenceIds.push_back(luaL_ref(luaStatePointer, LUA_REGISTRYINDEX));
+	return true;
+}
+
+void RuntimeContext::SettleRequestPromise(lua_State* luaStatePointer, uint64_t requestId, int luaEventTableStackIndex)
+{
+	// Validate.
+	if (!luaStatePointer || !lua_istable(luaStatePointer, luaEventTableStackIndex))
+	{
+		return;
+	}
+
+	// Fetch the given request's promise. Do not continue if it does not exist or has already settled.
+	auto iterator = fRequestPromiseCollection.find(requestId);
+	if ((iterator == fRequestPromiseCollection.end()) || iterator->second.IsSettled)
+	{
+		return;
+	}
+
+	// Convert a relative stack index to an absolute one, since we're about to push values to the stack.
+	if (luaEventTableStackIndex < 0)
+	{
+		luaEventTableStackIndex = lua_gettop(luaStatePointer) + (luaEventTableStackIndex + 1);
+	}
+
+	// Store a reference to the event table so that callbacks added later can receive it too.
+	auto& promise = iterator->second;
+	lua_getfield(luaStatePointer, luaEventTableStackIndex, "isError");
+	promise.IsError = lua_toboolean(luaStatePointer, -1) ? true : false;
+	lua_pop(luaStatePointer, 1);
+	lua_pushvalue(luaStatePointer, luaEventTableStackIndex);
+	promise.LuaEventReferenceId = luaL_ref(luaStatePointer, LUA_REGISTRYINDEX);
+	promise.IsSettled = true;
+
+	// Take the callbacks and aggregates waiting on this promise.
+	// Note: Lua code called below can create and remove promises, so the promise must not be accessed afterwards.
+	const bool isError = promise.IsError;
+	std::vector<int> callbackReferenceIds;
+	callbackReferenceIds.swap(promise.LuaCallbackReferenceIds);
+	std::vector<RequestPromiseAggregateMember> aggregateMembers;
+	aggregateMembers.swap(promise.AggregateMembers);
+
+	// Call the waiting Lua functions with the event table, in the order they were added.
+	// Note: CoronaLuaDoCall() catches and logs Lua errors, so a failing callback will not stop the others.
+	for (auto&& referenceId : callbackReferenceIds)
+	{
+		lua_rawgeti(luaStatePointer, LUA_REGISTRYINDEX, referenceId);
+		luaL_unref(luaStatePointer, LUA_REGISTRYINDEX, referenceId);
+		lua_pushvalue(luaStatePointer, luaEventTableStackIndex);
+		CoronaLuaDoCall(luaStatePointer, 1, 0);
+	}
+
+	// Notify the waiting aggregates.
+	for (auto&& member : aggregateMembers)
+	{
+		OnRequestPromiseAggregateMemberSettled(luaStatePointer, member, luaEventTableStackIndex, isError);
+	}
+}
+
+void RuntimeContext::SettleRequestPromiseWithError(
+	lua_State* luaStatePointer, uint64_t requestId, const char* luaEventName)
+{
+	// Validate.
+	if (!luaStatePointer || !luaEventName)
+	{
+		return;
+	}
+
+	// Do not continue if the given request has no promise waiting to be settled.
+	auto iterator = fRequestPromiseCollection.find(requestId);
+	if ((iterator == fRequestPromiseCollection.end()) || iterator->second.IsSettled)
+	{
+		return;
+	}
+	if (!lua_checkstack(luaStatePointer, 3))
+	{
+		CoronaLuaWarning(luaStatePointer, "Failed to settle request for event '%s' due to a Lua stack overflow.", luaEventName);
+		return;
+	}
+
+	// Settle the promise with an error event.
+	CoronaLuaNewEvent(luaStatePointer, luaEventName);
+	lua_pushboolean(luaStatePointer, 1);
+	lua_setfield(luaStatePointer, -2, "isError");
+	SettleRequestPromise(luaStatePointer, requestId, lua_gettop(luaStatePointer));
+	lua_pop(luaStatePointer, 1);
+}
+
+bool RuntimeContext::AddRequestPromiseAggregate(
+	lua_State* luaStatePointer, RuntimeContext::PromiseAggregateType type,
+	const std::vector<uint64_t>& requestIds, int luaHandleArrayStackIndex, int luaListenerStackIndex)
+{
+	// Validate.
+	if (!luaStatePointer || !lua_isfunction(luaStatePointer, luaListenerStackIndex))
+	{
+		return false;
+	}
+	if (requestIds.empty() && (type != PromiseAggregateType::kAll))
+	{
+		return false;
+	}
+	for (auto&& requestId : requestIds)
+	{
+		if (fRequestPromiseCollection.find(requestId) == fRequestPromiseCollection.end())
+		{
+			return false;
+		}
+	}
+
+	// Convert relative stack indexes to absolute ones, since we're about to push values to the stack.
+	if (luaHandleArrayStackIndex < 0)
+	{
+		luaHandleArrayStackIndex = lua_gettop(luaStatePointer) + (luaHandleArrayStackIndex + 1);
+	}
+	if (luaListenerStackIndex < 0)
+	{
+		luaListenerStackIndex = lua_gettop(luaStatePointer) + (luaListenerStackIndex + 1);
+	}
+
+	// Create the aggregate.
+	const uint64_t aggregateId = ++fLastRequestPromiseAggregateId;
+	{
+		RequestPromiseAggregate aggregate;
+		aggregate.Type = type;
+		aggregate.PendingRequestCount = requestIds.size();
+		lua_pushvalue(luaStatePointer, luaListenerStackIndex);
+		aggregate.LuaListenerReferenceId = luaL_ref(luaStatePointer, LUA_REGISTRYINDEX);
+		lua_pushvalue(luaStatePointer, luaHandleArrayStackIndex);
+		aggregate.LuaHandleArrayReferenceId = luaL_ref(luaStatePointer, LUA_REGISTRYINDEX);
+		aggregate.LuaEventArrayReferenceId = LUA_NOREF;
+		if (PromiseAggregateType::kAll == type)
+		{
+			lua_createtable(luaStatePointer, (int)requestIds.size(), 0);
+			aggregate.LuaEventArrayReferenceId = luaL_ref(luaStatePointer, LUA_REGISTRYINDEX);
+		}
+		fRequestPromiseAggregateCollection.emplace(aggregateId, aggregate);
+	}
+
+	// An empty kAll aggregate resolves immediately with an empty array.
+	if (requestIds.empty())
+	{
+		lua_newtable(luaStatePointer);
+		ResolveRequestPromiseAggregate(luaStatePointer, aggregateId, 1);
+		return true;
+	}
+
+	// Wait on all unsettled promises first. Settled promises are accounted for below, which can resolve
+	// the aggregate and call Lua code before all of the requests have been registered otherwise.
+	for (size_t index = 0; index < requestIds.size(); index++)
+	{
+		auto& promise = fRequestPromiseCollection[requestIds[index]];
+		if (!promise.IsSettled)
+		{
+			RequestPromiseAggregateMember member;
+			member.AggregateId = aggregateId;
+			member.Index = (int)index + 1;
+			promise.AggregateMembers.push_back(member);
+		}
+	}
+
+	// Account for the promises that have already settled, in order.
+	// Note: Stops once the aggregate has resolved, such as a kRace aggregate given a settled promise.
+	for (size_t index = 0; index < requestIds.size(); index++)
+	{
+		if (fRequestPromiseAggregateCollection.find(aggregateId) == fRequestPromiseAggregateCollection.end())
+		{
+			break;
+		}
+		auto iterator = fRequestPromiseCollection.find(requestIds[index]);
+		if ((iterator == fRequestPromiseCollection.end()) || !iterator->second.IsSettled)
+		{
+			continue;
+		}
+		RequestPromiseAggregateMember member;
+		member.AggregateId = aggregateId;
+		member.Index = (int)index + 1;
+		const bool isError = iterator->second.IsError;
+		lua_rawgeti(luaStatePointer, LUA_REGISTRYINDEX, iterator->second.LuaEventReferenceId);
+		OnRequestPromiseAggregateMemberSettled(luaStatePointer, member, lua_gettop(luaStatePointer), isError);
+		lua_pop(luaStatePointer, 1);
+	}
+	return true;
+}
+
+bool RuntimeContext::HasRequestPromiseFor(uint64_t requestId) const
+{
+	return (fRequestPromiseCollection.find(requestId) != fRequestPromiseCollection.end());
+}
+
+void RuntimeContext::SetUpRequestListenerFor(
+	BaseDispatchEventTask* taskPointer, lua_State* luaStatePointer, int luaListenerStackIndex)
+{
+	// Validate.
+	if (!taskPointer || !luaStatePointer)
+	{
+		return;
+	}
+
+	// Resume the given coroutine with the Lua event table when the operation completes, if awaited by one.
+	// This avoids creating a Lua event dispatcher per request.
+	if (lua_isthread(luaStatePointer, luaListenerStackIndex))
+	{
+		taskPointer->SetLuaCoroutine(luaStatePointer, luaListenerStackIndex);
+		return;
+	}
+
+	// Do not set up a listener if the result will only be delivered via the request's promise.
+	if (!lua_isfunction(luaStatePointer, luaListenerStackIndex))
+	{
+		return;
+	}
+
+	// Set up a temporary Lua event dispatcher used to call the given Lua function when the operation completes.
+	auto luaEventDispatcherPointer = std::make_shared<LuaEventDispatcher>(luaStatePointer);
+	luaEventDispatcherPointer->AddEventListener(
+			luaStatePointer, taskPointer->GetLuaEventName(), luaListenerStackIndex);
+	taskPointer->SetLuaEventDispatcher(luaEventDispatcherPointer);
+}
+
+RuntimeContext* RuntimeContext::GetInstanceBy(lua_State* luaStatePointer)
+{
+	// Validate.
+	if (!luaStatePointer)
+	{
+		return nullptr;
+	}
+
+	// Look up the runtime context by the given Lua state.
+	// Note: This is the runtime's main Lua state in the common case, which avoids the Corona thread lookup below.
+	auto iterator = sRuntimeContextCollection.find(luaStatePointer);
+	if (iterator != sRuntimeContextCollection.end())
+	{
+		return iterator->second;
+	}
+
+	// If the given Lua state belongs to a coroutine, then look up the runtime context by its main Lua state instead.
+	auto mainLuaStatePointer = CoronaLuaGetCoronaThread(luaStatePointer);
+	if (mainLuaStatePointer && (mainLuaStatePointer != luaStatePointer))
+	{
+		iterator = sRuntimeContextCollection.find(mainLuaStatePointer);
+		if (iterator != sRuntimeContextCollection.end())
+		{
+			return iterator->second;
+		}
+	}
+	return nullptr;
+}
+
+int RuntimeContext::GetInstanceCount()
+{
+	return (int)sRuntimeContextCollection.size();
+}
+
+int RuntimeContext::OnCoronaEnterFrame(lua_State* luaStatePointer)
+{
+	// Validate.
+	if (!luaStatePointer)
+	{
+		return 0;
+	}
+
+	{
+		std::lock_guard<std::recursive_mutex> scopedLock(SteamCallbackPump::GetMutex());
+
+		// Send or fail requests that were parked while Steam was being initialized, once it has finished.
+		UpdateSteamInitializationState();
+
+		// Poll steam for events. This will invoke the event handlers of all runtime contexts.
+		// Note: Skipped if another runtime context has already polled this frame or
+		//       if the SteamCallbackPump is polling Steam on its own thread.
+		SteamCallbackPump::PollFromFrame(fLastObservedPollCount);
+
+		// Abort requests that have been waiting for too long. Must be done before trimming the handler pool
+		// below since this returns their handlers to the pool.
+		TimeOutExpiredRequests();
+
+		// Send requests that were parked while Steam was disconnected, once their replay time has been reached.
+		ReplayParkedRequests();
+
+		// Send queued requests whose category has dropped below its concurrency limit.
+		SendQueuedRequests();
+
+		// Delete idle CCallResult handlers if we haven't needed them for a while.
+		fSteamCallResultHandlerPool.OnFrame();
+	}
+
+	// Move all queued events received from the above SteamAPI_RunCallbacks() call and worker threads
+	// to their pending priority lanes, behind any events that were carried over from the last frame.
+	MoveQueuedDispatchEventTasksToPendingLanes();
+
+	// Discard pending events that have been superseded by newer events, such as repeated "userProgressSave" events.
+	// Note: All events of the same type share the same lane, so coalescing each lane on its own is enough.
+	for (auto&& taskCollection : fPendingDispatchEventTaskLanes)
+	{
+		CoalescePendingDispatchEventTasks(taskCollection);
+	}
+
+	// If batch listeners have been registered, then push 1 array per batch listener to collect this frame's
+	// global event tables matching its filter in.
+	// Note: The listeners are copied in case a Lua listener adds or removes batch listeners during this frame.
+	//       Batched events are still dispatched to the listeners added via AddLuaEventListener().
+	//       Event tables belonging to a request's own listener are never batched.
+	LuaEventDispatcher* batchedEventDispatcherPointer = nullptr;
+	int luaEventArrayStackIndex = 0;
+	if (!fLuaBatchListenerCollection.empty())
+	{
+		batchedEventDispatcherPointer = fLuaEventDispatcherPointer.get();
+		fLuaBatchListenerDispatchCollection = fLuaBatchListenerCollection;
+		luaEventArrayStackIndex = lua_gettop(luaStatePointer) + 1;
+		for (size_t index = 0; index < fLuaBatchListenerDispatchCollection.size(); index++)
+		{
+			lua_createtable(luaStatePointer, (int)fDispatchEventTaskQueue.GetCapacity() / 8, 0);
+		}
+	}
+
+	// Dispatch all pending events to Lua, starting with the highest priority lane.
+	// Note: The SteamCallbackPump's mutex must not be held here. Lua listeners can take a long time to execute.
+	// If a time budget has been configured, then stop once it has been exceeded and leave the remaining
+	// events in their lanes to be dispatched on the next frame. This preserves their order within each lane
+	// and guarantees that critical events, such as purchase authorizations, are dispatched first next frame.
+	fLastCarriedOverEventCount = 0;
+	{
+		const auto startTime = std::chrono::steady_clock::now();
+		const auto timeBudget = std::chrono::microseconds(fDispatchTimeBudgetInMicroseconds);
+		bool wasBudgetExceeded = false;
+		for (auto&& taskCollection : fPendingDispatchEventTaskLanes)
+		{
+			// Dispatch this lane's events until we run out of time.
+			const size_t pendingTaskCount = taskCollection.size();
+			size_t executedTaskCount = 0;
+			while (!wasBudgetExceeded && (executedTaskCount < pendingTaskCount))
+			{
+				auto& taskPointer = taskCollection[executedTaskCount];
+				if (batchedEventDispatcherPointer &&
+				    (taskPointer->GetLuaEventDispatcher().get() == batchedEventDispatcherPointer))
+				{
+					DispatchAndBatchLuaEvent(luaStatePointer, *taskPointer, luaEventArrayStackIndex);
+				}
+				else if (taskPointer->GetRequestId() && HasRequestPromiseFor(taskPointer->GetRequestId()))
+				{
+					ExecuteAndSettleRequestPromise(luaStatePointer, *taskPointer);
+				}
+				else
+				{
+					taskPointer->Execute();
+				}
+				executedTaskCount++;
+				if (fDispatchTimeBudgetInMicroseconds > 0)
+				{
+					wasBudgetExceeded = ((std::chrono::steady_clock::now() - startTime) >= timeBudget);
+				}
+			}
+			fLastCarriedOverEventCount += (uint32_t)(pendingTaskCount - executedTaskCount);
+
+			// Release this lane's dispatched tasks back to their pools in bulk.
+			// Note: Erasing from a vector does not free its memory, so the pending lane will not re-allocate.
+			taskCollection.erase(taskCollection.begin(), taskCollection.begin() + executedTaskCount);
+		}
+		fTotalCarriedOverEventCount += fLastCarriedOverEventCount;
+	}
+
+	// Deliver this frame's batched global events to the Lua batch listeners with 1 call each.
+	if (luaEventArrayStackIndex > 0)
+	{
+		DispatchLuaEventBatch(luaStatePointer, luaEventArrayStackIndex);
+		lua_settop(luaStatePointer, luaEventArrayStackIndex - 1);
+	}
+
+	// Release all tasks that were canceled or dropped by other threads.
+	{
+		std::lock_guard<std::mutex> scopedLock(fDiscardedDispatchEventTasksMutex);
+		fDiscardedDispatchEventTasks.clear();
+	}
+
+	// If Steam's overlay needs to be rendered, then force Corona to render the next frame.
+	// We need to do this because Steam renders its overlay by hooking into the OpenGL/Direct3D rendering process.
+	auto steamUtilsPointer = SteamApiInitializer::GetUtils();
+	bool isSteamShowingOverlay = (steamUtilsPointer && steamUtilsPointer->BOverlayNeedsPresent());
+	if (isSteamShowingOverlay || fWasRenderRequested)
+	{
+		// We can force Corona to render the next frame by toggling the Lua stage object's visibility state.
+		lua_getglobal(luaStatePointer, "display");
+		if (!lua_isnil(luaStatePointer, -1))
+		{
+			lua_getfield(luaStatePointer, -1, "currentStage");
+			{
+				lua_getfield(luaStatePointer, -1, "isVisible");
+				if (lua_type(luaStatePointer, -1) == LUA_TBOOLEAN)
+				{
+					bool isVisible = lua_toboolean(luaStatePointer, -1) ? true : false;
+					lua_pushboolean(luaStatePointer, !isVisible ? 1 : 0);
+					lua_setfield(luaStatePointer, -3, "isVisible");
+					lua_pushboolean(luaStatePointer, isVisible ? 1 : 0);
+					lua_setfield(luaStatePointer, -3, "isVisible");
+				}
+				lua_pop(luaStatePointer, 1);
+			}
+			lua_pop(luaStatePointer, 1);
+		}
+		lua_pop(luaStatePointer, 1);
+	}
+	{
+		// We must always force Corona to render 1 more time while the Steam overlay is shown.
+		// This is needed to erase the last rendered frame of a Steam fade-out animation.
+		fWasRenderRequested = isSteamShowingOverlay;
+	}
+
+	return 0;
+}
+
+int RuntimeContext::OnCoronaSystemEvent(lua_State* luaStatePointer)
+{
+	// Validate.
+	if (!luaStatePointer || !lua_istable(luaStatePointer, 1))
+	{
+		return 0;
+	}
+
+	// Handle the system event's type.
+	lua_getfield(luaStatePointer, 1, "type");
+	auto eventType = lua_tostring(luaStatePointer, -1);
+	if (eventType)
+	{
+		if (!strcmp(eventType, "applicationSuspend"))
+		{
+			OnSuspended();
+		}
+		else if (!strcmp(eventType, "applicationResume"))
+		{
+			OnResumed();
+		}
+	}
+	lua_pop(luaStatePointer, 1);
+	return 0;
+}
+
+void RuntimeContext::OnSuspended()
+{
+	std::lock_guard<std::mutex> scopedLock(fSuspendedEventBufferMutex);
+	fIsSuspended = true;
+}
+
+void RuntimeContext::OnResumed()
+{
+	// Determine if Lua is interested in being told about dropped events.
+	// Note: Must be checked before locking the buffer mutex below, since Steam event handlers lock them in that order.
+	bool hasDroppedEventListeners = false;
+	{
+		std::lock_guard<std::recursive_mutex> scopedLock(SteamCallbackPump::GetMutex());
+		hasDroppedEventListeners = HasLuaEventListenersFor(DispatchSuspendedEventsDroppedEventTask::kLuaEventName);
+	}
+
+	// Block producers while we flush the buffers. They'll queue to the main queue once we've flagged that
+	// we've resumed, which guarantees that their events will be dispatched after the buffered events.
+	std::lock_guard<std::mutex> scopedLock(fSuspendedEventBufferMutex);
+	if (!fIsSuspended)
+	{
+		return;
+	}
+
+	// Move the events queued before we were suspended to the pending lanes first to preserve their order.
+	MoveQueuedDispatchEventTasksToPendingLanes();
+
+	// Move all buffered events to the pending lanes and tally up the number of dropped events per type.
+	DispatchEventTaskPool<DispatchSuspendedEventsDroppedEventTask>::TaskPointer droppedEventsTaskPointer;
+	for (auto&& buffer : fSuspendedEventBufferCollection)
+	{
+		for (auto&& taskPointer : buffer.TaskCollection)
+		{
+			AddPendingDispatchEventTask(std::move(taskPointer));
+		}
+		buffer.TaskCollection.clear();
+		if ((buffer.DroppedEventCount > 0) && hasDroppedEventListeners)
+		{
+			if (!droppedEventsTaskPointer)
+			{
+				droppedEventsTaskPointer =
+						DispatchEventTaskPool<DispatchSuspendedEventsDroppedEventTask>::GetInstance().Acquire();
+				droppedEventsTaskPointer->SetLuaEventDispatcher(fLuaEventDispatcherPointer);
+			}
+			droppedEventsTaskPointer->AddDroppedEventCount(buffer.LuaEventName, buffer.DroppedEventCount);
+		}
+		buffer.DroppedEventCount = 0;
+	}
+
+	// Notify Lua listeners about the dropped events after the buffered events have been dispatched.
+	if (droppedEventsTaskPointer)
+	{
+		AddPendingDispatchEventTask(std::move(droppedEventsTaskPointer));
+	}
+
+	// Flag that we're no longer suspended.
+	fIsSuspended = false;
+}
+
+void RuntimeContext::QueueGlobalDispatchEventTask(DispatchEventTaskPointer&& taskPointer)
+{
+	// Validate.
+	if (!taskPointer)
+	{
+		return;
+	}
+
+	// Queue the task normally if the Corona runtime is running.
+	if (!fIsSuspended)
+	{
+		QueueDispatchEventTask(std::move(taskPointer));
+		return;
+	}
+
+	// The Corona runtime is suspended. Store the task in its event type's bounded buffer.
+	std::lock_guard<std::mutex> scopedLock(fSuspendedEventBufferMutex);
+	if (!fIsSuspended)
+	{
+		// We were resumed while waiting for the above lock.
+		QueueDispatchEventTask(std::move(taskPointer));
+		return;
+	}
+
+	// Fetch the buffer for the task's event type, creating it if not found.
+	// Note: There are only a handful of global event types, which is why a linear search is used here.
+	SuspendedEventBuffer* bufferPointer = nullptr;
+	auto luaEventName = taskPointer->GetLuaEventName();
+	for (auto&& buffer : fSuspendedEventBufferCollection)
+	{
+		if ((buffer.LuaEventName == luaEventName) || !strcmp(buffer.LuaEventName, luaEventName))
+		{
+			bufferPointer = &buffer;
+			break;
+		}
+	}
+	if (!bufferPointer)
+	{
+		fSuspendedEventBufferCollection.emplace_back();
+		bufferPointer = &fSuspendedEventBufferCollection.back();
+		bufferPointer->LuaEventName = luaEventName;
+		bufferPointer->DroppedEventCount = 0;
+	}
+
+	// If the buffer is full, then make room or drop the given task depending on the overflow policy.
+	// Note: Dropped tasks must be released on the Lua thread, which is why they're discarded below.
+	auto& taskCollection = bufferPointer->TaskCollection;
+	if (taskCollection.size() >= fSuspendedEventCapacity)
+	{
+		uint32_t droppedEventCount = 0;
+		if (fSuspendedEventOverflowPolicy == EventOverflowPolicy::kDropNewest)
+		{
+			DiscardDispatchEventTask(std::move(taskPointer));
+			droppedEventCount = 1;
+		}
+		else if (fSuspendedEventOverflowPolicy == EventOverflowPolicy::kCollapseToLatest)
+		{
+			for (auto&& nextTaskPointer : taskCollection)
+			{
+				DiscardDispatchEventTask(std::move(nextTaskPointer));
+			}
+			droppedEventCount = (uint32_t)taskCollection.size();
+			taskCollection.clear();
+		}
+		else
+		{
+			while (taskCollection.size() >= fSuspendedEventCapacity)
+			{
+				DiscardDispatchEventTask(std::move(taskCollection.front()));
+				taskCollection.pop_front();
+				droppedEventCount++;
+			}
+		}
+		bufferPointer->DroppedEventCount += droppedEventCount;
+		fTotalDroppedSuspendedEventCount += droppedEventCount;
+	}
+	if (taskPointer)
+	{
+		taskCollection.push_back(std::move(taskPointer));
+	}
+}
+
+void RuntimeContext::AddPendingDispatchEventTask(DispatchEventTaskPointer&& taskPointer)
+{
+	if (taskPointer)
+	{
+		auto laneIndex = (size_t)taskPointer->GetPriority();
+		fPendingDispatchEventTaskLanes[laneIndex].push_back(std::move(taskPointer));
+	}
+}
+
+void RuntimeContext::CoalescePendingDispatchEventTasks(std::vector<DispatchEventTaskPointer>& taskCollection)
+{
+	// Do not continue if there is nothing to coalesce.
+	if (taskCollection.size() < 2)
+	{
+		return;
+	}
+
+	// Traverse the pending tasks from newest to oldest, nulling out older tasks having an already found key.
+	// Note: The number of unique keys is expected to be small, which is why a linear search is used here.
+	size_t coalescedTaskCount = 0;
+	fCoalescingKeyCollection.clear();
+	for (auto iterator = taskCollection.rbegin(); iterator != taskCollection.rend(); ++iterator)
+	{
+		BaseDispatchEventTask::CoalescingKey key;
+		if (!(*iterator) || !(*iterator)->CopyCoalescingKeyTo(key))
+		{
+			continue;
+		}
+		bool wasKeyFound = false;
+		for (auto&& nextKey : fCoalescingKeyCollection)
+		{
+			if (nextKey == key)
+			{
+				wasKeyFound = true;
+				break;
+			}
+		}
+		if (wasKeyFound)
+		{
+			*iterator = nullptr;
+			coalescedTaskCount++;
+		}
+		else
+		{
+			fCoalescingKeyCollection.push_back(key);
+		}
+	}
+
+	// Remove the superseded tasks from the collection, preserving the order of the remaining tasks.
+	if (coalescedTaskCount > 0)
+	{
+		taskCollection.erase(
+				std::remove(taskCollection.begin(), taskCollection.end(), nullptr), taskCollection.end());
+		fTotalCoalescedEventCount += coalescedTaskCount;
+	}
+}
+
+int RuntimeContext::IndexOfLuaBatchListener(lua_State* luaStatePointer, int luaListenerStackIndex) const
+{
+	// Convert a relative stack index to an absolute one, since we're about to push values to the stack.
+	if ((luaListenerStackIndex < 0) && (luaListenerStackIndex > LUA_REGISTRYINDEX))
+	{
+		luaListenerStackIndex = lua_gettop(luaStatePointer) + (luaListenerStackIndex + 1);
+	}
+
+	// Compare the given function with all of the registered functions.
+	for (size_t index = 0; index < fLuaBatchListenerCollection.size(); index++)
+	{
+		lua_rawgeti(luaStatePointer, LUA_REGISTRYINDEX, fLuaBatchListenerCollection[index].LuaReferenceId);
+		bool isEqual = lua_rawequal(luaStatePointer, -1, luaListenerStackIndex) ? true : false;
+		lua_pop(luaStatePointer, 1);
+		if (isEqual)
+		{
+			return (int)index;
+		}
+	}
+	return -1;
+}
+
+void RuntimeContext::CopyLeaderboardNameTo(
+	BaseDispatchLeaderboardEventTask* taskPointer, const char* leaderboardName)
+{
+	if (taskPointer)
+	{
+		taskPointer->SetLeaderboardName(leaderboardName);
+	}
+}
+
+void RuntimeContext::UpdateLuaEventListenerCountFor(const char* eventName)
+{
+	// Validate.
+	if (!eventName || !fLuaEventDispatcherPointer)
+	{
+		return;
+	}
+
+	// Fetch the event's listener count from the dispatcher and store it where event handlers can safely read it.
+	int count = fLuaEventDispatcherPointer->GetEventListenerCount(eventName);
+	std::lock_guard<std::recursive_mutex> scopedLock(SteamCallbackPump::GetMutex());
+	for (auto&& listenerCount : fLuaEventListenerCountCollection)
+	{
+		if (listenerCount.LuaEventName == eventName)
+		{
+			listenerCount.Count = count;
+			return;
+		}
+	}
+	LuaEventListenerCount listenerCount;
+	listenerCount.LuaEventName = eventName;
+	listenerCount.Count = count;
+	fLuaEventListenerCountCollection.push_back(listenerCount);
+}
+
+void RuntimeContext::UpdateLastStateEventTask(DispatchEventTaskPointer&& taskPointer)
+{
+	// Validate.
+	BaseDispatchEventTask::CoalescingKey key;
+	if (!taskPointer || !taskPointer->CopyCoalescingKeyTo(key))
+	{
+		return;
+	}
+
+	// Replace the last stored state having the same key, if any.
+	// Note: The replaced task is returned to its pool, which does not touch Lua for global events.
+	std::lock_guard<std::recursive_mutex> scopedLock(SteamCallbackPump::GetMutex());
+	for (auto&& lastTaskPointer : fLastStateEventTaskCollection)
+	{
+		BaseDispatchEventTask::CoalescingKey lastKey;
+		if (lastTaskPointer->CopyCoalescingKeyTo(lastKey) && (lastKey == key))
+		{
+			lastTaskPointer = std::move(taskPointer);
+			return;
+		}
+	}
+	fLastStateEventTaskCollection.push_back(std::move(taskPointer));
+}
+
+void RuntimeContext::ReplayLastStateEventsTo(
+	lua_State* luaStatePointer, const char* eventName, int luaListenerStackIndex, const LuaEventFilter& filter)
+{
+	// Validate.
+	if (!luaStatePointer || !eventName || !fLuaEventDispatcherPointer)
+	{
+		return;
+	}
+
+	// Convert the listener's stack index to an absolute index, since event tables are about to be pushed.
+	const int luaStackCount = lua_gettop(luaStatePointer);
+	if (luaListenerStackIndex < 0)
+	{
+		luaListenerStackIndex = luaStackCount + luaListenerStackIndex + 1;
+	}
+
+	// Push the event tables of all matching stored states while holding the mutex.
+	// Note: The listener is invoked after releasing the mutex since it can take a long time to execute.
+	{
+		std::lock_guard<std::recursive_mutex> scopedLock(SteamCallbackPump::GetMutex());
+
+		// The connection state is always known, so its event is built from it instead of being stored.
+		if (strcmp(eventName, DispatchConnectionStatusEventTask::kLuaEventName) == 0)
+		{
+			DispatchConnectionStatusEventTask task;
+			task.SetConnectionState(fConnectionState);
+			task.SetParkedRequestCount(fRequestReplayQueue.GetParkedRequestCount());
+			LuaEventFilter::EventFields eventFields;
+			task.CopyFilterFieldsTo(eventFields);
+			if (filter.IsMatch(eventFields) && lua_checkstack(luaStatePointer, 4))
+			{
+				task.PushLuaEventTableTo(luaStatePointer);
+			}
+		}
+		for (auto&& taskPointer : fLastStateEventTaskCollection)
+		{
+			if (strcmp(taskPointer->GetLuaEventName(), eventName) != 0)
+			{
+				continue;
+			}
+			LuaEventFilter::EventFields eventFields;
+			taskPointer->CopyFilterFieldsTo(eventFields);
+			if (!filter.IsMatch(eventFields) || !lua_checkstack(luaStatePointer, 4))
+			{
+				continue;
+			}
+			taskPointer->PushLuaEventTableTo(luaStatePointer);
+		}
+	}
+
+	// Invoke the listener with each pushed event table, oldest state first.
+	const int luaEventTableCount = lua_gettop(luaStatePointer) - luaStackCount;
+	for (int index = 1; index <= luaEventTableCount; index++)
+	{
+		fLuaEventDispatcherPointer->InvokeEventListener(
+				luaStatePointer, luaListenerStackIndex, eventName, luaStackCount + index);
+	}
+	lua_settop(luaStatePointer, luaStackCount);
+}
+
+bool RuntimeContext::HasLuaEventListenersFor(const char* luaEventName) const
+{
+	// Batch listeners may receive any global event. Their filters are checked before the event's Lua table is built.
+	if (fLuaBatchListenerCount > 0)
+	{
+		return true;
+	}
+
+	// Look up the event's native listener count.
+	if (luaEventName)
+	{
+		for (auto&& listenerCount : fLuaEventListenerCountCollection)
+		{
+			if (listenerCount.LuaEventName == luaEventName)
+			{
+				return (listenerCount.Count > 0);
+			}
+		}
+	}
+	return false;
+}
+
+void RuntimeContext::DispatchAndBatchLuaEvent(
+	lua_State* luaStatePointer, BaseDispatchEventTask& task, int luaEventArrayStackIndex)
+{
+	// Determine if any batch listener's filter matches the event, before building its Lua table.
+	LuaEventFilter::EventFields eventFields;
+	task.CopyFilterFieldsTo(eventFields);
+	bool isBatched = false;
+	for (auto&& batchListener : fLuaBatchListenerDispatchCollection)
+	{
+		if (batchListener.Filter.IsMatch(eventFields))
+		{
+			isBatched = true;
+			break;
+		}
+	}
+
+	// If no batch listener wants the event, then only dispatch it to its individual listeners, if any.
+	if (!isBatched)
+	{
+		task.Execute();
+		return;
+	}
+
+	// Build the event's table once and deliver it to its individual listeners whose filters match it.
+	if (!task.PushLuaEventTableTo(luaStatePointer))
+	{
+		return;
+	}
+	const int luaEventTableStackIndex = lua_gettop(luaStatePointer);
+	if (fLuaEventDispatcherPointer->HasEventListenersFor(task.GetLuaEventName(), eventFields))
+	{
+		task.DispatchLuaEventTable(luaStatePointer, luaEventTableStackIndex);
 	}
 
-	// If the given Lua state belongs to a coroutine, then use the main Lua state instead.
+	// Add the same table to the array of every batch listener whose filter matches it.
+	for (size_t index = 0; index < fLuaBatchListenerDispatchCollection.size(); index++)
 	{
-		auto mainLuaStatePointer = CoronaLuaGetCoronaThread(luaStatePointer);
-		if (mainLuaStatePointer && (mainLuaStatePointer != luaStatePointer))
+		auto& batchListener = fLuaBatchListenerDispatchCollection[index];
+		if (batchListener.Filter.IsMatch(eventFields))
 		{
-			luaStatePointer = mainLuaStatePointer;
+			batchListener.EventCount++;
+			lua_pushvalue(luaStatePointer, luaEventTableStackIndex);
+			lua_rawseti(luaStatePointer, luaEventArrayStackIndex + (int)index, batchListener.EventCount);
 		}
 	}
+	lua_settop(luaStatePointer, luaEventTableStackIndex - 1);
+}
 
-	// Create a Lua EventDispatcher object.
-	// Used to dispatch global events to listeners
-	fLuaEventDispatcherPointer = std::make_shared<LuaEventDispatcher>(luaStatePointer);
+void RuntimeContext::DispatchLuaEventBatch(lua_State* luaStatePointer, int luaEventArrayStackIndex)
+{
+	// Call each batch listener with its own event array, skipping listeners that did not receive any events.
+	// Note: CoronaLuaDoCall() catches and logs Lua errors, so a failing listener will not stop the others.
+	for (size_t index = 0; index < fLuaBatchListenerDispatchCollection.size(); index++)
+	{
+		if (fLuaBatchListenerDispatchCollection[index].EventCount <= 0)
+		{
+			continue;
+		}
+		lua_rawgeti(luaStatePointer, LUA_REGISTRYINDEX, fLuaBatchListenerDispatchCollection[index].LuaReferenceId);
+		if (lua_isfunction(luaStatePointer, -1))
+		{
+			lua_pushvalue(luaStatePointer, luaEventArrayStackIndex + (int)index);
+			CoronaLuaDoCall(luaStatePointer, 1, 0);
+		}
+		else
+		{
+			lua_pop(luaStatePointer, 1);
+		}
+	}
+}
 
-	// Add Corona runtime event listeners.
-	fLuaEnterFrameCallback.AddToRuntimeEventListeners("enterFrame");
+void RuntimeContext::DiscardDispatchEventTask(DispatchEventTaskPointer&& taskPointer)
+{
+	if (taskPointer)
+	{
+		std::lock_guard<std::mutex> scopedLock(fDiscardedDispatchEventTasksMutex);
+		fDiscardedDispatchEventTasks.push_back(std::move(taskPointer));
+	}
+}
+
+void RuntimeContext::ExecuteAndSettleRequestPromise(lua_State* luaStatePointer, BaseDispatchEventTask& task)
+{
+	// Push the task's event table once, so that its listener and promise callbacks receive the same table.
+	// If that fails, then settle the promise with an error event instead so that aggregates waiting on it complete.
+	if (!task.PushLuaEventTableTo(luaStatePointer))
+	{
+		SettleRequestPromiseWithError(luaStatePointer, task.GetRequestId(), task.GetLuaEventName());
+		return;
+	}
+	int luaEventTableStackIndex = lua_gettop(luaStatePointer);
 
-	// Add this class instance to the global collection.
-	sRuntimeContextCollection.insert(this);
+	// Deliver the event to the request's listener or awaiting coroutine first, if it has one.
+	// Note: The listener is allowed to transfer the request's promise, which is why the ID is fetched afterwards.
+	task.DispatchLuaEventTable(luaStatePointer, luaEventTableStackIndex);
+	SettleRequestPromise(luaStatePointer, task.GetRequestId(), luaEventTableStackIndex);
+	lua_settop(luaStatePointer, luaEventTableStackIndex - 1);
 }
 
-RuntimeContext::~RuntimeContext()
+void RuntimeContext::OnRequestPromiseAggregateMemberSettled(
+	lua_State* luaStatePointer, const RuntimeContext::RequestPromiseAggregateMember& member,
+	int luaEventTableStackIndex, bool isError)
 {
-	// Remove our Corona runtime event listeners.
-	fLuaEnterFrameCallback.RemoveFromRuntimeEventListeners("enterFrame");
+	// Fetch the aggregate. Do not continue if it has already resolved.
+	auto iterator = fRequestPromiseAggregateCollection.find(member.AggregateId);
+	if (iterator == fRequestPromiseAggregateCollection.end())
+	{
+		return;
+	}
+	auto& aggregate = iterator->second;
 
-	// Delete our pool of Steam call result handlers.
-	for (auto nextHandlerPointer : fSteamCallResultHandlerPool)
+	// Update the aggregate and resolve it if its condition has been met.
+	switch (aggregate.Type)
 	{
-		if (nextHandlerPointer)
-		{
-			delete nextHandlerPointer;
-		}
+		case PromiseAggregateType::kAll:
+			lua_rawgeti(luaStatePointer, LUA_REGISTRYINDEX, aggregate.LuaEventArrayReferenceId);
+			lua_pushvalue(luaStatePointer, luaEventTableStackIndex);
+			lua_rawseti(luaStatePointer, -2, member.Index);
+			if (aggregate.PendingRequestCount > 0)
+			{
+				aggregate.PendingRequestCount--;
+			}
+			if (0 == aggregate.PendingRequestCount)
+			{
+				ResolveRequestPromiseAggregate(luaStatePointer, member.AggregateId, 1);
+			}
+			else
+			{
+				lua_pop(luaStatePointer, 1);
+			}
+			break;
+
+		case PromiseAggregateType::kAny:
+			if (aggregate.PendingRequestCount > 0)
+			{
+				aggregate.PendingRequestCount--;
+			}
+			if (!isError || (0 == aggregate.PendingRequestCount))
+			{
+				lua_pushvalue(luaStatePointer, luaEventTableStackIndex);
+				lua_pushinteger(luaStatePointer, member.Index);
+				ResolveRequestPromiseAggregate(luaStatePointer, member.AggregateId, 2);
+			}
+			break;
+
+		case PromiseAggregateType::kRace:
+			lua_pushvalue(luaStatePointer, luaEventTableStackIndex);
+			lua_pushinteger(luaStatePointer, member.Index);
+			ResolveRequestPromiseAggregate(luaStatePointer, member.AggregateId, 2);
+			break;
+	}
+}
+
+void RuntimeContext::ResolveRequestPromiseAggregate(
+	lua_State* luaStatePointer, uint64_t aggregateId, int luaArgumentCount)
+{
+	// Fetch the aggregate.
+	auto iterator = fRequestPromiseAggregateCollection.find(aggregateId);
+	if (iterator == fRequestPromiseAggregateCollection.end())
+	{
+		lua_pop(luaStatePointer, luaArgumentCount);
+		return;
 	}
 
-	// Remove this class instance from the global collection.
-	sRuntimeContextCollection.erase(this);
+	// Push the aggregate's listener below the given arguments and release the aggregate's references.
+	// Note: The aggregate is removed before calling its listener, which is allowed to create new aggregates.
+	auto aggregate = iterator->second;
+	fRequestPromiseAggregateCollection.erase(iterator);
+	lua_rawgeti(luaStatePointer, LUA_REGISTRYINDEX, aggregate.LuaListenerReferenceId);
+	lua_insert(luaStatePointer, -(luaArgumentCount + 1));
+	luaL_unref(luaStatePointer, LUA_REGISTRYINDEX, aggregate.LuaListenerReferenceId);
+	luaL_unref(luaStatePointer, LUA_REGISTRYINDEX, aggregate.LuaHandleArrayReferenceId);
+	luaL_unref(luaStatePointer, LUA_REGISTRYINDEX, aggregate.LuaEventArrayReferenceId);
+
+	// Call the listener once with the aggregate's result.
+	CoronaLuaDoCall(luaStatePointer, luaArgumentCount, 0);
 }
 
-lua_State* RuntimeContext::GetMainLuaState() const
+void RuntimeContext::OnRequestRejected(const char* luaEventName)
 {
-	if (fLuaEventDispatcherPointer)
+	fRejectedRequestCount++;
+	CoronaLog(
+			"WARNING: [Steam] Max number of pending requests (%u) has been reached. Rejecting '%s' request.",
+			(unsigned int)fSteamCallResultHandlerPool.GetMaxHandlerCount(), luaEventName ? luaEventName : "");
+}
+
+void RuntimeContext::OnReceivedCallResult(const LeaderboardFindResult_t& result)
+{
+	// The cached handle is needed to fetch leaderboard entries and upload scores to Steam.
+	// Note: This method is invoked while the SteamCallbackPump's mutex is held, which guards this mapping.
+	auto steamUserStatsPointer = SteamApiInitializer::GetUserStats();
+	if (result.m_bLeaderboardFound && steamUserStatsPointer)
 	{
-		return fLuaEventDispatcherPointer->GetLuaState();
+		auto name = steamUserStatsPointer->GetLeaderboardName(result.m_hSteamLeaderboard);
+		if (name)
+		{
+			fLeaderboardNameHandleMap[std::string(name)] = result.m_hSteamLeaderboard;
+		}
 	}
-	return nullptr;
 }
 
-std::shared_ptr<LuaEventDispatcher> RuntimeContext::GetLuaEventDispatcher() const
+void RuntimeContext::AddPendingRequest(
+	uint64_t requestId, BaseSteamCallResultHandler* handlerPointer,
+	uint32_t timeoutInMilliseconds, uint32_t categoryIndex)
 {
-	return fLuaEventDispatcherPointer;
+	PendingRequest request{};
+	request.RequestId = requestId;
+	request.HandlerPointer = handlerPointer;
+	request.CategoryIndex = categoryIndex;
+	fRequestScheduler.OnRequestStarted(categoryIndex);
+	if (timeoutInMilliseconds > 0)
+	{
+		request.HasTimeout = true;
+		request.ExpirationTime =
+				std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutInMilliseconds);
+		fTimedPendingRequestCount++;
+	}
+	fPendingRequestCollection.push_back(request);
 }
 
-SteamLeaderboardEntries_t RuntimeContext::GetCachedLeaderboardHandleByName(const char* name) const
+BaseSteamCallResultHandler* RuntimeContext::RemovePendingRequest(uint64_t requestId)
 {
-	if (name)
+	// Note: The collection is unordered, so swap the request with the last entry to remove it in constant time.
+	for (size_t index = 0; index < fPendingRequestCollection.size(); index++)
 	{
-		auto iterator = fLeaderboardNameHandleMap.find(std::string(name));
-		if (iterator != fLeaderboardNameHandleMap.end())
+		auto& request = fPendingRequestCollection[index];
+		if (request.RequestId == requestId)
 		{
-			return iterator->second;
+			auto handlerPointer = request.HandlerPointer;
+			if (request.HasTimeout)
+			{
+				fTimedPendingRequestCount--;
+			}
+			fRequestScheduler.OnRequestEnded(request.CategoryIndex);
+			if (index + 1 < fPendingRequestCollection.size())
+			{
+				request = fPendingRequestCollection.back();
+			}
+			fPendingRequestCollection.pop_back();
+			return handlerPointer;
 		}
 	}
-	return 0;
+	return nullptr;
 }
 
-RuntimeContext* RuntimeContext::GetInstanceBy(lua_State* luaStatePointer)
+RuntimeContext::InFlightRequest* RuntimeContext::FindInFlightRequest(
+	const char* luaEventName, const char* singleFlightKey)
 {
 	// Validate.
-	if (!luaStatePointer)
+	if (!luaEventName || !singleFlightKey)
 	{
 		return nullptr;
 	}
 
-	// If the given Lua state belongs to a coroutine, then use the main Lua state instead.
+	// Find the in-flight call having the same result type and normalized arguments.
+	// Note: Calls whose leader was canceled are still joinable since their Steam call is still running.
+	for (auto&& inFlightRequest : fInFlightRequestCollection)
 	{
-		auto mainLuaStatePointer = CoronaLuaGetCoronaThread(luaStatePointer);
-		if (mainLuaStatePointer && (mainLuaStatePointer != luaStatePointer))
+		if ((inFlightRequest.LuaEventName == luaEventName) && (inFlightRequest.SingleFlightKey == singleFlightKey))
 		{
-			luaStatePointer = mainLuaStatePointer;
+			return &inFlightRequest;
 		}
 	}
+	return nullptr;
+}
 
-	// Return the first runtime context instance belonging to the given Lua state.
-	for (auto&& runtimePointer : sRuntimeContextCollection)
+RuntimeContext::InFlightRequest* RuntimeContext::FindInFlightRequestLedBy(uint64_t leaderRequestId)
+{
+	for (auto&& inFlightRequest : fInFlightRequestCollection)
 	{
-		if (runtimePointer && runtimePointer->GetMainLuaState() == luaStatePointer)
+		if (inFlightRequest.LeaderRequestId == leaderRequestId)
 		{
-			return runtimePointer;
+			return &inFlightRequest;
 		}
 	}
 	return nullptr;
 }
 
-int RuntimeContext::GetInstanceCount()
+bool RuntimeContext::IsCanceledLeaderRequest(uint64_t requestId)
 {
-	return (int)sRuntimeContextCollection.size();
+	auto inFlightRequestPointer = FindInFlightRequestLedBy(requestId);
+	return (inFlightRequestPointer && inFlightRequestPointer->WasLeaderCanceled);
 }
 
-int RuntimeContext::OnCoronaEnterFrame(lua_State* luaStatePointer)
+void RuntimeContext::ReleaseCanceledLeaderRequestIfUnused(uint64_t leaderRequestId)
 {
-	// Validate.
-	if (!luaStatePointer)
+	// Do not continue if the leader was not canceled or if other requests still need its Steam call.
+	auto inFlightRequestPointer = FindInFlightRequestLedBy(leaderRequestId);
+	if (!inFlightRequestPointer || !inFlightRequestPointer->WasLeaderCanceled ||
+	    !inFlightRequestPointer->FollowerCollection.empty())
 	{
-		return 0;
+		return;
 	}
 
-	// Poll steam for events. This will invoke our event handlers.
-	SteamAPI_RunCallbacks();
+	// Cancel the leader for real now, which frees its Steam call, pending entry, and category slot.
+	inFlightRequestPointer->WasLeaderCanceled = false;
+	CancelRequest(leaderRequestId);
+}
+
+bool RuntimeContext::CancelUnsentLeaderRequest(uint64_t requestId)
+{
+	auto inFlightRequestPointer = FindInFlightRequestLedBy(requestId);
+	if (!inFlightRequestPointer)
+	{
+		return false;
+	}
+	if (!inFlightRequestPointer->FollowerCollection.empty())
+	{
+		inFlightRequestPointer->WasLeaderCanceled = true;
+		return true;
+	}
+	InFlightRequest inFlightRequest;
+	TakeInFlightRequest(requestId, inFlightRequest);
+	return false;
+}
 
-	// Dispatch all queued events received from the above SteamAPI_RunCallbacks() call to Lua.
-	while (fDispatchEventTaskQueue.size() > 0)
+bool RuntimeContext::TakeInFlightRequest(uint64_t leaderRequestId, RuntimeContext::InFlightRequest& inFlightRequest)
+{
+	for (auto iterator = fInFlightRequestCollection.begin(); iterator != fInFlightRequestCollection.end(); ++iterator)
 	{
-		auto dispatchEventTaskPointer = fDispatchEventTaskQueue.front();
-		fDispatchEventTaskQueue.pop();
-		if (dispatchEventTaskPointer)
+		if (iterator->LeaderRequestId == leaderRequestId)
 		{
-			dispatchEventTaskPointer->Execute();
+			inFlightRequest = std::move(*iterator);
+			fInFlightRequestCollection.erase(iterator);
+			return true;
 		}
 	}
+	return false;
+}
 
-	// If Steam's overlay needs to be rendered, then force Corona to render the next frame.
-	// We need to do this because Steam renders its overlay by hooking into the OpenGL/Direct3D rendering process.
-	auto steamUtilsPointer = SteamUtils();
-	bool isSteamShowingOverlay = (steamUtilsPointer && steamUtilsPointer->BOverlayNeedsPresent());
-	if (isSteamShowingOverlay || fWasRenderRequested)
+void RuntimeContext::TimeOutExpiredRequests()
+{
+	const auto currentTime = std::chrono::steady_clock::now();
+
+	// Time out all expired parked requests. They are not waiting on Steam, so their tasks are queued directly.
+	auto failIfExpired = [this, currentTime](SteamParkedRequest& request)->bool
 	{
-		// We can force Corona to render the next frame by toggling the Lua stage object's visibility state.
-		lua_getglobal(luaStatePointer, "display");
-		if (!lua_isnil(luaStatePointer, -1))
+		if (!request.HasTimeout || (currentTime < request.ExpirationTime))
 		{
-			lua_getfield(luaStatePointer, -1, "currentStage");
+			return false;
+		}
+		FailUnsentRequest(request, true);
+		fTotalTimedOutRequestCount++;
+		return true;
+	};
+	fRequestReplayQueue.RemoveParkedRequestsIf(failIfExpired);
+
+	// Time out all expired queued requests the same way, since they were never sent to Steam either.
+	fRequestScheduler.RemoveQueuedRequestsIf(failIfExpired);
+
+	// Time out all expired requests attached to another request's Steam call by detaching them from it.
+	// Note: The call is canceled afterwards if its leader was canceled and nothing is attached to it anymore.
+	std::vector<uint64_t> detachedLeaderRequestIds;
+	for (auto&& inFlightRequest : fInFlightRequestCollection)
+	{
+		auto& followerCollection = inFlightRequest.FollowerCollection;
+		const size_t followerCount = followerCollection.size();
+		for (auto iterator = followerCollection.begin(); iterator != followerCollection.end();)
+		{
+			if (iterator->HasTimeout && (currentTime >= iterator->ExpirationTime))
 			{
-				lua_getfield(luaStatePointer, -1, "isVisible");
-				if (lua_type(luaStatePointer, -1) == LUA_TBOOLEAN)
-				{
-					bool isVisible = lua_toboolean(luaStatePointer, -1) ? true : false;
-					lua_pushboolean(luaStatePointer, !isVisible ? 1 : 0);
-					lua_setfield(luaStatePointer, -3, "isVisible");
-					lua_pushboolean(luaStatePointer, isVisible ? 1 : 0);
-					lua_setfield(luaStatePointer, -3, "isVisible");
-				}
-				lua_pop(luaStatePointer, 1);
+				auto taskPointer = static_cast<BaseDispatchCallResultEventTask*>(iterator->TaskPointer.get());
+				taskPointer->SetHadIOFailure(true);
+				taskPointer->SetTimedOut(true);
+				QueueDispatchEventTask(std::move(iterator->TaskPointer));
+				iterator = followerCollection.erase(iterator);
+				fTotalTimedOutRequestCount++;
+			}
+			else
+			{
+				++iterator;
 			}
-			lua_pop(luaStatePointer, 1);
 		}
-		lua_pop(luaStatePointer, 1);
+		if (inFlightRequest.WasLeaderCanceled && followerCollection.empty() && (followerCount > 0))
+		{
+			detachedLeaderRequestIds.push_back(inFlightRequest.LeaderRequestId);
+		}
 	}
+	for (auto&& leaderRequestId : detachedLeaderRequestIds)
 	{
-		// We must always force Corona to render 1 more time while the Steam overlay is shown.
-		// This is needed to erase the last rendered frame of a Steam fade-out animation.
-		fWasRenderRequested = isSteamShowingOverlay;
+		ReleaseCanceledLeaderRequestIfUnused(leaderRequestId);
 	}
 
-	return 0;
+	// Do not continue if no pending requests have a timeout.
+	if (fTimedPendingRequestCount <= 0)
+	{
+		return;
+	}
+
+	// Time out all expired requests.
+	// Note: TimeOut() invokes the request's callback, which queues its "timedOut" event.
+	//       The request is removed from the collection first so that the callback won't need to search for it.
+	size_t index = 0;
+	while (index < fPendingRequestCollection.size())
+	{
+		const auto& request = fPendingRequestCollection[index];
+		if (request.HasTimeout && (currentTime >= request.ExpirationTime))
+		{
+			auto handlerPointer = RemovePendingRequest(request.RequestId);
+			fTotalTimedOutRequestCount++;
+			if (handlerPointer)
+			{
+				handlerPointer->TimeOut();
+			}
+		}
+		else
+		{
+			index++;
+		}
+	}
+}
+
+void RuntimeContext::ReplayParkedRequests()
+{
+	// Do not continue if Steam is still disconnected or initializing.
+	if ((fConnectionState == SteamConnectionState::kDisconnected) ||
+	    (fConnectionState == SteamConnectionState::kInitializing))
+	{
+		return;
+	}
+
+	// Send all parked requests whose replay time has been reached, preserving the order of the others.
+	// Note: The request is removed from the collection first, since a failed replay dispatches its event.
+	if (fRequestReplayQueue.GetParkedRequestCount() > 0)
+	{
+		const auto currentTime = std::chrono::steady_clock::now();
+		fRequestReplayQueue.RemoveParkedRequestsIf([this, currentTime](SteamParkedRequest& parkedRequest)->bool
+		{
+			if (!parkedRequest.IsReplayScheduled || (currentTime < parkedRequest.ReplayTime))
+			{
+				return false;
+			}
+			SteamParkedRequest request(std::move(parkedRequest));
+			SendOrQueueRequest(request);
+			return true;
+		});
+	}
+
+	// Let Lua know that requests are sent to Steam immediately again once all parked requests have been sent.
+	if ((0 == fRequestReplayQueue.GetParkedRequestCount()) &&
+	    (fConnectionState == SteamConnectionState::kReconnecting))
+	{
+		SetConnectionState(SteamConnectionState::kConnected);
+	}
+}
+
+void RuntimeContext::UpdateSteamInitializationState()
+{
+	// Do not continue if not waiting on the SteamApiInitializer or if it hasn't finished yet.
+	if (fConnectionState != SteamConnectionState::kInitializing)
+	{
+		return;
+	}
+	auto initializerState = SteamApiInitializer::GetState();
+	if (SteamApiInitializer::State::kInitializing == initializerState)
+	{
+		return;
+	}
+
+	// If initialization failed, then dispatch all parked requests as failed since Steam will never receive them.
+	if (initializerState != SteamApiInitializer::State::kSucceeded)
+	{
+		CoronaLuaError(GetMainLuaState(), "Failed to initialize connection with Steam client.");
+		fRequestReplayQueue.RemoveParkedRequestsIf([this](SteamParkedRequest& request)->bool
+		{
+			FailUnsentRequest(request, false);
+			return true;
+		});
+		SetConnectionState(SteamConnectionState::kDisconnected);
+		return;
+	}
+
+	// Initialization succeeded. Send all parked requests right away, in the order they were made.
+	// There is no need to spread them out over time like after a reconnect since Steam isn't recovering from anything.
+	if (0 == fRequestReplayQueue.GetParkedRequestCount())
+	{
+		SetConnectionState(SteamConnectionState::kConnected);
+		return;
+	}
+	fRequestReplayQueue.ScheduleImmediateReplay();
+	SetConnectionState(SteamConnectionState::kReconnecting);
+}
+
+void RuntimeContext::SendOrQueueRequest(SteamParkedRequest& request)
+{
+	if (!fRequestScheduler.CanSendNowIn(request.CategoryIndex) && fRequestScheduler.Enqueue(request))
+	{
+		return;
+	}
+	request.ReplayFunctionPointer(*this, request);
+}
+
+void RuntimeContext::SendQueuedRequests()
+{
+	// Do not continue if Steam can't receive requests right now. They'll stay queued in the meantime.
+	if ((fConnectionState == SteamConnectionState::kDisconnected) ||
+	    (fConnectionState == SteamConnectionState::kInitializing))
+	{
+		return;
+	}
+
+	// Send queued requests until all categories are empty or at their concurrency limit.
+	// Note: Every iteration removes a request from a queue, so this loop always ends, even if a request fails
+	//       to be sent or attaches to an in-flight call instead of counting against its category's limit.
+	while (true)
+	{
+		SteamParkedRequest request;
+		if (!fRequestScheduler.TryDequeue(request))
+		{
+			break;
+		}
+		request.ReplayFunctionPointer(*this, request);
+	}
+}
+
+void RuntimeContext::FailUnsentRequest(SteamParkedRequest& request, bool timedOut)
+{
+	// Fail the requests attached to this request's Steam call, if it's waiting to be retried.
+	bool wasLeaderCanceled = false;
+	InFlightRequest inFlightRequest;
+	if (TakeInFlightRequest(request.RequestId, inFlightRequest))
+	{
+		wasLeaderCanceled = inFlightRequest.WasLeaderCanceled;
+		for (auto&& followerRequest : inFlightRequest.FollowerCollection)
+		{
+			auto taskPointer = static_cast<BaseDispatchCallResultEventTask*>(followerRequest.TaskPointer.get());
+			taskPointer->SetHadIOFailure(true);
+			taskPointer->SetTimedOut(timedOut);
+			taskPointer->SetAttemptCount(request.AttemptCount);
+			QueueDispatchEventTask(std::move(followerRequest.TaskPointer));
+		}
+	}
+
+	// Fail the request itself, unless it was canceled and only kept for the above requests.
+	// Note: Parked tasks are always CCallResult event tasks, as enforced by the SendRequestFor() method.
+	if (!request.TaskPointer)
+	{
+		return;
+	}
+	if (wasLeaderCanceled)
+	{
+		DiscardDispatchEventTask(std::move(request.TaskPointer));
+		return;
+	}
+	auto taskPointer = static_cast<BaseDispatchCallResultEventTask*>(request.TaskPointer.get());
+	taskPointer->SetHadIOFailure(true);
+	taskPointer->SetTimedOut(timedOut);
+	taskPointer->SetAttemptCount(request.AttemptCount);
+	QueueDispatchEventTask(std::move(request.TaskPointer));
+}
+
+void RuntimeContext::SetConnectionState(const SteamConnectionState& state)
+{
+	// Update the state.
+	// Note: Lua listeners added later with the "replayLast" option receive an event built from this state.
+	fConnectionState = state;
+
+	// Do not create an event that no Lua listener is subscribed to.
+	if (!HasLuaEventListenersFor(DispatchConnectionStatusEventTask::kLuaEventName))
+	{
+		fTotalUnobservedEventCount++;
+		return;
+	}
+
+	// Queue a "connectionStatus" event to be dispatched to Lua later.
+	auto taskPointer = DispatchEventTaskPool<DispatchConnectionStatusEventTask>::GetInstance().Acquire();
+	taskPointer->SetLuaEventDispatcher(fLuaEventDispatcherPointer);
+	taskPointer->SetConnectionState(state);
+	taskPointer->SetParkedRequestCount(fRequestReplayQueue.GetParkedRequestCount());
+	QueueGlobalDispatchEventTask(std::move(taskPointer));
 }
 
 template<class TSteamResultType, class TDispatchEventTask>
@@ -205,18 +2189,32 @@ void RuntimeContext::OnHandleGlobalSteamEvent(TSteamResultType* eventDataPointer
 		return;
 	}
 
-	// Create and configure the event dispatcher task.
-	auto taskPointer = new TDispatchEventTask();
-	if (!taskPointer)
+	// Always remember the newest state for Lua listeners added later with the "replayLast" option,
+	// even before any such listener exists. Costs 1 pooled task per state event type and coalescing key.
+	if (SteamEventTraits<TSteamResultType>::kIsStateEvent)
+	{
+		auto stateTaskPointer = DispatchEventTaskPool<TDispatchEventTask>::GetInstance().Acquire();
+		stateTaskPointer->SetLuaEventDispatcher(fLuaEventDispatcherPointer);
+		stateTaskPointer->AcquireEventDataFrom(*eventDataPointer);
+		UpdateLastStateEventTask(std::move(stateTaskPointer));
+	}
+
+	// Do not create an event that no Lua listener is subscribed to.
+	// Note: Steam event handlers are always invoked while the SteamCallbackPump's mutex is held.
+	if (!HasLuaEventListenersFor(TDispatchEventTask::kLuaEventName))
 	{
+		fTotalUnobservedEventCount++;
 		return;
 	}
+
+	// Fetch an event dispatcher task from its pool and configure it.
+	auto taskPointer = DispatchEventTaskPool<TDispatchEventTask>::GetInstance().Acquire();
 	taskPointer->SetLuaEventDispatcher(fLuaEventDispatcherPointer);
 	taskPointer->AcquireEventDataFrom(*eventDataPointer);
 
 	// Queue the received Steam event data to be dispatched to Lua later.
 	// This ensures that Lua events are only dispatched while Corona is running (ie: not suspended).
-	fDispatchEventTaskQueue.push(std::shared_ptr<BaseDispatchEventTask>(taskPointer));
+	QueueGlobalDispatchEventTask(std::move(taskPointer));
 }
 
 template<class TSteamResultType, class TDispatchEventTask>
@@ -230,7 +2228,7 @@ void RuntimeContext::OnHandleGlobalSteamEventWithGameId(TSteamResultType* eventD
 
 	// Ignore the given event if it belongs to another application.
 	// Note: The below if-check works for "m_nGameID" fields that are of type uint64 and CGameID.
-	auto steamUtilsPointer = SteamUtils();
+	auto steamUtilsPointer = SteamApiInitializer::GetUtils();
 	if (steamUtilsPointer)
 	{
 		if (CGameID(steamUtilsPointer->GetAppID()) != CGameID(eventDataPointer->m_nGameID))
@@ -245,32 +2243,62 @@ void RuntimeContext::OnHandleGlobalSteamEventWithGameId(TSteamResultType* eventD
 
 void RuntimeContext::OnSteamGameOverlayActivated(GameOverlayActivated_t* eventDataPointer)
 {
-	OnHandleGlobalSteamEvent<GameOverlayActivated_t, DispatchGameOverlayActivatedEventTask>(eventDataPointer);
+	OnHandleGlobalSteamEvent<GameOverlayActivated_t>(eventDataPointer);
 }
 
 void RuntimeContext::OnSteamMicrotransactionAuthorizationReceived(MicroTxnAuthorizationResponse_t* eventDataPointer)
 {
-	OnHandleGlobalSteamEvent<
-			MicroTxnAuthorizationResponse_t, DispatchMicrotransactionAuthorizationResponseEventTask>(eventDataPointer);
+	OnHandleGlobalSteamEvent<MicroTxnAuthorizationResponse_t>(eventDataPointer);
 }
 
 void RuntimeContext::OnSteamUserAchievementStored(UserAchievementStored_t* eventDataPointer)
 {
-	OnHandleGlobalSteamEventWithGameId<
-			UserAchievementStored_t, DispatchUserAchievementStoredEventTask>(eventDataPointer);
+	OnHandleGlobalSteamEventWithGameId<UserAchievementStored_t>(eventDataPointer);
 }
 
 void RuntimeContext::OnSteamUserStatsReceived(UserStatsReceived_t* eventDataPointer)
 {
-	OnHandleGlobalSteamEventWithGameId<UserStatsReceived_t, DispatchUserStatsReceivedEventTask>(eventDataPointer);
+	OnHandleGlobalSteamEventWithGameId<UserStatsReceived_t>(eventDataPointer);
 }
 
 void RuntimeContext::OnSteamUserStatsStored(UserStatsStored_t* eventDataPointer)
 {
-	OnHandleGlobalSteamEventWithGameId<UserStatsStored_t, DispatchUserStatsStoredEventTask>(eventDataPointer);
+	OnHandleGlobalSteamEventWithGameId<UserStatsStored_t>(eventDataPointer);
 }
 
 void RuntimeContext::OnSteamUserStatsUnloaded(UserStatsUnloaded_t* eventDataPointer)
 {
-	OnHandleGlobalSteamEvent<UserStatsUnloaded_t, DispatchUserStatsUnloadedEventTask>(eventDataPointer);
+	OnHandleGlobalSteamEvent<UserStatsUnloaded_t>(eventDataPointer);
+}
+
+void RuntimeContext::OnSteamServersConnected(SteamServersConnected_t*)
+{
+	// Ignore redundant notifications.
+	if (fConnectionState != SteamConnectionState::kDisconnected)
+	{
+		return;
+	}
+
+	// Schedule all parked requests to be replayed over time, if any, backing off further if the connection is flapping.
+	// They'll be sent by the "enterFrame" listener, which switches to the kConnected state once all are sent.
+	fRequestReplayQueue.OnSteamReconnected();
+	if (0 == fRequestReplayQueue.GetParkedRequestCount())
+	{
+		SetConnectionState(SteamConnectionState::kConnected);
+		return;
+	}
+	SetConnectionState(SteamConnectionState::kReconnecting);
+}
+
+void RuntimeContext::OnSteamServersDisconnected(SteamServersDisconnected_t*)
+{
+	// Ignore redundant notifications.
+	if (fConnectionState == SteamConnectionState::kDisconnected)
+	{
+		return;
+	}
+
+	// Stop replaying parked requests. New requests will be parked too until Steam reconnects.
+	fRequestReplayQueue.OnSteamDisconnected();
+	SetConnectionState(SteamConnectionState::kDisconnected);
 }
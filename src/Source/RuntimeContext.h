@@ -11,15 +11,31 @@
 
 #include "BaseSteamCallResultHandler.h"
 #include "DispatchEventTask.h"
+#include "DispatchEventTaskPool.h"
+#include "EventOverflowPolicy.h"
+#include "InlineFunction.h"
 #include "LuaEventDispatcher.h"
+#include "LuaEventFilter.h"
 #include "LuaMethodCallback.h"
+#include "MpscRingBuffer.h"
 #include "PluginMacros.h"
+#include "SteamCallbackPump.h"
 #include "SteamCallResultHandler.h"
-#include <functional>
+#include "SteamCallResultHandlerPool.h"
+#include "SteamConnectionState.h"
+#include "SteamEventTraits.h"
+#include "SteamParkedRequest.h"
+#include "SteamRequestCategory.h"
+#include "SteamRequestReplayQueue.h"
+#include "SteamRequestScheduler.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
 #include <memory>
-#include <queue>
+#include <mutex>
+#include <string>
 #include <type_traits>
-#include <typeinfo>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -38,33 +54,16 @@ extern "C"
   Manages the plugin's event handling and current state between 1 Corona runtime and Steam.
 
   Automatically polls for and dispatches global Steam events, such as "GameOverlayActivated_t", to Lua.
+  Polling is done on "enterFrame" via SteamCallbackPump::PollFromFrame(), which is shared by all instances,
+  unless the SteamCallbackPump is running on its own thread. Global Steam events are received once per process
+  and forwarded to every instance.
   Provides easy handling of Steam's CCallResult async operation via this class' AddEventHandlerFor() method.
   Also ensures that Steam events are only dispatched to Lua while the Corona runtime is running (ie: not suspended).
+  While suspended, global Steam events are stored in bounded per-event-type buffers which are flushed on resume.
  */
 class RuntimeContext
 {
 	public:
-		/**
-		  Instance of this type are passed as arguments to the
-		  RuntimeContext::EventHandlerSettings::QueuingEventTaskCallback callback.
-		 */
-		struct QueuingEventTaskCallbackArguments
-		{
-			/**
-			  Pointer to the task object that is about to be queued for execution.
-			  Stores a copy of the information received from the Steam CCallResult operation.
-			  This object is mutable and can be modified by the callback if needed.
-			 */
-			BaseDispatchCallResultEventTask* TaskPointer;
-
-			/**
-			  Callback can set this true to prevent this task from being queued, which in turn
-			  prevents a Lua event from being dispatched.
-			 */
-			bool IsCanceled;
-		};
-
-
 		/**
 		  Struct to be passed to a RuntimeContext's AddEventHandlerFor() method.
 		  Sets up a Steam CCallResult async listener and then passes the received steam data to Lua as an
@@ -75,7 +74,12 @@ class RuntimeContext
 			/** Lua state that the "LuaFunctionStackIndex" field indexes. */
 			lua_State* LuaStatePointer;
 
-			/** Index to the Lua function that will receive a Lua event providing Steam's CCallResult data. */
+			/**
+			  Index to the Lua function that will receive a Lua event providing Steam's CCallResult data.
+			  Can also index a suspended Lua coroutine awaiting the result, which will be resumed with the
+			  Lua event table instead, without creating a Lua event dispatcher.
+			  Can also index nil if the result is only delivered via the request's promise.
+			 */
 			int LuaFunctionStackIndex;
 
 			/**
@@ -85,16 +89,68 @@ class RuntimeContext
 			SteamAPICall_t SteamCallResultHandle;
 
 			/**
-			  Optional callback which will be invoked after a new BaseDispatchCallResultEventTask derived class
-			  has been configured with the CCallResult's received information, but before the task has been
-			  queued for dispatching its event data to Lua.
+			  Optional unique name of the leaderboard the async operation is for. Copied to the Lua event table
+			  of leaderboard related events since Steam's CCallResult data does not provide it.
+			  Ignored by non-leaderboard events. Can be null.
+			 */
+			const char* LeaderboardName;
+
+			/**
+			  Optional max number of milliseconds to wait for Steam's result. Once elapsed, the request is aborted
+			  and a Lua event flagged with "isError" and "timedOut" is dispatched instead.
+			  Set to zero to wait indefinitely.
+			 */
+			uint32_t TimeoutInMilliseconds;
+
+			/**
+			  Optional normalized arguments of the Steam async call, such as a leaderboard name, used to share
+			  1 in-flight Steam call between identical requests. The call's result type is implicitly part of the key.
+			  Passed to AttachToInFlightRequestFor() to attach to a matching call, or to AddEventHandlerFor() to let
+			  later identical requests attach to this one until its result has been received.
+			  Set to null for calls that must never be shared, such as calls that modify data on Steam.
+			 */
+			const char* SingleFlightKey;
+		};
+
+		/**
+		  Scheduling statistics of 1 request category, as returned by GetRequestCategoryStatisticsFor().
+		  Extends the SteamRequestScheduler's statistics with the category's retry metrics.
+		 */
+		struct RequestCategoryStatistics : public SteamRequestScheduler::CategoryStatistics
+		{
+			/** Number of Steam calls of the category that were retried after an I/O failure. */
+			uint64_t TotalRetryCount;
+
+			/** Number of I/O failures that were not retried because the category's retry budget was used up. */
+			uint64_t TotalRetryBudgetExhaustedCount;
+		};
+
+		/** Settings deciding if and when a request category's Steam calls are retried after an I/O failure. */
+		typedef SteamRequestReplayQueue::RetryPolicy RequestRetryPolicy;
 
-			  This is the caller's opportunity to modify the task's information or prevent it from being
-			  queued by setting the argument's "IsCanceled" field to true.
+		/** Determines when a request promise aggregate created via AddRequestPromiseAggregate() resolves. */
+		enum class PromiseAggregateType
+		{
+			/** Resolves once all requests have settled, with an array of their event tables in the given order. */
+			kAll,
+
+			/**
+			  Resolves with the first event table that is not flagged with "isError" and its index.
+			  Resolves with the last failed event table and its index if all requests have failed.
 			 */
-			std::function<void(RuntimeContext::QueuingEventTaskCallbackArguments&)> QueuingEventTaskCallback;
+			kAny,
+
+			/** Resolves with the first settled event table and its index, whether it succeeded or not. */
+			kRace
 		};
 
+		/**
+		  Callback given to the SendRequestFor() method which makes a Steam async call and returns its handle.
+		  Invoked later if the request gets parked while Steam is disconnected, which is why it must capture
+		  copies of the call's arguments instead of pointers to strings on the Lua stack.
+		 */
+		typedef SteamParkedRequest::SendRequestCallback SendRequestCallback;
+
 
 		/**
 		  Creates a new Corona runtime context bound to the given Lua state.
@@ -124,6 +180,73 @@ class RuntimeContext
 		 */
 		std::shared_ptr<LuaEventDispatcher> GetLuaEventDispatcher() const;
 
+		/**
+		  Adds a Lua listener for the given global Steam event to the GetLuaEventDispatcher() object and
+		  updates this context's native listener count for that event.
+		  Global Steam events having no listeners are ignored without creating a task or a Lua event table.
+		  @param luaStatePointer Pointer to the Lua state that the "luaListenerStackIndex" argument references.
+		  @param eventName Name of the global Steam event to add a listener for.
+		  @param luaListenerStackIndex Index to the Lua function or table to be registered as a listener.
+		  @param filter Determines which events are delivered to the listener. Checked natively before an
+		                event's Lua table is built. Set to an empty filter to receive all events.
+		  @param shouldReplayLastEvent Set true to immediately invoke the added listener with the last received
+		                               state event matching the given event name and filter, if any, such as the
+		                               last "overlayStatus" event. Also starts storing that event's newest states
+		                               for listeners added later. Ignored for events which are not state events.
+		  @return Returns true if the listener was added.
+
+		          Returns false if given invalid arguments or if the listener was already added for the given event.
+		 */
+		bool AddLuaEventListener(
+				lua_State* luaStatePointer, const char* eventName, int luaListenerStackIndex,
+				const LuaEventFilter& filter, bool shouldReplayLastEvent);
+
+		/**
+		  Removes a Lua listener for the given global Steam event from the GetLuaEventDispatcher() object and
+		  updates this context's native listener count for that event.
+		  @param luaStatePointer Pointer to the Lua state that the "luaListenerStackIndex" argument references.
+		  @param eventName Name of the global Steam event to remove a listener from.
+		  @param luaListenerStackIndex Index to the Lua function or table that was registered as a listener.
+		  @return Returns true if the listener was removed.
+
+		          Returns false if given invalid arguments or if the listener was not added for the given event.
+		 */
+		bool RemoveLuaEventListener(lua_State* luaStatePointer, const char* eventName, int luaListenerStackIndex);
+
+		/**
+		  Gets the number of global Steam events that were ignored because no Lua listeners were subscribed to them.
+		  Must be called while holding the SteamCallbackPump's mutex.
+		  @return Returns the number of ignored events since this context was created.
+		 */
+		uint64_t GetTotalUnobservedEventCount() const;
+
+		/**
+		  Adds a Lua function to be called once per frame with an array of all global Steam event tables
+		  dispatched during that frame, in dispatch order.
+
+		  Batches are delivered in addition to dispatching each global Steam event to the listeners of the
+		  GetLuaEventDispatcher() object, which share the same event table. Events belonging to a request's own
+		  listener are never batched.
+		  @param luaStatePointer Pointer to the Lua state that the "luaListenerStackIndex" argument references.
+		  @param luaListenerStackIndex Index to the Lua function to be registered as a batch listener.
+		  @param filter Determines which events are added to the listener's batches. Checked natively before
+		                an event's Lua table is built. An empty filter batches all global events.
+		  @return Returns true if the listener was added.
+
+		          Returns false if given invalid arguments or if the function is already registered.
+		 */
+		bool AddLuaBatchListener(lua_State* luaStatePointer, int luaListenerStackIndex, const LuaEventFilter& filter);
+
+		/**
+		  Removes a Lua function that was added via the AddLuaBatchListener() method.
+		  @param luaStatePointer Pointer to the Lua state that the "luaListenerStackIndex" argument references.
+		  @param luaListenerStackIndex Index to the Lua function to be unregistered.
+		  @return Returns true if the listener was removed.
+
+		          Returns false if given invalid arguments or if the function was not registered.
+		 */
+		bool RemoveLuaBatchListener(lua_State* luaStatePointer, int luaListenerStackIndex);
+
 		/**
 		  Gets a Steam leaderboard handle that was cached by this context's AddEventHandlerFor() method
 		  after giving it a "LeaderboardFindResult_t" CCallResult. This allows the caller to only fetch
@@ -137,27 +260,401 @@ class RuntimeContext
 		 */
 		SteamLeaderboardEntries_t GetCachedLeaderboardHandleByName(const char* name) const;
 
-		template<class TSteamResultType, class TDispatchEventTask>
+		/**
+		  Pushes the given task to the queue to be dispatched to Lua on the next "enterFrame" event.
+
+		  This method is thread safe. It can be called by worker threads, such as an image decoder,
+		  to produce events that will later be dispatched on the Lua thread that owns this context.
+		  Note that the task is expected to be released on the Lua thread after it executes,
+		  which is where its LuaEventDispatcher will be released too.
+		  @param taskPointer The task to be queued. Expected to be acquired from a DispatchEventTaskPool.
+		                     Ownership is transferred to this context if successfully queued.
+		                     Can be null, in which case this method will do nothing.
+		  @return Returns true if the task was queued.
+
+		          Returns false if given a null pointer or if the queue is full, in which case the task is dropped.
+		          Only coalescable global events are dropped. Request results and one-shot global events are
+		          stored in an unbounded overflow queue instead.
+		 */
+		bool QueueDispatchEventTask(DispatchEventTaskPointer&& taskPointer);
+
+		/**
+		  Gets the max amount of time this context is allowed to spend dispatching queued events to Lua per frame.
+		  @return Returns the time budget in microseconds. Returns zero if the time budget is unlimited.
+		 */
+		uint32_t GetDispatchTimeBudgetInMicroseconds() const;
+
+		/**
+		  Sets the max amount of time this context is allowed to spend dispatching queued events to Lua per frame.
+
+		  Once the time budget has been exceeded, the remaining queued events will be carried over to the next frame
+		  in the same order they were queued. At least 1 event will always be dispatched per frame, even if it
+		  exceeds the budget, to guarantee that the queue makes progress.
+		  @param value The time budget in microseconds. Set to zero to dispatch all queued events every frame.
+		 */
+		void SetDispatchTimeBudgetInMicroseconds(uint32_t value);
+
+		/**
+		  Gets the number of queued events that were carried over to the next frame during the last "enterFrame"
+		  because the dispatch time budget was exceeded.
+		  @return Returns the number of events carried over by the last frame. Returns zero if none were.
+		 */
+		uint32_t GetLastCarriedOverEventCount() const;
+
+		/**
+		  Gets the total number of times queued events were carried over to the next frame because the dispatch
+		  time budget was exceeded. An event carried over across multiple frames is counted once per frame.
+		  @return Returns the total number of carried over events since this context was created.
+		 */
+		uint64_t GetTotalCarriedOverEventCount() const;
+
+		/**
+		  Gets the total number of queued events that were discarded because a newer event with the same
+		  coalescing key, such as the same event name and user, was queued before they were dispatched.
+		  @return Returns the total number of coalesced events since this context was created.
+		 */
+		uint64_t GetTotalCoalescedEventCount() const;
+
+		/**
+		  Gets the pool of Steam CCallResult handlers used by this context's AddEventHandlerFor() method.
+		  Allows the caller to configure the pool's limits and to read its handler counts.
+		  @return Returns a reference to this context's CCallResult handler pool.
+		 */
+		SteamCallResultHandlerPool& GetSteamCallResultHandlerPool();
+
+		/**
+		  Gets the max number of global Steam events of each type that will be buffered while suspended.
+		  @return Returns the max number of buffered events per Lua event name.
+		 */
+		uint32_t GetSuspendedEventCapacity();
+
+		/**
+		  Sets the max number of global Steam events of each type that will be buffered while suspended.
+		  Events received while a type's buffer is full are handled by the suspended event overflow policy.
+		  @param value The max number of buffered events per Lua event name. Values less than 1 are treated as 1.
+		 */
+		void SetSuspendedEventCapacity(uint32_t value);
+
+		/**
+		  Gets the policy used to decide which events are dropped when a suspended event buffer is full.
+		  @return Returns a policy such as kDropOldest, kDropNewest, or kCollapseToLatest.
+		 */
+		EventOverflowPolicy GetSuspendedEventOverflowPolicy();
+
+		/**
+		  Sets the policy used to decide which events are dropped when a suspended event buffer is full.
+		  @param policy The policy to use such as kDropOldest, kDropNewest, or kCollapseToLatest.
+		                Will be ignored if set to kUnknown.
+		 */
+		void SetSuspendedEventOverflowPolicy(const EventOverflowPolicy& policy);
+
+		/**
+		  Gets the total number of global Steam events dropped because a suspended event buffer was full.
+		  @return Returns the number of dropped events since this context was created.
+		 */
+		uint64_t GetTotalDroppedSuspendedEventCount();
+
+		/**
+		  Gets the number of AddEventHandlerFor() calls that were rejected because the CCallResult handler
+		  pool's max handler count was reached and all of its handlers were waiting for a result.
+		  @return Returns the number of rejected requests since this context was created.
+		 */
+		uint64_t GetRejectedRequestCount() const;
+
+		/**
+		  Gets the number of requests made via AddEventHandlerFor() that were aborted because their timeout elapsed.
+		  Must be called while holding the SteamCallbackPump's mutex.
+		  @return Returns the number of timed out requests since this context was created.
+		 */
+		uint64_t GetTotalTimedOutRequestCount() const;
+
+		/**
+		  Aborts a request made via AddEventHandlerFor() that is still waiting for Steam's result.
+		  The request's CCallResult handler is returned to the pool immediately and its Lua listener
+		  will not be called.
+		  @param requestId Unique ID returned by the AddEventHandlerFor() method.
+		  @return Returns true if the request was canceled.
+
+		          Returns false if the request has already completed, timed out, or was already canceled.
+		 */
+		bool CancelRequest(uint64_t requestId);
+
+		/**
+		  Determines if a request made via AddEventHandlerFor() is still waiting for Steam's result.
+		  @param requestId Unique ID returned by the AddEventHandlerFor() method.
+		  @return Returns true if still waiting for a result. Returns false if completed, timed out, or canceled.
+		 */
+		bool IsRequestPending(uint64_t requestId);
+
+		/**
+		  Creates the native promise of a request made via AddEventHandlerFor(), which gets settled with the
+		  request's Lua event table once it has been dispatched. Expected to be called when a request handle is
+		  returned to Lua and removed via RemoveRequestPromise() when that handle is garbage collected.
+		  Must be called on the Lua thread.
+		  @param requestId Unique ID returned by the AddEventHandlerFor() method.
+		  @return Returns true if the promise was created. Returns false if given a zero ID or if it already exists.
+		 */
+		bool AddRequestPromise(uint64_t requestId);
+
+		/**
+		  Removes a promise created via AddRequestPromise() and releases its event table and pending callbacks.
+		  Must be called on the Lua thread.
+		  @param luaStatePointer Pointer to the Lua state the promise's references belong to.
+		  @param requestId The ID the promise was created for.
+		 */
+		void RemoveRequestPromise(lua_State* luaStatePointer, uint64_t requestId);
+
+		/**
+		  Transfers a promise to another request, such as when a request gets re-sent on the caller's behalf.
+		  Any promise already created for the destination request is removed first.
+		  Must be called on the Lua thread.
+		  @param luaStatePointer Pointer to the Lua state the promises' references belong to.
+		  @param fromRequestId ID of the request whose promise is to be transferred. Can be zero.
+		  @param toRequestId ID of the request that will settle the promise from now on.
+		 */
+		void MoveRequestPromise(lua_State* luaStatePointer, uint64_t fromRequestId, uint64_t toRequestId);
+
+		/**
+		  Adds a Lua function to be called with the request's event table once its promise settles.
+		  Called immediately if the promise has already settled. Must be called on the Lua thread.
+		  @param luaStatePointer Pointer to the Lua state that the "luaCallbackStackIndex" argument references.
+		  @param requestId The ID the promise was created for.
+		  @param luaCallbackStackIndex Index to the Lua function to be called.
+		  @return Returns true if the callback was added or called.
+
+		          Returns false if given invalid arguments or if the request does not have a promise.
+		 */
+		bool AddRequestPromiseCallback(lua_State* luaStatePointer, uint64_t requestId, int luaCallbackStackIndex);
+
+		/**
+		  Settles a request's promise with the given event table, calls its pending Lua callbacks, and notifies the
+		  aggregates waiting on it. Does nothing if the request has no promise or if it has already settled.
+		  Must be called on the Lua thread.
+		  @param luaStatePointer Pointer to the Lua state that the "luaEventTableStackIndex" argument references.
+		  @param requestId The ID the promise was created for.
+		  @param luaEventTableStackIndex Index to the request's Lua event table.
+		 */
+		void SettleRequestPromise(lua_State* luaStatePointer, uint64_t requestId, int luaEventTableStackIndex);
+
+		/**
+		  Settles a request's promise with a minimal error event having only "name" and "isError" fields.
+		  Used when the request's own event table could not be pushed, so that callbacks and aggregates waiting
+		  on the promise still complete. Does nothing if the request has no promise or if it has already settled.
+		  Must be called on the Lua thread.
+		  @param luaStatePointer Pointer to the Lua state to create the event table in.
+		  @param requestId The ID the promise was created for.
+		  @param luaEventName The name of the event the request was expected to receive.
+		 */
+		void SettleRequestPromiseWithError(lua_State* luaStatePointer, uint64_t requestId, const char* luaEventName);
+
+		/**
+		  Calls the given Lua function once when the given requests' promises resolve as a group.
+		  Settlement is tracked natively, which avoids Lua side counters and per-request closures.
+		  Promises that have already settled are accounted for immediately. Must be called on the Lua thread.
+		  @param luaStatePointer Pointer to the Lua state that the given stack indexes reference.
+		  @param type Determines when the aggregate resolves and what its Lua listener receives.
+		  @param requestIds IDs of the requests to wait on, in the order their results are reported.
+		                    Must not be empty unless the type is kAll.
+		  @param luaHandleArrayStackIndex Index to the Lua array of request handles given by the caller.
+		                                  Referenced until resolved to keep the handles' promises alive.
+		  @param luaListenerStackIndex Index to the Lua function to be called when the aggregate resolves.
+		  @return Returns true if the aggregate was created or has already resolved.
+
+		          Returns false if given invalid arguments or if a request does not have a promise.
+		 */
+		bool AddRequestPromiseAggregate(
+				lua_State* luaStatePointer, RuntimeContext::PromiseAggregateType type,
+				const std::vector<uint64_t>& requestIds, int luaHandleArrayStackIndex, int luaListenerStackIndex);
+
+		/**
+		  Determines if the given request has a promise created via AddRequestPromise().
+		  @param requestId Unique ID returned by the AddEventHandlerFor() method.
+		  @return Returns true if a promise exists for the request. Returns false if not.
+		 */
+		bool HasRequestPromiseFor(uint64_t requestId) const;
+
+		template<
+				class TSteamResultType,
+				class TDispatchEventTask = typename SteamEventTraits<TSteamResultType>::DispatchEventTask>
 		/**
 		  Sets up a Steam CCallResult handler used to receive the result from a Steam async operation and
 		  dispatch its data as a Lua event to the given Lua function.
 
 		  This is a templatized method.
 		  * The 1st template type must be set to the Steam result struct type, such as "NumberOfCurrentPlayers_t".
-		  * The 2nd template type must be set to a "BaseDispatchEventTask" derived class,
-		    such as the "DispatchNumberOfCurrentPlayersEventTask" class.
+		  * The 2nd template type is optional and defaults to the "BaseDispatchEventTask" derived class
+		    registered for the Steam result type in "SteamEventTraits.h".
 		  @param settings Provides a handle returned by a Steam async C/C++ function call used to listen for the result
 		                  and an index to a Lua function to receive the result as a Lua event table.
-		  @return Returns true if a CCallResult handler was successfully set up.
+		  @return Returns a non-zero request ID if a CCallResult handler was successfully set up.
+		          This ID can be passed to the CancelRequest() method.
 
-		          Returns false if the given "settings" argument contains invalid values. Both the Steam API handle
+		          Returns zero if the given "settings" argument contains invalid values. Both the Steam API handle
 		          and Lua listener index must be assigned or else this method will fail.
 		 */
-		bool AddEventHandlerFor(const RuntimeContext::EventHandlerSettings& settings);
+		uint64_t AddEventHandlerFor(const RuntimeContext::EventHandlerSettings& settings);
+
+		template<
+				class TSteamResultType,
+				class TDispatchEventTask = typename SteamEventTraits<TSteamResultType>::DispatchEventTask>
+		/**
+		  Attaches a new request to an identical Steam async call that is still in flight, instead of making the
+		  same Steam call again. The in-flight call's result will be fanned out to this request's own Lua listener,
+		  coroutine, and promise. This request shares the in-flight call's fate, including its timeout.
+
+		  This is a templatized method.
+		  * The 1st template type must be set to the Steam result struct type, such as "NumberOfCurrentPlayers_t".
+		  * The 2nd template type is optional and defaults to the "BaseDispatchEventTask" derived class
+		    registered for the Steam result type in "SteamEventTraits.h".
+		  @param settings Provides the "SingleFlightKey" to match and the Lua listener to deliver the result to.
+		                  Its "SteamCallResultHandle" field is ignored.
+		  @return Returns a non-zero request ID if attached to an in-flight call.
+		          This ID can be passed to the CancelRequest() method.
+
+		          Returns zero if there is no matching in-flight call or if the settings' "SingleFlightKey" is null,
+		          in which case the caller is expected to make the Steam call and pass it to AddEventHandlerFor().
+		 */
+		uint64_t AttachToInFlightRequestFor(const RuntimeContext::EventHandlerSettings& settings);
+
+		template<
+				class TSteamResultType,
+				class TDispatchEventTask = typename SteamEventTraits<TSteamResultType>::DispatchEventTask>
+		/**
+		  Sends a Steam async request and sets up the given Lua listener to receive its result.
+
+		  If Steam is connected, then the request attaches to an identical in-flight call via
+		  AttachToInFlightRequestFor() or invokes the given callback and passes its handle to AddEventHandlerFor().
+		  If Steam is disconnected or still replaying requests after reconnecting, then the request is parked
+		  instead and the callback is invoked once it gets replayed, spread out by a jittered backoff.
+		  The request's timeout, if any, starts now and also applies while parked.
+
+		  If the request category registered for the Steam result type in "SteamEventTraits.h" has reached its
+		  concurrency limit, then the request is queued and sent once one of the category's requests has completed.
+		  Queued requests of different categories are sent in a weighted fair order by the "enterFrame" listener.
+
+		  If the Steam call fails due to an I/O failure and the category's retry policy allows it, then the callback
+		  is invoked again after an exponential backoff with jitter. Only the final outcome is dispatched to Lua.
+
+		  This is a templatized method.
+		  * The 1st template type must be set to the Steam result struct type, such as "NumberOfCurrentPlayers_t".
+		  * The 2nd template type is optional and defaults to the "BaseDispatchEventTask" derived class
+		    registered for the Steam result type in "SteamEventTraits.h".
+		  @param settings Provides the Lua listener to receive the result. Its "SteamCallResultHandle" field is ignored.
+		  @param sendCallback Makes the Steam async call and returns its handle. Cannot be empty.
+		  @return Returns a non-zero request ID if the request was sent or parked.
+		          This ID can be passed to the CancelRequest() method.
+
+		          Returns zero if given invalid arguments or if the request was rejected.
+		 */
+		uint64_t SendRequestFor(
+				const RuntimeContext::EventHandlerSettings& settings, RuntimeContext::SendRequestCallback&& sendCallback);
+
+		/**
+		  Gets the Steam connection state tracked via Steam's "SteamServersConnected_t" and
+		  "SteamServersDisconnected_t" events. Assumed to be connected until Steam reports otherwise.
+		  @return Returns kConnected, kDisconnected, or kReconnecting.
+
+		          Returns kInitializing if WaitForSteamInitialization() was called and the SteamApiInitializer
+		          has not finished yet.
+		 */
+		SteamConnectionState GetConnectionState() const;
+
+		/**
+		  Parks all requests made via SendRequestFor() until the SteamApiInitializer's asynchronous initialization
+		  has finished. They are then sent immediately, or dispatched as failed if Steam failed to initialize.
+		  To be called on the Lua thread after SteamApiInitializer::InitializeAsync().
+		 */
+		void WaitForSteamInitialization();
+
+		/**
+		  Gets how long it took to load the plugin instance that owns this context, as set by the
+		  SetStartupDurationInMicroseconds() method.
+		  @return Returns the duration in microseconds. Returns zero if not set.
+		 */
+		uint64_t GetStartupDurationInMicroseconds() const;
+
+		/**
+		  Sets how long it took to load the plugin instance that owns this context, to be reported to Lua.
+		  @param value The duration in microseconds.
+		 */
+		void SetStartupDurationInMicroseconds(uint64_t value);
+
+		/**
+		  Gets the number of requests made via SendRequestFor() which are parked until Steam reconnects.
+		  @return Returns the number of requests waiting to be sent to Steam.
+		 */
+		uint32_t GetParkedRequestCount() const;
+
+		/**
+		  Gets the number of requests that were parked by SendRequestFor() because Steam was disconnected.
+		  @return Returns the number of parked requests since this context was created.
+		 */
+		uint64_t GetTotalParkedRequestCount() const;
+
+		/**
+		  Gets the number of requests that attached to an identical in-flight Steam call via
+		  AttachToInFlightRequestFor() instead of making their own Steam call.
+		  @return Returns the number of shared requests since this context was created.
+		 */
+		uint64_t GetTotalSingleFlightRequestCount() const;
+
+		/**
+		  Gets the scheduling statistics of the given request category, such as its queue depth and wait times.
+		  @param category The category to fetch statistics for.
+		  @return Returns the category's statistics. Returns zeroed statistics if given kUnknown.
+		 */
+		RuntimeContext::RequestCategoryStatistics GetRequestCategoryStatisticsFor(
+				const SteamRequestCategory& category) const;
+
+		/**
+		  Sets the max number of the given category's requests allowed to wait on Steam at the same time.
+		  Requests exceeding it are queued by SendRequestFor(). Defaults to the category's default concurrency limit.
+		  @param category The category to configure. Ignored if kUnknown.
+		  @param value The max number of concurrent requests. Zero means unlimited.
+		 */
+		void SetRequestConcurrencyLimitFor(const SteamRequestCategory& category, uint32_t value);
+
+		/**
+		  Sets the given category's share of queued requests sent relative to other categories.
+		  Defaults to the category's default weight.
+		  @param category The category to configure. Ignored if kUnknown.
+		  @param value The category's weight. Values less than 1 are treated as 1.
+		 */
+		void SetRequestWeightFor(const SteamRequestCategory& category, uint32_t value);
+
+		/**
+		  Gets the settings deciding if and when the given category's Steam calls are retried after an I/O failure.
+		  @param category The category to fetch the retry policy of.
+		  @return Returns the category's retry policy. Returns a policy with retries disabled if given kUnknown.
+		 */
+		RuntimeContext::RequestRetryPolicy GetRequestRetryPolicyFor(const SteamRequestCategory& category) const;
+
+		/**
+		  Sets the settings deciding if and when the given category's Steam calls are retried after an I/O failure.
+		  Only applies to requests made via SendRequestFor() after this call.
+		  @param category The category to configure. Ignored if kUnknown.
+		  @param policy The retry settings to copy. A "MaxAttemptCount" less than 1 is treated as 1.
+		 */
+		void SetRequestRetryPolicyFor(
+				const SteamRequestCategory& category, const RuntimeContext::RequestRetryPolicy& policy);
+
+		/**
+		  Sets up the given task to deliver its event to the given Lua function when executed, or to resume
+		  the given Lua coroutine with its event table if the request is being awaited by a coroutine.
+		  Must be called on the Lua thread.
+		  @param taskPointer The CCallResult event task to set up. Can be null.
+		  @param luaStatePointer Pointer to the Lua state that the "luaListenerStackIndex" argument references.
+		  @param luaListenerStackIndex Index to the Lua function or coroutine to deliver the event to.
+		                               Can index nil if the result is only delivered via the request's promise.
+		 */
+		static void SetUpRequestListenerFor(
+				BaseDispatchEventTask* taskPointer, lua_State* luaStatePointer, int luaListenerStackIndex);
 
 		/**
 		  Fetches an active RuntimeContext instance that belongs to the given Lua state.
+		  Performs a constant time hash lookup by the runtime's main Lua state.
 		  @param luaStatePointer Lua state that was passed to a RuntimeContext instance's constructor.
+		                         Can also be a Lua coroutine belonging to that runtime.
 		  @return Returns a pointer to a RuntimeContext that belongs to the given Lua state.
 
 		          Returns null if there is no RuntimeContext belonging to the given Lua state, or if there
@@ -185,86 +682,832 @@ class RuntimeContext
 		 */
 		int OnCoronaEnterFrame(lua_State* luatStatePointer);
 
-		template<class TSteamResultType, class TDispatchEventTask>
 		/**
-		  To be called by this class' global steam event handler methods, such as OnSteamGameOverlayActivated().
-		  Pushes the given steam event data to the queue to be dispatched to Lua later once this runtime
-		  context verifies that Corona is currently running (ie: not suspended).
+		  Called when a Lua "system" event has been dispatched.
+		  Used to detect when the Corona runtime has been suspended and resumed.
+		  @param luaStatePointer Pointer to the Lua state that dispatched the event.
+		  @return Returns the number of return values pushed to Lua. Returns 0 if no return values were pushed.
+		 */
+		int OnCoronaSystemEvent(lua_State* luaStatePointer);
 
-		  This is a templatized method.
-		  The 1st template type must be set to the Steam event struct type, such as "GameOverlayActivated_t".
-		  The 2nd template type must be set to a "BaseDispatchEventTask" derived class,
-		  such as the "DispatchGameOverlayActivatedEventTask" class.
-		  @param eventDataPointer Pointer to the Steam event data received. Can be null.
+		/** Called when the Corona runtime has been suspended. Starts buffering global Steam events. */
+		void OnSuspended();
+
+		/**
+		  Called when the Corona runtime has been resumed. Moves all buffered global Steam events to the
+		  pending collection to be dispatched on the next "enterFrame", followed by a "suspendedEventsDropped"
+		  event if any events were dropped while suspended.
 		 */
-		void OnHandleGlobalSteamEvent(TSteamResultType* eventDataPointer);
+		void OnResumed();
 
-		template<class TSteamResultType, class TDispatchEventTask>
 		/**
-		  To be called by this class' global steam event handler methods whose Steam event structure contains
-		  an "m_nGameID" field, such as "UserAchievementStored_t". Will ignore the given Steam event if it
-		  belongs to another game/app by comparing its game ID with this application's Steam app ID.
+		  Queues the given global Steam event task to be dispatched to Lua later.
+		  If the Corona runtime is suspended, then the task will be stored in its event type's bounded buffer instead.
+		  @param taskPointer The task to be queued. Can be null, in which case this method will do nothing.
+		 */
+		void QueueGlobalDispatchEventTask(DispatchEventTaskPointer&& taskPointer);
 
-		  If the given event belongs to this app, then this method pushes the event data to the queue to be
-		  dispatched to Lua later once the runtime context verifies thta Corona is running (ie: not suspended).
+		/**
+		  Moves the given task to the end of the pending lane matching the task's priority.
+		  Must only be called on the Lua thread.
+		  @param taskPointer The task to be dispatched on the next "enterFrame". Can be null, in which case
+		                     this method will do nothing.
+		 */
+		void AddPendingDispatchEventTask(DispatchEventTaskPointer&& taskPointer);
 
-		  This is a templatized method.
-		  The 1st template type must be set to the Steam event struct type, such as "GameOverlayActivated_t".
-		  The 2nd template type must be set to a "BaseDispatchEventTask" derived class,
-		  such as the "DispatchGameOverlayActivatedEventTask" class.
-		  @param eventDataPointer Pointer to the Steam event data received. Can be null.
+		/**
+		  Moves all tasks pushed via QueueDispatchEventTask(), including the overflowed ones, to their pending lanes.
+		  Must only be called on the Lua thread.
 		 */
-		void OnHandleGlobalSteamEventWithGameId(TSteamResultType* eventDataPointer);
+		void MoveQueuedDispatchEventTasksToPendingLanes();
+
+		/**
+		  Removes tasks from the given pending lane which are superseded by a newer task having the same
+		  coalescing key. Only the newest task per key is kept, in its original queued position.
+		  Tasks that do not provide a coalescing key are never removed.
+		  @param taskCollection The "fPendingDispatchEventTaskLanes" lane to be coalesced.
+		 */
+		void CoalescePendingDispatchEventTasks(std::vector<DispatchEventTaskPointer>& taskCollection);
+
+		template<class TSteamResultType, class TDispatchEventTask>
+		/**
+		  Callback given to a SteamCallResultHandler by the AddEventHandlerFor() method.
+		  Owns the task that the CCallResult's data will be copied to, which is returned to its pool
+		  if this callback gets destroyed without being invoked, such as when the request gets aborted.
+		  Small enough to fit within the handler's inline callback storage.
+		 */
+		struct CallResultCallback
+		{
+			/** The runtime context that the request was made on. */
+			RuntimeContext* ContextPointer;
 
-		/** Set up global Steam event handlers via their macros. */
-		STEAM_CALLBACK(RuntimeContext, OnSteamGameOverlayActivated, GameOverlayActivated_t);
-		STEAM_CALLBACK(RuntimeContext, OnSteamMicrotransactionAuthorizationReceived, MicroTxnAuthorizationResponse_t);
-		STEAM_CALLBACK(RuntimeContext, OnSteamUserAchievementStored, UserAchievementStored_t);
-		STEAM_CALLBACK(RuntimeContext, OnSteamUserStatsReceived, UserStatsReceived_t);
-		STEAM_CALLBACK(RuntimeContext, OnSteamUserStatsStored, UserStatsStored_t);
-		STEAM_CALLBACK(RuntimeContext, OnSteamUserStatsUnloaded, UserStatsUnloaded_t);
+			/** Task to receive the CCallResult's data. Already set up with the request's Lua event dispatcher. */
+			typename DispatchEventTaskPool<TDispatchEventTask>::TaskPointer TaskPointer;
 
+			/** Unique ID returned by AddEventHandlerFor() for this request. */
+			uint64_t RequestId;
+
+			void operator()(TSteamResultType* resultPointer, bool hadIOFailure)
+			{
+				ContextPointer->OnHandleCallResult<TSteamResultType, TDispatchEventTask>(
+						RequestId, std::move(TaskPointer), resultPointer, hadIOFailure);
+			}
+		};
 
+		template<class TSteamResultType, class TDispatchEventTask>
 		/**
-		  The main event dispatcher that the plugin's Lua addEventListener() and removeEventListener() functions
-		  are bound to. Used to dispatch global steam events such as "GameOverlayActivated_t".
+		  Sets up a pooled CCallResult handler to receive the result of the given Steam async call and deliver it to
+		  the given task. Used by AddEventHandlerFor() and to replay parked requests under their existing request ID.
+		  Must be called while holding the SteamCallbackPump's mutex.
+		  @param steamCallResultHandle Handle returned by the Steam async call. Must be valid.
+		  @param taskPointer The request's task, already set up with its Lua listener.
+		                     Only moved from if this method succeeds.
+		  @param requestId Unique ID assigned to the request.
+		  @param timeoutInMilliseconds Max time to wait for Steam's result. Zero means no timeout.
+		  @param singleFlightKey The request's "SingleFlightKey" setting. Can be null.
+		  @return Returns true if the handler was set up.
+
+		          Returns false if the CCallResult handler pool is full, in which case the task is left untouched.
 		 */
-		std::shared_ptr<LuaEventDispatcher> fLuaEventDispatcherPointer;
+		bool StartCallResultFor(
+				SteamAPICall_t steamCallResultHandle,
+				typename DispatchEventTaskPool<TDispatchEventTask>::TaskPointer& taskPointer,
+				uint64_t requestId, uint32_t timeoutInMilliseconds, const char* singleFlightKey);
 
-		/** Lua "enterFrame" listener. */
-		LuaMethodCallback<RuntimeContext> fLuaEnterFrameCallback;
+		template<class TSteamResultType, class TDispatchEventTask>
+		/**
+		  Called by a CallResultCallback when a request made via AddEventHandlerFor() has received its result.
+		  Copies the result to the given task and queues it to be dispatched to Lua.
+		  Invoked while the SteamCallbackPump's mutex is held.
+		  @param requestId Unique ID that AddEventHandlerFor() assigned to the request.
+		  @param taskPointer The task that was set up by the AddEventHandlerFor() method.
+		  @param resultPointer Pointer to Steam's result data. Null if the request has timed out, in which case
+		                       the task is dispatched with its "timedOut" flag set.
+		  @param hadIOFailure Set true if there was an I/O failure during the operation. False if succeeded.
+		 */
+		void OnHandleCallResult(
+				uint64_t requestId,
+				typename DispatchEventTaskPool<TDispatchEventTask>::TaskPointer&& taskPointer,
+				TSteamResultType* resultPointer, bool hadIOFailure);
 
 		/**
-		  Queue of task objects used to dispatch various Steam related events to Lua.
-		  Native Steam event callbacks are expected to push their event data to this queue to be dispatched
-		  by this context later and only while the Corona runtime is running (ie: not suspended).
+		  Caches the leaderboard handle received by a successful "LeaderboardFindResult_t" CCallResult,
+		  making it available via the GetCachedLeaderboardHandleByName() method.
+		  Called by OnHandleCallResult() while the SteamCallbackPump's mutex is held.
+		  @param result The CCallResult data received from Steam.
 		 */
-		std::queue<std::shared_ptr<BaseDispatchEventTask>> fDispatchEventTaskQueue;
+		void OnReceivedCallResult(const LeaderboardFindResult_t& result);
 
+		template<class TSteamResultType>
 		/**
-		  Pool of re-usable Steam CCallResult handlers used to receive data from Steam's async API and
-		  queue the results to the "fDispatchEventTaskQueue" to be dispatched as a Lua event later.
+		  Overload of the above method for all other CCallResult types, which does nothing.
+		  Allows OnHandleCallResult() to pick the right method at compile time.
 		 */
-		std::vector<BaseSteamCallResultHandler*> fSteamCallResultHandlerPool;
+		void OnReceivedCallResult(const TSteamResultType&) {}
 
 		/**
-		  Hash table of cached leaderboard handles, using the leaderboard's unique names as a key.
-		  This class' AddEventHandlerFor() method is expected to update this mapping when a succesful
-		  Steam "LeaderboardFindResult_t" event has been received.
+		  Copies the given leaderboard name to a leaderboard event task.
+		  @param taskPointer The leaderboard event task to copy the name to. Can be null.
+		  @param leaderboardName The leaderboard's unique name. Can be null.
 		 */
-		std::unordered_map<std::string, SteamLeaderboard_t> fLeaderboardNameHandleMap;
+		static void CopyLeaderboardNameTo(BaseDispatchLeaderboardEventTask* taskPointer, const char* leaderboardName);
 
-		/** Set true if we need to force Corona to render on the next "enterFrame" event. */
-		bool fWasRenderRequested;
-};
+		/**
+		  Overload of the above method for non-leaderboard event tasks, which does nothing.
+		  Allows AddEventHandlerFor() to pick the right method at compile time.
+		 */
+		static void CopyLeaderboardNameTo(BaseDispatchEventTask*, const char*) {}
 
+		/**
+		  Finds the given Lua function in the "fLuaBatchListenerCollection".
+		  @param luaStatePointer Pointer to the Lua state that the "luaListenerStackIndex" argument references.
+		  @param luaListenerStackIndex Index to the Lua function to search for.
+		  @return Returns the index of the function's Lua registry reference within the collection.
 
-// ------------------------------------------------------------------------------------------
-// Templatized class method defined below to prevent it from being inlined into calling code.
-// ------------------------------------------------------------------------------------------
+		          Returns -1 if the function was not found.
+		 */
+		int IndexOfLuaBatchListener(lua_State* luaStatePointer, int luaListenerStackIndex) const;
+
+		/**
+		  Copies the GetLuaEventDispatcher() object's listener count for the given event to the
+		  "fLuaEventListenerCountCollection" so that it can be read by the SteamCallbackPump's thread.
+		  Must be called on the Lua thread.
+		  @param eventName Name of the event whose listener count has changed.
+		 */
+		void UpdateLuaEventListenerCountFor(const char* eventName);
+
+		/**
+		  Stores the given task in the "fLastStateEventTaskCollection", replacing the stored task having the same
+		  coalescing key, if any. Intended to be given a copy of every received state event, so that the newest state
+		  can be replayed to listeners.
+		  @param taskPointer The state event's task. Ignored if null or if the task is not coalescable.
+		 */
+		void UpdateLastStateEventTask(DispatchEventTaskPointer&& taskPointer);
+
+		/**
+		  Invokes the given Lua listener with the last received state events matching the given event name and filter.
+		  Must be called on the Lua thread without holding the SteamCallbackPump's mutex.
+		  @param luaStatePointer Pointer to the Lua state that the "luaListenerStackIndex" argument references.
+		  @param eventName Name of the state event to replay, such as "overlayStatus".
+		  @param luaListenerStackIndex Index to the Lua function or table to be invoked.
+		  @param filter Determines which of the stored events are replayed to the listener.
+		 */
+		void ReplayLastStateEventsTo(
+				lua_State* luaStatePointer, const char* eventName, int luaListenerStackIndex,
+				const LuaEventFilter& filter);
+
+		/**
+		  Determines if any Lua listener would receive the given global Steam event, including batch listeners.
+		  Must be called while holding the SteamCallbackPump's mutex.
+		  @param luaEventName Name of the global Steam event, such as "overlayStatus".
+		  @return Returns true if at least 1 Lua listener is subscribed to the given event.
+
+		          Returns false if the event does not need to be created and dispatched.
+		 */
+		bool HasLuaEventListenersFor(const char* luaEventName) const;
+
+		/**
+		  Dispatches the given global event to its individual Lua listeners and adds its event table to the arrays
+		  of all batch listeners in the "fLuaBatchListenerDispatchCollection" whose filters match it.
+		  Only builds the event's Lua table if a batch listener or an individual listener wants it.
+		  @param luaStatePointer Pointer to the main Lua state.
+		  @param task The global event to dispatch and batch.
+		  @param luaEventArrayStackIndex Index to the 1st batch listener's Lua event array, followed by the arrays
+		                                 of the other batch listeners in order. Must be a positive index.
+		 */
+		void DispatchAndBatchLuaEvent(
+				lua_State* luaStatePointer, BaseDispatchEventTask& task, int luaEventArrayStackIndex);
+
+		/**
+		  Calls each Lua batch listener in the "fLuaBatchListenerDispatchCollection" with its event array,
+		  unless no events were added to it this frame.
+		  @param luaStatePointer Pointer to the main Lua state.
+		  @param luaEventArrayStackIndex Index to the 1st batch listener's Lua event array, followed by the arrays
+		                                 of the other batch listeners in order. Must be a positive index.
+		 */
+		void DispatchLuaEventBatch(lua_State* luaStatePointer, int luaEventArrayStackIndex);
+
+		/**
+		  Called by AddEventHandlerFor() when it failed to acquire a CCallResult handler from the pool
+		  because its max handler count has been reached. Logs a warning and updates the rejected request count.
+		  @param luaEventName Name of the Lua event that will not be dispatched for the rejected request.
+		 */
+		void OnRequestRejected(const char* luaEventName);
+
+		/**
+		  Stores a request made by AddEventHandlerFor() in the "fPendingRequestCollection".
+		  Must be called while holding the SteamCallbackPump's mutex.
+		  Also counts the request against its category's concurrency limit until removed.
+		  @param requestId Unique ID assigned to the request.
+		  @param handlerPointer The CCallResult handler waiting for the request's result. Cannot be null.
+		  @param timeoutInMilliseconds Max time to wait for Steam's result. Zero means no timeout.
+		  @param categoryIndex Index of the request's SteamRequestCategory.
+		 */
+		void AddPendingRequest(
+				uint64_t requestId, BaseSteamCallResultHandler* handlerPointer,
+				uint32_t timeoutInMilliseconds, uint32_t categoryIndex);
+
+		/**
+		  Removes the given request from the "fPendingRequestCollection", if still there.
+		  Must be called while holding the SteamCallbackPump's mutex.
+		  @param requestId Unique ID that AddEventHandlerFor() assigned to the request.
+		  @return Returns the request's CCallResult handler. Returns null if the request is no longer pending.
+		 */
+		BaseSteamCallResultHandler* RemovePendingRequest(uint64_t requestId);
+
+		/** A request attached to another request's in-flight Steam call via AttachToInFlightRequestFor(). */
+		struct FollowerRequest
+		{
+			/** Unique ID returned by AttachToInFlightRequestFor(). */
+			uint64_t RequestId;
+
+			/**
+			  Task to receive a copy of the in-flight call's result. Set up with the request's Lua listener.
+			  Always of the same task type as the task of the request that made the Steam call.
+			 */
+			DispatchEventTaskPointer TaskPointer;
+
+			/** Set true if the request gave its own timeout, in which case it is detached once "ExpirationTime" is reached. */
+			bool HasTimeout;
+
+			/** Time at which the request times out, regardless of the in-flight call's own timeout. */
+			std::chrono::steady_clock::time_point ExpirationTime;
+		};
+
+		/** A Steam async call made via AddEventHandlerFor() which identical requests can attach to. */
+		struct InFlightRequest
+		{
+			/** Name of the Lua event the call's result is dispatched as. Identifies the call's result type. */
+			const char* LuaEventName;
+
+			/** The normalized arguments given via the "SingleFlightKey" setting. */
+			std::string SingleFlightKey;
+
+			/** ID of the request that made the Steam call and owns its CCallResult handler. */
+			uint64_t LeaderRequestId;
+
+			/**
+			  Set true if the leader request was canceled while followers were attached.
+			  The Steam call is kept alive for the followers, but the leader's event will not be dispatched.
+			 */
+			bool WasLeaderCanceled;
+
+			/** Requests waiting for this call's result, in the order they attached. */
+			std::vector<FollowerRequest> FollowerCollection;
+		};
+
+		/**
+		  Fetches the in-flight Steam call matching the given result type and normalized arguments.
+		  Must be called while holding the SteamCallbackPump's mutex.
+		  @param luaEventName The result type's Lua event name. Expected to be a task class' static "kLuaEventName".
+		  @param singleFlightKey The call's normalized arguments. Can be null.
+		  @return Returns a pointer to the matching call. Returns null if not found.
+		 */
+		InFlightRequest* FindInFlightRequest(const char* luaEventName, const char* singleFlightKey);
+
+		/**
+		  Removes the in-flight call made by the given request from the "fInFlightRequestCollection".
+		  Must be called while holding the SteamCallbackPump's mutex.
+		  @param leaderRequestId ID of the request that made the Steam call.
+		  @param inFlightRequest Receives the removed call and its followers.
+		  @return Returns true if the given request made a shareable call. Returns false if not.
+		 */
+		bool TakeInFlightRequest(uint64_t leaderRequestId, RuntimeContext::InFlightRequest& inFlightRequest);
+
+		/**
+		  Fetches the in-flight Steam call made by the given request, which is kept while the request is retried.
+		  Must be called while holding the SteamCallbackPump's mutex.
+		  @param leaderRequestId ID of the request that made the Steam call.
+		  @return Returns a pointer to the call. Returns null if the request did not make a shareable call.
+		 */
+		InFlightRequest* FindInFlightRequestLedBy(uint64_t leaderRequestId);
+
+		/**
+		  Determines if the given request was canceled while other requests were attached to its Steam call,
+		  in which case the request is only kept until the call's result has been received.
+		  Must be called while holding the SteamCallbackPump's mutex.
+		  @param requestId ID of the request to check.
+		  @return Returns true if the request was canceled. Returns false if not or if it did not make a shared call.
+		 */
+		bool IsCanceledLeaderRequest(uint64_t requestId);
+
+		/**
+		  Cancels the Steam call of a canceled leader request once the last request attached to it is gone.
+		  Does nothing if the leader was not canceled or if requests are still attached to its call.
+		  Must be called while holding the SteamCallbackPump's mutex.
+		  @param leaderRequestId ID of the request that made the Steam call.
+		 */
+		void ReleaseCanceledLeaderRequestIfUnused(uint64_t leaderRequestId);
+
+		/**
+		  Called when canceling a parked or queued request which may be waiting to retry a shareable Steam call.
+		  If other requests are attached to the call, then flags the call's leader as canceled so that the call keeps
+		  being retried for them. Otherwise, removes the call's in-flight entry, if any.
+		  Must be called while holding the SteamCallbackPump's mutex.
+		  @param requestId ID of the request being canceled.
+		  @return Returns true if the request must be kept since other requests depend on it.
+		          Returns false if the caller is expected to remove the request and release its task.
+		 */
+		bool CancelUnsentLeaderRequest(uint64_t requestId);
+
+		/**
+		  Aborts all pending, parked, and attached requests whose timeout has elapsed, dispatching a "timedOut" event
+		  for each of them. Must be called on the Lua thread.
+		 */
+		void TimeOutExpiredRequests();
+
+		template<class TSteamResultType, class TDispatchEventTask>
+		/**
+		  Creates a record of the given request's settings and callback, needed to make its Steam call at a later
+		  time, such as when replaying or retrying it. The record's request ID and task are left unassigned.
+		  @param settings The settings given to SendRequestFor().
+		  @param sendCallback The callback given to SendRequestFor(), which is moved into the returned record.
+		  @return Returns the new record.
+		 */
+		SteamParkedRequest CreateRequestRecordFor(
+				const RuntimeContext::EventHandlerSettings& settings, RuntimeContext::SendRequestCallback&& sendCallback);
+
+		template<class TSteamResultType, class TDispatchEventTask>
+		/**
+		  Creates a request to be parked or queued by SendRequestFor(), which can be sent later via its
+		  "ReplayFunctionPointer". Acquires and sets up the request's task and assigns it a new request ID.
+		  Must be called while holding the SteamCallbackPump's mutex.
+		  @param settings The settings given to SendRequestFor().
+		  @param sendCallback The callback given to SendRequestFor(), which is moved into the returned request.
+		  @return Returns the new request.
+		 */
+		SteamParkedRequest CreateParkedRequestFor(
+				const RuntimeContext::EventHandlerSettings& settings, RuntimeContext::SendRequestCallback&& sendCallback);
+
+		template<class TSteamResultType, class TDispatchEventTask>
+		/**
+		  Sends the given parked request to Steam under its existing request ID, or attaches it to an identical
+		  in-flight call. If the call could not be made, then the request's event is dispatched flagged as an error.
+		  Must be called while holding the SteamCallbackPump's mutex.
+		  @param request The request removed from the "fRequestReplayQueue" or from the "fRequestScheduler".
+		 */
+		void ReplayParkedRequest(SteamParkedRequest& request);
+
+		template<class TSteamResultType, class TDispatchEventTask>
+		/**
+		  Calls the given context's ReplayParkedRequest() method. Assigned to a request's "ReplayFunctionPointer".
+		  @param context The context that created the request.
+		  @param request The request to send.
+		 */
+		static void ReplayParkedRequestOn(RuntimeContext& context, SteamParkedRequest& request);
+
+		/**
+		  Sends all parked requests whose replay time has been reached and switches from kReconnecting to kConnected
+		  once all of them have been sent. Does nothing while disconnected.
+		  Must be called on the Lua thread while holding the SteamCallbackPump's mutex.
+		 */
+		void ReplayParkedRequests();
+
+		/**
+		  Leaves the kInitializing state once the SteamApiInitializer has finished. Schedules all parked requests
+		  to be sent right away if it succeeded. Dispatches them as failed and logs an error if it failed.
+		  Must be called on the Lua thread while holding the SteamCallbackPump's mutex.
+		 */
+		void UpdateSteamInitializationState();
+
+		/**
+		  Sends the given request via its "ReplayFunctionPointer" if its category allows it right away.
+		  Otherwise, moves it to the back of its category's queue in the "fRequestScheduler".
+		  Must be called while holding the SteamCallbackPump's mutex.
+		  @param request The request to send or queue.
+		 */
+		void SendOrQueueRequest(SteamParkedRequest& request);
+
+		/**
+		  Sends the requests handed back by the "fRequestScheduler" until all categories are empty or at their
+		  concurrency limit, in weighted fair order.
+		  Does nothing while Steam is disconnected or initializing.
+		  Must be called on the Lua thread while holding the SteamCallbackPump's mutex.
+		 */
+		void SendQueuedRequests();
+
+		/**
+		  Dispatches the given request's task flagged as an I/O failure, along with the tasks of all requests
+		  attached to its in-flight Steam call, if any. Used when a parked or queued request is given up on
+		  before getting a result from Steam. Must be called while holding the SteamCallbackPump's mutex.
+		  @param request The request to fail. Its task is moved out of it.
+		  @param timedOut Set true to also flag the tasks as timed out.
+		 */
+		void FailUnsentRequest(SteamParkedRequest& request, bool timedOut);
+
+		/**
+		  Updates the connection state and queues a "connectionStatus" event, if any Lua listeners are subscribed.
+		  Must be called while holding the SteamCallbackPump's mutex.
+		  @param state The new connection state.
+		 */
+		void SetConnectionState(const SteamConnectionState& state);
+
+		/**
+		  Releases the given task that will not be dispatched, such as a task that was canceled or failed to be
+		  queued. The task's release is deferred to the next "enterFrame" event since the task's Lua event
+		  dispatcher must only be released on the Lua thread, while this method can be called by any thread.
+		  @param taskPointer The task to be released. Can be null, in which case this method does nothing.
+		 */
+		void DiscardDispatchEventTask(DispatchEventTaskPointer&& taskPointer);
+
+		/**
+		  Dispatches the given request's event task to its Lua listener and then settles the request's promise
+		  with the same Lua event table. Used instead of the task's Execute() method if the request has a promise.
+		  @param luaStatePointer Pointer to the main Lua state.
+		  @param task The request's event task to dispatch.
+		 */
+		void ExecuteAndSettleRequestPromise(lua_State* luaStatePointer, BaseDispatchEventTask& task);
+
+		/** Identifies 1 entry of a request promise aggregate that is waiting on a request's promise. */
+		struct RequestPromiseAggregateMember
+		{
+			/** ID assigned to the aggregate by AddRequestPromiseAggregate(). */
+			uint64_t AggregateId;
+
+			/** 1-based position of the request within the aggregate's request array. */
+			int Index;
+		};
+
+		/**
+		  Updates a request promise aggregate when 1 of its requests has settled and calls its Lua listener
+		  if the aggregate has resolved. Does nothing if the aggregate has already resolved.
+		  @param luaStatePointer Pointer to the Lua state that the "luaEventTableStackIndex" argument references.
+		  @param member Identifies the aggregate and the request's position within it.
+		  @param luaEventTableStackIndex Index to the settled request's Lua event table. Must be a positive index.
+		  @param isError Set true if the settled request's event table is flagged with "isError".
+		 */
+		void OnRequestPromiseAggregateMemberSettled(
+				lua_State* luaStatePointer, const RuntimeContext::RequestPromiseAggregateMember& member,
+				int luaEventTableStackIndex, bool isError);
+
+		/**
+		  Removes a resolved request promise aggregate and calls its Lua listener with the given arguments.
+		  @param luaStatePointer Pointer to the Lua state the arguments were pushed to.
+		  @param aggregateId ID assigned to the aggregate by AddRequestPromiseAggregate().
+		  @param luaArgumentCount Number of arguments at the top of the stack to pass to the listener,
+		                          which are popped off by this method.
+		 */
+		void ResolveRequestPromiseAggregate(lua_State* luaStatePointer, uint64_t aggregateId, int luaArgumentCount);
+
+		template<
+				class TSteamResultType,
+				class TDispatchEventTask = typename SteamEventTraits<TSteamResultType>::DispatchEventTask>
+		/**
+		  To be called by this class' global steam event handler methods, such as OnSteamGameOverlayActivated().
+		  Pushes the given steam event data to the queue to be dispatched to Lua later once this runtime
+		  context verifies that Corona is currently running (ie: not suspended).
+
+		  This is a templatized method.
+		  The 1st template type must be set to the Steam event struct type, such as "GameOverlayActivated_t".
+		  The 2nd template type is optional and defaults to the "BaseDispatchEventTask" derived class
+		  registered for the Steam event type in "SteamEventTraits.h".
+		  @param eventDataPointer Pointer to the Steam event data received. Can be null.
+		 */
+		void OnHandleGlobalSteamEvent(TSteamResultType* eventDataPointer);
+
+		template<
+				class TSteamResultType,
+				class TDispatchEventTask = typename SteamEventTraits<TSteamResultType>::DispatchEventTask>
+		/**
+		  To be called by this class' global steam event handler methods whose Steam event structure contains
+		  an "m_nGameID" field, such as "UserAchievementStored_t". Will ignore the given Steam event if it
+		  belongs to another game/app by comparing its game ID with this application's Steam app ID.
+
+		  If the given event belongs to this app, then this method pushes the event data to the queue to be
+		  dispatched to Lua later once the runtime context verifies thta Corona is running (ie: not suspended).
+
+		  This is a templatized method.
+		  The 1st template type must be set to the Steam event struct type, such as "GameOverlayActivated_t".
+		  The 2nd template type is optional and defaults to the "BaseDispatchEventTask" derived class
+		  registered for the Steam event type in "SteamEventTraits.h".
+		  @param eventDataPointer Pointer to the Steam event data received. Can be null.
+		 */
+		void OnHandleGlobalSteamEventWithGameId(TSteamResultType* eventDataPointer);
+
+		/**
+		  Global Steam event handlers.
+		  Invoked by the process-wide SteamGlobalEventRelay, which receives each global Steam event once
+		  and forwards it to every RuntimeContext instance while the SteamCallbackPump's mutex is held.
+		 */
+		void OnSteamGameOverlayActivated(GameOverlayActivated_t* eventDataPointer);
+		void OnSteamMicrotransactionAuthorizationReceived(MicroTxnAuthorizationResponse_t* eventDataPointer);
+		void OnSteamUserAchievementStored(UserAchievementStored_t* eventDataPointer);
+		void OnSteamUserStatsReceived(UserStatsReceived_t* eventDataPointer);
+		void OnSteamUserStatsStored(UserStatsStored_t* eventDataPointer);
+		void OnSteamUserStatsUnloaded(UserStatsUnloaded_t* eventDataPointer);
+		void OnSteamServersConnected(SteamServersConnected_t* eventDataPointer);
+		void OnSteamServersDisconnected(SteamServersDisconnected_t* eventDataPointer);
+
+		/** Allows the process-wide Steam event listener to forward global Steam events to the above handlers. */
+		friend class SteamGlobalEventRelay;
+
+
+		/**
+		  The main event dispatcher that the plugin's Lua addEventListener() and removeEventListener() functions
+		  are bound to. Used to dispatch global steam events such as "GameOverlayActivated_t".
+		 */
+		std::shared_ptr<LuaEventDispatcher> fLuaEventDispatcherPointer;
+
+		/** Lua "enterFrame" listener. */
+		LuaMethodCallback<RuntimeContext> fLuaEnterFrameCallback;
+
+		/** Lua "system" event listener. */
+		LuaMethodCallback<RuntimeContext> fLuaSystemEventCallback;
+
+		/**
+		  Lock-free queue of task objects used to dispatch various Steam related events to Lua.
+		  Native Steam event callbacks and worker threads are expected to push their event data to this queue
+		  via the QueueDispatchEventTask() method. The queue is drained on the Lua thread by this context's
+		  "enterFrame" listener, which only happens while the Corona runtime is running (ie: not suspended).
+		 */
+		MpscRingBuffer<DispatchEventTaskPointer> fDispatchEventTaskQueue;
+
+		/** Mutex used to synchronize access to the "fOverflowDispatchEventTasks" collection. */
+		std::mutex fOverflowDispatchEventTaskMutex;
+
+		/**
+		  Request results and non-coalescable global events passed to QueueDispatchEventTask() while the
+		  "fDispatchEventTaskQueue" was full.
+		  Drained on the Lua thread right after that queue.
+		 */
+		std::vector<DispatchEventTaskPointer> fOverflowDispatchEventTasks;
+
+		/** Number of tasks in "fOverflowDispatchEventTasks". Lets the Lua thread skip its mutex when it is empty. */
+		std::atomic<size_t> fOverflowDispatchEventTaskCount;
+
+		/**
+		  Tasks moved out of the "fDispatchEventTaskQueue" by the Lua thread which are waiting to be dispatched,
+		  stored in 1 lane per BaseDispatchEventTask::Priority value and indexed by it.
+		  Lanes are dispatched from highest to lowest priority. Tasks are coalesced in their lane before being
+		  dispatched and tasks which did not fit within the dispatch time budget remain here, in order,
+		  until the next "enterFrame" event.
+		  Dispatched tasks are released back to their pools in bulk after the dispatch loop.
+		  Must only be accessed on the Lua thread.
+		 */
+		std::vector<DispatchEventTaskPointer> fPendingDispatchEventTaskLanes[BaseDispatchEventTask::kPriorityCount];
+
+		/** Bounded buffer of global Steam events of 1 type, received while the Corona runtime is suspended. */
+		struct SuspendedEventBuffer
+		{
+			/** Name of the Lua event this buffer stores. Expected to be a task class' static "kLuaEventName". */
+			const char* LuaEventName;
+
+			/** Buffered tasks, in the order they were received. */
+			std::deque<DispatchEventTaskPointer> TaskCollection;
+
+			/** Number of events of this type dropped since the runtime was suspended. */
+			uint32_t DroppedEventCount;
+		};
+
+		/** Set true while the Corona runtime is suspended. Read by producer threads. */
+		std::atomic<bool> fIsSuspended;
+
+		/**
+		  Mutex used to synchronize access to the suspended event buffers and their settings.
+		  Also held while flushing the buffers on resume to keep producers from queuing events out of order.
+		 */
+		std::mutex fSuspendedEventBufferMutex;
+
+		/**
+		  Buffers of global Steam events received while suspended. Only 1 buffer per Lua event name.
+		  Note: A deque is used since it never moves its buffers, which are not copyable.
+		 */
+		std::deque<SuspendedEventBuffer> fSuspendedEventBufferCollection;
+
+		/** Max number of events stored per suspended event buffer. */
+		uint32_t fSuspendedEventCapacity;
+
+		/** Policy deciding which events are dropped when a suspended event buffer is full. */
+		EventOverflowPolicy fSuspendedEventOverflowPolicy;
+
+		/** Total number of global Steam events dropped because a suspended event buffer was full. */
+		uint64_t fTotalDroppedSuspendedEventCount;
+
+		/** A Lua function added via AddLuaBatchListener(). */
+		struct LuaBatchListener
+		{
+			/** Lua registry reference to the function. */
+			int LuaReferenceId;
+
+			/** Determines which global events are added to the function's batches. */
+			LuaEventFilter Filter;
+
+			/** Number of events added to the function's batch this frame. Only used by the dispatch copy. */
+			int EventCount;
+		};
+
+		/** Number of Lua listeners subscribed to 1 global Steam event. */
+		struct LuaEventListenerCount
+		{
+			/** Name of the global Steam event. */
+			std::string LuaEventName;
+
+			/** Number of Lua listeners added for the event via AddLuaEventListener(). */
+			int Count;
+		};
+
+		/**
+		  Native listener count per global Steam event name.
+		  Written on the Lua thread and read by Steam event handlers, all while holding the SteamCallbackPump's mutex.
+		  Note: There are only a handful of global event names, which is why a vector is linearly searched.
+		 */
+		std::vector<LuaEventListenerCount> fLuaEventListenerCountCollection;
+
+		/**
+		  Copy of the newest task received per state event and coalescing key, such as the last "overlayStatus" event
+		  and the last "userProgressUpdate" event per user. Stored even if no Lua listener is subscribed to them.
+		  Replayed to Lua listeners added with the "replayLast" option. Guarded by the SteamCallbackPump's mutex.
+		  Note: There are only a handful of state events, which is why a vector is linearly searched.
+		 */
+		std::vector<DispatchEventTaskPointer> fLastStateEventTaskCollection;
+
+		/** Number of functions in "fLuaBatchListenerCollection". Guarded by the SteamCallbackPump's mutex. */
+		size_t fLuaBatchListenerCount;
+
+		/** Number of global Steam events ignored due to having no listeners. Guarded by the SteamCallbackPump's mutex. */
+		uint64_t fTotalUnobservedEventCount;
+
+		/** Functions added via AddLuaBatchListener() and their filters, in the order they were added. Lua thread only. */
+		std::vector<LuaBatchListener> fLuaBatchListenerCollection;
+
+		/**
+		  Copy of "fLuaBatchListenerCollection" made at the start of each frame's dispatch, which collects the number
+		  of events batched per listener. Allows Lua listeners to add or remove batch listeners during the dispatch.
+		  Kept as a member to re-use its memory.
+		 */
+		std::vector<LuaBatchListener> fLuaBatchListenerDispatchCollection;
+
+		/** Mutex used to synchronize access to the "fDiscardedDispatchEventTasks" collection. */
+		std::mutex fDiscardedDispatchEventTasksMutex;
+
+		/** Tasks passed to DiscardDispatchEventTask() that are waiting to be released on the Lua thread. */
+		std::vector<DispatchEventTaskPointer> fDiscardedDispatchEventTasks;
+
+		/** Coalescing keys found by CoalescePendingDispatchEventTasks(). Kept as a member to re-use its memory. */
+		std::vector<BaseDispatchEventTask::CoalescingKey> fCoalescingKeyCollection;
+
+		/**
+		  Pool of re-usable Steam CCallResult handlers used to receive data from Steam's async API and
+		  queue the results to the "fDispatchEventTaskQueue" to be dispatched as a Lua event later.
+		 */
+		SteamCallResultHandlerPool fSteamCallResultHandlerPool;
+
+		/**
+		  Hash table of cached leaderboard handles, using the leaderboard's unique names as a key.
+		  This class' AddEventHandlerFor() method is expected to update this mapping when a succesful
+		  Steam "LeaderboardFindResult_t" event has been received.
+		  Must only be accessed while holding the SteamCallbackPump's mutex.
+		 */
+		std::unordered_map<std::string, SteamLeaderboard_t> fLeaderboardNameHandleMap;
+
+		/** Set true if we need to force Corona to render on the next "enterFrame" event. */
+		bool fWasRenderRequested;
+
+		/** Max number of microseconds to spend dispatching queued events per frame. Zero means unlimited. */
+		uint32_t fDispatchTimeBudgetInMicroseconds;
+
+		/** Number of queued events left in the queue by the last "enterFrame" due to the dispatch time budget. */
+		uint32_t fLastCarriedOverEventCount;
+
+		/** Total number of queued events carried over to the next frame due to the dispatch time budget. */
+		uint64_t fTotalCarriedOverEventCount;
+
+		/** Total number of queued events discarded in favor of a newer event having the same coalescing key. */
+		uint64_t fTotalCoalescedEventCount;
+
+		/** Number of AddEventHandlerFor() calls rejected because the CCallResult handler pool was full. */
+		uint64_t fRejectedRequestCount;
+
+		/** A request made via AddEventHandlerFor() which is still waiting for Steam's result. */
+		struct PendingRequest
+		{
+			/** Unique ID returned by AddEventHandlerFor(). */
+			uint64_t RequestId;
+
+			/** The CCallResult handler waiting for the request's result. */
+			BaseSteamCallResultHandler* HandlerPointer;
+
+			/** Index of the request's SteamRequestCategory. Set to SteamRequestCategory::kCount if uncategorized. */
+			uint32_t CategoryIndex;
+
+			/** Set true if the request has a timeout, in which case "ExpirationTime" is valid. */
+			bool HasTimeout;
+
+			/** Time at which the request times out. */
+			std::chrono::steady_clock::time_point ExpirationTime;
+		};
+
+		/**
+		  Requests that are waiting for Steam's result. Entries are removed when a result is received,
+		  when canceled via CancelRequest(), or when timed out.
+		  Must only be accessed while holding the SteamCallbackPump's mutex.
+		 */
+		std::vector<PendingRequest> fPendingRequestCollection;
+
+		/** Number of entries in "fPendingRequestCollection" having a timeout. Allows skipping the expiration scan. */
+		size_t fTimedPendingRequestCount;
+
+		/** The last ID assigned to a request by AddEventHandlerFor(). Guarded by the SteamCallbackPump's mutex. */
+		uint64_t fLastRequestId;
+
+		/** Number of requests aborted because their timeout elapsed. Guarded by the SteamCallbackPump's mutex. */
+		uint64_t fTotalTimedOutRequestCount;
+
+		/**
+		  The poll count last observed by this context's "enterFrame" listener.
+		  Passed to SteamCallbackPump::PollFromFrame() so that all contexts share 1 Steam poll per frame.
+		 */
+		uint64_t fLastObservedPollCount;
+
+		/**
+		  Shareable Steam calls which have not received their result yet.
+		  Note: Only identical requests made within the same window of time are in here, which is why a vector
+		        is linearly searched. Must only be accessed while holding the SteamCallbackPump's mutex.
+		 */
+		std::vector<InFlightRequest> fInFlightRequestCollection;
+
+		/** Number of requests that attached to an in-flight Steam call. Guarded by the SteamCallbackPump's mutex. */
+		uint64_t fTotalSingleFlightRequestCount;
+
+		/** The current Steam connection state. Guarded by the SteamCallbackPump's mutex. */
+		SteamConnectionState fConnectionState;
+
+		/**
+		  Requests parked while Steam was disconnected or waiting to retry their Steam call, along with the
+		  retry policy of each request category. Must only be accessed while holding the SteamCallbackPump's mutex.
+		 */
+		SteamRequestReplayQueue fRequestReplayQueue;
+
+		/** Microseconds it took to load the plugin instance that owns this context. */
+		uint64_t fStartupDurationInMicroseconds;
+
+		/**
+		  Limits the number of concurrent requests of each request category and queues the rest.
+		  Must only be accessed while holding the SteamCallbackPump's mutex.
+		 */
+		SteamRequestScheduler fRequestScheduler;
+
+		/** Native promise of a request created via AddRequestPromise(). */
+		struct RequestPromise
+		{
+			/** Set true once settled with the request's event table. */
+			bool IsSettled;
+
+			/** Set true if the settled event table is flagged with "isError". */
+			bool IsError;
+
+			/** Lua registry reference to the settled event table. Set to LUA_NOREF until settled. */
+			int LuaEventReferenceId;
+
+			/** Lua registry references to the functions waiting for this promise to settle. */
+			std::vector<int> LuaCallbackReferenceIds;
+
+			/** Aggregates waiting for this promise to settle. */
+			std::vector<RequestPromiseAggregateMember> AggregateMembers;
+		};
+
+		/**
+		  Promises of requests whose handles were returned to Lua, keyed by request ID.
+		  Must only be accessed on the Lua thread.
+		 */
+		std::unordered_map<uint64_t, RequestPromise> fRequestPromiseCollection;
+
+		/** Group of request promises created via AddRequestPromiseAggregate() that resolves once. */
+		struct RequestPromiseAggregate
+		{
+			/** Determines when this aggregate resolves. */
+			PromiseAggregateType Type;
+
+			/** Number of requests that have not settled yet, or have not succeeded yet for kAny aggregates. */
+			size_t PendingRequestCount;
+
+			/** Lua registry reference to the function to be called when this aggregate resolves. */
+			int LuaListenerReferenceId;
+
+			/** Lua registry reference to the caller's request handle array, keeping its promises alive. */
+			int LuaHandleArrayReferenceId;
+
+			/** Lua registry reference to the array collecting the settled event tables. Only used by kAll. */
+			int LuaEventArrayReferenceId;
+		};
+
+		/**
+		  Request promise aggregates that have not resolved yet, keyed by the ID assigned to them.
+		  Must only be accessed on the Lua thread.
+		 */
+		std::unordered_map<uint64_t, RequestPromiseAggregate> fRequestPromiseAggregateCollection;
+
+		/** The last ID assigned to an aggregate by AddRequestPromiseAggregate(). */
+		uint64_t fLastRequestPromiseAggregateId;
+};
+
+
+// ------------------------------------------------------------------------------------------
+// Templatized class method defined below to prevent it from being inlined into calling code.
+// ------------------------------------------------------------------------------------------
 
 template<class TSteamResultType, class TDispatchEventTask>
-bool RuntimeContext::AddEventHandlerFor(
+uint64_t RuntimeContext::AddEventHandlerFor(
 	const RuntimeContext::EventHandlerSettings& settings)
 {
 	// Triggers a compiler error if "TDispatchEventTask" does not derive from "BaseDispatchCallResultEventTask".
@@ -276,108 +1519,397 @@ bool RuntimeContext::AddEventHandlerFor(
 	// Validate arguments.
 	if (!settings.LuaStatePointer || !settings.LuaFunctionStackIndex)
 	{
-		return false;
+		return 0;
 	}
 	if (k_uAPICallInvalid == settings.SteamCallResultHandle)
 	{
-		return false;
+		return 0;
 	}
 	
-	// Attempt to fetch an unused Steam CCallResult handler from the pool.
-	BaseSteamCallResultHandler* handlerPointer = nullptr;
-	const std::type_info& handlerType = typeid(SteamCallResultHandler<TSteamResultType>);
-	for (auto nextHandlerPointer : fSteamCallResultHandlerPool)
+	// Block the SteamCallbackPump's thread, if running, while we register a CCallResult with Steam below.
+	std::lock_guard<std::recursive_mutex> scopedLock(SteamCallbackPump::GetMutex());
+
+	// Fetch an event dispatcher task from its pool and set it up now, while we're on the Lua thread.
+	// This allows the handler's callback to only capture the task, which fits within its inline callback storage.
+	// Pooled tasks keep their memory capacity, so this does not allocate memory once the pool has warmed up.
+	auto taskPointer = DispatchEventTaskPool<TDispatchEventTask>::GetInstance().Acquire();
+	RuntimeContext::SetUpRequestListenerFor(
+			taskPointer.get(), settings.LuaStatePointer, settings.LuaFunctionStackIndex);
+	RuntimeContext::CopyLeaderboardNameTo(taskPointer.get(), settings.LeaderboardName);
+
+	// Start listening for the async Steam result.
+	// Note: If rejected, then the task is released here, which also releases its Lua listener.
+	auto requestId = ++fLastRequestId;
+	bool wasStarted = StartCallResultFor<TSteamResultType, TDispatchEventTask>(
+			settings.SteamCallResultHandle, taskPointer, requestId,
+			settings.TimeoutInMilliseconds, settings.SingleFlightKey);
+	return wasStarted ? requestId : 0;
+}
+
+template<class TSteamResultType, class TDispatchEventTask>
+bool RuntimeContext::StartCallResultFor(
+	SteamAPICall_t steamCallResultHandle,
+	typename DispatchEventTaskPool<TDispatchEventTask>::TaskPointer& taskPointer,
+	uint64_t requestId, uint32_t timeoutInMilliseconds, const char* singleFlightKey)
+{
+	// Fetch an unused Steam CCallResult handler from the pool. Will create a new one if none are available.
+	auto handlerPointer = fSteamCallResultHandlerPool.Acquire<TSteamResultType>();
+	if (!handlerPointer)
 	{
-		if (nextHandlerPointer && (typeid(*nextHandlerPointer) == handlerType))
-		{
-			if (nextHandlerPointer->IsNotWaitingForResult())
-			{
-				handlerPointer = nextHandlerPointer;
-				break;
-			}
-		}
+		OnRequestRejected(TDispatchEventTask::kLuaEventName);
+		return false;
 	}
 
-	// If an unused Steam CCallResult handler was not found in the pool above, then create a new one.
-	if (!handlerPointer)
+	// Create a callback to be invoked when the async operation completes.
+	// Note: If the operation gets aborted, then the callback and its captured task will be destroyed without
+	//       being invoked, which returns the task to its pool. The pool releases the task's Lua event dispatcher.
+	CallResultCallback<TSteamResultType, TDispatchEventTask> callback;
+	callback.ContextPointer = this;
+	callback.TaskPointer = std::move(taskPointer);
+	callback.RequestId = requestId;
+	callback.TaskPointer->SetRequestId(requestId);
+	AddPendingRequest(
+			requestId, handlerPointer, timeoutInMilliseconds,
+			SteamEventTraits<TSteamResultType>::GetRequestCategory().GetIndex());
+
+	// Set up the Steam CCallResult handler to start listening for the async Steam result.
+	// Will invoke the above callback when the async operation ends, pushing the result to the event queue.
+	handlerPointer->Handle(steamCallResultHandle, std::move(callback));
+
+	// If shareable, let identical requests attach to this Steam call until its result has been received.
+	// Note: A retried request keeps its call's existing entry, along with the requests attached to it.
+	if (singleFlightKey && !FindInFlightRequestLedBy(requestId))
 	{
-		handlerPointer = new SteamCallResultHandler<TSteamResultType>();
-		if (!handlerPointer)
+		InFlightRequest inFlightRequest;
+		inFlightRequest.LuaEventName = TDispatchEventTask::kLuaEventName;
+		inFlightRequest.SingleFlightKey = singleFlightKey;
+		inFlightRequest.LeaderRequestId = requestId;
+		inFlightRequest.WasLeaderCanceled = false;
+		fInFlightRequestCollection.push_back(std::move(inFlightRequest));
+	}
+	return true;
+}
+
+template<class TSteamResultType, class TDispatchEventTask>
+uint64_t RuntimeContext::SendRequestFor(
+	const RuntimeContext::EventHandlerSettings& settings, RuntimeContext::SendRequestCallback&& sendCallback)
+{
+	// Triggers a compiler error if "TDispatchEventTask" does not derive from "BaseDispatchCallResultEventTask".
+	static_assert(
+			std::is_base_of<BaseDispatchCallResultEventTask, TDispatchEventTask>::value,
+			"SendRequestFor<TSteamResultType, TDispatchEventTask>() method's 'TDispatchEventTask' type "
+			"must be set to a class type derived from the 'BaseDispatchCallResultEventTask' class.");
+
+	// Validate arguments.
+	if (!settings.LuaStatePointer || !settings.LuaFunctionStackIndex || !sendCallback)
+	{
+		return 0;
+	}
+
+	// Block the SteamCallbackPump's thread, if running, since it updates the connection state.
+	std::lock_guard<std::recursive_mutex> scopedLock(SteamCallbackPump::GetMutex());
+
+	// If Steam is disconnected, then park the request instead of sending it to Steam, where it would only fail.
+	// Requests made while still replaying parked requests are parked behind them so that they are not starved.
+	if (fConnectionState != SteamConnectionState::kConnected)
+	{
+		auto request = CreateParkedRequestFor<TSteamResultType, TDispatchEventTask>(settings, std::move(sendCallback));
+		auto requestId = request.RequestId;
+		if (fConnectionState == SteamConnectionState::kReconnecting)
 		{
-			return false;
+			fRequestReplayQueue.ScheduleReplay(request);
 		}
-		fSteamCallResultHandlerPool.push_back(handlerPointer);
+		fRequestReplayQueue.Park(request);
+		return requestId;
+	}
+
+	// Share an identical Steam call that is already in flight, if any.
+	auto requestId = AttachToInFlightRequestFor<TSteamResultType, TDispatchEventTask>(settings);
+	if (requestId)
+	{
+		return requestId;
+	}
+
+	// If the request's category has reached its concurrency limit, then queue it until one of its requests completes.
+	// Also queue it if others of its category are already queued, so that it doesn't jump ahead of them.
+	if (!fRequestScheduler.CanSendNowIn(SteamEventTraits<TSteamResultType>::GetRequestCategory().GetIndex()))
+	{
+		auto request = CreateParkedRequestFor<TSteamResultType, TDispatchEventTask>(settings, std::move(sendCallback));
+		requestId = request.RequestId;
+		fRequestScheduler.Enqueue(request);
+		return requestId;
 	}
 
-	// Set up a temporary Lua event dispatcher used to call the given Lua function when the operation completes.
-	auto luaEventDispatcherPointer = std::make_shared<LuaEventDispatcher>(settings.LuaStatePointer);
-	auto eventName = TDispatchEventTask::kLuaEventName;
-	luaEventDispatcherPointer->AddEventListener(
-			settings.LuaStatePointer, eventName, settings.LuaFunctionStackIndex);
-	auto queuingEventTaskCallback = settings.QueuingEventTaskCallback;
-	auto callback =
-			[this, luaEventDispatcherPointer, queuingEventTaskCallback]
-			(TSteamResultType* resultPointer, bool hadIOFailure)->void
+	// Make the Steam call and listen for its result.
+	auto sendSettings = settings;
+	sendSettings.SteamCallResultHandle = sendCallback();
+	requestId = AddEventHandlerFor<TSteamResultType, TDispatchEventTask>(sendSettings);
+
+	// Keep what's needed to make the Steam call again if its category retries I/O failures.
+	const uint32_t categoryIndex = SteamEventTraits<TSteamResultType>::GetRequestCategory().GetIndex();
+	if (requestId && fRequestReplayQueue.IsRetryEnabledIn(categoryIndex))
+	{
+		auto request = CreateRequestRecordFor<TSteamResultType, TDispatchEventTask>(settings, std::move(sendCallback));
+		request.RequestId = requestId;
+		request.AttemptCount = 1;
+		fRequestReplayQueue.AddRetryableRequest(request);
+	}
+	return requestId;
+}
+
+template<class TSteamResultType, class TDispatchEventTask>
+SteamParkedRequest RuntimeContext::CreateParkedRequestFor(
+	const RuntimeContext::EventHandlerSettings& settings, RuntimeContext::SendRequestCallback&& sendCallback)
+{
+	// Copy everything needed to make the Steam call later.
+	auto request = CreateRequestRecordFor<TSteamResultType, TDispatchEventTask>(settings, std::move(sendCallback));
+
+	// Set up a task to receive the request's result now, while we're on the Lua thread.
+	auto taskPointer = DispatchEventTaskPool<TDispatchEventTask>::GetInstance().Acquire();
+	RuntimeContext::SetUpRequestListenerFor(
+			taskPointer.get(), settings.LuaStatePointer, settings.LuaFunctionStackIndex);
+	RuntimeContext::CopyLeaderboardNameTo(taskPointer.get(), settings.LeaderboardName);
+	request.RequestId = ++fLastRequestId;
+	taskPointer->SetRequestId(request.RequestId);
+	request.TaskPointer = std::move(taskPointer);
+	return request;
+}
+
+template<class TSteamResultType, class TDispatchEventTask>
+SteamParkedRequest RuntimeContext::CreateRequestRecordFor(
+	const RuntimeContext::EventHandlerSettings& settings, RuntimeContext::SendRequestCallback&& sendCallback)
+{
+	SteamParkedRequest request;
+	request.RequestId = 0;
+	request.SendCallback = std::move(sendCallback);
+	request.ReplayFunctionPointer = &RuntimeContext::ReplayParkedRequestOn<TSteamResultType, TDispatchEventTask>;
+	request.HasSingleFlightKey = (settings.SingleFlightKey != nullptr);
+	if (settings.SingleFlightKey)
 	{
-		// Validate.
-		if (!resultPointer)
+		request.SingleFlightKey = settings.SingleFlightKey;
+	}
+	request.HasTimeout = (settings.TimeoutInMilliseconds > 0);
+	if (request.HasTimeout)
+	{
+		request.ExpirationTime =
+				std::chrono::steady_clock::now() + std::chrono::milliseconds(settings.TimeoutInMilliseconds);
+	}
+	request.IsReplayScheduled = false;
+	request.CategoryIndex = SteamEventTraits<TSteamResultType>::GetRequestCategory().GetIndex();
+	request.AttemptCount = 0;
+	return request;
+}
+
+template<class TSteamResultType, class TDispatchEventTask>
+void RuntimeContext::ReplayParkedRequest(SteamParkedRequest& request)
+{
+	// Take back ownership of the task with its concrete type.
+	// Note: The task was acquired from this type's pool by SendRequestFor(), which specialized this method with it.
+	typename DispatchEventTaskPool<TDispatchEventTask>::TaskPointer taskPointer(
+			static_cast<TDispatchEventTask*>(request.TaskPointer.release()));
+	if (!taskPointer)
+	{
+		return;
+	}
+
+	// Share an identical Steam call that is already in flight, such as one replayed by another parked request.
+	// Note: A retried request finds its own call's entry, which it keeps instead of attaching to it.
+	if (request.HasSingleFlightKey)
+	{
+		auto inFlightRequestPointer =
+				FindInFlightRequest(TDispatchEventTask::kLuaEventName, request.SingleFlightKey.c_str());
+		if (inFlightRequestPointer && (inFlightRequestPointer->LeaderRequestId != request.RequestId))
 		{
+			FollowerRequest followerRequest;
+			followerRequest.RequestId = request.RequestId;
+			followerRequest.TaskPointer = std::move(taskPointer);
+			followerRequest.HasTimeout = request.HasTimeout;
+			followerRequest.ExpirationTime = request.ExpirationTime;
+			inFlightRequestPointer->FollowerCollection.push_back(std::move(followerRequest));
+			fTotalSingleFlightRequestCount++;
 			return;
 		}
+	}
 
-		// If this is a leaderboard fetch request, then cache the received leaderboard handle before handling the event.
-		// This handle is needed to fetch leaderboard entries and uploading scores to Steam.
-		// These handles can be fetched by leaderboard name via this class' GetCachedLeaderboardHandleByName() method.
-		if (typeid(*resultPointer) == typeid(LeaderboardFindResult_t))
+	// Only wait for whatever is left of the request's timeout, which started when the request was parked.
+	uint32_t timeoutInMilliseconds = 0;
+	if (request.HasTimeout)
+	{
+		auto remainingTime = std::chrono::duration_cast<std::chrono::milliseconds>(
+				request.ExpirationTime - std::chrono::steady_clock::now()).count();
+		timeoutInMilliseconds = (remainingTime > 1) ? (uint32_t)remainingTime : 1;
+	}
+
+	// Make the Steam call and listen for its result under the request's existing ID.
+	auto steamCallResultHandle = request.SendCallback();
+	if (k_uAPICallInvalid != steamCallResultHandle)
+	{
+		request.AttemptCount++;
+		bool wasStarted = StartCallResultFor<TSteamResultType, TDispatchEventTask>(
+				steamCallResultHandle, taskPointer, request.RequestId, timeoutInMilliseconds,
+				request.HasSingleFlightKey ? request.SingleFlightKey.c_str() : nullptr);
+		if (wasStarted)
 		{
-			auto steamUserStatsPointer = SteamUserStats();
-			auto leaderboardResultPointer = (LeaderboardFindResult_t*)resultPointer;
-			if (leaderboardResultPointer->m_bLeaderboardFound && steamUserStatsPointer)
+			// Keep the request's record in case its category retries the call after an I/O failure.
+			if (fRequestReplayQueue.IsRetryEnabledIn(request.CategoryIndex))
 			{
-				auto name = steamUserStatsPointer->GetLeaderboardName(leaderboardResultPointer->m_hSteamLeaderboard);
-				if (name)
-				{
-					this->fLeaderboardNameHandleMap[std::string(name)] = leaderboardResultPointer->m_hSteamLeaderboard;
-				}
+				fRequestReplayQueue.AddRetryableRequest(request);
 			}
+			return;
 		}
+	}
+
+	// The request could not be sent. Since the caller was already given a request handle,
+	// dispatch the task's default data flagged as an error instead of dropping it silently.
+	request.TaskPointer = std::move(taskPointer);
+	FailUnsentRequest(request, false);
+}
+
+template<class TSteamResultType, class TDispatchEventTask>
+void RuntimeContext::ReplayParkedRequestOn(RuntimeContext& context, SteamParkedRequest& request)
+{
+	context.ReplayParkedRequest<TSteamResultType, TDispatchEventTask>(request);
+}
+
+template<class TSteamResultType, class TDispatchEventTask>
+uint64_t RuntimeContext::AttachToInFlightRequestFor(const RuntimeContext::EventHandlerSettings& settings)
+{
+	// Triggers a compiler error if "TDispatchEventTask" does not derive from "BaseDispatchCallResultEventTask".
+	static_assert(
+			std::is_base_of<BaseDispatchCallResultEventTask, TDispatchEventTask>::value,
+			"AttachToInFlightRequestFor<TSteamResultType, TDispatchEventTask>() method's 'TDispatchEventTask' type "
+			"must be set to a class type derived from the 'BaseDispatchCallResultEventTask' class.");
+
+	// Validate arguments.
+	if (!settings.LuaStatePointer || !settings.LuaFunctionStackIndex || !settings.SingleFlightKey)
+	{
+		return 0;
+	}
+
+	// Fetch the matching Steam call, if still in flight.
+	// Note: Its result is received while holding this mutex, which keeps it from completing while we attach.
+	std::lock_guard<std::recursive_mutex> scopedLock(SteamCallbackPump::GetMutex());
+	auto inFlightRequestPointer = FindInFlightRequest(TDispatchEventTask::kLuaEventName, settings.SingleFlightKey);
+	if (!inFlightRequestPointer)
+	{
+		return 0;
+	}
+
+	// Set up a task to receive a copy of the call's result, just like AddEventHandlerFor() would.
+	auto taskPointer = DispatchEventTaskPool<TDispatchEventTask>::GetInstance().Acquire();
+	RuntimeContext::SetUpRequestListenerFor(
+			taskPointer.get(), settings.LuaStatePointer, settings.LuaFunctionStackIndex);
+	RuntimeContext::CopyLeaderboardNameTo(taskPointer.get(), settings.LeaderboardName);
+
+	// Attach the request to the in-flight call.
+	FollowerRequest followerRequest;
+	followerRequest.RequestId = ++fLastRequestId;
+	taskPointer->SetRequestId(followerRequest.RequestId);
+	followerRequest.TaskPointer = std::move(taskPointer);
+	followerRequest.HasTimeout = (settings.TimeoutInMilliseconds > 0);
+	if (followerRequest.HasTimeout)
+	{
+		followerRequest.ExpirationTime =
+				std::chrono::steady_clock::now() + std::chrono::milliseconds(settings.TimeoutInMilliseconds);
+	}
+	inFlightRequestPointer->FollowerCollection.push_back(std::move(followerRequest));
+	fTotalSingleFlightRequestCount++;
+	return fLastRequestId;
+}
 
-		// Create and configure the event dispatcher task.
-		auto taskPointer = new TDispatchEventTask();
-		if (!taskPointer)
+template<class TSteamResultType, class TDispatchEventTask>
+void RuntimeContext::OnHandleCallResult(
+	uint64_t requestId,
+	typename DispatchEventTaskPool<TDispatchEventTask>::TaskPointer&& taskPointer,
+	TSteamResultType* resultPointer, bool hadIOFailure)
+{
+	// The request is no longer pending. (Already removed if it timed out.)
+	RemovePendingRequest(requestId);
+
+	// If the Steam call had an I/O failure, then make it again later if the request's retry policy allows it.
+	// Its in-flight entry is kept so that attached requests also only receive the final outcome.
+	uint32_t attemptCount = 1;
+	{
+		SteamParkedRequest request;
+		if (fRequestReplayQueue.TakeRetryableRequest(requestId, request))
 		{
-			return;
+			attemptCount = request.AttemptCount;
+			if (resultPointer && hadIOFailure && taskPointer && fRequestReplayQueue.TryConsumeRetryFor(request))
+			{
+				request.TaskPointer = std::move(taskPointer);
+				fRequestReplayQueue.ParkForRetry(
+						request,
+						(fConnectionState != SteamConnectionState::kDisconnected) &&
+						(fConnectionState != SteamConnectionState::kInitializing));
+				return;
+			}
 		}
-		auto sharedTaskPointer = std::shared_ptr<BaseDispatchEventTask>(taskPointer);
-		taskPointer->SetLuaEventDispatcher(luaEventDispatcherPointer);
-		taskPointer->SetHadIOFailure(hadIOFailure);
-		taskPointer->AcquireEventDataFrom(*resultPointer);
+	}
 
-		// Notify the caller of AddEventHandlerFor() about this new task, if a callback was configured.
-		if (queuingEventTaskCallback)
+	// Let this context post-process the result before handling the event, such as caching a leaderboard handle.
+	// Done before anything else, so that it happens even if the leader was canceled after followers attached.
+	// Note: The overload matching the result's type is selected at compile time.
+	if (resultPointer)
+	{
+		OnReceivedCallResult(*resultPointer);
+	}
+
+	// Fan the result out to the requests that attached to this request's Steam call, if any.
+	// Note: Followers share the same task type, which was verified via the call's Lua event name when attaching.
+	bool wasLeaderCanceled = false;
+	if (!fInFlightRequestCollection.empty())
+	{
+		InFlightRequest inFlightRequest;
+		if (TakeInFlightRequest(requestId, inFlightRequest))
 		{
-			// Invoke the given callback.
-			QueuingEventTaskCallbackArguments callbackArguments;
-			callbackArguments.TaskPointer = taskPointer;
-			callbackArguments.IsCanceled = false;
-			queuingEventTaskCallback(callbackArguments);
-
-			// Do not queue the event dispatcher task if canceled by the callback.
-			// Note: The shared pointer which wraps the task pointer will auto delete it for us.
-			if (callbackArguments.IsCanceled)
+			wasLeaderCanceled = inFlightRequest.WasLeaderCanceled;
+			for (auto&& followerRequest : inFlightRequest.FollowerCollection)
 			{
-				return;
+				auto followerTaskPointer = static_cast<TDispatchEventTask*>(followerRequest.TaskPointer.get());
+				followerTaskPointer->SetAttemptCount(attemptCount);
+				if (resultPointer)
+				{
+					followerTaskPointer->SetHadIOFailure(hadIOFailure);
+					followerTaskPointer->AcquireEventDataFrom(*resultPointer);
+				}
+				else
+				{
+					followerTaskPointer->SetHadIOFailure(true);
+					followerTaskPointer->SetTimedOut(true);
+				}
+				QueueDispatchEventTask(std::move(followerRequest.TaskPointer));
 			}
 		}
+	}
 
-		// Queue the received Steam event data to be dispatched to Lua later.
-		// This ensures that Lua events are only dispatched while Corona is running (ie: not suspended).
-		fDispatchEventTaskQueue.push(sharedTaskPointer);
-	};
+	// Validate.
+	if (!taskPointer)
+	{
+		return;
+	}
 
-	// Set up the Steam CCallResult handler to start listening for the async Steam result.
-	// Will invoke the above callback when the async operation ends, pushing the result to the event queue.
-	auto concreteHandlerPointer = (SteamCallResultHandler<TSteamResultType>*)handlerPointer;
-	concreteHandlerPointer->Handle(settings.SteamCallResultHandle, callback);
-	return true;
+	// Do not dispatch the result to the leader if it was canceled after other requests attached to its Steam call.
+	if (wasLeaderCanceled)
+	{
+		DiscardDispatchEventTask(std::move(taskPointer));
+		return;
+	}
+	taskPointer->SetAttemptCount(attemptCount);
+
+	// A null result means the request has timed out. Dispatch the task's default data flagged as an error.
+	if (!resultPointer)
+	{
+		taskPointer->SetHadIOFailure(true);
+		taskPointer->SetTimedOut(true);
+		QueueDispatchEventTask(std::move(taskPointer));
+		return;
+	}
+
+	// Copy the received result to the task.
+	taskPointer->SetHadIOFailure(hadIOFailure);
+	taskPointer->AcquireEventDataFrom(*resultPointer);
+
+	// Queue the received Steam event data to be dispatched to Lua later.
+	// This ensures that Lua events are only dispatched while Corona is running (ie: not suspended).
+	QueueDispatchEventTask(std::move(taskPointer));
 }
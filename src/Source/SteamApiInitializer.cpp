@@ -0,0 +1,147 @@
+// ----------------------------------------------------------------------------
+// 
+// SteamApiInitializer.cpp
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#include "SteamApiInitializer.h"
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <thread>
+
+
+/** The connection's current state. Written by the initializer's thread and read by any thread. */
+static std::atomic<SteamApiInitializer::State> sState(SteamApiInitializer::State::kNotStarted);
+
+/** Microseconds spent by the last initialization. Zero until it has finished. */
+static std::atomic<uint64_t> sInitializationDurationInMicroseconds(0);
+
+/** The thread calling SteamAPI_Init() asynchronously. Not joinable if not initializing asynchronously. */
+static std::thread sThread;
+
+
+bool SteamApiInitializer::Initialize(SteamAPIWarningMessageHook_t warningMessageHook)
+{
+	// Wait for a pending asynchronous initialization instead of initializing twice.
+	if (sThread.joinable())
+	{
+		sThread.join();
+	}
+
+	// Initialize on this thread, if not done already.
+	if (sState.load() == State::kNotStarted)
+	{
+		sState = State::kInitializing;
+		OnInitialize(warningMessageHook);
+	}
+	return (sState.load() == State::kSucceeded);
+}
+
+bool SteamApiInitializer::InitializeAsync(SteamAPIWarningMessageHook_t warningMessageHook)
+{
+	// Do not continue if already initialized or initializing.
+	auto state = sState.load();
+	if (state != State::kNotStarted)
+	{
+		return (state != State::kFailed);
+	}
+
+	// Start initializing on a dedicated thread.
+	// Note: The state is set before starting the thread so that Steam isn't polled until it has finished.
+	sState = State::kInitializing;
+	try
+	{
+		sThread = std::thread(&SteamApiInitializer::OnInitialize, warningMessageHook);
+	}
+	catch (const std::exception&)
+	{
+		sState = State::kNotStarted;
+		return false;
+	}
+	return true;
+}
+
+void SteamApiInitializer::Shutdown()
+{
+	if (sThread.joinable())
+	{
+		sThread.join();
+	}
+	SteamAPI_Shutdown();
+	sState = State::kNotStarted;
+	sInitializationDurationInMicroseconds = 0;
+}
+
+SteamApiInitializer::State SteamApiInitializer::GetState()
+{
+	return sState.load();
+}
+
+bool SteamApiInitializer::IsInitializing()
+{
+	return (sState.load() == State::kInitializing);
+}
+
+uint64_t SteamApiInitializer::GetInitializationDurationInMicroseconds()
+{
+	return sInitializationDurationInMicroseconds.load();
+}
+
+ISteamApps* SteamApiInitializer::GetApps()
+{
+	return (sState.load() == State::kSucceeded) ? SteamApps() : nullptr;
+}
+
+ISteamFriends* SteamApiInitializer::GetFriends()
+{
+	return (sState.load() == State::kSucceeded) ? SteamFriends() : nullptr;
+}
+
+ISteamUser* SteamApiInitializer::GetUser()
+{
+	return (sState.load() == State::kSucceeded) ? SteamUser() : nullptr;
+}
+
+ISteamUserStats* SteamApiInitializer::GetUserStats()
+{
+	return (sState.load() == State::kSucceeded) ? SteamUserStats() : nullptr;
+}
+
+ISteamUtils* SteamApiInitializer::GetUtils()
+{
+	return (sState.load() == State::kSucceeded) ? SteamUtils() : nullptr;
+}
+
+void SteamApiInitializer::OnInitialize(SteamAPIWarningMessageHook_t warningMessageHook)
+{
+	const auto startTime = std::chrono::steady_clock::now();
+
+	// Initialize our connection with the Steam client. This blocks until the Steam client has responded.
+	bool wasInitialized = SteamAPI_Init();
+	if (wasInitialized)
+	{
+		// Set up a callback to receive Steam's info/warning messages.
+		auto steamClientPointer = SteamClient();
+		if (steamClientPointer && warningMessageHook)
+		{
+			steamClientPointer->SetWarningMessageHook(warningMessageHook);
+		}
+
+		// Request the current logged in user's stats and achievement info.
+		auto steamUserStatsPointer = SteamUserStats();
+		if (steamUserStatsPointer)
+		{
+			steamUserStatsPointer->RequestCurrentStats();
+		}
+	}
+
+	// Publish the result. Only done once all of the above calls have finished, since the state allows
+	// other threads to start using Steam's APIs.
+	auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime);
+	sInitializationDurationInMicroseconds = (uint64_t)duration.count();
+	sState = wasInitialized ? State::kSucceeded : State::kFailed;
+}
@@ -0,0 +1,135 @@
+// ----------------------------------------------------------------------------
+// 
+// SteamApiInitializer.h
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#pragma once
+
+#include "PluginMacros.h"
+#include <cstdint>
+PLUGIN_DISABLE_STEAM_WARNINGS_BEGIN
+#	include "steam_api.h"
+PLUGIN_DISABLE_STEAM_WARNINGS_END
+
+
+/**
+  Initializes the process' connection with the Steam client via SteamAPI_Init(), either synchronously or on a
+  dedicated thread, and shuts it down via SteamAPI_Shutdown().
+
+  SteamAPI_Init() performs a blocking handshake with the Steam client which can noticeably delay the app's
+  first frame. Initializing asynchronously lets the plugin's Lua table be returned immediately instead.
+  While initializing, the SteamCallbackPump does not poll Steam and RuntimeContext instances park their requests
+  until GetState() returns kSucceeded. Steam's interfaces must be fetched via this class' Get*() methods instead of
+  Steam's global accessors, since the latter would race with SteamAPI_Init() on the initializer's thread.
+
+  This class only provides static members since Steam only supports 1 connection per process.
+ */
+class SteamApiInitializer
+{
+	public:
+		/** Indicates how far along the connection with the Steam client is. */
+		enum class State
+		{
+			/** Initialization has not been started or the connection has been shut down. */
+			kNotStarted,
+
+			/** SteamAPI_Init() is being called on the initializer's thread. */
+			kInitializing,
+
+			/** Connected to the Steam client. Steam's APIs can be used. */
+			kSucceeded,
+
+			/** SteamAPI_Init() has failed, such as when the Steam client is not running. */
+			kFailed
+		};
+
+		/**
+		  Calls SteamAPI_Init() on the calling thread and blocks until it returns.
+		  Once connected, installs the given warning message hook and requests the current user's stats.
+		  Does nothing if already initialized or initializing.
+		  @param warningMessageHook Callback to receive Steam's info/warning messages. Can be null.
+		  @return Returns true if connected to the Steam client. Returns false if failed.
+		 */
+		static bool Initialize(SteamAPIWarningMessageHook_t warningMessageHook);
+
+		/**
+		  Starts calling SteamAPI_Init() on a dedicated thread and returns immediately.
+		  Once connected, installs the given warning message hook and requests the current user's stats.
+		  Does nothing if already initialized or initializing.
+		  @param warningMessageHook Callback to receive Steam's info/warning messages. Can be null.
+		  @return Returns true if initialization has been started or has already succeeded.
+
+		          Returns false if failed to create a thread, in which case the caller is expected to fall back
+		          to the synchronous Initialize() method.
+		 */
+		static bool InitializeAsync(SteamAPIWarningMessageHook_t warningMessageHook);
+
+		/**
+		  Waits for an asynchronous initialization to finish, if any, and then calls SteamAPI_Shutdown().
+		  Must be called after stopping the SteamCallbackPump.
+		 */
+		static void Shutdown();
+
+		/**
+		  Gets how far along the connection with the Steam client is. This method is thread safe.
+		  @return Returns the current state, such as kInitializing or kSucceeded.
+		 */
+		static SteamApiInitializer::State GetState();
+
+		/**
+		  Determines if SteamAPI_Init() is currently being called on the initializer's thread.
+		  @return Returns true if initializing asynchronously. Returns false if not.
+		 */
+		static bool IsInitializing();
+
+		/**
+		  Gets the amount of time the last initialization spent in SteamAPI_Init() and its follow-up calls,
+		  on whichever thread it ran.
+		  @return Returns the duration in microseconds. Returns zero if initialization has not finished yet.
+		 */
+		static uint64_t GetInitializationDurationInMicroseconds();
+
+		/**
+		  Fetches Steam's ISteamApps interface once connected to the Steam client.
+		  @return Returns the interface. Returns null if not initialized yet, still initializing, or failed.
+		 */
+		static ISteamApps* GetApps();
+
+		/**
+		  Fetches Steam's ISteamFriends interface once connected to the Steam client.
+		  @return Returns the interface. Returns null if not initialized yet, still initializing, or failed.
+		 */
+		static ISteamFriends* GetFriends();
+
+		/**
+		  Fetches Steam's ISteamUser interface once connected to the Steam client.
+		  @return Returns the interface. Returns null if not initialized yet, still initializing, or failed.
+		 */
+		static ISteamUser* GetUser();
+
+		/**
+		  Fetches Steam's ISteamUserStats interface once connected to the Steam client.
+		  @return Returns the interface. Returns null if not initialized yet, still initializing, or failed.
+		 */
+		static ISteamUserStats* GetUserStats();
+
+		/**
+		  Fetches Steam's ISteamUtils interface once connected to the Steam client.
+		  @return Returns the interface. Returns null if not initialized yet, still initializing, or failed.
+		 */
+		static ISteamUtils* GetUtils();
+
+	private:
+		/** Constructor deleted since this class only provides static members. */
+		SteamApiInitializer() = delete;
+
+		/**
+		  Performs the actual initialization and updates this class' state. Called by both initialize methods.
+		  @param warningMessageHook Callback to receive Steam's info/warning messages. Can be null.
+		 */
+		static void OnInitialize(SteamAPIWarningMessageHook_t warningMessageHook);
+};
@@ -10,8 +10,8 @@
 #pragma once
 
 #include "BaseSteamCallResultHandler.h"
+#include "InlineFunction.h"
 #include "PluginMacros.h"
-#include <functional>
 PLUGIN_DISABLE_STEAM_WARNINGS_BEGIN
 #	include "steam_api.h"
 PLUGIN_DISABLE_STEAM_WARNINGS_END
@@ -25,10 +25,18 @@ template<class TSteamResult>
 class SteamCallResultHandler : public BaseSteamCallResultHandler
 {
 	public:
+		/** Max number of bytes a callback given to the Handle() method can capture. */
+		static const size_t kCallbackCapacity = 4 * sizeof(void*);
+
+		/**
+		  Type of callback to be given to the Handle() method.
+		  Stores its captures inline instead of on the heap and does not need to be copyable.
+		 */
+		typedef InlineFunction<void(TSteamResult*, bool), kCallbackCapacity> Callback;
+
 		/** Creates a new Steam CCallResult handler. */
 		SteamCallResultHandler()
 		{
-			fCallback = nullptr;
 		}
 
 		/** Unregisters the Steam CCallResult event handler and disposes of this object. */
@@ -55,16 +63,49 @@ class SteamCallResultHandler : public BaseSteamCallResultHandler
 		{
 			fCallback = nullptr;
 			fCallResult.Cancel();
+			ReleaseToPool();
+		}
+
+		/**
+		  Aborts the last Handle() operation and then invokes its assigned callback with a null result
+		  and an I/O failure flag, making this handler available to handle another async operation.
+		  Expected to be called when the caller no longer wants to wait for Steam's result.
+		 */
+		virtual void TimeOut() override
+		{
+			// Move the callback to the stack first since Abort() destroys it.
+			Callback callback(std::move(fCallback));
+			Abort();
+			if (callback)
+			{
+				callback(nullptr, true);
+			}
+		}
+
+		virtual size_t GetTypeIndex() const override
+		{
+			return GetStaticTypeIndex();
+		}
+
+		/**
+		  Gets the unique index assigned to this template instantiation's Steam result type.
+		  @return Returns a zero based index which is unique to the "TSteamResult" type.
+		 */
+		static size_t GetStaticTypeIndex()
+		{
+			static const size_t sTypeIndex = BaseSteamCallResultHandler::ReserveTypeIndex();
+			return sTypeIndex;
 		}
 
 		/**
 		  Starts listening for result data for the given async Steam operation.
 		  @param callResultHandle Handle returned by Steam's C/C++ async API.
 		  @param callback The callback to be invoked by this handler when Steam's result data has been received.
+		                  Will be moved into this handler.
 		 */
-		void Handle(SteamAPICall_t callResultHandle, const std::function<void(TSteamResult*, bool)>& callback)
+		void Handle(SteamAPICall_t callResultHandle, Callback&& callback)
 		{
-			fCallback = callback;
+			fCallback = std::move(callback);
 			fCallResult.Set(callResultHandle, this, &SteamCallResultHandler::OnReceived);
 		}
 
@@ -84,16 +125,18 @@ class SteamCallResultHandler : public BaseSteamCallResultHandler
 		 */
 		void OnReceived(TSteamResult* resultPointer, bool hadIOFailure)
 		{
+			// This handler is no longer waiting for a result. Make it available to handle another async operation.
+			ReleaseToPool();
+
 			// Do not continue if this handler was not assigned a callback.
 			if (!fCallback)
 			{
 				return;
 			}
 
-			// Copy the handler's assigned callback before invoking it below, keeping its captures alive on the stack.
+			// Move the handler's assigned callback to the stack before invoking it below, keeping its captures alive.
 			// This is in case the Handle() method gets called by the callback, replacing the current callback.
-			auto callback = fCallback;
-			fCallback = nullptr;
+			Callback callback(std::move(fCallback));
 
 			// Pass the received result data to this handler's assigned callback.
 			callback(resultPointer, hadIOFailure);
@@ -104,5 +147,5 @@ class SteamCallResultHandler : public BaseSteamCallResultHandler
 		CCallResult<SteamCallResultHandler<TSteamResult>, TSteamResult> fCallResult;
 
 		/** Callback to be invoked by this handler, passing the received result data from the CCallResult object. */
-		std::function<void(TSteamResult*, bool)> fCallback;
+		Callback fCallback;
 };
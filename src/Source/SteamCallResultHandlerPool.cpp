@@ -0,0 +1,193 @@
+// ----------------------------------------------------------------------------
+// 
+// SteamCallResultHandlerPool.cpp
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#include "SteamCallResultHandlerPool.h"
+
+
+SteamCallResultHandlerPool::SteamCallResultHandlerPool()
+:	fIdleHandlerCount(0),
+	fPeakActiveHandlerCount(0),
+	fMaxHandlerCount(0),
+	fIdleHandlerLimit(0),
+	fTrimDelayInFrames(0),
+	fQuietFrameCount(0)
+{
+}
+
+SteamCallResultHandlerPool::~SteamCallResultHandlerPool()
+{
+	Clear();
+}
+
+void SteamCallResultHandlerPool::Release(BaseSteamCallResultHandler* handlerPointer)
+{
+	// Validate.
+	if (!handlerPointer || (handlerPointer->fPoolPointer != this) || handlerPointer->fIsIdleInPool)
+	{
+		return;
+	}
+
+	// Push the handler to its type's free list.
+	const size_t typeIndex = handlerPointer->GetTypeIndex();
+	if (typeIndex >= fIdleHandlerCollections.size())
+	{
+		fIdleHandlerCollections.resize(typeIndex + 1);
+	}
+	fIdleHandlerCollections[typeIndex].push_back(handlerPointer);
+	handlerPointer->fIsIdleInPool = true;
+	fIdleHandlerCount++;
+}
+
+void SteamCallResultHandlerPool::OnFrame()
+{
+	// Do not continue if trimming is disabled.
+	if (fTrimDelayInFrames <= 0)
+	{
+		return;
+	}
+
+	// Trim the pool if no handlers have been acquired for the configured number of frames.
+	if (fQuietFrameCount < fTrimDelayInFrames)
+	{
+		fQuietFrameCount++;
+		return;
+	}
+	TrimTo(fIdleHandlerLimit);
+}
+
+void SteamCallResultHandlerPool::TrimTo(size_t maxIdleHandlerCount)
+{
+	while (fIdleHandlerCount > maxIdleHandlerCount)
+	{
+		if (!DeleteIdleHandler())
+		{
+			break;
+		}
+	}
+}
+
+void SteamCallResultHandlerPool::Clear()
+{
+	// Detach all handlers from this pool first so that aborting them below won't modify our collections.
+	for (auto nextHandlerPointer : fHandlerCollection)
+	{
+		nextHandlerPointer->fPoolPointer = nullptr;
+	}
+
+	// Delete all handlers. This unregisters their CCallResult listeners from Steam.
+	for (auto nextHandlerPointer : fHandlerCollection)
+	{
+		delete nextHandlerPointer;
+	}
+	fHandlerCollection.clear();
+	for (auto&& idleHandlerCollection : fIdleHandlerCollections)
+	{
+		idleHandlerCollection.clear();
+	}
+	fIdleHandlerCount = 0;
+}
+
+size_t SteamCallResultHandlerPool::GetHandlerCount() const
+{
+	return fHandlerCollection.size();
+}
+
+size_t SteamCallResultHandlerPool::GetIdleHandlerCount() const
+{
+	return fIdleHandlerCount;
+}
+
+size_t SteamCallResultHandlerPool::GetActiveHandlerCount() const
+{
+	return fHandlerCollection.size() - fIdleHandlerCount;
+}
+
+size_t SteamCallResultHandlerPool::GetPeakActiveHandlerCount() const
+{
+	return fPeakActiveHandlerCount;
+}
+
+size_t SteamCallResultHandlerPool::GetMaxHandlerCount() const
+{
+	return fMaxHandlerCount;
+}
+
+void SteamCallResultHandlerPool::SetMaxHandlerCount(size_t value)
+{
+	fMaxHandlerCount = value;
+}
+
+size_t SteamCallResultHandlerPool::GetIdleHandlerLimit() const
+{
+	return fIdleHandlerLimit;
+}
+
+void SteamCallResultHandlerPool::SetIdleHandlerLimit(size_t value)
+{
+	fIdleHandlerLimit = value;
+}
+
+uint32_t SteamCallResultHandlerPool::GetTrimDelayInFrames() const
+{
+	return fTrimDelayInFrames;
+}
+
+void SteamCallResultHandlerPool::SetTrimDelayInFrames(uint32_t value)
+{
+	fTrimDelayInFrames = value;
+}
+
+bool SteamCallResultHandlerPool::DeleteIdleHandler()
+{
+	// Pop an idle handler from the first non-empty free list.
+	BaseSteamCallResultHandler* handlerPointer = nullptr;
+	for (auto&& idleHandlerCollection : fIdleHandlerCollections)
+	{
+		if (!idleHandlerCollection.empty())
+		{
+			handlerPointer = idleHandlerCollection.back();
+			idleHandlerCollection.pop_back();
+			fIdleHandlerCount--;
+			break;
+		}
+	}
+	if (!handlerPointer)
+	{
+		return false;
+	}
+
+	// Remove the handler from the main collection by swapping it with the last handler.
+	const size_t index = handlerPointer->fPoolCollectionIndex;
+	auto lastHandlerPointer = fHandlerCollection.back();
+	fHandlerCollection[index] = lastHandlerPointer;
+	lastHandlerPointer->fPoolCollectionIndex = index;
+	fHandlerCollection.pop_back();
+
+	// Delete the handler. This unregisters its CCallResult object from Steam.
+	handlerPointer->fPoolPointer = nullptr;
+	delete handlerPointer;
+	return true;
+}
+
+void SteamCallResultHandlerPool::OnHandlerCreated(BaseSteamCallResultHandler* handlerPointer)
+{
+	handlerPointer->fPoolPointer = this;
+	handlerPointer->fPoolCollectionIndex = fHandlerCollection.size();
+	fHandlerCollection.push_back(handlerPointer);
+}
+
+void SteamCallResultHandlerPool::OnHandlerAcquired()
+{
+	fQuietFrameCount = 0;
+	const size_t activeHandlerCount = GetActiveHandlerCount();
+	if (activeHandlerCount > fPeakActiveHandlerCount)
+	{
+		fPeakActiveHandlerCount = activeHandlerCount;
+	}
+}
@@ -0,0 +1,227 @@
+// ----------------------------------------------------------------------------
+// 
+// SteamCallResultHandlerPool.h
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#pragma once
+
+#include "BaseSteamCallResultHandler.h"
+#include "SteamCallResultHandler.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+/**
+  Pool of re-usable Steam CCallResult handlers of any result type.
+
+  Idle handlers are stored in a separate free list per Steam result type, indexed by the handler's type index.
+  This makes acquiring a handler of a given type and releasing it back to the pool constant time operations,
+  no matter how many handlers of other types exist or are waiting for a result.
+
+  Handlers automatically release themselves back to this pool once their result has been received or aborted.
+
+  The number of handlers this pool creates can be capped via SetMaxHandlerCount(). Idle handlers exceeding the
+  SetIdleHandlerLimit() watermark are deleted by the OnFrame() method once no handlers have been acquired for
+  the number of frames set via SetTrimDelayInFrames(). This unregisters their CCallResult objects from Steam.
+
+  This class is not thread safe. It is expected to only be accessed on the thread that runs Steam's callbacks.
+ */
+class SteamCallResultHandlerPool
+{
+	public:
+		/** Creates a new empty pool. */
+		SteamCallResultHandlerPool();
+
+		/** Deletes all handlers owned by this pool, aborting all operations they are waiting on. */
+		virtual ~SteamCallResultHandlerPool();
+
+		template<class TSteamResult>
+		/**
+		  Fetches an idle handler for the given Steam result type, creating a new one if none are idle.
+		  @return Returns a handler owned by this pool which is ready to handle an async Steam operation.
+
+		          Returns null if the max handler count has been reached and all handlers are in use.
+		 */
+		SteamCallResultHandler<TSteamResult>* Acquire();
+
+		/**
+		  Returns the given handler to its type's free list, making it available to a later Acquire() call.
+		  Handlers automatically call this when they're no longer waiting for a result.
+		  @param handlerPointer The handler to be released. Will be ignored if null, if it belongs to another pool,
+		                        or if it has already been released.
+		 */
+		void Release(BaseSteamCallResultHandler* handlerPointer);
+
+		/**
+		  To be called once per frame. Deletes idle handlers exceeding the idle handler limit if no handlers
+		  have been acquired for at least the number of frames set via SetTrimDelayInFrames().
+		 */
+		void OnFrame();
+
+		/**
+		  Deletes idle handlers until the number of idle handlers is no more than the given count.
+		  @param maxIdleHandlerCount The max number of idle handlers to keep in the pool.
+		 */
+		void TrimTo(size_t maxIdleHandlerCount);
+
+		/** Deletes all handlers owned by this pool, aborting all operations they are waiting on. */
+		void Clear();
+
+		/**
+		  Gets the number of handlers owned by this pool, whether they're idle or waiting for a result.
+		  @return Returns the number of handlers currently allocated by this pool.
+		 */
+		size_t GetHandlerCount() const;
+
+		/**
+		  Gets the number of handlers that are not waiting for a result.
+		  @return Returns the number of handlers currently stored in this pool's free lists.
+		 */
+		size_t GetIdleHandlerCount() const;
+
+		/**
+		  Gets the number of handlers that have been acquired and are waiting for a result.
+		  @return Returns the number of handlers currently in use.
+		 */
+		size_t GetActiveHandlerCount() const;
+
+		/**
+		  Gets the highest number of handlers that were in use at the same time.
+		  @return Returns the peak number of active handlers since this pool was created.
+		 */
+		size_t GetPeakActiveHandlerCount() const;
+
+		/**
+		  Gets the max number of handlers this pool is allowed to allocate at the same time.
+		  @return Returns the max number of handlers. Returns zero if unlimited.
+		 */
+		size_t GetMaxHandlerCount() const;
+
+		/**
+		  Sets the max number of handlers this pool is allowed to allocate at the same time.
+		  Once reached, the Acquire() method will delete an idle handler of another type to make room
+		  or will return null if all handlers are in use.
+		  @param value The max number of handlers. Set to zero for unlimited.
+		 */
+		void SetMaxHandlerCount(size_t value);
+
+		/**
+		  Gets the number of idle handlers the OnFrame() method will keep when trimming the pool.
+		  @return Returns the idle handler watermark.
+		 */
+		size_t GetIdleHandlerLimit() const;
+
+		/**
+		  Sets the number of idle handlers the OnFrame() method will keep when trimming the pool.
+		  @param value The idle handler watermark. Set to zero to delete all idle handlers when trimming.
+		 */
+		void SetIdleHandlerLimit(size_t value);
+
+		/**
+		  Gets the number of consecutive frames without acquiring a handler before the pool is trimmed.
+		  @return Returns the number of quiet frames needed to trim the pool. Returns zero if trimming is disabled.
+		 */
+		uint32_t GetTrimDelayInFrames() const;
+
+		/**
+		  Sets the number of consecutive frames without acquiring a handler before the pool is trimmed.
+		  @param value The number of quiet frames needed to trim the pool. Set to zero to never trim.
+		 */
+		void SetTrimDelayInFrames(uint32_t value);
+
+	private:
+		/** Copy constructor deleted to prevent it from being called. */
+		SteamCallResultHandlerPool(const SteamCallResultHandlerPool&) = delete;
+
+		/** Copy operator deleted to prevent it from being called. */
+		void operator=(const SteamCallResultHandlerPool&) = delete;
+
+		/**
+		  Deletes 1 idle handler of any type.
+		  @return Returns true if an idle handler was deleted. Returns false if there are no idle handlers.
+		 */
+		bool DeleteIdleHandler();
+
+		/**
+		  Adds the given new handler to this pool's collection of handlers and updates its statistics.
+		  @param handlerPointer The newly created handler. Cannot be null.
+		 */
+		void OnHandlerCreated(BaseSteamCallResultHandler* handlerPointer);
+
+		/** To be called when a handler has been acquired. Updates the peak count and resets the quiet frame count. */
+		void OnHandlerAcquired();
+
+
+		/** Collection of all handlers created and owned by this pool. */
+		std::vector<BaseSteamCallResultHandler*> fHandlerCollection;
+
+		/** Free lists of idle handlers, indexed by their BaseSteamCallResultHandler::GetTypeIndex() value. */
+		std::vector<std::vector<BaseSteamCallResultHandler*>> fIdleHandlerCollections;
+
+		/** Total number of handlers stored in the "fIdleHandlerCollections" free lists. */
+		size_t fIdleHandlerCount;
+
+		/** Highest number of handlers that were waiting for a result at the same time. */
+		size_t fPeakActiveHandlerCount;
+
+		/** Max number of handlers this pool can allocate at the same time. Zero means unlimited. */
+		size_t fMaxHandlerCount;
+
+		/** Number of idle handlers to keep when the pool is trimmed. */
+		size_t fIdleHandlerLimit;
+
+		/** Number of consecutive frames without acquiring a handler before the pool is trimmed. Zero disables trimming. */
+		uint32_t fTrimDelayInFrames;
+
+		/** Number of consecutive frames that have elapsed without acquiring a handler. */
+		uint32_t fQuietFrameCount;
+};
+
+
+// ------------------------------------------------------------------------------------------
+// Templatized class method defined below to prevent it from being inlined into calling code.
+// ------------------------------------------------------------------------------------------
+
+template<class TSteamResult>
+SteamCallResultHandler<TSteamResult>* SteamCallResultHandlerPool::Acquire()
+{
+	// Attempt to pop an idle handler from the given type's free list.
+	const size_t typeIndex = SteamCallResultHandler<TSteamResult>::GetStaticTypeIndex();
+	if (typeIndex < fIdleHandlerCollections.size())
+	{
+		auto& idleHandlerCollection = fIdleHandlerCollections[typeIndex];
+		if (!idleHandlerCollection.empty())
+		{
+			auto handlerPointer = idleHandlerCollection.back();
+			idleHandlerCollection.pop_back();
+			handlerPointer->fIsIdleInPool = false;
+			fIdleHandlerCount--;
+			OnHandlerAcquired();
+			return static_cast<SteamCallResultHandler<TSteamResult>*>(handlerPointer);
+		}
+	}
+
+	// An idle handler was not found. If the pool is full, then delete an idle handler of another type to make room.
+	if ((fMaxHandlerCount > 0) && (fHandlerCollection.size() >= fMaxHandlerCount))
+	{
+		if (!DeleteIdleHandler())
+		{
+			return nullptr;
+		}
+	}
+
+	// Create a new handler.
+	auto handlerPointer = new SteamCallResultHandler<TSteamResult>();
+	if (!handlerPointer)
+	{
+		return nullptr;
+	}
+	OnHandlerCreated(handlerPointer);
+	OnHandlerAcquired();
+	return handlerPointer;
+}
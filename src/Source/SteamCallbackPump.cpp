@@ -0,0 +1,178 @@
+// ----------------------------------------------------------------------------
+// 
+// SteamCallbackPump.cpp
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#include "SteamCallbackPump.h"
+#include "PluginMacros.h"
+#include "SteamApiInitializer.h"
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <thread>
+PLUGIN_DISABLE_STEAM_WARNINGS_BEGIN
+#	include "steam_api.h"
+PLUGIN_DISABLE_STEAM_WARNINGS_END
+
+
+/** Recursive mutex held while calling SteamAPI_RunCallbacks() and while (un)registering Steam callbacks. */
+static std::recursive_mutex sSteamCallbackMutex;
+
+/**
+  Number of times SteamAPI_RunCallbacks() has been called by the PollFromFrame() method.
+  Guarded by the "sSteamCallbackMutex".
+ */
+static uint64_t sFramePollCount = 0;
+
+/** Mutex used to synchronize access to the pump thread's state below. */
+static std::mutex sThreadStateMutex;
+
+/** Used to wake up the pump thread early when it is being stopped. */
+static std::condition_variable sStopRequestedCondition;
+
+/** The pump's thread. Not joinable if the pump is not running. */
+static std::thread sThread;
+
+/** Set true when the Stop() method has been called to flag the pump thread to exit. */
+static bool sWasStopRequested = false;
+
+/** Number of times per second the pump thread polls Steam for events. Zero if not running. */
+static uint32_t sFrequencyInHertz = 0;
+
+
+bool SteamCallbackPump::Start(uint32_t frequencyInHertz)
+{
+	// Validate.
+	if (frequencyInHertz <= 0)
+	{
+		return false;
+	}
+
+	// Do not continue if already running.
+	if (sThread.joinable())
+	{
+		return true;
+	}
+
+	// Start the pump's thread.
+	{
+		std::lock_guard<std::mutex> scopedLock(sThreadStateMutex);
+		sWasStopRequested = false;
+		sFrequencyInHertz = frequencyInHertz;
+	}
+	try
+	{
+		sThread = std::thread(&SteamCallbackPump::OnRunThread);
+	}
+	catch (const std::exception&)
+	{
+		std::lock_guard<std::mutex> scopedLock(sThreadStateMutex);
+		sFrequencyInHertz = 0;
+		return false;
+	}
+	return true;
+}
+
+void SteamCallbackPump::Stop()
+{
+	// Do not continue if not running.
+	if (!sThread.joinable())
+	{
+		return;
+	}
+
+	// Flag the pump's thread to exit, wake it up, and wait for it to exit.
+	{
+		std::lock_guard<std::mutex> scopedLock(sThreadStateMutex);
+		sWasStopRequested = true;
+	}
+	sStopRequestedCondition.notify_all();
+	sThread.join();
+	{
+		std::lock_guard<std::mutex> scopedLock(sThreadStateMutex);
+		sFrequencyInHertz = 0;
+	}
+}
+
+bool SteamCallbackPump::IsRunning()
+{
+	std::lock_guard<std::mutex> scopedLock(sThreadStateMutex);
+	return (sFrequencyInHertz > 0);
+}
+
+uint32_t SteamCallbackPump::GetFrequencyInHertz()
+{
+	std::lock_guard<std::mutex> scopedLock(sThreadStateMutex);
+	return sFrequencyInHertz;
+}
+
+std::recursive_mutex& SteamCallbackPump::GetMutex()
+{
+	return sSteamCallbackMutex;
+}
+
+void SteamCallbackPump::PollFromFrame(uint64_t& lastObservedPollCount)
+{
+	// Do not continue if the pump's thread is polling Steam for us.
+	if (IsRunning())
+	{
+		return;
+	}
+
+	// Do not poll Steam while it is being initialized on another thread.
+	if (SteamApiInitializer::IsInitializing())
+	{
+		return;
+	}
+
+	// Poll Steam for events, unless another runtime has already done so since the caller's last poll.
+	std::lock_guard<std::recursive_mutex> scopedLock(sSteamCallbackMutex);
+	if (lastObservedPollCount == sFramePollCount)
+	{
+		SteamAPI_RunCallbacks();
+		sFramePollCount++;
+	}
+	lastObservedPollCount = sFramePollCount;
+}
+
+void SteamCallbackPump::OnRunThread()
+{
+	// Fetch the amount of time to wait between polls.
+	std::chrono::microseconds interval;
+	{
+		std::lock_guard<std::mutex> scopedLock(sThreadStateMutex);
+		interval = std::chrono::microseconds(1000000 / sFrequencyInHertz);
+	}
+
+	// Poll Steam for events at a fixed frequency until flagged to stop.
+	// Note: Steam's callbacks will push their event data to each RuntimeContext's thread safe dispatch queue.
+	auto nextPollTime = std::chrono::steady_clock::now();
+	while (true)
+	{
+		if (!SteamApiInitializer::IsInitializing())
+		{
+			std::lock_guard<std::recursive_mutex> scopedLock(sSteamCallbackMutex);
+			SteamAPI_RunCallbacks();
+		}
+
+		// Wait for the next poll, aligned to a fixed schedule. Wake up early if flagged to stop.
+		// If we've fallen behind, such as after a slow callback, then poll again immediately without catching up.
+		nextPollTime += interval;
+		auto currentTime = std::chrono::steady_clock::now();
+		if (nextPollTime < currentTime)
+		{
+			nextPollTime = currentTime;
+		}
+		std::unique_lock<std::mutex> scopedLock(sThreadStateMutex);
+		bool wasStopRequested = sStopRequestedCondition.wait_until(
+				scopedLock, nextPollTime, []() { return sWasStopRequested; });
+		if (wasStopRequested)
+		{
+			break;
+		}
+	}
+}
@@ -0,0 +1,88 @@
+// ----------------------------------------------------------------------------
+// 
+// SteamCallbackPump.h
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+
+
+/**
+  Optionally polls Steam for events via SteamAPI_RunCallbacks() on a dedicated thread at a fixed frequency.
+
+  By default, the RuntimeContext class polls Steam for events on "enterFrame" via the PollFromFrame() method,
+  which polls at most once per frame for the whole process no matter how many Corona runtimes exist.
+  This ties Steam's callback latency to the app's frame rate and stops polling entirely while Corona is
+  suspended or stalled. Starting this pump decouples polling from the frame rate. Received events are still
+  queued to each RuntimeContext's thread safe dispatch queue and delivered to Lua on the next "enterFrame" event.
+
+  Steam's callbacks and CCallResult registration are global and not thread safe. All code which registers,
+  unregisters, or polls Steam callbacks must hold the mutex returned by GetMutex() while the pump is running.
+  The pump holds this mutex while calling SteamAPI_RunCallbacks().
+
+  This class only provides static members since Steam only supports 1 callback pump per process.
+ */
+class SteamCallbackPump
+{
+	public:
+		/**
+		  Starts polling Steam for events on a dedicated thread.
+		  Does nothing if the pump is already running.
+		  @param frequencyInHertz Number of times per second to call SteamAPI_RunCallbacks(). Must be greater than zero.
+		  @return Returns true if the pump was started or is already running.
+
+		          Returns false if given an invalid frequency or if failed to create a thread.
+		 */
+		static bool Start(uint32_t frequencyInHertz);
+
+		/**
+		  Stops the pump's thread and blocks until it exits.
+		  Must be called before calling SteamAPI_Shutdown(). Does nothing if the pump is not running.
+		 */
+		static void Stop();
+
+		/**
+		  Determines if the pump's thread is currently polling Steam for events.
+		  @return Returns true if the pump is running. Returns false if it has not been started or has been stopped.
+		 */
+		static bool IsRunning();
+
+		/**
+		  Gets the number of times per second the pump polls Steam for events.
+		  @return Returns the frequency in hertz. Returns zero if the pump is not running.
+		 */
+		static uint32_t GetFrequencyInHertz();
+
+		/**
+		  Gets the mutex used to synchronize access to Steam's global callback registry with the pump's thread.
+		  @return Returns a reference to a recursive mutex which is held while polling Steam for events.
+		 */
+		static std::recursive_mutex& GetMutex();
+
+		/**
+		  To be called by a RuntimeContext's "enterFrame" listener to poll Steam for events via SteamAPI_RunCallbacks().
+
+		  Since Steam's callbacks are global, 1 poll delivers events to every RuntimeContext. So, this method
+		  only polls if no other caller has polled since the given caller's last call. This way, multiple
+		  runtimes updating at the same frame rate share 1 poll per frame while a runtime that stops
+		  updating, such as a suspended runtime, does not prevent the others from polling.
+
+		  Does nothing if the pump's thread is running since it is already polling Steam for events.
+		  @param lastObservedPollCount Reference to the caller's own poll counter, initialized to zero.
+		                               Updated by this method to track polls made by other callers.
+		 */
+		static void PollFromFrame(uint64_t& lastObservedPollCount);
+
+	private:
+		/** Constructor deleted since this class only provides static members. */
+		SteamCallbackPump() = delete;
+
+		/** Entry point of the pump's thread. */
+		static void OnRunThread();
+};
@@ -0,0 +1,47 @@
+// ----------------------------------------------------------------------------
+// 
+// SteamConnectionState.cpp
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#include "SteamConnectionState.h"
+
+
+const SteamConnectionState SteamConnectionState::kUnknown;
+const SteamConnectionState SteamConnectionState::kInitializing("initializing");
+const SteamConnectionState SteamConnectionState::kConnected("connected");
+const SteamConnectionState SteamConnectionState::kDisconnected("disconnected");
+const SteamConnectionState SteamConnectionState::kReconnecting("reconnecting");
+
+
+SteamConnectionState::SteamConnectionState()
+:	fCoronaStringId(nullptr)
+{
+}
+
+SteamConnectionState::SteamConnectionState(const char* coronaStringId)
+:	fCoronaStringId(coronaStringId)
+{
+}
+
+SteamConnectionState::~SteamConnectionState()
+{
+}
+
+const char* SteamConnectionState::GetCoronaStringId() const
+{
+	return fCoronaStringId ? fCoronaStringId : "unknown";
+}
+
+bool SteamConnectionState::operator==(const SteamConnectionState& state) const
+{
+	return (fCoronaStringId == state.fCoronaStringId);
+}
+
+bool SteamConnectionState::operator!=(const SteamConnectionState& state) const
+{
+	return (fCoronaStringId != state.fCoronaStringId);
+}
@@ -0,0 +1,81 @@
+// ----------------------------------------------------------------------------
+// 
+// SteamConnectionState.h
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#pragma once
+
+
+/**
+  Indicates if the Steam client is currently connected to Steam's servers, as tracked by a RuntimeContext via
+  Steam's "SteamServersConnected_t" and "SteamServersDisconnected_t" events.
+  Provides predefined constants kInitializing, kConnected, kDisconnected, and kReconnecting for identifying the state
+  which also provide Corona plugin defined string IDs intended to be pushed to Lua.
+ */
+class SteamConnectionState final
+{
+	private:
+		/**
+		  Creates a new connection state using the given unique string ID.
+		  This constructor is private and is only used to create this class' predefined
+		  constants such as kConnected, kDisconnected, and kReconnecting.
+		  @param coronaStringId Unique string ID assigned to the state.
+		 */
+		SteamConnectionState(const char* coronaStringId);
+
+	public:
+		/** Indicates that the connection state is unknown. */
+		static const SteamConnectionState kUnknown;
+
+		/**
+		  Indicates that SteamAPI_Init() is still being called asynchronously by the SteamApiInitializer
+		  and that new requests are parked until it has finished.
+		 */
+		static const SteamConnectionState kInitializing;
+
+		/** Indicates that Steam is connected and that requests are sent to Steam immediately. */
+		static const SteamConnectionState kConnected;
+
+		/** Indicates that Steam has lost its connection and that new requests are parked until it reconnects. */
+		static const SteamConnectionState kDisconnected;
+
+		/**
+		  Indicates that Steam has reconnected, but requests parked while disconnected are still being replayed.
+		  New requests are parked behind them until all of them have been sent.
+		 */
+		static const SteamConnectionState kReconnecting;
+
+		/** Creates a state initialized to unknown. */
+		SteamConnectionState();
+
+		/** Destroys this object. */
+		virtual ~SteamConnectionState();
+
+		/**
+		  Gets a unique string ID used to identify this connection state.
+		  @return Returns the state's unique string ID such as "connected", "disconnected", or "reconnecting".
+		 */
+		const char* GetCoronaStringId() const;
+
+		/**
+		  Determines if this state matches the given state.
+		  @param state The state to be compared with.
+		  @return Returns true if the states match. Returns false if they don't match.
+		 */
+		bool operator==(const SteamConnectionState& state) const;
+
+		/**
+		  Determines if this state does not match the given state.
+		  @param state The state to be compared with.
+		  @return Returns true if the states do not match. Returns false if they do.
+		 */
+		bool operator!=(const SteamConnectionState& state) const;
+
+	private:
+		/** Unique string ID assigned to the state such as "connected", "disconnected", etc. */
+		const char* fCoronaStringId;
+};
@@ -0,0 +1,129 @@
+// ----------------------------------------------------------------------------
+// 
+// SteamEventTraits.h
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#pragma once
+
+#include "DispatchEventTask.h"
+#include "PluginMacros.h"
+#include "SteamRequestCategory.h"
+PLUGIN_DISABLE_STEAM_WARNINGS_BEGIN
+#	include "steam_api.h"
+PLUGIN_DISABLE_STEAM_WARNINGS_END
+
+
+template<class TSteamResultType>
+/**
+  Compile-time registry mapping a Steam event/result struct type to the task class used to dispatch it to Lua.
+
+  Each supported Steam struct must have a specialization of this template below providing a "DispatchEventTask"
+  typedef. This allows the RuntimeContext to select the right task class at compile time from the Steam type alone.
+  Steam CCallResult structs must also provide a static GetRequestCategory() function, which selects the
+  concurrency limit and queue the RuntimeContext schedules the Steam call under.
+  Global Steam event structs must also provide a static "kIsStateEvent" flag. When true, the event describes
+  current state where only the newest event matters, which the RuntimeContext remembers so that it can be
+  replayed to Lua listeners added later.
+  Using a Steam struct that is not registered here triggers a compiler error.
+ */
+struct SteamEventTraits;
+
+
+// ----------------------------------------------------------------------------
+// Global Steam events.
+// ----------------------------------------------------------------------------
+
+template<>
+struct SteamEventTraits<GameOverlayActivated_t>
+{
+	typedef DispatchGameOverlayActivatedEventTask DispatchEventTask;
+	static const bool kIsStateEvent = true;
+};
+
+template<>
+struct SteamEventTraits<MicroTxnAuthorizationResponse_t>
+{
+	typedef DispatchMicrotransactionAuthorizationResponseEventTask DispatchEventTask;
+	static const bool kIsStateEvent = false;
+};
+
+template<>
+struct SteamEventTraits<UserAchievementStored_t>
+{
+	typedef DispatchUserAchievementStoredEventTask DispatchEventTask;
+	static const bool kIsStateEvent = false;
+};
+
+template<>
+struct SteamEventTraits<UserStatsReceived_t>
+{
+	typedef DispatchUserStatsReceivedEventTask DispatchEventTask;
+	static const bool kIsStateEvent = true;
+};
+
+template<>
+struct SteamEventTraits<UserStatsStored_t>
+{
+	typedef DispatchUserStatsStoredEventTask DispatchEventTask;
+	static const bool kIsStateEvent = false;
+};
+
+template<>
+struct SteamEventTraits<UserStatsUnloaded_t>
+{
+	typedef DispatchUserStatsUnloadedEventTask DispatchEventTask;
+	static const bool kIsStateEvent = false;
+};
+
+
+// ----------------------------------------------------------------------------
+// Steam CCallResult events.
+// ----------------------------------------------------------------------------
+
+template<>
+struct SteamEventTraits<LeaderboardFindResult_t>
+{
+	typedef DispatchLeaderboardFindResultEventTask DispatchEventTask;
+
+	static const SteamRequestCategory& GetRequestCategory()
+	{
+		return SteamRequestCategory::kLeaderboardFind;
+	}
+};
+
+template<>
+struct SteamEventTraits<LeaderboardScoresDownloaded_t>
+{
+	typedef DispatchLeaderboardScoresDownloadedEventTask DispatchEventTask;
+
+	static const SteamRequestCategory& GetRequestCategory()
+	{
+		return SteamRequestCategory::kLeaderboardDownload;
+	}
+};
+
+template<>
+struct SteamEventTraits<LeaderboardScoreUploaded_t>
+{
+	typedef DispatchLeaderboardScoreUploadEventTask DispatchEventTask;
+
+	static const SteamRequestCategory& GetRequestCategory()
+	{
+		return SteamRequestCategory::kLeaderboardUpload;
+	}
+};
+
+template<>
+struct SteamEventTraits<NumberOfCurrentPlayers_t>
+{
+	typedef DispatchNumberOfCurrentPlayersEventTask DispatchEventTask;
+
+	static const SteamRequestCategory& GetRequestCategory()
+	{
+		return SteamRequestCategory::kActivePlayerCount;
+	}
+};
@@ -0,0 +1,84 @@
+// ----------------------------------------------------------------------------
+// 
+// SteamParkedRequest.h
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#pragma once
+
+#include "DispatchEventTask.h"
+#include "InlineFunction.h"
+#include "PluginMacros.h"
+#include <chrono>
+#include <cstdint>
+#include <string>
+PLUGIN_DISABLE_STEAM_WARNINGS_BEGIN
+#	include "steam_api.h"
+PLUGIN_DISABLE_STEAM_WARNINGS_END
+
+// Forward declarations.
+class RuntimeContext;
+
+
+/**
+  A request made via the RuntimeContext's SendRequestFor() method whose Steam call is made at a later time.
+  That is, a request parked while Steam was disconnected, queued behind its category's concurrency limit,
+  or waiting to retry its Steam call after an I/O failure.
+
+  Stored by the SteamRequestReplayQueue and the SteamRequestScheduler, which only move it around.
+  The request is sent by invoking its "ReplayFunctionPointer" with the RuntimeContext that created it.
+ */
+struct SteamParkedRequest
+{
+	/**
+	  Callback which makes the request's Steam async call and returns its handle.
+	  Must capture copies of the call's arguments since it is invoked after the Lua function that made the request
+	  has returned.
+	 */
+	typedef InlineFunction<SteamAPICall_t(), 64> SendRequestCallback;
+
+	/** Unique ID returned by SendRequestFor(). Kept when the request gets replayed. */
+	uint64_t RequestId;
+
+	/** Task to receive the request's result. Set up with the request's Lua listener. */
+	DispatchEventTaskPointer TaskPointer;
+
+	/** Makes the Steam async call when the request gets replayed. */
+	SendRequestCallback SendCallback;
+
+	/**
+	  Function which sends the request via the given context, specialized for the request's Steam result and
+	  task types. Allows replaying requests of any type from 1 collection without RTTI.
+	 */
+	void (*ReplayFunctionPointer)(RuntimeContext& context, SteamParkedRequest& request);
+
+	/** Set true if "SingleFlightKey" is valid, allowing the replay to attach to an identical call. */
+	bool HasSingleFlightKey;
+
+	/** Copy of the "SingleFlightKey" setting given to SendRequestFor(). */
+	std::string SingleFlightKey;
+
+	/** Set true if the request has a timeout, in which case "ExpirationTime" is valid. */
+	bool HasTimeout;
+
+	/** Time at which the request times out, measured from when it was parked. */
+	std::chrono::steady_clock::time_point ExpirationTime;
+
+	/** Set true once Steam has reconnected, in which case "ReplayTime" is valid. */
+	bool IsReplayScheduled;
+
+	/** Time at which the request will be sent to Steam. */
+	std::chrono::steady_clock::time_point ReplayTime;
+
+	/** Index of the SteamRequestCategory registered for the request's Steam result type. */
+	uint32_t CategoryIndex;
+
+	/** Time at which the request was added to its category's queue, if queued. */
+	std::chrono::steady_clock::time_point QueueTime;
+
+	/** Number of times the request's Steam call has been made. */
+	uint32_t AttemptCount;
+};
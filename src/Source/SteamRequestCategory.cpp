@@ -0,0 +1,104 @@
+// ----------------------------------------------------------------------------
+// 
+// SteamRequestCategory.cpp
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#include "SteamRequestCategory.h"
+#include <string>
+#include <unordered_map>
+
+
+static std::unordered_map<std::string, const SteamRequestCategory*> sSteamRequestCategoryMap;
+static const SteamRequestCategory* sSteamRequestCategoryArray[SteamRequestCategory::kCount];
+
+const SteamRequestCategory SteamRequestCategory::kUnknown;
+const SteamRequestCategory SteamRequestCategory::kLeaderboardFind("leaderboardFind", 0, 4, 2);
+const SteamRequestCategory SteamRequestCategory::kLeaderboardDownload("leaderboardDownload", 1, 2, 1);
+const SteamRequestCategory SteamRequestCategory::kLeaderboardUpload("leaderboardUpload", 2, 2, 4);
+const SteamRequestCategory SteamRequestCategory::kActivePlayerCount("activePlayerCount", 3, 1, 1);
+
+
+SteamRequestCategory::SteamRequestCategory()
+:	fCoronaStringId(nullptr),
+	fIndex(kCount),
+	fDefaultConcurrencyLimit(0),
+	fDefaultWeight(1)
+{
+}
+
+SteamRequestCategory::SteamRequestCategory(
+	const char* coronaStringId, uint32_t index, uint32_t defaultConcurrencyLimit, uint32_t defaultWeight)
+:	fCoronaStringId(coronaStringId),
+	fIndex(index),
+	fDefaultConcurrencyLimit(defaultConcurrencyLimit),
+	fDefaultWeight((defaultWeight > 0) ? defaultWeight : 1)
+{
+	if (fCoronaStringId)
+	{
+		sSteamRequestCategoryMap[std::string(fCoronaStringId)] = this;
+	}
+	if (fIndex < kCount)
+	{
+		sSteamRequestCategoryArray[fIndex] = this;
+	}
+}
+
+SteamRequestCategory::~SteamRequestCategory()
+{
+}
+
+const char* SteamRequestCategory::GetCoronaStringId() const
+{
+	return fCoronaStringId ? fCoronaStringId : "unknown";
+}
+
+uint32_t SteamRequestCategory::GetIndex() const
+{
+	return fIndex;
+}
+
+uint32_t SteamRequestCategory::GetDefaultConcurrencyLimit() const
+{
+	return fDefaultConcurrencyLimit;
+}
+
+uint32_t SteamRequestCategory::GetDefaultWeight() const
+{
+	return fDefaultWeight;
+}
+
+bool SteamRequestCategory::operator==(const SteamRequestCategory& category) const
+{
+	return (fCoronaStringId == category.fCoronaStringId);
+}
+
+bool SteamRequestCategory::operator!=(const SteamRequestCategory& category) const
+{
+	return (fCoronaStringId != category.fCoronaStringId);
+}
+
+SteamRequestCategory SteamRequestCategory::FromCoronaStringId(const char* stringId)
+{
+	if (stringId)
+	{
+		auto iterator = sSteamRequestCategoryMap.find(std::string(stringId));
+		if (iterator != sSteamRequestCategoryMap.end())
+		{
+			return *(iterator->second);
+		}
+	}
+	return SteamRequestCategory::kUnknown;
+}
+
+SteamRequestCategory SteamRequestCategory::FromIndex(uint32_t index)
+{
+	if ((index < kCount) && sSteamRequestCategoryArray[index])
+	{
+		return *sSteamRequestCategoryArray[index];
+	}
+	return SteamRequestCategory::kUnknown;
+}
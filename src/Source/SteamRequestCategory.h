@@ -0,0 +1,133 @@
+// ----------------------------------------------------------------------------
+// 
+// SteamRequestCategory.h
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+
+
+/**
+  Identifies a kind of Steam async call which a RuntimeContext limits the concurrency of, such as leaderboard
+  entry downloads. Requests of a category that has reached its concurrency limit are queued, and queued requests
+  of different categories are sent in a weighted fair order so that a flood of one category cannot starve the others.
+
+  Provides predefined constants kLeaderboardFind, kLeaderboardDownload, kLeaderboardUpload, and kActivePlayerCount
+  which also provide Corona plugin defined string IDs intended to be used by the "config.lua" file and pushed to Lua.
+  Also provides static functions FromCoronaStringId() and FromIndex() for converting back to a predefined constant.
+ */
+class SteamRequestCategory final
+{
+	private:
+		/**
+		  Creates a new request category using the given unique string ID and scheduling defaults.
+		  This constructor is private and is only used to create this class' predefined constants.
+		  @param coronaStringId Unique string ID assigned to the category.
+		  @param index Unique zero based index assigned to the category. Must be less than kCount.
+		  @param defaultConcurrencyLimit Max number of this category's requests waiting on Steam at the same time.
+		  @param defaultWeight Share of queued requests sent relative to other categories. Must be at least 1.
+		 */
+		SteamRequestCategory(
+				const char* coronaStringId, uint32_t index, uint32_t defaultConcurrencyLimit, uint32_t defaultWeight);
+
+	public:
+		/** Number of predefined categories, not counting kUnknown. */
+		static const uint32_t kCount = 4;
+
+		/** Indicates that the request category is unknown. */
+		static const SteamRequestCategory kUnknown;
+
+		/** Category of FindLeaderboard() calls, made by all leaderboard requests whose handle is not cached yet. */
+		static const SteamRequestCategory kLeaderboardFind;
+
+		/** Category of DownloadLeaderboardEntries() calls. */
+		static const SteamRequestCategory kLeaderboardDownload;
+
+		/** Category of UploadLeaderboardScore() calls. */
+		static const SteamRequestCategory kLeaderboardUpload;
+
+		/** Category of GetNumberOfCurrentPlayers() calls. */
+		static const SteamRequestCategory kActivePlayerCount;
+
+		/** Creates a category initialized to unknown. */
+		SteamRequestCategory();
+
+		/** Destroys this object. */
+		virtual ~SteamRequestCategory();
+
+		/**
+		  Gets a unique string ID used to identify this category.
+		  @return Returns the category's unique string ID.
+		 */
+		const char* GetCoronaStringId() const;
+
+		/**
+		  Gets the unique zero based index of this category, intended to index per-category arrays.
+		  @return Returns an index less than kCount. Returns kCount if this category is unknown.
+		 */
+		uint32_t GetIndex() const;
+
+		/**
+		  Gets the max number of this category's requests allowed to wait on Steam at the same time by default.
+		  @return Returns the default concurrency limit. Zero means unlimited.
+		 */
+		uint32_t GetDefaultConcurrencyLimit() const;
+
+		/**
+		  Gets this category's default share of queued requests sent relative to other categories.
+		  For example, a category with a weight of 2 is sent twice as many queued requests as a category
+		  with a weight of 1 while both have requests queued.
+		  @return Returns the default weight, which is at least 1.
+		 */
+		uint32_t GetDefaultWeight() const;
+
+		/**
+		  Determines if this category matches the given category.
+		  @param category The category to be compared with.
+		  @return Returns true if the categories match. Returns false if they don't match.
+		 */
+		bool operator==(const SteamRequestCategory& category) const;
+
+		/**
+		  Determines if this category does not match the given category.
+		  @param category The category to be compared with.
+		  @return Returns true if the categories do not match. Returns false if they do.
+		 */
+		bool operator!=(const SteamRequestCategory& category) const;
+
+		/**
+		  Returns a new instance of this class matching the given string ID.
+		  @param stringId Unique string ID identifying the category such as
+		                  "leaderboardFind", "leaderboardDownload", or "leaderboardUpload".
+		  @return Returns a new category instance matching the string ID such as
+		          kLeaderboardFind, kLeaderboardDownload, or kLeaderboardUpload.
+
+		          Returns kUnknown if given an unknown string ID or null.
+		 */
+		static SteamRequestCategory FromCoronaStringId(const char* stringId);
+
+		/**
+		  Returns a new instance of this class matching the given index.
+		  @param index Zero based index of the category. Expected to be less than kCount.
+		  @return Returns a new category instance matching the index. Returns kUnknown if out of range.
+		 */
+		static SteamRequestCategory FromIndex(uint32_t index);
+
+	private:
+		/** Unique string ID assigned to the category such as "leaderboardFind", "leaderboardDownload", etc. */
+		const char* fCoronaStringId;
+
+		/** Unique zero based index assigned to the category. Set to kCount if unknown. */
+		uint32_t fIndex;
+
+		/** Default max number of the category's requests waiting on Steam at the same time. Zero means unlimited. */
+		uint32_t fDefaultConcurrencyLimit;
+
+		/** Default share of queued requests sent relative to other categories. */
+		uint32_t fDefaultWeight;
+};
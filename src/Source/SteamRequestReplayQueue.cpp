@@ -0,0 +1,316 @@
+// ----------------------------------------------------------------------------
+// 
+// SteamRequestReplayQueue.cpp
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#include "SteamRequestReplayQueue.h"
+
+
+/** Backoff delay used to spread out the replay of parked requests after Steam reconnects for the first time. */
+static const uint32_t kParkedRequestReplayBaseDelayInMilliseconds = 250;
+
+/** Max backoff delay used to spread out the replay of parked requests after Steam reconnects repeatedly. */
+static const uint32_t kParkedRequestReplayMaxDelayInMilliseconds = 16000;
+
+/**
+  Min amount of time Steam must stay connected after reconnecting for the next reconnect to be treated as a
+  fresh reconnect, resetting the parked request replay backoff delay, instead of a flapping connection.
+ */
+static const uint32_t kStableConnectionDurationInMilliseconds = 60000;
+
+/** Default max number of times a request's Steam call is made when it keeps failing with an I/O failure. */
+static const uint32_t kDefaultRequestRetryMaxAttemptCount = 3;
+
+/** Default max delay before retrying a Steam call for the first time. Doubles for every following retry. */
+static const uint32_t kDefaultRequestRetryBaseDelayInMilliseconds = 500;
+
+/** Default upper limit of the doubling retry delay. */
+static const uint32_t kDefaultRequestRetryMaxDelayInMilliseconds = 8000;
+
+/** Default max number of retries each request category may make per minute. */
+static const uint32_t kDefaultRequestRetryBudgetPerMinute = 30;
+
+
+SteamRequestReplayQueue::SteamRequestReplayQueue()
+:	fTotalParkedRequestCount(0),
+	fConsecutiveReconnectCount(0),
+	fReplayJitterGenerator((std::minstd_rand::result_type)std::chrono::steady_clock::now().time_since_epoch().count())
+{
+	for (auto&& categoryState : fCategoryRetryStateArray)
+	{
+		categoryState.Policy.MaxAttemptCount = kDefaultRequestRetryMaxAttemptCount;
+		categoryState.Policy.BaseDelayInMilliseconds = kDefaultRequestRetryBaseDelayInMilliseconds;
+		categoryState.Policy.MaxDelayInMilliseconds = kDefaultRequestRetryMaxDelayInMilliseconds;
+		categoryState.Policy.BudgetPerMinute = kDefaultRequestRetryBudgetPerMinute;
+		categoryState.BudgetUsedCount = 0;
+		categoryState.TotalRetryCount = 0;
+		categoryState.TotalBudgetExhaustedCount = 0;
+	}
+}
+
+SteamRequestReplayQueue::~SteamRequestReplayQueue()
+{
+}
+
+void SteamRequestReplayQueue::Park(SteamParkedRequest& request)
+{
+	fParkedRequestCollection.push_back(std::move(request));
+	fTotalParkedRequestCount++;
+}
+
+uint32_t SteamRequestReplayQueue::GetParkedRequestCount() const
+{
+	return (uint32_t)fParkedRequestCollection.size();
+}
+
+uint64_t SteamRequestReplayQueue::GetTotalParkedRequestCount() const
+{
+	return fTotalParkedRequestCount;
+}
+
+SteamParkedRequest* SteamRequestReplayQueue::FindParkedRequest(uint64_t requestId)
+{
+	for (auto&& request : fParkedRequestCollection)
+	{
+		if (request.RequestId == requestId)
+		{
+			return &request;
+		}
+	}
+	return nullptr;
+}
+
+bool SteamRequestReplayQueue::RemoveParkedRequest(uint64_t requestId)
+{
+	for (auto iterator = fParkedRequestCollection.begin(); iterator != fParkedRequestCollection.end(); ++iterator)
+	{
+		if (iterator->RequestId == requestId)
+		{
+			fParkedRequestCollection.erase(iterator);
+			return true;
+		}
+	}
+	return false;
+}
+
+void SteamRequestReplayQueue::ScheduleReplay(SteamParkedRequest& request)
+{
+	// Double the backoff delay for every reconnect that happened shortly after the previous one.
+	uint32_t maxDelayInMilliseconds = kParkedRequestReplayBaseDelayInMilliseconds;
+	for (uint32_t count = 0; count < fConsecutiveReconnectCount; count++)
+	{
+		if (maxDelayInMilliseconds >= (kParkedRequestReplayMaxDelayInMilliseconds / 2))
+		{
+			maxDelayInMilliseconds = kParkedRequestReplayMaxDelayInMilliseconds;
+			break;
+		}
+		maxDelayInMilliseconds *= 2;
+	}
+
+	// Pick a random time within the 2nd half of the backoff delay so that parked requests trickle out to Steam,
+	// and so that multiple runtimes and apps sharing the same connection do not replay in lockstep.
+	std::uniform_int_distribution<uint32_t> distribution(maxDelayInMilliseconds / 2, maxDelayInMilliseconds);
+	request.ReplayTime = fLastReconnectTime + std::chrono::milliseconds(distribution(fReplayJitterGenerator));
+	request.IsReplayScheduled = true;
+}
+
+void SteamRequestReplayQueue::OnSteamReconnected()
+{
+	// Grow the replay backoff delay if Steam's connection is flapping. Reset it if it was stable for a while.
+	const auto currentTime = std::chrono::steady_clock::now();
+	const auto stableDuration = std::chrono::milliseconds(kStableConnectionDurationInMilliseconds);
+	const bool hasReconnectedBefore = (fLastReconnectTime != std::chrono::steady_clock::time_point());
+	if (hasReconnectedBefore && ((currentTime - fLastReconnectTime) < stableDuration))
+	{
+		fConsecutiveReconnectCount++;
+	}
+	else
+	{
+		fConsecutiveReconnectCount = 0;
+	}
+	fLastReconnectTime = currentTime;
+
+	// Schedule all parked requests to be replayed over time.
+	for (auto&& request : fParkedRequestCollection)
+	{
+		ScheduleReplay(request);
+	}
+}
+
+void SteamRequestReplayQueue::OnSteamDisconnected()
+{
+	for (auto&& request : fParkedRequestCollection)
+	{
+		request.IsReplayScheduled = false;
+	}
+}
+
+void SteamRequestReplayQueue::ScheduleImmediateReplay()
+{
+	const auto currentTime = std::chrono::steady_clock::now();
+	for (auto&& request : fParkedRequestCollection)
+	{
+		request.ReplayTime = currentTime;
+		request.IsReplayScheduled = true;
+	}
+}
+
+SteamRequestReplayQueue::RetryPolicy SteamRequestReplayQueue::GetRetryPolicyFor(uint32_t categoryIndex) const
+{
+	if (categoryIndex >= SteamRequestCategory::kCount)
+	{
+		RetryPolicy policy{};
+		policy.MaxAttemptCount = 1;
+		return policy;
+	}
+	return fCategoryRetryStateArray[categoryIndex].Policy;
+}
+
+void SteamRequestReplayQueue::SetRetryPolicyFor(
+	uint32_t categoryIndex, const SteamRequestReplayQueue::RetryPolicy& policy)
+{
+	if (categoryIndex >= SteamRequestCategory::kCount)
+	{
+		return;
+	}
+	auto& categoryPolicy = fCategoryRetryStateArray[categoryIndex].Policy;
+	categoryPolicy = policy;
+	if (categoryPolicy.MaxAttemptCount < 1)
+	{
+		categoryPolicy.MaxAttemptCount = 1;
+	}
+}
+
+bool SteamRequestReplayQueue::IsRetryEnabledIn(uint32_t categoryIndex) const
+{
+	if (categoryIndex >= SteamRequestCategory::kCount)
+	{
+		return false;
+	}
+	return (fCategoryRetryStateArray[categoryIndex].Policy.MaxAttemptCount > 1);
+}
+
+uint64_t SteamRequestReplayQueue::GetTotalRetryCountFor(uint32_t categoryIndex) const
+{
+	if (categoryIndex >= SteamRequestCategory::kCount)
+	{
+		return 0;
+	}
+	return fCategoryRetryStateArray[categoryIndex].TotalRetryCount;
+}
+
+uint64_t SteamRequestReplayQueue::GetTotalRetryBudgetExhaustedCountFor(uint32_t categoryIndex) const
+{
+	if (categoryIndex >= SteamRequestCategory::kCount)
+	{
+		return 0;
+	}
+	return fCategoryRetryStateArray[categoryIndex].TotalBudgetExhaustedCount;
+}
+
+void SteamRequestReplayQueue::AddRetryableRequest(SteamParkedRequest& request)
+{
+	auto requestId = request.RequestId;
+	fRetryableRequestMap.emplace(requestId, std::move(request));
+}
+
+bool SteamRequestReplayQueue::TakeRetryableRequest(uint64_t requestId, SteamParkedRequest& request)
+{
+	if (fRetryableRequestMap.empty())
+	{
+		return false;
+	}
+	auto iterator = fRetryableRequestMap.find(requestId);
+	if (iterator == fRetryableRequestMap.end())
+	{
+		return false;
+	}
+	request = std::move(iterator->second);
+	fRetryableRequestMap.erase(iterator);
+	return true;
+}
+
+void SteamRequestReplayQueue::RemoveRetryableRequest(uint64_t requestId)
+{
+	fRetryableRequestMap.erase(requestId);
+}
+
+bool SteamRequestReplayQueue::TryConsumeRetryFor(const SteamParkedRequest& request)
+{
+	// Do not retry if the request has made all of its attempts or if it would time out anyways.
+	if (request.CategoryIndex >= SteamRequestCategory::kCount)
+	{
+		return false;
+	}
+	auto& categoryState = fCategoryRetryStateArray[request.CategoryIndex];
+	if (request.AttemptCount >= categoryState.Policy.MaxAttemptCount)
+	{
+		return false;
+	}
+	const auto currentTime = std::chrono::steady_clock::now();
+	if (request.HasTimeout && (currentTime >= request.ExpirationTime))
+	{
+		return false;
+	}
+
+	// Do not retry if the category has used up its retries for the current minute.
+	// This keeps a Steam outage from being met with a flood of retries.
+	if (categoryState.Policy.BudgetPerMinute > 0)
+	{
+		if ((currentTime - categoryState.BudgetWindowStartTime) >= std::chrono::minutes(1))
+		{
+			categoryState.BudgetWindowStartTime = currentTime;
+			categoryState.BudgetUsedCount = 0;
+		}
+		if (categoryState.BudgetUsedCount >= categoryState.Policy.BudgetPerMinute)
+		{
+			categoryState.TotalBudgetExhaustedCount++;
+			return false;
+		}
+		categoryState.BudgetUsedCount++;
+	}
+	categoryState.TotalRetryCount++;
+	return true;
+}
+
+void SteamRequestReplayQueue::ParkForRetry(SteamParkedRequest& request, bool canReplay)
+{
+	// Double the retry delay for every attempt the request has made after its first, up to the max delay.
+	uint32_t maxDelayInMilliseconds = 0;
+	if (request.CategoryIndex < SteamRequestCategory::kCount)
+	{
+		const auto& policy = fCategoryRetryStateArray[request.CategoryIndex].Policy;
+		maxDelayInMilliseconds = policy.BaseDelayInMilliseconds;
+		for (uint32_t count = 1; count < request.AttemptCount; count++)
+		{
+			if (maxDelayInMilliseconds >= (policy.MaxDelayInMilliseconds / 2))
+			{
+				maxDelayInMilliseconds = policy.MaxDelayInMilliseconds;
+				break;
+			}
+			maxDelayInMilliseconds *= 2;
+		}
+		if (maxDelayInMilliseconds > policy.MaxDelayInMilliseconds)
+		{
+			maxDelayInMilliseconds = policy.MaxDelayInMilliseconds;
+		}
+	}
+
+	// Pick a random time within the 2nd half of the delay so that requests failed by the same hiccup
+	// do not all retry at the same time. If Steam is disconnected, then the retry is scheduled once it reconnects.
+	std::uniform_int_distribution<uint32_t> distribution(maxDelayInMilliseconds / 2, maxDelayInMilliseconds);
+	request.ReplayTime =
+			std::chrono::steady_clock::now() + std::chrono::milliseconds(distribution(fReplayJitterGenerator));
+	request.IsReplayScheduled = canReplay;
+	fParkedRequestCollection.push_back(std::move(request));
+}
+
+void SteamRequestReplayQueue::Clear()
+{
+	fParkedRequestCollection.clear();
+	fRetryableRequestMap.clear();
+}
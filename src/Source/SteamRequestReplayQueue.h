@@ -0,0 +1,274 @@
+// ----------------------------------------------------------------------------
+// 
+// SteamRequestReplayQueue.h
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#pragma once
+
+#include "SteamParkedRequest.h"
+#include "SteamRequestCategory.h"
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+
+/**
+  Stores requests whose Steam call is to be made at a later time and decides when to make it.
+
+  Requests made while Steam is disconnected are parked and replayed once it reconnects, spread out over a
+  randomized backoff delay which doubles while the connection keeps flapping.
+
+  Requests whose category retries I/O failures are remembered while waiting on Steam. If their call fails,
+  then they are parked again until their retry time, as allowed by their category's RetryPolicy and its
+  per-minute retry budget.
+
+  This class only stores and schedules requests. Sending them is up to its owner, the RuntimeContext.
+  This class is not thread safe. A RuntimeContext only accesses it while holding the SteamCallbackPump's mutex.
+ */
+class SteamRequestReplayQueue
+{
+	public:
+		/** Settings deciding if and when a request category's Steam calls are retried after an I/O failure. */
+		struct RetryPolicy
+		{
+			/** Max number of times a request's Steam call is made, including its first attempt. 1 disables retries. */
+			uint32_t MaxAttemptCount;
+
+			/** Max delay before the 1st retry. Doubles for every following retry. */
+			uint32_t BaseDelayInMilliseconds;
+
+			/** Upper limit of the doubling retry delay. */
+			uint32_t MaxDelayInMilliseconds;
+
+			/** Max number of retries the category may make per minute. Zero means unlimited. */
+			uint32_t BudgetPerMinute;
+		};
+
+
+		/** Creates a new empty queue applying the default retry policy to every request category. */
+		SteamRequestReplayQueue();
+
+		/** Destroys all parked and retryable requests, releasing their tasks. */
+		virtual ~SteamRequestReplayQueue();
+
+		/**
+		  Adds the given request to the back of the parked requests, to be replayed once its replay time is scheduled.
+		  @param request The request to park, which is moved into this queue.
+		 */
+		void Park(SteamParkedRequest& request);
+
+		/**
+		  Gets the number of requests waiting to be replayed, including failed requests waiting to be retried.
+		  @return Returns the number of parked requests.
+		 */
+		uint32_t GetParkedRequestCount() const;
+
+		/**
+		  Gets the number of requests parked via the Park() method.
+		  @return Returns the number of parked requests since this queue was created.
+		 */
+		uint64_t GetTotalParkedRequestCount() const;
+
+		/**
+		  Fetches a parked request by its ID.
+		  @param requestId ID of the request to find.
+		  @return Returns a pointer to the parked request. Returns null if not parked.
+		 */
+		SteamParkedRequest* FindParkedRequest(uint64_t requestId);
+
+		/**
+		  Removes the given parked request, destroying it.
+		  @param requestId ID of the request to remove.
+		  @return Returns true if the request was removed. Returns false if not parked.
+		 */
+		bool RemoveParkedRequest(uint64_t requestId);
+
+		template<class TPredicate>
+		/**
+		  Removes all parked requests matching the given predicate, preserving the order of the others.
+		  @param predicate Function invoked with a "SteamParkedRequest&" which returns true to remove the request.
+		                   It may move the request out, but must not add or remove parked requests.
+		 */
+		void RemoveParkedRequestsIf(TPredicate predicate);
+
+		/**
+		  Sets the time at which the given request will be replayed, which is randomly picked between half and all
+		  of the current backoff delay after the last reconnect. The backoff delay doubles every time Steam reconnects
+		  shortly after its last reconnect, which keeps a flapping connection from being hammered.
+		  @param request The request to schedule, to be parked afterwards.
+		 */
+		void ScheduleReplay(SteamParkedRequest& request);
+
+		/**
+		  To be called when Steam reconnects. Grows the replay backoff delay if the connection is flapping, or
+		  resets it if the connection was stable for a while, and then schedules the replay of all parked requests.
+		 */
+		void OnSteamReconnected();
+
+		/** To be called when Steam disconnects. Stops replaying parked requests until Steam reconnects. */
+		void OnSteamDisconnected();
+
+		/** Schedules all parked requests to be replayed right away, such as once Steam has been initialized. */
+		void ScheduleImmediateReplay();
+
+		/**
+		  Gets the settings deciding if and when the given category's Steam calls are retried after an I/O failure.
+		  @param categoryIndex Index of the SteamRequestCategory to fetch the retry policy of.
+		  @return Returns the category's retry policy. Returns a policy with retries disabled if given an invalid index.
+		 */
+		SteamRequestReplayQueue::RetryPolicy GetRetryPolicyFor(uint32_t categoryIndex) const;
+
+		/**
+		  Sets the settings deciding if and when the given category's Steam calls are retried after an I/O failure.
+		  @param categoryIndex Index of the SteamRequestCategory to configure. Ignored if invalid.
+		  @param policy The retry settings to copy. A "MaxAttemptCount" less than 1 is treated as 1.
+		 */
+		void SetRetryPolicyFor(uint32_t categoryIndex, const SteamRequestReplayQueue::RetryPolicy& policy);
+
+		/**
+		  Determines if the given category's retry policy allows retrying its requests at all.
+		  @param categoryIndex Index of the request's SteamRequestCategory.
+		  @return Returns true if the category's max attempt count is greater than 1. Returns false if not.
+		 */
+		bool IsRetryEnabledIn(uint32_t categoryIndex) const;
+
+		/**
+		  Gets the number of the given category's Steam calls that were retried after an I/O failure.
+		  @param categoryIndex Index of the SteamRequestCategory to fetch the count for.
+		  @return Returns the number of retries since this queue was created. Returns zero if given an invalid index.
+		 */
+		uint64_t GetTotalRetryCountFor(uint32_t categoryIndex) const;
+
+		/**
+		  Gets the number of the given category's I/O failures not retried because its retry budget was used up.
+		  @param categoryIndex Index of the SteamRequestCategory to fetch the count for.
+		  @return Returns the number of skipped retries since this queue was created.
+
+		          Returns zero if given an invalid index.
+		 */
+		uint64_t GetTotalRetryBudgetExhaustedCountFor(uint32_t categoryIndex) const;
+
+		/**
+		  Keeps the record of a request that is waiting on Steam, needed to make its Steam call again if it fails.
+		  @param request The record of the request, which is moved into this queue. Its task must have been moved out.
+		 */
+		void AddRetryableRequest(SteamParkedRequest& request);
+
+		/**
+		  Removes the record of the given request added via AddRetryableRequest().
+		  @param requestId ID of the request whose record is to be removed.
+		  @param request Assigned the request's record if this method returns true.
+		  @return Returns true if the record was removed. Returns false if the request has no record.
+		 */
+		bool TakeRetryableRequest(uint64_t requestId, SteamParkedRequest& request);
+
+		/**
+		  Destroys the record of the given request added via AddRetryableRequest(), if any.
+		  @param requestId ID of the request whose record is to be destroyed.
+		 */
+		void RemoveRetryableRequest(uint64_t requestId);
+
+		/**
+		  Determines if the given request may be retried after an I/O failure and, if so, uses up 1 retry of its
+		  category's per-minute budget. A request is not retried once it has made its category's max number of
+		  attempts or once its timeout has elapsed.
+		  @param request The record of the request that failed.
+		  @return Returns true if the request is to be retried. Returns false if its failure is to be dispatched.
+		 */
+		bool TryConsumeRetryFor(const SteamParkedRequest& request);
+
+		/**
+		  Parks the given failed request until its retry time, which is randomly picked between half and all of its
+		  category's retry delay. The delay doubles for every attempt the request has made, up to the category's
+		  max delay. Not counted by GetTotalParkedRequestCount().
+		  @param request The request to retry, which is moved into this queue.
+		  @param canReplay Set true if Steam can receive requests right now. Set false to leave the retry unscheduled
+		                   until OnSteamReconnected() or ScheduleImmediateReplay() is called.
+		 */
+		void ParkForRetry(SteamParkedRequest& request, bool canReplay);
+
+		/** Destroys all parked requests and retryable request records. Keeps the retry policies and metrics. */
+		void Clear();
+
+	private:
+		/** Copy constructor deleted to prevent it from being called. */
+		SteamRequestReplayQueue(const SteamRequestReplayQueue&) = delete;
+
+		/** Copy operator deleted to prevent it from being called. */
+		void operator=(const SteamRequestReplayQueue&) = delete;
+
+
+		/** Retry state of 1 request category. */
+		struct CategoryRetryState
+		{
+			/** Decides if and when the category's requests are retried after an I/O failure. */
+			RetryPolicy Policy;
+
+			/** Time at which the category's current 1 minute retry budget window started. */
+			std::chrono::steady_clock::time_point BudgetWindowStartTime;
+
+			/** Number of retries made during the current retry budget window. */
+			uint32_t BudgetUsedCount;
+
+			/** Number of Steam calls of the category that were retried after an I/O failure. */
+			uint64_t TotalRetryCount;
+
+			/** Number of I/O failures that were not retried because the category's retry budget was used up. */
+			uint64_t TotalBudgetExhaustedCount;
+		};
+
+		/** Requests waiting to be replayed, in the order they were parked. */
+		std::vector<SteamParkedRequest> fParkedRequestCollection;
+
+		/** Number of requests parked via Park() since this queue was created. */
+		uint64_t fTotalParkedRequestCount;
+
+		/** Time at which Steam last reconnected. */
+		std::chrono::steady_clock::time_point fLastReconnectTime;
+
+		/**
+		  Number of times Steam reconnected shortly after its previous reconnect.
+		  Doubles the parked request replay backoff delay each time.
+		 */
+		uint32_t fConsecutiveReconnectCount;
+
+		/** Generates the random jitter applied to replay and retry times. */
+		std::minstd_rand fReplayJitterGenerator;
+
+		/** Retry state of each request category, indexed by SteamRequestCategory::GetIndex(). */
+		CategoryRetryState fCategoryRetryStateArray[SteamRequestCategory::kCount];
+
+		/**
+		  Records of requests waiting on Steam whose category retries I/O failures, keyed by request ID.
+		  Keeps the callback needed to make the request's Steam call again. The record is moved to the
+		  parked requests while waiting to be retried and is removed once the request has completed.
+		 */
+		std::unordered_map<uint64_t, SteamParkedRequest> fRetryableRequestMap;
+};
+
+
+// ------------------------------------------------------------------------------------------
+// Templatized class method defined below to prevent it from being inlined into calling code.
+// ------------------------------------------------------------------------------------------
+
+template<class TPredicate>
+void SteamRequestReplayQueue::RemoveParkedRequestsIf(TPredicate predicate)
+{
+	for (auto iterator = fParkedRequestCollection.begin(); iterator != fParkedRequestCollection.end();)
+	{
+		if (predicate(*iterator))
+		{
+			iterator = fParkedRequestCollection.erase(iterator);
+		}
+		else
+		{
+			++iterator;
+		}
+	}
+}
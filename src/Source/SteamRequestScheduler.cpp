@@ -0,0 +1,208 @@
+// ----------------------------------------------------------------------------
+// 
+// SteamRequestScheduler.cpp
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#include "SteamRequestScheduler.h"
+
+
+SteamRequestScheduler::SteamRequestScheduler()
+:	fVirtualTime(0)
+{
+	for (uint32_t index = 0; index < SteamRequestCategory::kCount; index++)
+	{
+		auto category = SteamRequestCategory::FromIndex(index);
+		auto& categoryState = fCategoryStateArray[index];
+		categoryState.Statistics = CategoryStatistics{};
+		categoryState.Statistics.ConcurrencyLimit = category.GetDefaultConcurrencyLimit();
+		categoryState.Statistics.Weight = category.GetDefaultWeight();
+		categoryState.VirtualFinishTime = 0;
+	}
+}
+
+SteamRequestScheduler::~SteamRequestScheduler()
+{
+}
+
+SteamRequestScheduler::CategoryStatistics SteamRequestScheduler::GetStatisticsFor(uint32_t categoryIndex) const
+{
+	if (categoryIndex >= SteamRequestCategory::kCount)
+	{
+		return CategoryStatistics{};
+	}
+	return fCategoryStateArray[categoryIndex].Statistics;
+}
+
+void SteamRequestScheduler::SetConcurrencyLimitFor(uint32_t categoryIndex, uint32_t value)
+{
+	if (categoryIndex < SteamRequestCategory::kCount)
+	{
+		fCategoryStateArray[categoryIndex].Statistics.ConcurrencyLimit = value;
+	}
+}
+
+void SteamRequestScheduler::SetWeightFor(uint32_t categoryIndex, uint32_t value)
+{
+	if (categoryIndex < SteamRequestCategory::kCount)
+	{
+		fCategoryStateArray[categoryIndex].Statistics.Weight = (value > 0) ? value : 1;
+	}
+}
+
+void SteamRequestScheduler::OnRequestStarted(uint32_t categoryIndex)
+{
+	if (categoryIndex < SteamRequestCategory::kCount)
+	{
+		fCategoryStateArray[categoryIndex].Statistics.ActiveRequestCount++;
+	}
+}
+
+void SteamRequestScheduler::OnRequestEnded(uint32_t categoryIndex)
+{
+	if (categoryIndex < SteamRequestCategory::kCount)
+	{
+		auto& statistics = fCategoryStateArray[categoryIndex].Statistics;
+		if (statistics.ActiveRequestCount > 0)
+		{
+			statistics.ActiveRequestCount--;
+		}
+	}
+}
+
+bool SteamRequestScheduler::CanSendNowIn(uint32_t categoryIndex) const
+{
+	if (categoryIndex >= SteamRequestCategory::kCount)
+	{
+		return true;
+	}
+	const auto& categoryState = fCategoryStateArray[categoryIndex];
+	if (!categoryState.QueuedRequestCollection.empty())
+	{
+		return false;
+	}
+	const auto& statistics = categoryState.Statistics;
+	return ((0 == statistics.ConcurrencyLimit) || (statistics.ActiveRequestCount < statistics.ConcurrencyLimit));
+}
+
+bool SteamRequestScheduler::Enqueue(SteamParkedRequest& request)
+{
+	// Validate.
+	if (request.CategoryIndex >= SteamRequestCategory::kCount)
+	{
+		return false;
+	}
+
+	// If the category was idle, then catch its virtual time up with the scheduler's so that it competes fairly.
+	auto& categoryState = fCategoryStateArray[request.CategoryIndex];
+	if (categoryState.QueuedRequestCollection.empty() && (categoryState.VirtualFinishTime < fVirtualTime))
+	{
+		categoryState.VirtualFinishTime = fVirtualTime;
+	}
+
+	// Add the request to the back of its category's queue.
+	request.QueueTime = std::chrono::steady_clock::now();
+	categoryState.QueuedRequestCollection.push_back(std::move(request));
+	auto& statistics = categoryState.Statistics;
+	statistics.QueuedRequestCount = (uint32_t)categoryState.QueuedRequestCollection.size();
+	statistics.TotalQueuedRequestCount++;
+	if (statistics.QueuedRequestCount > statistics.PeakQueuedRequestCount)
+	{
+		statistics.PeakQueuedRequestCount = statistics.QueuedRequestCount;
+	}
+	return true;
+}
+
+bool SteamRequestScheduler::TryDequeue(SteamParkedRequest& request)
+{
+	// Pick the category whose next request has the earliest virtual finish time.
+	CategoryState* selectedCategoryStatePointer = nullptr;
+	double selectedVirtualFinishTime = 0;
+	for (auto&& categoryState : fCategoryStateArray)
+	{
+		const auto& statistics = categoryState.Statistics;
+		if (categoryState.QueuedRequestCollection.empty())
+		{
+			continue;
+		}
+		if (statistics.ConcurrencyLimit && (statistics.ActiveRequestCount >= statistics.ConcurrencyLimit))
+		{
+			continue;
+		}
+		double virtualFinishTime = categoryState.VirtualFinishTime + (1.0 / (double)statistics.Weight);
+		if (!selectedCategoryStatePointer || (virtualFinishTime < selectedVirtualFinishTime))
+		{
+			selectedCategoryStatePointer = &categoryState;
+			selectedVirtualFinishTime = virtualFinishTime;
+		}
+	}
+	if (!selectedCategoryStatePointer)
+	{
+		return false;
+	}
+
+	// Remove the category's oldest request from its queue and record how long it waited.
+	auto& categoryState = *selectedCategoryStatePointer;
+	auto& statistics = categoryState.Statistics;
+	categoryState.VirtualFinishTime = selectedVirtualFinishTime;
+	fVirtualTime = selectedVirtualFinishTime;
+	request = std::move(categoryState.QueuedRequestCollection.front());
+	categoryState.QueuedRequestCollection.pop_front();
+	statistics.QueuedRequestCount = (uint32_t)categoryState.QueuedRequestCollection.size();
+	auto waitTime = std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now() - request.QueueTime);
+	auto waitTimeInMicroseconds = (waitTime.count() > 0) ? (uint64_t)waitTime.count() : 0;
+	statistics.TotalDequeuedRequestCount++;
+	statistics.TotalQueueWaitTimeInMicroseconds += waitTimeInMicroseconds;
+	if (waitTimeInMicroseconds > statistics.MaxQueueWaitTimeInMicroseconds)
+	{
+		statistics.MaxQueueWaitTimeInMicroseconds = waitTimeInMicroseconds;
+	}
+	return true;
+}
+
+SteamParkedRequest* SteamRequestScheduler::FindQueuedRequest(uint64_t requestId)
+{
+	for (auto&& categoryState : fCategoryStateArray)
+	{
+		for (auto&& request : categoryState.QueuedRequestCollection)
+		{
+			if (request.RequestId == requestId)
+			{
+				return &request;
+			}
+		}
+	}
+	return nullptr;
+}
+
+bool SteamRequestScheduler::RemoveQueuedRequest(uint64_t requestId)
+{
+	for (auto&& categoryState : fCategoryStateArray)
+	{
+		auto& queuedRequestCollection = categoryState.QueuedRequestCollection;
+		for (auto iterator = queuedRequestCollection.begin(); iterator != queuedRequestCollection.end(); ++iterator)
+		{
+			if (iterator->RequestId == requestId)
+			{
+				queuedRequestCollection.erase(iterator);
+				categoryState.Statistics.QueuedRequestCount = (uint32_t)queuedRequestCollection.size();
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+void SteamRequestScheduler::Clear()
+{
+	for (auto&& categoryState : fCategoryStateArray)
+	{
+		categoryState.QueuedRequestCollection.clear();
+		categoryState.Statistics.ActiveRequestCount = 0;
+		categoryState.Statistics.QueuedRequestCount = 0;
+	}
+}
@@ -0,0 +1,215 @@
+// ----------------------------------------------------------------------------
+// 
+// SteamRequestScheduler.h
+// Copyright (c) 2016 Corona Labs Inc. All rights reserved.
+// This software may be modified and distributed under the terms
+// of the MIT license.  See the LICENSE file for details.
+//
+// ----------------------------------------------------------------------------
+
+#pragma once
+
+#include "SteamParkedRequest.h"
+#include "SteamRequestCategory.h"
+#include <chrono>
+#include <cstdint>
+#include <deque>
+
+
+/**
+  Limits how many requests of each SteamRequestCategory may wait on Steam at the same time and queues the rest.
+
+  Queued requests are handed back via TryDequeue() once their category drops below its concurrency limit.
+  When several categories can send, the one with the earliest virtual finish time is picked, which shares the
+  available sends between categories in proportion to their weights (ie: weighted fair queuing).
+
+  This class is not thread safe. A RuntimeContext only accesses it while holding the SteamCallbackPump's mutex.
+ */
+class SteamRequestScheduler
+{
+	public:
+		/** Scheduling settings and metrics of 1 request category. */
+		struct CategoryStatistics
+		{
+			/** Max number of the category's requests allowed to wait on Steam at the same time. Zero if unlimited. */
+			uint32_t ConcurrencyLimit;
+
+			/** The category's share of queued requests sent relative to other categories. */
+			uint32_t Weight;
+
+			/** Number of the category's requests currently waiting on Steam's result. */
+			uint32_t ActiveRequestCount;
+
+			/** Number of the category's requests currently queued behind its concurrency limit. */
+			uint32_t QueuedRequestCount;
+
+			/** Highest "QueuedRequestCount" since this scheduler was created. */
+			uint32_t PeakQueuedRequestCount;
+
+			/** Number of the category's requests that were queued since this scheduler was created. */
+			uint64_t TotalQueuedRequestCount;
+
+			/** Number of the category's queued requests that have been dequeued since this scheduler was created. */
+			uint64_t TotalDequeuedRequestCount;
+
+			/** Sum of the time all dequeued requests spent in the queue. */
+			uint64_t TotalQueueWaitTimeInMicroseconds;
+
+			/** Longest time a dequeued request spent in the queue. */
+			uint64_t MaxQueueWaitTimeInMicroseconds;
+		};
+
+
+		/** Creates a new scheduler applying each category's default concurrency limit and weight. */
+		SteamRequestScheduler();
+
+		/** Destroys all queued requests, releasing their tasks. */
+		virtual ~SteamRequestScheduler();
+
+		/**
+		  Gets the scheduling settings and metrics of the given category.
+		  @param categoryIndex Index of the SteamRequestCategory to fetch statistics for.
+		  @return Returns the category's statistics. Returns zeroed statistics if given an invalid index.
+		 */
+		SteamRequestScheduler::CategoryStatistics GetStatisticsFor(uint32_t categoryIndex) const;
+
+		/**
+		  Sets the max number of the given category's requests allowed to wait on Steam at the same time.
+		  @param categoryIndex Index of the SteamRequestCategory to configure. Ignored if invalid.
+		  @param value The max number of concurrent requests. Zero means unlimited.
+		 */
+		void SetConcurrencyLimitFor(uint32_t categoryIndex, uint32_t value);
+
+		/**
+		  Sets the given category's share of queued requests sent relative to other categories.
+		  @param categoryIndex Index of the SteamRequestCategory to configure. Ignored if invalid.
+		  @param value The category's weight. Values less than 1 are treated as 1.
+		 */
+		void SetWeightFor(uint32_t categoryIndex, uint32_t value);
+
+		/**
+		  To be called when a request of the given category starts waiting on Steam's result.
+		  Counts the request against its category's concurrency limit.
+		  @param categoryIndex Index of the request's SteamRequestCategory. Ignored if uncategorized.
+		 */
+		void OnRequestStarted(uint32_t categoryIndex);
+
+		/**
+		  To be called when a request of the given category is no longer waiting on Steam's result,
+		  making room for another request of its category.
+		  @param categoryIndex Index of the request's SteamRequestCategory. Ignored if uncategorized.
+		 */
+		void OnRequestEnded(uint32_t categoryIndex);
+
+		/**
+		  Determines if a request of the given category can be sent to Steam right away. That is, if the category
+		  is below its concurrency limit and has no requests queued ahead of it.
+		  @param categoryIndex Index of the request's SteamRequestCategory.
+		  @return Returns true if the request can be sent now. Returns false if it must be queued.
+		 */
+		bool CanSendNowIn(uint32_t categoryIndex) const;
+
+		/**
+		  Moves the given request to the back of its category's queue, to be handed back by TryDequeue().
+		  @param request The request to be queued.
+		  @return Returns true if the request was queued.
+
+		          Returns false if the request is uncategorized, in which case it is left untouched
+		          and the caller is expected to send it right away.
+		 */
+		bool Enqueue(SteamParkedRequest& request);
+
+		/**
+		  Removes the next request to be sent from its category's queue, picking the category having the earliest
+		  virtual finish time among the categories that are below their concurrency limit.
+		  @param request Assigned the dequeued request if this method returns true.
+		  @return Returns true if a request was dequeued.
+
+		          Returns false if all categories are empty or at their concurrency limit.
+		 */
+		bool TryDequeue(SteamParkedRequest& request);
+
+		/**
+		  Fetches a queued request by its ID.
+		  @param requestId ID of the request to find.
+		  @return Returns a pointer to the queued request. Returns null if not queued.
+		 */
+		SteamParkedRequest* FindQueuedRequest(uint64_t requestId);
+
+		/**
+		  Removes the given request from its category's queue, destroying it.
+		  @param requestId ID of the request to remove.
+		  @return Returns true if the request was removed. Returns false if not queued.
+		 */
+		bool RemoveQueuedRequest(uint64_t requestId);
+
+		template<class TPredicate>
+		/**
+		  Removes all queued requests matching the given predicate, preserving the order of the others.
+		  @param predicate Function invoked with a "SteamParkedRequest&" which returns true to remove the request.
+		                   It may move the request's task out, but must not access this scheduler.
+		 */
+		void RemoveQueuedRequestsIf(TPredicate predicate);
+
+		/** Destroys all queued requests and resets the number of active requests of every category. */
+		void Clear();
+
+	private:
+		/** Copy constructor deleted to prevent it from being called. */
+		SteamRequestScheduler(const SteamRequestScheduler&) = delete;
+
+		/** Copy operator deleted to prevent it from being called. */
+		void operator=(const SteamRequestScheduler&) = delete;
+
+
+		/** Scheduling state of 1 request category, used to limit its concurrency and queue its excess requests. */
+		struct CategoryState
+		{
+			/** The category's scheduling settings and metrics, as returned by GetStatisticsFor(). */
+			CategoryStatistics Statistics;
+
+			/** Requests waiting for the category to drop below its concurrency limit, in the order they were made. */
+			std::deque<SteamParkedRequest> QueuedRequestCollection;
+
+			/**
+			  Virtual time at which the category's last dequeued request finished its fair share.
+			  Advances by 1/weight per dequeued request, which makes heavier categories get picked more often.
+			 */
+			double VirtualFinishTime;
+		};
+
+		/** Scheduling state of each request category, indexed by SteamRequestCategory::GetIndex(). */
+		CategoryState fCategoryStateArray[SteamRequestCategory::kCount];
+
+		/**
+		  Virtual finish time of the last request handed out by TryDequeue(). A category that starts queueing
+		  resumes from this time, so that it cannot claim a burst of sends for the time it was idle.
+		 */
+		double fVirtualTime;
+};
+
+
+// ------------------------------------------------------------------------------------------
+// Templatized class method defined below to prevent it from being inlined into calling code.
+// ------------------------------------------------------------------------------------------
+
+template<class TPredicate>
+void SteamRequestScheduler::RemoveQueuedRequestsIf(TPredicate predicate)
+{
+	for (auto&& categoryState : fCategoryStateArray)
+	{
+		auto& queuedRequestCollection = categoryState.QueuedRequestCollection;
+		for (auto iterator = queuedRequestCollection.begin(); iterator != queuedRequestCollection.end();)
+		{
+			if (predicate(*iterator))
+			{
+				iterator = queuedRequestCollection.erase(iterator);
+			}
+			else
+			{
+				++iterator;
+			}
+		}
+		categoryState.Statistics.QueuedRequestCount = (uint32_t)queuedRequestCollection.size();
+	}
+}
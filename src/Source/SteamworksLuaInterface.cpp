@@ -10,16 +10,25 @@
 #include "CoronaLua.h"
 #include "CoronaMacros.h"
 #include "DispatchEventTask.h"
+#include "DispatchEventTaskPool.h"
+#include "EventOverflowPolicy.h"
 #include "LuaEventDispatcher.h"
+#include "LuaEventFilter.h"
 #include "PluginConfigLuaSettings.h"
 #include "PluginMacros.h"
 #include "RuntimeContext.h"
+#include "SteamApiInitializer.h"
+#include "SteamCallbackPump.h"
+#include "SteamConnectionState.h"
+#include "SteamRequestCategory.h"
 #include "SteamStatValueType.h"
+#include <chrono>
 #include <cmath>
 #include <sstream>
 #include <stdint.h>
 #include <string>
 #include <thread>
+#include <vector>
 extern "C"
 {
 #	include "lua.h"
@@ -42,6 +51,9 @@ PLUGIN_DISABLE_STEAM_WARNINGS_END
  */
 static const char kSteamAppIdEnvironmentVariableName[] = "SteamAppId";
 
+/** Name of the Lua metatable assigned to the request handles returned by this plugin's request*() functions. */
+static const char kRequestHandleMetatableName[] = "plugin.steamworks.requestHandle";
+
 
 //---------------------------------------------------------------------------------
 // Private Static Variables
@@ -70,7 +82,7 @@ static std::thread::id sMainThreadId;
 bool CopySteamAppIdTo(std::string& stringId)
 {
 	bool wasCopied = false;
-	auto steamUtilsPointer = SteamUtils();
+	auto steamUtilsPointer = SteamApiInitializer::GetUtils();
 	if (steamUtilsPointer)
 	{
 		std::stringstream stringStream;
@@ -110,7 +122,7 @@ bool CopySteamAppIdTo(std::string& stringId)
 bool CanShowSteamOverlay()
 {
 	bool canShow = false;
-	auto steamUtilsPointer = SteamUtils();
+	auto steamUtilsPointer = SteamApiInitializer::GetUtils();
 	if (steamUtilsPointer)
 	{
 		canShow = steamUtilsPointer->IsOverlayEnabled();
@@ -118,6 +130,27 @@ bool CanShowSteamOverlay()
 	return canShow;
 }
 
+/**
+  Determines if a request using Steam's ISteamUserStats interface can be made via the given runtime context.
+  @param contextPointer The runtime context the request is to be sent by. Can be null.
+  @return Returns true if Steam's user stats interface is available or if Steam is still being initialized
+          asynchronously, in which case the request will be parked by the context until initialization finishes.
+
+          Returns false if not connected to the Steam client or if given a null argument.
+ */
+bool CanSendUserStatsRequestWith(RuntimeContext* contextPointer)
+{
+	if (!contextPointer)
+	{
+		return false;
+	}
+	if (contextPointer->GetConnectionState() == SteamConnectionState::kInitializing)
+	{
+		return true;
+	}
+	return (SteamApiInitializer::GetUserStats() != nullptr);
+}
+
 /**
   Pushes the Steamworks plugin table to the top of the Lua stack.
   @param luaStatePointer Pointer to the Lua state to push the plugin table to.
@@ -203,39 +236,408 @@ bool IsRunningInCoronaSimulator(lua_State* luaStatePointer)
 }
 
 /**
-  Creates and returns a lambda to be invoked by the RuntimeContext::AddEventHandlerFor() method when
-  a task is about to be queued for dispatching a Lua event.
+  Fetches the request ID stored by the request handle at the given Lua stack index.
+  @param luaStatePointer Pointer to the Lua state to read the request handle from.
+  @param luaStackIndex Index to the request handle userdata pushed by the PushRequestHandleTo() function.
+  @return Returns a pointer to the request ID stored within the request handle.
+
+          Returns null if the given Lua value is not a request handle.
+ */
+uint64_t* ToRequestHandle(lua_State* luaStatePointer, int luaStackIndex)
+{
+	// Validate.
+	if (!luaStatePointer)
+	{
+		return nullptr;
+	}
 
-  Intended to be used for leaderboard related events. Copies the leaderboard's unique name to the event
-  since this name is not received by Steam's CCallResult data.
-  @param leaderboardName Unique name of the leaderboard used by the Steam request API.
-                         Will be copied to the Lua dispatching event table.
-  @return Returns a lambda for handling the leaderboard event dispatching task. Expected to be assigned
-          to the "RuntimeContext::EventHandlerSettings::QueuingEventTaskCallback" field.
+	// Fetch the userdata and verify that it has the request handle's metatable.
+	auto requestIdPointer = (uint64_t*)lua_touserdata(luaStatePointer, luaStackIndex);
+	if (!requestIdPointer || !lua_getmetatable(luaStatePointer, luaStackIndex))
+	{
+		return nullptr;
+	}
+	luaL_getmetatable(luaStatePointer, kRequestHandleMetatableName);
+	bool isRequestHandle = lua_rawequal(luaStatePointer, -1, -2) ? true : false;
+	lua_pop(luaStatePointer, 2);
+	return isRequestHandle ? requestIdPointer : nullptr;
+}
+
+/** bool requestHandle:cancel() */
+int OnRequestHandleCancel(lua_State* luaStatePointer)
+{
+	bool wasCanceled = false;
+	auto requestIdPointer = ToRequestHandle(luaStatePointer, 1);
+	auto contextPointer = RuntimeContext::GetInstanceBy(luaStatePointer);
+	if (requestIdPointer && contextPointer)
+	{
+		wasCanceled = contextPointer->CancelRequest(*requestIdPointer);
+	}
+	else if (!requestIdPointer)
+	{
+		CoronaLuaError(luaStatePointer, "cancel() must be called on a request handle via the ':' operator.");
+	}
+	lua_pushboolean(luaStatePointer, wasCanceled ? 1 : 0);
+	return 1;
+}
+
+/** bool requestHandle:isPending() */
+int OnRequestHandleIsPending(lua_State* luaStatePointer)
+{
+	bool isPending = false;
+	auto requestIdPointer = ToRequestHandle(luaStatePointer, 1);
+	auto contextPointer = RuntimeContext::GetInstanceBy(luaStatePointer);
+	if (requestIdPointer && contextPointer)
+	{
+		isPending = contextPointer->IsRequestPending(*requestIdPointer);
+	}
+	else if (!requestIdPointer)
+	{
+		CoronaLuaError(luaStatePointer, "isPending() must be called on a request handle via the ':' operator.");
+	}
+	lua_pushboolean(luaStatePointer, isPending ? 1 : 0);
+	return 1;
+}
 
-          Returns an empty lambda if given a null or empty string.
+/** requestHandle:next(callback) */
+int OnRequestHandleNext(lua_State* luaStatePointer)
+{
+	auto requestIdPointer = ToRequestHandle(luaStatePointer, 1);
+	if (!requestIdPointer)
+	{
+		CoronaLuaError(luaStatePointer, "next() must be called on a request handle via the ':' operator.");
+		return 0;
+	}
+	if (!lua_isfunction(luaStatePointer, 2))
+	{
+		CoronaLuaError(luaStatePointer, "next() must be given a Lua function.");
+		return 0;
+	}
+	auto contextPointer = RuntimeContext::GetInstanceBy(luaStatePointer);
+	if (contextPointer && !contextPointer->AddRequestPromiseCallback(luaStatePointer, *requestIdPointer, 2))
+	{
+		CoronaLuaError(luaStatePointer, "next() was called on a request handle which does not provide a result.");
+	}
+	return 0;
+}
+
+/** Called when a request handle is garbage collected. Releases the request's native promise. */
+int OnRequestHandleCollected(lua_State* luaStatePointer)
+{
+	auto requestIdPointer = ToRequestHandle(luaStatePointer, 1);
+	auto contextPointer = RuntimeContext::GetInstanceBy(luaStatePointer);
+	if (requestIdPointer && contextPointer)
+	{
+		contextPointer->RemoveRequestPromise(luaStatePointer, *requestIdPointer);
+	}
+	return 0;
+}
+
+/**
+  Pushes a new request handle userdata to the top of the Lua stack.
+  Its Lua cancel() method aborts the request via the RuntimeContext::CancelRequest() method.
+  Its Lua next() method observes the request's promise, if one was created via RuntimeContext::AddRequestPromise(),
+  which is removed when the handle is garbage collected.
+  @param luaStatePointer Pointer to the Lua state to push the request handle to. Cannot be null.
+  @param requestId Unique ID returned by the RuntimeContext::AddEventHandlerFor() method.
+  @return Returns a pointer to the request ID stored within the pushed userdata, which can be changed later.
  */
-std::function<void(RuntimeContext::QueuingEventTaskCallbackArguments&)>
-CreateQueueingLeaderboardEventTaskCallbackWith(const char* leaderboardName)
+uint64_t* PushRequestHandleTo(lua_State* luaStatePointer, uint64_t requestId)
 {
-	// Return a callback that no-ops if given an invalid leaderboard name.
-	if (!leaderboardName || ('\0' == leaderboardName[0]))
+	auto requestIdPointer = (uint64_t*)lua_newuserdata(luaStatePointer, sizeof(uint64_t));
+	*requestIdPointer = requestId;
+	if (luaL_newmetatable(luaStatePointer, kRequestHandleMetatableName))
 	{
-		return std::function<void(RuntimeContext::QueuingEventTaskCallbackArguments&)>();
+		const struct luaL_Reg luaFunctions[] =
+		{
+			{ "cancel", OnRequestHandleCancel },
+			{ "isPending", OnRequestHandleIsPending },
+			{ "next", OnRequestHandleNext },
+			{ nullptr, nullptr }
+		};
+		lua_createtable(luaStatePointer, 0, 3);
+		luaL_openlib(luaStatePointer, nullptr, luaFunctions, 0);
+		lua_setfield(luaStatePointer, -2, "__index");
+		lua_pushcfunction(luaStatePointer, OnRequestHandleCollected);
+		lua_setfield(luaStatePointer, -2, "__gc");
 	}
+	lua_setmetatable(luaStatePointer, -2);
+	return requestIdPointer;
+}
 
-	// Return a lambda used to finish setting up a leaderboard event dispatcher.
-	std::string capturedLeaderboardName(leaderboardName);
-	return [capturedLeaderboardName](RuntimeContext::QueuingEventTaskCallbackArguments& arguments)->void
+/**
+  Pushes the return values of a request*() Lua function to the top of the Lua stack.
+  Also creates the request's promise, which the returned request handle's next() method and the
+  plugin's all(), any(), and race() Lua functions observe.
+  @param luaStatePointer Pointer to the Lua state to push the return values to. Cannot be null.
+  @param contextPointer The runtime context the request was made on. Cannot be null.
+  @param requestId Unique ID returned by the RuntimeContext::AddEventHandlerFor() method. Zero if it failed.
+  @return Returns the number of values pushed, which is 2 (true and a request handle) if the request was sent.
+
+          Returns 1 (false) if given a zero request ID.
+ */
+int PushRequestResultTo(lua_State* luaStatePointer, RuntimeContext* contextPointer, uint64_t requestId)
+{
+	if (!requestId)
 	{
-		auto leaderboardTaskPointer = dynamic_cast<BaseDispatchLeaderboardEventTask*>(arguments.TaskPointer);
-		if (leaderboardTaskPointer)
+		lua_pushboolean(luaStatePointer, 0);
+		return 1;
+	}
+	contextPointer->AddRequestPromise(requestId);
+	lua_pushboolean(luaStatePointer, 1);
+	PushRequestHandleTo(luaStatePointer, requestId);
+	return 2;
+}
+
+/**
+  Fetches the optional "timeoutMs" field from a request*() function's Lua settings table.
+  @param luaStatePointer Pointer to the Lua state that the "luaTableStackIndex" argument references.
+  @param luaTableStackIndex Index to the Lua settings table. Must be a positive index.
+  @param timeoutInMilliseconds Reference to receive the timeout. Set to zero if the field is not set.
+  @return Returns true if the field was not set or is a valid number.
+
+          Returns false if the field is not a number, in which case a Lua error is logged.
+ */
+bool CopyRequestTimeoutFrom(lua_State* luaStatePointer, int luaTableStackIndex, uint32_t& timeoutInMilliseconds)
+{
+	bool isValid = true;
+	timeoutInMilliseconds = 0;
+	lua_getfield(luaStatePointer, luaTableStackIndex, "timeoutMs");
+	const auto luaValueType = lua_type(luaStatePointer, -1);
+	if (luaValueType == LUA_TNUMBER)
+	{
+		auto numberValue = lua_tonumber(luaStatePointer, -1);
+		timeoutInMilliseconds = (numberValue > 0) ? (uint32_t)numberValue : 0;
+	}
+	else if ((luaValueType != LUA_TNIL) && (luaValueType != LUA_TNONE))
+	{
+		CoronaLuaError(luaStatePointer, "The 'timeoutMs' field must be of type number.");
+		isValid = false;
+	}
+	lua_pop(luaStatePointer, 1);
+	return isValid;
+}
+
+/**
+  Pushes the calling Lua coroutine to the top of the stack, to be resumed with a request's result once received.
+  Used by request*() Lua functions that were not given a listener, which makes the calling coroutine await the result.
+  @param luaStatePointer Pointer to the calling Lua state.
+  @return Returns true if the caller is running within a coroutine, which was pushed to the top of the stack.
+
+          Returns false if called from the main Lua thread, which cannot yield. Nothing is pushed in this case.
+ */
+bool PushAwaitingCoroutineTo(lua_State* luaStatePointer)
+{
+	if (lua_pushthread(luaStatePointer))
+	{
+		lua_pop(luaStatePointer, 1);
+		return false;
+	}
+	return true;
+}
+
+/**
+  Pushes the "listener" field of a request*() function's Lua settings table to the top of the stack.
+  If the field is not set and the caller is a coroutine, then the coroutine is pushed instead to await the result.
+  If the field is set to false, then nil is pushed and the result is only delivered via the request handle's promise.
+  @param luaStatePointer Pointer to the Lua state that the "luaTableStackIndex" argument references.
+  @param luaTableStackIndex Index to the Lua settings table. Must be a positive index.
+  @param isAwaiting Set true if the calling coroutine was pushed. Set false otherwise.
+  @return Returns the stack index of the pushed Lua function, coroutine, or nil.
+
+          Returns zero if the field is of an invalid type or is not set outside of a coroutine,
+          in which case a Lua error is logged and nothing is pushed.
+ */
+int PushRequestListenerTo(lua_State* luaStatePointer, int luaTableStackIndex, bool& isAwaiting)
+{
+	// Push the listener field if it references a Lua function.
+	// Note: A coroutine is accepted too, which is how a re-sent request keeps resuming the original caller.
+	isAwaiting = false;
+	lua_getfield(luaStatePointer, luaTableStackIndex, "listener");
+	if (lua_isfunction(luaStatePointer, -1) || lua_isthread(luaStatePointer, -1))
+	{
+		return lua_gettop(luaStatePointer);
+	}
+
+	// If the listener was explicitly set to false, then the caller will only observe the result via the
+	// returned request handle. Push nil in its place.
+	if ((lua_type(luaStatePointer, -1) == LUA_TBOOLEAN) && !lua_toboolean(luaStatePointer, -1))
+	{
+		lua_pop(luaStatePointer, 1);
+		lua_pushnil(luaStatePointer);
+		return lua_gettop(luaStatePointer);
+	}
+
+	// If a listener was not given and we're running within a coroutine, then push it to await the result.
+	if (lua_isnil(luaStatePointer, -1))
+	{
+		lua_pop(luaStatePointer, 1);
+		if (PushAwaitingCoroutineTo(luaStatePointer))
 		{
-			leaderboardTaskPointer->SetLeaderboardName(capturedLeaderboardName.c_str());
+			isAwaiting = true;
+			return lua_gettop(luaStatePointer);
 		}
-	};
+		CoronaLuaError(luaStatePointer, "Table must contain a 'listener' field of type function.");
+		return 0;
+	}
+	lua_pop(luaStatePointer, 1);
+	CoronaLuaError(luaStatePointer, "The 'listener' field must be of type function or false.");
+	return 0;
+}
+
+/**
+  Pushes a shallow copy of a request*() function's Lua settings table with its "listener" field replaced.
+  Used to re-send a request awaited by a coroutine on its behalf, without modifying the caller's table.
+  @param luaStatePointer Pointer to the Lua state that the given stack indexes reference.
+  @param luaTableStackIndex Index to the Lua settings table to copy. Must be a positive index.
+  @param luaListenerStackIndex Index to the value to assign to the copy's "listener" field. Must be a positive index.
+ */
+void PushRequestSettingsCopyTo(lua_State* luaStatePointer, int luaTableStackIndex, int luaListenerStackIndex)
+{
+	lua_newtable(luaStatePointer);
+	lua_pushnil(luaStatePointer);
+	while (lua_next(luaStatePointer, luaTableStackIndex))
+	{
+		lua_pushvalue(luaStatePointer, -2);
+		lua_insert(luaStatePointer, -2);
+		lua_settable(luaStatePointer, -4);
+	}
+	lua_pushvalue(luaStatePointer, luaListenerStackIndex);
+	lua_setfield(luaStatePointer, -2, "listener");
 }
 
+/**
+  Implements the plugin's all(), any(), and race() Lua functions, which call a Lua listener once when the
+  promises of the given request handles resolve as a group.
+  @param luaStatePointer Pointer to the calling Lua state. Expects an array of request handles and a listener.
+  @param type Determines when the group resolves and what the listener receives.
+  @param functionName Name of the calling Lua function. Used by error messages.
+  @return Returns the number of values pushed to Lua, which is 1 (a boolean indicating success).
+ */
+int AddRequestPromiseAggregateFrom(
+	lua_State* luaStatePointer, RuntimeContext::PromiseAggregateType type, const char* functionName)
+{
+	// Fetch this plugin's runtime context associated with the calling Lua state.
+	auto contextPointer = (RuntimeContext*)lua_touserdata(luaStatePointer, lua_upvalueindex(1));
+	if (!contextPointer)
+	{
+		lua_pushboolean(luaStatePointer, 0);
+		return 1;
+	}
+
+	// Validate arguments.
+	if (!lua_istable(luaStatePointer, 1))
+	{
+		CoronaLuaError(luaStatePointer, "1st argument to %s() must be an array of request handles.", functionName);
+		lua_pushboolean(luaStatePointer, 0);
+		return 1;
+	}
+	if (!lua_isfunction(luaStatePointer, 2))
+	{
+		CoronaLuaError(luaStatePointer, "2nd argument to %s() must be a Lua function.", functionName);
+		lua_pushboolean(luaStatePointer, 0);
+		return 1;
+	}
+	const int handleCount = (int)lua_objlen(luaStatePointer, 1);
+	if ((handleCount <= 0) && (type != RuntimeContext::PromiseAggregateType::kAll))
+	{
+		CoronaLuaError(luaStatePointer, "The array given to %s() cannot be empty.", functionName);
+		lua_pushboolean(luaStatePointer, 0);
+		return 1;
+	}
+
+	// Fetch the request IDs of the given handles, in order.
+	std::vector<uint64_t> requestIds;
+	requestIds.reserve((size_t)handleCount);
+	for (int index = 1; index <= handleCount; index++)
+	{
+		lua_rawgeti(luaStatePointer, 1, index);
+		auto requestIdPointer = ToRequestHandle(luaStatePointer, -1);
+		lua_pop(luaStatePointer, 1);
+		if (!requestIdPointer || !contextPointer->HasRequestPromiseFor(*requestIdPointer))
+		{
+			CoronaLuaError(
+					luaStatePointer,
+					"Element %d of the array given to %s() is not a request handle returned by a request function.",
+					index, functionName);
+			lua_pushboolean(luaStatePointer, 0);
+			return 1;
+		}
+		requestIds.push_back(*requestIdPointer);
+	}
+
+	// Track the group's settlement natively. The listener will be called once it resolves.
+	bool wasAdded = contextPointer->AddRequestPromiseAggregate(luaStatePointer, type, requestIds, 1, 2);
+	lua_pushboolean(luaStatePointer, wasAdded ? 1 : 0);
+	return 1;
+}
+
+/**
+  Fetches the optional filter table passed to the addEventListener() and addBatchListener() Lua functions.
+  Supports a "userSteamId" string field and an "achievementName" string field.
+  @param luaStatePointer Pointer to the Lua state that the "luaTableStackIndex" argument references.
+  @param luaTableStackIndex Index to the Lua filter table. Must be a positive index.
+  @param filter Reference to the filter to be configured with the table's fields.
+  @return Returns true if all of the table's supported fields were valid or not set.
+
+          Returns false if a field is of the wrong type or is invalid, in which case a Lua error is logged.
+ */
+bool CopyEventFilterFrom(lua_State* luaStatePointer, int luaTableStackIndex, LuaEventFilter& filter)
+{
+	// Fetch the optional Steam ID of the user that events must belong to.
+	lua_getfield(luaStatePointer, luaTableStackIndex, "userSteamId");
+	{
+		const auto luaValueType = lua_type(luaStatePointer, -1);
+		if (luaValueType == LUA_TSTRING)
+		{
+			auto userStringId = lua_tostring(luaStatePointer, -1);
+			CSteamID userSteamId;
+			{
+				uint64 integerId = 0;
+				std::stringstream stringStream;
+				stringStream.imbue(std::locale::classic());
+				stringStream << userStringId;
+				stringStream >> integerId;
+				if (!stringStream.fail())
+				{
+					userSteamId.SetFromUint64(integerId);
+				}
+			}
+			if (userSteamId.IsValid() == false)
+			{
+				CoronaLuaError(luaStatePointer, "Given filter's user ID is invalid: '%s'", userStringId);
+				lua_pop(luaStatePointer, 1);
+				return false;
+			}
+			filter.SetUserIntegerId(userSteamId.ConvertToUint64());
+		}
+		else if ((luaValueType != LUA_TNIL) && (luaValueType != LUA_TNONE))
+		{
+			CoronaLuaError(luaStatePointer, "The filter's 'userSteamId' field must be of type string.");
+			lua_pop(luaStatePointer, 1);
+			return false;
+		}
+	}
+	lua_pop(luaStatePointer, 1);
+
+	// Fetch the optional name of the achievement that events must belong to.
+	lua_getfield(luaStatePointer, luaTableStackIndex, "achievementName");
+	{
+		const auto luaValueType = lua_type(luaStatePointer, -1);
+		if (luaValueType == LUA_TSTRING)
+		{
+			filter.SetAchievementName(lua_tostring(luaStatePointer, -1));
+		}
+		else if ((luaValueType != LUA_TNIL) && (luaValueType != LUA_TNONE))
+		{
+			CoronaLuaError(luaStatePointer, "The filter's 'achievementName' field must be of type string.");
+			lua_pop(luaStatePointer, 1);
+			return false;
+		}
+	}
+	lua_pop(luaStatePointer, 1);
+	return true;
+}
 
 //---------------------------------------------------------------------------------
 // Steam Event Handlers
@@ -337,7 +739,7 @@ int OnGetAchievementInfo(lua_State* luaStatePointer)
 
 	// Fetch the Steam interface needed by this API call.
 	// Note: Will return null if Steam client is not currently running.
-	auto steamUserStatsPointer = SteamUserStats();
+	auto steamUserStatsPointer = SteamApiInitializer::GetUserStats();
 	if (!steamUserStatsPointer)
 	{
 		lua_pushnil(luaStatePointer);
@@ -456,8 +858,8 @@ int OnGetUserInfo(lua_State* luaStatePointer)
 	}
 
 	// Fetch the Steam interfaces needed by this API call.
-	auto steamUserPointer = SteamUser();
-	auto steamFriendsPointer = SteamFriends();
+	auto steamUserPointer = SteamApiInitializer::GetUser();
+	auto steamFriendsPointer = SteamApiInitializer::GetFriends();
 	if (!steamUserPointer || !steamFriendsPointer)
 	{
 		lua_pushnil(luaStatePointer);
@@ -729,7 +1131,7 @@ int OnGetUserStatValue(lua_State* luaStatePointer)
 
 	// Fetch the Steam interface needed by this API call.
 	// Note: Will return null if Steam client is not currently running.
-	auto steamUserStatsPointer = SteamUserStats();
+	auto steamUserStatsPointer = SteamApiInitializer::GetUserStats();
 	if (!steamUserStatsPointer)
 	{
 		lua_pushnil(luaStatePointer);
@@ -786,7 +1188,10 @@ int OnGetUserStatValue(lua_State* luaStatePointer)
 	return 1;
 }
 
-/** bool steamworks.requestActivePlayerCount(listener) */
+/**
+	bool, requestHandle steamworks.requestActivePlayerCount([listener, timeoutMs])
+	event steamworks.requestActivePlayerCount([nil, timeoutMs]) -- Awaited by a coroutine.
+ */
 int OnRequestActivePlayerCount(lua_State* luaStatePointer)
 {
 	// Validate.
@@ -795,14 +1200,49 @@ int OnRequestActivePlayerCount(lua_State* luaStatePointer)
 		return 0;
 	}
 
-	// Do not continue if the 1st argument is not a Lua function.
-	if (!lua_isfunction(luaStatePointer, 1))
+	// Fetch the Lua listener function.
+	// If not given and we're running within a coroutine, then the coroutine will await the result instead.
+	// If set to false, then the result is only delivered via the request handle's promise.
+	int luaListenerStackIndex = 0;
+	bool isAwaiting = false;
+	if (lua_isfunction(luaStatePointer, 1))
+	{
+		luaListenerStackIndex = 1;
+	}
+	else if ((lua_type(luaStatePointer, 1) == LUA_TBOOLEAN) && !lua_toboolean(luaStatePointer, 1))
+	{
+		lua_pushnil(luaStatePointer);
+		luaListenerStackIndex = lua_gettop(luaStatePointer);
+	}
+	else if (lua_isnoneornil(luaStatePointer, 1) && PushAwaitingCoroutineTo(luaStatePointer))
+	{
+		isAwaiting = true;
+		luaListenerStackIndex = lua_gettop(luaStatePointer);
+	}
+	else
 	{
 		CoronaLuaError(luaStatePointer, "1st argument must be a Lua function.");
 		lua_pushboolean(luaStatePointer, 0);
 		return 1;
 	}
 
+	// Fetch the optional timeout in milliseconds.
+	uint32_t timeoutInMilliseconds = 0;
+	{
+		const auto luaArgumentType = lua_type(luaStatePointer, 2);
+		if (luaArgumentType == LUA_TNUMBER)
+		{
+			auto numberValue = lua_tonumber(luaStatePointer, 2);
+			timeoutInMilliseconds = (numberValue > 0) ? (uint32_t)numberValue : 0;
+		}
+		else if ((luaArgumentType != LUA_TNONE) && (luaArgumentType != LUA_TNIL))
+		{
+			CoronaLuaError(luaStatePointer, "2nd argument (timeoutMs) must be of type number.");
+			lua_pushboolean(luaStatePointer, 0);
+			return 1;
+		}
+	}
+
 	// Fetch this plugin's runtime context associated with the calling Lua state.
 	auto contextPointer = (RuntimeContext*)lua_touserdata(luaStatePointer, lua_upvalueindex(1));
 	if (!contextPointer)
@@ -811,35 +1251,41 @@ int OnRequestActivePlayerCount(lua_State* luaStatePointer)
 		return 1;
 	}
 
-	// Fetch the Steam interface needed by this API call.
-	// Note: Will return null if Steam client is not currently running.
-	auto steamUserStatsPointer = SteamUserStats();
-	if (!steamUserStatsPointer)
+	// Do not continue if Steam's user stats interface is unavailable.
+	// Note: Requests made while Steam is still being initialized asynchronously are sent once it has finished.
+	if (!CanSendUserStatsRequestWith(contextPointer))
 	{
 		lua_pushboolean(luaStatePointer, 0);
 		return 1;
 	}
 
-	// Fetch the number of active players for this application.
-	auto resultHandle = steamUserStatsPointer->GetNumberOfCurrentPlayers();
-
-	// Set up the given Lua function to receive the result of the above async operation.
+	// Set up the given Lua function to receive the number of active players for this application.
+	// Note: This call has no arguments, so all requests made while it's in flight share the same Steam call.
 	RuntimeContext::EventHandlerSettings settings{};
 	settings.LuaStatePointer = luaStatePointer;
-	settings.LuaFunctionStackIndex = 1;
-	settings.SteamCallResultHandle = resultHandle;
-	bool wasSuccessful = contextPointer->AddEventHandlerFor
-			<NumberOfCurrentPlayers_t, DispatchNumberOfCurrentPlayersEventTask>(settings);
+	settings.LuaFunctionStackIndex = luaListenerStackIndex;
+	settings.TimeoutInMilliseconds = timeoutInMilliseconds;
+	settings.SingleFlightKey = "";
+	auto requestId = contextPointer->SendRequestFor<NumberOfCurrentPlayers_t>(settings, []()
+	{
+		auto steamUserStatsPointer = SteamApiInitializer::GetUserStats();
+		return steamUserStatsPointer ? steamUserStatsPointer->GetNumberOfCurrentPlayers() : k_uAPICallInvalid;
+	});
 
-	// Return true to Lua if the above async operation was successfully started/executed.
-	lua_pushboolean(luaStatePointer, wasSuccessful ? 1 : 0);
-	return 1;
+	// If awaited by a coroutine, then suspend it. It will be resumed with the event table once received.
+	if (isAwaiting && requestId)
+	{
+		return lua_yield(luaStatePointer, 0);
+	}
+
+	// Return true and a request handle to Lua if the above async operation was successfully started/executed.
+	return PushRequestResultTo(luaStatePointer, contextPointer, requestId);
 }
 
 /**
-	bool steamworks.requestLeaderboardEntries(
+	bool, requestHandle steamworks.requestLeaderboardEntries(
 	{
-		leaderboardName="", listener=myListener [,playerScope=""] [,startIndex=x, endIndex=y]
+		leaderboardName="", listener=myListener [,playerScope=""] [,startIndex=x, endIndex=y] [,timeoutMs=x]
 	})
  */
 int OnRequestLeaderboardEntries(lua_State* luaStatePointer)
@@ -858,10 +1304,9 @@ int OnRequestLeaderboardEntries(lua_State* luaStatePointer)
 		return 1;
 	}
 
-	// Fetch the Steam interface needed by this API call.
-	// Note: Will return null if Steam client is not currently running.
-	auto steamUserStatsPointer = SteamUserStats();
-	if (!steamUserStatsPointer)
+	// Do not continue if Steam's user stats interface is unavailable.
+	// Note: Requests made while Steam is still being initialized asynchronously are sent once it has finished.
+	if (!CanSendUserStatsRequestWith(contextPointer))
 	{
 		lua_pushboolean(luaStatePointer, 0);
 		return 1;
@@ -1059,17 +1504,22 @@ int OnRequestLeaderboardEntries(lua_State* luaStatePointer)
 		}
 	}
 
-	// Do not continue if the required Lua listener is not in the table.
+	// Fetch the Lua listener from the table and push it to the top of the stack.
+	// If not given and we're running within a coroutine, then the coroutine will await the result instead.
+	bool isAwaiting = false;
+	int luaListenerStackIndex = PushRequestListenerTo(luaStatePointer, 1, isAwaiting);
+	if (!luaListenerStackIndex)
 	{
-		lua_getfield(luaStatePointer, 1, "listener");
-		bool hasListener = lua_isfunction(luaStatePointer, -1) ? true : false;
-		lua_pop(luaStatePointer, 1);
-		if (!hasListener)
-		{
-			CoronaLuaError(luaStatePointer, "Table must contain a 'listener' field of type function.");
-			lua_pushboolean(luaStatePointer, 0);
-			return 1;
-		}
+		lua_pushboolean(luaStatePointer, 0);
+		return 1;
+	}
+
+	// Fetch the optional request timeout from the Lua table.
+	uint32_t timeoutInMilliseconds = 0;
+	if (!CopyRequestTimeoutFrom(luaStatePointer, 1, timeoutInMilliseconds))
+	{
+		lua_pushboolean(luaStatePointer, 0);
+		return 1;
 	}
 
 	// Attempt to fetch the leaderboard's handle by its unique name.
@@ -1108,6 +1558,11 @@ int OnRequestLeaderboardEntries(lua_State* luaStatePointer)
 			}
 			lua_pop(luaStatePointer, 1);
 
+			// Check if the leaderboard handle request has timed out.
+			lua_getfield(luaStatePointer, 1, "timedOut");
+			bool hasTimedOut = lua_toboolean(luaStatePointer, -1) ? true : false;
+			lua_pop(luaStatePointer, 1);
+
 			// Fetch the leaderboard name.
 			const char* leaderboardName = nullptr;
 			lua_getfield(luaStatePointer, 1, "leaderboardName");
@@ -1137,10 +1592,23 @@ int OnRequestLeaderboardEntries(lua_State* luaStatePointer)
 					if (lua_isfunction(luaStatePointer, -1))
 					{
 						lua_pushvalue(luaStatePointer, luaSettingsTableStackIndex);
-						CoronaLuaDoCall(luaStatePointer, 1, 1);
-						if (lua_type(luaStatePointer, -1) == LUA_TBOOLEAN)
+						CoronaLuaDoCall(luaStatePointer, 1, 2);
+						if (lua_type(luaStatePointer, -2) == LUA_TBOOLEAN)
 						{
-							hasSucceeded = lua_toboolean(luaStatePointer, -1) ? true : false;
+							hasSucceeded = lua_toboolean(luaStatePointer, -2) ? true : false;
+						}
+
+						// Make the request handle given to the caller cancel the re-sent request from now on
+						// and let the re-sent request settle the caller's promise.
+						// Note: The re-sent request's own handle is cleared so that its finalizer won't remove it.
+						auto requestIdPointer = ToRequestHandle(luaStatePointer, lua_upvalueindex(2));
+						auto newRequestIdPointer = ToRequestHandle(luaStatePointer, -1);
+						if (hasSucceeded && requestIdPointer && newRequestIdPointer)
+						{
+							contextPointer->MoveRequestPromise(
+									luaStatePointer, *requestIdPointer, *newRequestIdPointer);
+							*requestIdPointer = *newRequestIdPointer;
+							*newRequestIdPointer = 0;
 						}
 					}
 				}
@@ -1157,7 +1625,7 @@ int OnRequestLeaderboardEntries(lua_State* luaStatePointer)
 				if (lua_istable(luaStatePointer, luaSettingsTableStackIndex))
 				{
 					lua_getfield(luaStatePointer, luaSettingsTableStackIndex, "listener");
-					if (lua_isfunction(luaStatePointer, -1))
+					if (lua_isfunction(luaStatePointer, -1) || lua_isthread(luaStatePointer, -1))
 					{
 						luaListenerStackIndex = lua_gettop(luaStatePointer);
 					}
@@ -1167,30 +1635,49 @@ int OnRequestLeaderboardEntries(lua_State* luaStatePointer)
 					}
 				}
 
-				// Dispatch an event to the Lua listener.
-				if (luaListenerStackIndex)
+				// Dispatch an event to the Lua listener or resume the coroutine awaiting the result.
+				// Also settle the promise of the request handle given to the caller with the same event.
 				{
-					// Create a Lua event dispatcher and add the Lua listener to it.
-					auto luaEventDispatcherPointer = std::make_shared<LuaEventDispatcher>(luaStatePointer);
-					luaEventDispatcherPointer->AddEventListener(
-							luaStatePointer,
-							DispatchLeaderboardScoresDownloadedEventTask::kLuaEventName,
-							luaListenerStackIndex);
-
-					// Dispatch the event to the Lua listener.
 					LeaderboardScoresDownloaded_t eventData{};
 					if (contextPointer)
 					{
 						eventData.m_hSteamLeaderboard = contextPointer->GetCachedLeaderboardHandleByName(leaderboardName);
 					}
 					DispatchLeaderboardScoresDownloadedEventTask task;
-					task.SetLuaEventDispatcher(luaEventDispatcherPointer);
+					if (luaListenerStackIndex)
+					{
+						RuntimeContext::SetUpRequestListenerFor(&task, luaStatePointer, luaListenerStackIndex);
+					}
 					task.AcquireEventDataFrom(eventData);
 					task.SetLeaderboardName(leaderboardName);
 					task.SetHadIOFailure(true);
-					task.Execute();
+					task.SetTimedOut(hasTimedOut);
+					if (task.PushLuaEventTableTo(luaStatePointer))
+					{
+						int luaEventTableStackIndex = lua_gettop(luaStatePointer);
+						task.DispatchLuaEventTable(luaStatePointer, luaEventTableStackIndex);
+						auto requestIdPointer = ToRequestHandle(luaStatePointer, lua_upvalueindex(2));
+						if (requestIdPointer)
+						{
+							contextPointer->SettleRequestPromise(
+									luaStatePointer, *requestIdPointer, luaEventTableStackIndex);
+						}
+						lua_pop(luaStatePointer, 1);
+					}
+					else if (contextPointer)
+					{
+						auto requestIdPointer = ToRequestHandle(luaStatePointer, lua_upvalueindex(2));
+						if (requestIdPointer)
+						{
+							contextPointer->SettleRequestPromiseWithError(
+									luaStatePointer, *requestIdPointer, task.GetLuaEventName());
+						}
+					}
+				}
 
-					// Pop the Lua listener off of the stack.
+				// Pop the Lua listener off of the stack.
+				if (luaListenerStackIndex)
+				{
 					lua_pop(luaStatePointer, 1);
 				}
 			}
@@ -1200,55 +1687,109 @@ int OnRequestLeaderboardEntries(lua_State* luaStatePointer)
 		// Push the above callback to Lua.
 		// We also store the requestLeaderboardEntries() function's argument as an upvalue so that
 		// the above callback (when invoked) can call this function again with that same argument.
-		lua_pushvalue(luaStatePointer, 1);
-		lua_pushcclosure(luaStatePointer, lambda, 1);
+		// The request handle returned to the caller is stored as an upvalue too, so that it can be updated
+		// to reference the re-sent request.
+		// If awaited by a coroutine, then store a copy of the argument referencing the coroutine as its listener
+		// instead, so that the re-sent request resumes the coroutine.
+		auto requestIdPointer = PushRequestHandleTo(luaStatePointer, 0);
+		int luaRequestHandleStackIndex = lua_gettop(luaStatePointer);
+		if (isAwaiting)
+		{
+			PushRequestSettingsCopyTo(luaStatePointer, 1, luaListenerStackIndex);
+		}
+		else
+		{
+			lua_pushvalue(luaStatePointer, 1);
+		}
+		lua_pushvalue(luaStatePointer, luaRequestHandleStackIndex);
+		lua_pushcclosure(luaStatePointer, lambda, 2);
 
-		// Request the leaderboard handle from Steam.
+		// Request the leaderboard handle from Steam, unless the same leaderboard is already being looked up.
 		// Set up the above callback to receive the result of this request.
-		auto resultHandle = steamUserStatsPointer->FindLeaderboard(leaderboardName);
 		RuntimeContext::EventHandlerSettings settings{};
 		settings.LuaStatePointer = luaStatePointer;
 		settings.LuaFunctionStackIndex = lua_gettop(luaStatePointer);
-		settings.SteamCallResultHandle = resultHandle;
-		settings.QueuingEventTaskCallback = CreateQueueingLeaderboardEventTaskCallbackWith(leaderboardName);
-		bool wasSuccessful = contextPointer->AddEventHandlerFor
-				<LeaderboardFindResult_t, DispatchLeaderboardFindResultEventTask>(settings);
+		settings.LeaderboardName = leaderboardName;
+		settings.TimeoutInMilliseconds = timeoutInMilliseconds;
+		settings.SingleFlightKey = leaderboardName;
+		std::string leaderboardNameCopy(leaderboardName);
+		auto requestId = contextPointer->SendRequestFor<LeaderboardFindResult_t>(settings, [leaderboardNameCopy]()
+		{
+			auto steamUserStatsPointer = SteamApiInitializer::GetUserStats();
+			if (!steamUserStatsPointer)
+			{
+				return k_uAPICallInvalid;
+			}
+			return steamUserStatsPointer->FindLeaderboard(leaderboardNameCopy.c_str());
+		});
 
 		// Pop the above Lua closure off of the stack.
 		lua_pop(luaStatePointer, 1);
 
-		// Return true to Lua if we've successfully sent the above request.
-		lua_pushboolean(luaStatePointer, wasSuccessful ? 1 : 0);
-		return 1;
-	}
+		// Return false to Lua if we've failed to send the above request.
+		if (!requestId)
+		{
+			lua_pop(luaStatePointer, 1);
+			lua_pushboolean(luaStatePointer, 0);
+			return 1;
+		}
 
-	// Push the Lua listener function from the Lua table to the top of the stack.
-	// Note: We've already determined that it exists in the table up above.
-	lua_getfield(luaStatePointer, 1, "listener");
-	int luaFunctionStackIndex = lua_gettop(luaStatePointer);
+		// If awaited by a coroutine, then suspend it. It will be resumed with the re-sent request's event table.
+		if (isAwaiting)
+		{
+			return lua_yield(luaStatePointer, 0);
+		}
 
-	// Send the leaderboard entry download request to Steam.
-	auto resultHandle = steamUserStatsPointer->DownloadLeaderboardEntries(
-			leaderboardHandle, playerScope, rangeStartIndex, rangeEndIndex);
+		// Return true and the above request handle to Lua.
+		// Note: The find request settles the handle's promise unless it gets moved to the re-sent request.
+		*requestIdPointer = requestId;
+		contextPointer->AddRequestPromise(requestId);
+		lua_pushboolean(luaStatePointer, 1);
+		lua_insert(luaStatePointer, -2);
+		return 2;
+	}
 
-	// Set up the given Lua function to receive the result of the above async operation.
+	// Set up the given Lua function to receive the requested leaderboard entries.
+	// Identical downloads made while this one is in flight share its Steam call, keyed by the normalized arguments.
+	std::string singleFlightKey(leaderboardName);
+	singleFlightKey += '\n';
+	singleFlightKey += std::to_string((int)playerScope);
+	singleFlightKey += '\n';
+	singleFlightKey += std::to_string(rangeStartIndex);
+	singleFlightKey += '\n';
+	singleFlightKey += std::to_string(rangeEndIndex);
 	RuntimeContext::EventHandlerSettings settings{};
 	settings.LuaStatePointer = luaStatePointer;
-	settings.LuaFunctionStackIndex = luaFunctionStackIndex;
-	settings.SteamCallResultHandle = resultHandle;
-	settings.QueuingEventTaskCallback = CreateQueueingLeaderboardEventTaskCallbackWith(leaderboardName);
-	bool wasSuccessful = contextPointer->AddEventHandlerFor
-			<LeaderboardScoresDownloaded_t, DispatchLeaderboardScoresDownloadedEventTask>(settings);
+	settings.LuaFunctionStackIndex = luaListenerStackIndex;
+	settings.LeaderboardName = leaderboardName;
+	settings.TimeoutInMilliseconds = timeoutInMilliseconds;
+	settings.SingleFlightKey = singleFlightKey.c_str();
+	auto requestId = contextPointer->SendRequestFor<LeaderboardScoresDownloaded_t>(
+			settings, [leaderboardHandle, playerScope, rangeStartIndex, rangeEndIndex]()
+	{
+		auto steamUserStatsPointer = SteamApiInitializer::GetUserStats();
+		if (!steamUserStatsPointer)
+		{
+			return k_uAPICallInvalid;
+		}
+		return steamUserStatsPointer->DownloadLeaderboardEntries(
+				leaderboardHandle, playerScope, rangeStartIndex, rangeEndIndex);
+	});
 
 	// Pop the Lua listener off of the stack.
 	lua_pop(luaStatePointer, 1);
 
-	// Return true to Lua if the above async operation was successfully started/executed.
-	lua_pushboolean(luaStatePointer, wasSuccessful ? 1 : 0);
-	return 1;
+	// If awaited by a coroutine, then suspend it. It will be resumed with the event table once received.
+	if (isAwaiting && requestId)
+	{
+		return lua_yield(luaStatePointer, 0);
+	}
+
+	// Return true and a request handle to Lua if the above async operation was successfully started/executed.
+	return PushRequestResultTo(luaStatePointer, contextPointer, requestId);
 }
 
-/** bool steamworks.requestLeaderboardInfo({leaderboardName="", listener=myListener}) */
+/** bool, requestHandle steamworks.requestLeaderboardInfo({leaderboardName="", listener=myListener [,timeoutMs=x]}) */
 int OnRequestLeaderboardInfo(lua_State* luaStatePointer)
 {
 	// Validate.
@@ -1265,10 +1806,9 @@ int OnRequestLeaderboardInfo(lua_State* luaStatePointer)
 		return 1;
 	}
 
-	// Fetch the Steam interface needed by this API call.
-	// Note: Will return null if Steam client is not currently running.
-	auto steamUserStatsPointer = SteamUserStats();
-	if (!steamUserStatsPointer)
+	// Do not continue if Steam's user stats interface is unavailable.
+	// Note: Requests made while Steam is still being initialized asynchronously are sent once it has finished.
+	if (!CanSendUserStatsRequestWith(contextPointer))
 	{
 		lua_pushboolean(luaStatePointer, 0);
 		return 1;
@@ -1310,45 +1850,62 @@ int OnRequestLeaderboardInfo(lua_State* luaStatePointer)
 		}
 	}
 
-	// Fetch the Lua listener function from the Lua table and push it to the top of the stack.
-	int luaFunctionStackIndex = 0;
-	lua_getfield(luaStatePointer, 1, "listener");
-	if (lua_isfunction(luaStatePointer, -1))
+	// Fetch the optional request timeout from the Lua table.
+	uint32_t timeoutInMilliseconds = 0;
+	if (!CopyRequestTimeoutFrom(luaStatePointer, 1, timeoutInMilliseconds))
 	{
-		luaFunctionStackIndex = lua_gettop(luaStatePointer);
-	}
-	else
-	{
-		CoronaLuaError(luaStatePointer, "Table must contain a 'listener' field of type function.");
-		lua_pop(luaStatePointer, 1);
+		lua_pushboolean(luaStatePointer, 0);
+		return 1;
 	}
-	if (!luaFunctionStackIndex)
+
+	// Fetch the Lua listener from the table and push it to the top of the stack.
+	// If not given and we're running within a coroutine, then the coroutine will await the result instead.
+	bool isAwaiting = false;
+	int luaListenerStackIndex = PushRequestListenerTo(luaStatePointer, 1, isAwaiting);
+	if (!luaListenerStackIndex)
 	{
 		lua_pushboolean(luaStatePointer, 0);
 		return 1;
 	}
 
-	// Fetch the number of active players for this application.
-	auto resultHandle = steamUserStatsPointer->FindLeaderboard(leaderboardName);
-
-	// Set up the given Lua function to receive the result of the above async operation.
+	// Set up the given Lua function to receive the leaderboard's info.
+	// If the same leaderboard is already being looked up, then share that Steam call instead of making another.
 	RuntimeContext::EventHandlerSettings settings{};
 	settings.LuaStatePointer = luaStatePointer;
-	settings.LuaFunctionStackIndex = luaFunctionStackIndex;
-	settings.SteamCallResultHandle = resultHandle;
-	settings.QueuingEventTaskCallback = CreateQueueingLeaderboardEventTaskCallbackWith(leaderboardName);
-	bool wasSuccessful = contextPointer->AddEventHandlerFor
-			<LeaderboardFindResult_t, DispatchLeaderboardFindResultEventTask>(settings);
+	settings.LuaFunctionStackIndex = luaListenerStackIndex;
+	settings.LeaderboardName = leaderboardName;
+	settings.TimeoutInMilliseconds = timeoutInMilliseconds;
+	settings.SingleFlightKey = leaderboardName;
+	std::string leaderboardNameCopy(leaderboardName);
+	auto requestId = contextPointer->SendRequestFor<LeaderboardFindResult_t>(settings, [leaderboardNameCopy]()
+	{
+		auto steamUserStatsPointer = SteamApiInitializer::GetUserStats();
+		if (!steamUserStatsPointer)
+		{
+			return k_uAPICallInvalid;
+		}
+		return steamUserStatsPointer->FindLeaderboard(leaderboardNameCopy.c_str());
+	});
 
 	// Pop the Lua listener off of the stack.
 	lua_pop(luaStatePointer, 1);
 
-	// Return true to Lua if the above async operation was successfully started/executed.
-	lua_pushboolean(luaStatePointer, wasSuccessful ? 1 : 0);
-	return 1;
+	// If awaited by a coroutine, then suspend it. It will be resumed with the event table once received.
+	if (isAwaiting && requestId)
+	{
+		return lua_yield(luaStatePointer, 0);
+	}
+
+	// Return true and a request handle to Lua if the above async operation was successfully started/executed.
+	return PushRequestResultTo(luaStatePointer, contextPointer, requestId);
 }
 
-/** bool steamworks.requestSetHighScore({leaderboardName="", value=x, listener=myListener}) */
+/**
+	bool, requestHandle steamworks.requestSetHighScore(
+	{
+		leaderboardName="", value=x, listener=myListener [,timeoutMs=x]
+	})
+ */
 int OnRequestSetHighScore(lua_State* luaStatePointer)
 {
 	// Validate.
@@ -1365,10 +1922,9 @@ int OnRequestSetHighScore(lua_State* luaStatePointer)
 		return 1;
 	}
 
-	// Fetch the Steam interface needed by this API call.
-	// Note: Will return null if Steam client is not currently running.
-	auto steamUserStatsPointer = SteamUserStats();
-	if (!steamUserStatsPointer)
+	// Do not continue if Steam's user stats interface is unavailable.
+	// Note: Requests made while Steam is still being initialized asynchronously are sent once it has finished.
+	if (!CanSendUserStatsRequestWith(contextPointer))
 	{
 		lua_pushboolean(luaStatePointer, 0);
 		return 1;
@@ -1436,17 +1992,22 @@ int OnRequestSetHighScore(lua_State* luaStatePointer)
 		}
 	}
 
-	// Do not continue if the required Lua listener is not in the table.
+	// Fetch the Lua listener from the table and push it to the top of the stack.
+	// If not given and we're running within a coroutine, then the coroutine will await the result instead.
+	bool isAwaiting = false;
+	int luaListenerStackIndex = PushRequestListenerTo(luaStatePointer, 1, isAwaiting);
+	if (!luaListenerStackIndex)
 	{
-		lua_getfield(luaStatePointer, 1, "listener");
-		bool hasListener = lua_isfunction(luaStatePointer, -1) ? true : false;
-		lua_pop(luaStatePointer, 1);
-		if (!hasListener)
-		{
-			CoronaLuaError(luaStatePointer, "Table must contain a 'listener' field of type function.");
-			lua_pushboolean(luaStatePointer, 0);
-			return 1;
-		}
+		lua_pushboolean(luaStatePointer, 0);
+		return 1;
+	}
+
+	// Fetch the optional request timeout from the Lua table.
+	uint32_t timeoutInMilliseconds = 0;
+	if (!CopyRequestTimeoutFrom(luaStatePointer, 1, timeoutInMilliseconds))
+	{
+		lua_pushboolean(luaStatePointer, 0);
+		return 1;
 	}
 
 	// Attempt to fetch the leaderboard's handle by its unique name.
@@ -1485,6 +2046,11 @@ int OnRequestSetHighScore(lua_State* luaStatePointer)
 			}
 			lua_pop(luaStatePointer, 1);
 
+			// Check if the leaderboard handle request has timed out.
+			lua_getfield(luaStatePointer, 1, "timedOut");
+			bool hasTimedOut = lua_toboolean(luaStatePointer, -1) ? true : false;
+			lua_pop(luaStatePointer, 1);
+
 			// Fetch the leaderboard name.
 			const char* leaderboardName = nullptr;
 			lua_getfield(luaStatePointer, 1, "leaderboardName");
@@ -1514,10 +2080,23 @@ int OnRequestSetHighScore(lua_State* luaStatePointer)
 					if (lua_isfunction(luaStatePointer, -1))
 					{
 						lua_pushvalue(luaStatePointer, luaSettingsTableStackIndex);
-						CoronaLuaDoCall(luaStatePointer, 1, 1);
-						if (lua_type(luaStatePointer, -1) == LUA_TBOOLEAN)
+						CoronaLuaDoCall(luaStatePointer, 1, 2);
+						if (lua_type(luaStatePointer, -2) == LUA_TBOOLEAN)
 						{
-							hasSucceeded = lua_toboolean(luaStatePointer, -1) ? true : false;
+							hasSucceeded = lua_toboolean(luaStatePointer, -2) ? true : false;
+						}
+
+						// Make the request handle given to the caller cancel the re-sent request from now on
+						// and let the re-sent request settle the caller's promise.
+						// Note: The re-sent request's own handle is cleared so that its finalizer won't remove it.
+						auto requestIdPointer = ToRequestHandle(luaStatePointer, lua_upvalueindex(2));
+						auto newRequestIdPointer = ToRequestHandle(luaStatePointer, -1);
+						if (hasSucceeded && requestIdPointer && newRequestIdPointer)
+						{
+							contextPointer->MoveRequestPromise(
+									luaStatePointer, *requestIdPointer, *newRequestIdPointer);
+							*requestIdPointer = *newRequestIdPointer;
+							*newRequestIdPointer = 0;
 						}
 					}
 				}
@@ -1534,7 +2113,7 @@ int OnRequestSetHighScore(lua_State* luaStatePointer)
 				if (lua_istable(luaStatePointer, luaSettingsTableStackIndex))
 				{
 					lua_getfield(luaStatePointer, luaSettingsTableStackIndex, "listener");
-					if (lua_isfunction(luaStatePointer, -1))
+					if (lua_isfunction(luaStatePointer, -1) || lua_isthread(luaStatePointer, -1))
 					{
 						luaListenerStackIndex = lua_gettop(luaStatePointer);
 					}
@@ -1544,30 +2123,49 @@ int OnRequestSetHighScore(lua_State* luaStatePointer)
 					}
 				}
 
-				// Dispatch an event to the Lua listener.
-				if (luaListenerStackIndex)
+				// Dispatch an event to the Lua listener or resume the coroutine awaiting the result.
+				// Also settle the promise of the request handle given to the caller with the same event.
 				{
-					// Create a Lua event dispatcher and add the Lua listener to it.
-					auto luaEventDispatcherPointer = std::make_shared<LuaEventDispatcher>(luaStatePointer);
-					luaEventDispatcherPointer->AddEventListener(
-							luaStatePointer,
-							DispatchLeaderboardScoreUploadEventTask::kLuaEventName,
-							luaListenerStackIndex);
-
-					// Dispatch the event to the Lua listener.
 					LeaderboardScoreUploaded_t eventData{};
 					if (contextPointer)
 					{
 						eventData.m_hSteamLeaderboard = contextPointer->GetCachedLeaderboardHandleByName(leaderboardName);
 					}
 					DispatchLeaderboardScoreUploadEventTask task;
-					task.SetLuaEventDispatcher(luaEventDispatcherPointer);
+					if (luaListenerStackIndex)
+					{
+						RuntimeContext::SetUpRequestListenerFor(&task, luaStatePointer, luaListenerStackIndex);
+					}
 					task.AcquireEventDataFrom(eventData);
 					task.SetLeaderboardName(leaderboardName);
 					task.SetHadIOFailure(true);
-					task.Execute();
+					task.SetTimedOut(hasTimedOut);
+					if (task.PushLuaEventTableTo(luaStatePointer))
+					{
+						int luaEventTableStackIndex = lua_gettop(luaStatePointer);
+						task.DispatchLuaEventTable(luaStatePointer, luaEventTableStackIndex);
+						auto requestIdPointer = ToRequestHandle(luaStatePointer, lua_upvalueindex(2));
+						if (requestIdPointer)
+						{
+							contextPointer->SettleRequestPromise(
+									luaStatePointer, *requestIdPointer, luaEventTableStackIndex);
+						}
+						lua_pop(luaStatePointer, 1);
+					}
+					else if (contextPointer)
+					{
+						auto requestIdPointer = ToRequestHandle(luaStatePointer, lua_upvalueindex(2));
+						if (requestIdPointer)
+						{
+							contextPointer->SettleRequestPromiseWithError(
+									luaStatePointer, *requestIdPointer, task.GetLuaEventName());
+						}
+					}
+				}
 
-					// Pop the Lua listener off of the stack.
+				// Pop the Lua listener off of the stack.
+				if (luaListenerStackIndex)
+				{
 					lua_pop(luaStatePointer, 1);
 				}
 			}
@@ -1577,55 +2175,99 @@ int OnRequestSetHighScore(lua_State* luaStatePointer)
 		// Push the above callback to Lua.
 		// We also store the requestSetHighScore() function's argument as an upvalue so that
 		// the above callback (when invoked) can call this function again with that same argument.
-		lua_pushvalue(luaStatePointer, 1);
-		lua_pushcclosure(luaStatePointer, lambda, 1);
+		// The request handle returned to the caller is stored as an upvalue too, so that it can be updated
+		// to reference the re-sent request.
+		// If awaited by a coroutine, then store a copy of the argument referencing the coroutine as its listener
+		// instead, so that the re-sent request resumes the coroutine.
+		auto requestIdPointer = PushRequestHandleTo(luaStatePointer, 0);
+		int luaRequestHandleStackIndex = lua_gettop(luaStatePointer);
+		if (isAwaiting)
+		{
+			PushRequestSettingsCopyTo(luaStatePointer, 1, luaListenerStackIndex);
+		}
+		else
+		{
+			lua_pushvalue(luaStatePointer, 1);
+		}
+		lua_pushvalue(luaStatePointer, luaRequestHandleStackIndex);
+		lua_pushcclosure(luaStatePointer, lambda, 2);
 
-		// Request the leaderboard handle from Steam.
+		// Request the leaderboard handle from Steam, unless the same leaderboard is already being looked up.
 		// Set up the above callback to receive the result of this request.
-		auto resultHandle = steamUserStatsPointer->FindLeaderboard(leaderboardName);
 		RuntimeContext::EventHandlerSettings settings{};
 		settings.LuaStatePointer = luaStatePointer;
 		settings.LuaFunctionStackIndex = lua_gettop(luaStatePointer);
-		settings.SteamCallResultHandle = resultHandle;
-		settings.QueuingEventTaskCallback = CreateQueueingLeaderboardEventTaskCallbackWith(leaderboardName);
-		bool wasSuccessful = contextPointer->AddEventHandlerFor
-				<LeaderboardFindResult_t, DispatchLeaderboardFindResultEventTask>(settings);
+		settings.LeaderboardName = leaderboardName;
+		settings.TimeoutInMilliseconds = timeoutInMilliseconds;
+		settings.SingleFlightKey = leaderboardName;
+		std::string leaderboardNameCopy(leaderboardName);
+		auto requestId = contextPointer->SendRequestFor<LeaderboardFindResult_t>(settings, [leaderboardNameCopy]()
+		{
+			auto steamUserStatsPointer = SteamApiInitializer::GetUserStats();
+			if (!steamUserStatsPointer)
+			{
+				return k_uAPICallInvalid;
+			}
+			return steamUserStatsPointer->FindLeaderboard(leaderboardNameCopy.c_str());
+		});
 
 		// Pop the above Lua closure off of the stack.
 		lua_pop(luaStatePointer, 1);
 
-		// Return true to Lua if we've successfully sent the above request.
-		lua_pushboolean(luaStatePointer, wasSuccessful ? 1 : 0);
-		return 1;
-	}
+		// Return false to Lua if we've failed to send the above request.
+		if (!requestId)
+		{
+			lua_pop(luaStatePointer, 1);
+			lua_pushboolean(luaStatePointer, 0);
+			return 1;
+		}
 
-	// Push the table's Lua listener function to the top of the stack.
-	// Note: We've already determined that it exists in the table up above.
-	lua_getfield(luaStatePointer, 1, "listener");
-	int luaFunctionStackIndex = lua_gettop(luaStatePointer);
+		// If awaited by a coroutine, then suspend it. It will be resumed with the re-sent request's event table.
+		if (isAwaiting)
+		{
+			return lua_yield(luaStatePointer, 0);
+		}
 
-	// Request Steam to update its leaderboard with the given score.
-	auto resultHandle = steamUserStatsPointer->UploadLeaderboardScore(
-			leaderboardHandle, k_ELeaderboardUploadScoreMethodKeepBest, scoreValue, nullptr, 0);
+		// Return true and the above request handle to Lua.
+		// Note: The find request settles the handle's promise unless it gets moved to the re-sent request.
+		*requestIdPointer = requestId;
+		contextPointer->AddRequestPromise(requestId);
+		lua_pushboolean(luaStatePointer, 1);
+		lua_insert(luaStatePointer, -2);
+		return 2;
+	}
 
-	// Set up the given Lua function to receive the result of the above async operation.
+	// Request Steam to update its leaderboard with the given score.
+	// Set up the given Lua function to receive the result of this async operation.
+	// Note: Uploads modify the leaderboard, so they are never shared with identical in-flight uploads.
 	RuntimeContext::EventHandlerSettings settings{};
 	settings.LuaStatePointer = luaStatePointer;
-	settings.LuaFunctionStackIndex = luaFunctionStackIndex;
-	settings.SteamCallResultHandle = resultHandle;
-	settings.QueuingEventTaskCallback = CreateQueueingLeaderboardEventTaskCallbackWith(leaderboardName);
-	bool wasSuccessful = contextPointer->AddEventHandlerFor
-			<LeaderboardScoreUploaded_t, DispatchLeaderboardScoreUploadEventTask>(settings);
+	settings.LuaFunctionStackIndex = luaListenerStackIndex;
+	settings.LeaderboardName = leaderboardName;
+	settings.TimeoutInMilliseconds = timeoutInMilliseconds;
+	auto requestId = contextPointer->SendRequestFor<LeaderboardScoreUploaded_t>(
+			settings, [leaderboardHandle, scoreValue]()
+	{
+		auto steamUserStatsPointer = SteamApiInitializer::GetUserStats();
+		if (!steamUserStatsPointer)
+		{
+			return k_uAPICallInvalid;
+		}
+		return steamUserStatsPointer->UploadLeaderboardScore(
+				leaderboardHandle, k_ELeaderboardUploadScoreMethodKeepBest, scoreValue, nullptr, 0);
+	});
+
+	// Pop the Lua listener off of the stack.
+	lua_pop(luaStatePointer, 1);
 
-	// Pop the Lua listener off of the stack, if provided.
-	if (luaFunctionStackIndex)
+	// If awaited by a coroutine, then suspend it. It will be resumed with the event table once received.
+	if (isAwaiting && requestId)
 	{
-		lua_pop(luaStatePointer, 1);
+		return lua_yield(luaStatePointer, 0);
 	}
 
-	// Return true to Lua if the above async operation was successfully started/executed.
-	lua_pushboolean(luaStatePointer, wasSuccessful ? 1 : 0);
-	return 1;
+	// Return true and a request handle to Lua if the above async operation was successfully started/executed.
+	return PushRequestResultTo(luaStatePointer, contextPointer, requestId);
 }
 
 /** bool steamworks.requestUserProgress([userSteamId]) */
@@ -1674,7 +2316,7 @@ int OnRequestUserProgress(lua_State* luaStatePointer)
 
 	// Fetch the Steam interface needed by this API call.
 	// Note: Will return null if Steam client is not currently running.
-	auto steamUserStatsPointer = SteamUserStats();
+	auto steamUserStatsPointer = SteamApiInitializer::GetUserStats();
 	if (!steamUserStatsPointer)
 	{
 		lua_pushboolean(luaStatePointer, 0);
@@ -1712,7 +2354,7 @@ int OnResetUserProgress(lua_State* luaStatePointer)
 
 	// Clear the user's stats and achievements.
 	bool wasSuccessful = false;
-	auto steamUserStatsPointer = SteamUserStats();
+	auto steamUserStatsPointer = SteamApiInitializer::GetUserStats();
 	if (steamUserStatsPointer)
 	{
 		wasSuccessful = steamUserStatsPointer->ResetAllStats(true);
@@ -1732,7 +2374,7 @@ int OnResetUserStats(lua_State* luaStatePointer)
 
 	// Clear the user's stats.
 	bool wasSuccessful = false;
-	auto steamUserStatsPointer = SteamUserStats();
+	auto steamUserStatsPointer = SteamApiInitializer::GetUserStats();
 	if (steamUserStatsPointer)
 	{
 		wasSuccessful = steamUserStatsPointer->ResetAllStats(false);
@@ -1823,7 +2465,7 @@ int OnSetAchievementProgress(lua_State* luaStatePointer)
 
 	// Fetch the Steam object used to access achievements.
 	// Will return false to Lua if not currently connected to Steam client.
-	auto steamUserStatsPointer = SteamUserStats();
+	auto steamUserStatsPointer = SteamApiInitializer::GetUserStats();
 	if (!steamUserStatsPointer)
 	{
 		lua_pushboolean(luaStatePointer, 0);
@@ -1862,7 +2504,7 @@ int OnSetAchievementUnlocked(lua_State* luaStatePointer)
 
 	// Fetch the Steam object used to access achievements.
 	// Will return false to Lua if not currently connected to Steam client.
-	auto steamUserStatsPointer = SteamUserStats();
+	auto steamUserStatsPointer = SteamApiInitializer::GetUserStats();
 	if (!steamUserStatsPointer)
 	{
 		lua_pushboolean(luaStatePointer, 0);
@@ -1903,7 +2545,7 @@ int OnShowGameOverlay(lua_State* luaStatePointer)
 
 	// Fetch the Steam object used to display the overlay.
 	// Will return false to Lua if not currently connected to Steam client.
-	auto steamFriendsPointer = SteamFriends();
+	auto steamFriendsPointer = SteamApiInitializer::GetFriends();
 	if (!steamFriendsPointer)
 	{
 		lua_pushboolean(luaStatePointer, 0);
@@ -1949,7 +2591,7 @@ int OnShowStoreOverlay(lua_State* luaStatePointer)
 
 	// Fetch the Steam object used to display the overlay.
 	// Will return false to Lua if not currently connected to Steam client.
-	auto steamFriendsPointer = SteamFriends();
+	auto steamFriendsPointer = SteamApiInitializer::GetFriends();
 	if (!steamFriendsPointer)
 	{
 		lua_pushboolean(luaStatePointer, 0);
@@ -2025,7 +2667,7 @@ int OnShowUserOverlay(lua_State* luaStatePointer)
 
 	// Fetch the Steam object used to display the overlay.
 	// Will return false to Lua if not currently connected to Steam client.
-	auto steamFriendsPointer = SteamFriends();
+	auto steamFriendsPointer = SteamApiInitializer::GetFriends();
 	if (!steamFriendsPointer)
 	{
 		lua_pushboolean(luaStatePointer, 0);
@@ -2120,7 +2762,7 @@ int OnShowWebOverlay(lua_State* luaStatePointer)
 
 	// Fetch the Steam object used to display the overlay.
 	// Will return false to Lua if not currently connected to Steam client.
-	auto steamFriendsPointer = SteamFriends();
+	auto steamFriendsPointer = SteamApiInitializer::GetFriends();
 	if (!steamFriendsPointer)
 	{
 		lua_pushboolean(luaStatePointer, 0);
@@ -2167,7 +2809,7 @@ int OnSetNotificationPosition(lua_State* luaStatePointer)
 	}
 
 	// Fetch the steam object used to set the notification position.
-	auto steamUtilsPointer = SteamUtils();
+	auto steamUtilsPointer = SteamApiInitializer::GetUtils();
 	if (!steamUtilsPointer)
 	{
 		lua_pushboolean(luaStatePointer, 0);
@@ -2237,7 +2879,7 @@ int OnSetUserStatValues(lua_State* luaStatePointer)
 
 	// Fetch the Steam interface needed by this API call.
 	// Note: Will return null if Steam client is not currently running.
-	auto steamUserStatsPointer = SteamUserStats();
+	auto steamUserStatsPointer = SteamApiInitializer::GetUserStats();
 	if (!steamUserStatsPointer)
 	{
 		lua_pushboolean(luaStatePointer, 0);
@@ -2391,7 +3033,7 @@ int OnIsDlcInstalled(lua_State* luaStatePointer)
 
 	// Fetch the Steam object used to display the overlay.
 	// Will return false to Lua if not currently connected to Steam client.
-	auto steamApps = SteamApps();
+	auto steamApps = SteamApiInitializer::GetApps();
 	if (!steamApps)
 	{
 		lua_pushboolean(luaStatePointer, 0);
@@ -2451,7 +3093,7 @@ int OnGetAchievementNames(lua_State* luaStatePointer)
 
 	// Fetch the Steam interface needed by this API call.
 	// Note: Will return an empty array if not connected to Steam client.
-	auto steamUserStatsPointer = SteamUserStats();
+	auto steamUserStatsPointer = SteamApiInitializer::GetUserStats();
 	if (!steamUserStatsPointer)
 	{
 		lua_createtable(luaStatePointer, 0, 0);
@@ -2470,7 +3112,124 @@ int OnGetAchievementNames(lua_State* luaStatePointer)
 	return 1;
 }
 
-/** steamworks.addEventListener(eventName, listener) */
+/** table steamworks.getRuntimeStatistics() */
+int OnGetRuntimeStatistics(lua_State* luaStatePointer)
+{
+	// Validate.
+	if (!luaStatePointer)
+	{
+		return 0;
+	}
+
+	// Fetch the runtime context associated with the calling Lua state.
+	auto contextPointer = (RuntimeContext*)lua_touserdata(luaStatePointer, lua_upvalueindex(1));
+	if (!contextPointer)
+	{
+		lua_pushnil(luaStatePointer);
+		return 1;
+	}
+
+	// Push a table of the plugin's event dispatching statistics to Lua.
+	lua_createtable(luaStatePointer, 0, 19);
+	lua_pushnumber(luaStatePointer, (double)contextPointer->GetDispatchTimeBudgetInMicroseconds());
+	lua_setfield(luaStatePointer, -2, "dispatchTimeBudget");
+	lua_pushnumber(luaStatePointer, (double)contextPointer->GetLastCarriedOverEventCount());
+	lua_setfield(luaStatePointer, -2, "carriedOverEventCount");
+	lua_pushnumber(luaStatePointer, (double)contextPointer->GetTotalCarriedOverEventCount());
+	lua_setfield(luaStatePointer, -2, "totalCarriedOverEventCount");
+	lua_pushnumber(luaStatePointer, (double)contextPointer->GetTotalCoalescedEventCount());
+	lua_setfield(luaStatePointer, -2, "totalCoalescedEventCount");
+	lua_pushnumber(luaStatePointer, (double)BaseDispatchEventTaskPool::GetTotalSlabAllocationCount());
+	lua_setfield(luaStatePointer, -2, "eventTaskSlabAllocationCount");
+	{
+		std::lock_guard<std::recursive_mutex> scopedLock(SteamCallbackPump::GetMutex());
+		auto& handlerPool = contextPointer->GetSteamCallResultHandlerPool();
+		lua_pushnumber(luaStatePointer, (double)handlerPool.GetActiveHandlerCount());
+		lua_setfield(luaStatePointer, -2, "liveRequestHandlerCount");
+		lua_pushnumber(luaStatePointer, (double)handlerPool.GetIdleHandlerCount());
+		lua_setfield(luaStatePointer, -2, "idleRequestHandlerCount");
+		lua_pushnumber(luaStatePointer, (double)handlerPool.GetPeakActiveHandlerCount());
+		lua_setfield(luaStatePointer, -2, "peakRequestHandlerCount");
+		lua_pushnumber(luaStatePointer, (double)contextPointer->GetTotalUnobservedEventCount());
+		lua_setfield(luaStatePointer, -2, "totalUnobservedEventCount");
+		lua_pushnumber(luaStatePointer, (double)contextPointer->GetTotalTimedOutRequestCount());
+		lua_setfield(luaStatePointer, -2, "totalTimedOutRequestCount");
+		lua_pushnumber(luaStatePointer, (double)contextPointer->GetTotalSingleFlightRequestCount());
+		lua_setfield(luaStatePointer, -2, "totalSharedRequestCount");
+		lua_pushnumber(luaStatePointer, (double)contextPointer->GetParkedRequestCount());
+		lua_setfield(luaStatePointer, -2, "parkedRequestCount");
+		lua_pushnumber(luaStatePointer, (double)contextPointer->GetTotalParkedRequestCount());
+		lua_setfield(luaStatePointer, -2, "totalParkedRequestCount");
+	}
+	lua_pushnumber(luaStatePointer, (double)contextPointer->GetRejectedRequestCount());
+	lua_setfield(luaStatePointer, -2, "rejectedRequestCount");
+	lua_pushnumber(luaStatePointer, (double)SteamCallbackPump::GetFrequencyInHertz());
+	lua_setfield(luaStatePointer, -2, "callbackPumpFrequency");
+	lua_pushnumber(luaStatePointer, (double)contextPointer->GetTotalDroppedSuspendedEventCount());
+	lua_setfield(luaStatePointer, -2, "totalSuspendedEventDropCount");
+	lua_pushnumber(luaStatePointer, (double)contextPointer->GetStartupDurationInMicroseconds());
+	lua_setfield(luaStatePointer, -2, "startupTime");
+	lua_pushnumber(luaStatePointer, (double)SteamApiInitializer::GetInitializationDurationInMicroseconds());
+	lua_setfield(luaStatePointer, -2, "steamInitTime");
+
+	// Push a table of request scheduling statistics, keyed by request category name.
+	lua_createtable(luaStatePointer, 0, SteamRequestCategory::kCount);
+	for (uint32_t index = 0; index < SteamRequestCategory::kCount; index++)
+	{
+		auto category = SteamRequestCategory::FromIndex(index);
+		auto statistics = contextPointer->GetRequestCategoryStatisticsFor(category);
+		lua_createtable(luaStatePointer, 0, 10);
+		lua_pushnumber(luaStatePointer, (double)statistics.ConcurrencyLimit);
+		lua_setfield(luaStatePointer, -2, "concurrencyLimit");
+		lua_pushnumber(luaStatePointer, (double)statistics.Weight);
+		lua_setfield(luaStatePointer, -2, "weight");
+		lua_pushnumber(luaStatePointer, (double)statistics.ActiveRequestCount);
+		lua_setfield(luaStatePointer, -2, "activeCount");
+		lua_pushnumber(luaStatePointer, (double)statistics.QueuedRequestCount);
+		lua_setfield(luaStatePointer, -2, "queuedCount");
+		lua_pushnumber(luaStatePointer, (double)statistics.PeakQueuedRequestCount);
+		lua_setfield(luaStatePointer, -2, "peakQueuedCount");
+		lua_pushnumber(luaStatePointer, (double)statistics.TotalQueuedRequestCount);
+		lua_setfield(luaStatePointer, -2, "totalQueuedCount");
+		double averageWaitTime = 0;
+		if (statistics.TotalDequeuedRequestCount > 0)
+		{
+			averageWaitTime =
+					(double)statistics.TotalQueueWaitTimeInMicroseconds / (double)statistics.TotalDequeuedRequestCount;
+		}
+		lua_pushnumber(luaStatePointer, averageWaitTime);
+		lua_setfield(luaStatePointer, -2, "averageQueueWaitTime");
+		lua_pushnumber(luaStatePointer, (double)statistics.MaxQueueWaitTimeInMicroseconds);
+		lua_setfield(luaStatePointer, -2, "maxQueueWaitTime");
+		lua_pushnumber(luaStatePointer, (double)statistics.TotalRetryCount);
+		lua_setfield(luaStatePointer, -2, "totalRetryCount");
+		lua_pushnumber(luaStatePointer, (double)statistics.TotalRetryBudgetExhaustedCount);
+		lua_setfield(luaStatePointer, -2, "totalRetryBudgetExhaustedCount");
+		lua_setfield(luaStatePointer, -2, category.GetCoronaStringId());
+	}
+	lua_setfield(luaStatePointer, -2, "requestCategories");
+	return 1;
+}
+
+/** bool steamworks.all(requestHandles, listener) */
+int OnAll(lua_State* luaStatePointer)
+{
+	return AddRequestPromiseAggregateFrom(luaStatePointer, RuntimeContext::PromiseAggregateType::kAll, "all");
+}
+
+/** bool steamworks.any(requestHandles, listener) */
+int OnAny(lua_State* luaStatePointer)
+{
+	return AddRequestPromiseAggregateFrom(luaStatePointer, RuntimeContext::PromiseAggregateType::kAny, "any");
+}
+
+/** bool steamworks.race(requestHandles, listener) */
+int OnRace(lua_State* luaStatePointer)
+{
+	return AddRequestPromiseAggregateFrom(luaStatePointer, RuntimeContext::PromiseAggregateType::kRace, "race");
+}
+
+/** steamworks.addEventListener(eventName, listener, [filter]) */
 int OnAddEventListener(lua_State* luaStatePointer)
 {
 	// Validate.
@@ -2498,6 +3257,41 @@ int OnAddEventListener(lua_State* luaStatePointer)
 		return 0;
 	}
 
+	// Fetch the optional filter table, which limits which events are delivered to the listener.
+	// Its optional "replayLast" field requests the last received state event to be replayed to the listener.
+	LuaEventFilter filter;
+	bool shouldReplayLastEvent = false;
+	{
+		const auto luaArgumentType = lua_type(luaStatePointer, 3);
+		if (luaArgumentType == LUA_TTABLE)
+		{
+			if (!CopyEventFilterFrom(luaStatePointer, 3, filter))
+			{
+				lua_pushboolean(luaStatePointer, 0);
+				return 1;
+			}
+			lua_getfield(luaStatePointer, 3, "replayLast");
+			const auto luaValueType = lua_type(luaStatePointer, -1);
+			if (luaValueType == LUA_TBOOLEAN)
+			{
+				shouldReplayLastEvent = lua_toboolean(luaStatePointer, -1) ? true : false;
+			}
+			lua_pop(luaStatePointer, 1);
+			if ((luaValueType != LUA_TBOOLEAN) && (luaValueType != LUA_TNIL))
+			{
+				CoronaLuaError(luaStatePointer, "The filter's 'replayLast' field must be of type boolean.");
+				lua_pushboolean(luaStatePointer, 0);
+				return 1;
+			}
+		}
+		else if ((luaArgumentType != LUA_TNONE) && (luaArgumentType != LUA_TNIL))
+		{
+			CoronaLuaError(luaStatePointer, "3rd argument must be set to a filter table or nil.");
+			lua_pushboolean(luaStatePointer, 0);
+			return 1;
+		}
+	}
+
 	// Fetch the runtime context associated with the calling Lua state.
 	auto contextPointer = (RuntimeContext*)lua_touserdata(luaStatePointer, lua_upvalueindex(1));
 	if (!contextPointer)
@@ -2506,12 +3300,95 @@ int OnAddEventListener(lua_State* luaStatePointer)
 	}
 
 	// Add the given listener for the global Steam event.
-	auto luaEventDispatcherPointer = contextPointer->GetLuaEventDispatcher();
-	if (luaEventDispatcherPointer)
+	// Note: The runtime context keeps a native count of listeners per event, which it uses to skip
+	//       creating events that no Lua listener is subscribed to. A listener's filter is checked
+	//       natively before an event's Lua table is built.
+	bool wasAdded = contextPointer->AddLuaEventListener(luaStatePointer, eventName, 2, filter, shouldReplayLastEvent);
+	lua_pushboolean(luaStatePointer, wasAdded ? 1 : 0);
+	return 1;
+}
+
+/** steamworks.addBatchListener(listener, [filter]) */
+int OnAddBatchListener(lua_State* luaStatePointer)
+{
+	// Validate.
+	if (!luaStatePointer)
 	{
-		luaEventDispatcherPointer->AddEventListener(luaStatePointer, eventName, 2);
+		return 0;
 	}
-	return 0;
+
+	// Determine if the 1st argument references a Lua function.
+	if (!lua_isfunction(luaStatePointer, 1))
+	{
+		CoronaLuaError(luaStatePointer, "1st argument must be set to a listener function.");
+		lua_pushboolean(luaStatePointer, 0);
+		return 1;
+	}
+
+	// Fetch the optional filter table, which limits which events are added to the listener's batches.
+	LuaEventFilter filter;
+	{
+		const auto luaArgumentType = lua_type(luaStatePointer, 2);
+		if (luaArgumentType == LUA_TTABLE)
+		{
+			if (!CopyEventFilterFrom(luaStatePointer, 2, filter))
+			{
+				lua_pushboolean(luaStatePointer, 0);
+				return 1;
+			}
+		}
+		else if ((luaArgumentType != LUA_TNONE) && (luaArgumentType != LUA_TNIL))
+		{
+			CoronaLuaError(luaStatePointer, "2nd argument must be set to a filter table or nil.");
+			lua_pushboolean(luaStatePointer, 0);
+			return 1;
+		}
+	}
+
+	// Fetch the runtime context associated with the calling Lua state.
+	auto contextPointer = (RuntimeContext*)lua_touserdata(luaStatePointer, lua_upvalueindex(1));
+	if (!contextPointer)
+	{
+		lua_pushboolean(luaStatePointer, 0);
+		return 1;
+	}
+
+	// Add the given function as a batch listener.
+	// Note: Its filter is checked natively before an event's Lua table is built.
+	bool wasSuccessful = contextPointer->AddLuaBatchListener(luaStatePointer, 1, filter);
+	lua_pushboolean(luaStatePointer, wasSuccessful ? 1 : 0);
+	return 1;
+}
+
+/** steamworks.removeBatchListener(listener) */
+int OnRemoveBatchListener(lua_State* luaStatePointer)
+{
+	// Validate.
+	if (!luaStatePointer)
+	{
+		return 0;
+	}
+
+	// Determine if the 1st argument references a Lua function.
+	if (!lua_isfunction(luaStatePointer, 1))
+	{
+		CoronaLuaError(luaStatePointer, "1st argument must be set to a listener function.");
+		lua_pushboolean(luaStatePointer, 0);
+		return 1;
+	}
+
+	// Fetch the runtime context associated with the calling Lua state.
+	auto contextPointer = (RuntimeContext*)lua_touserdata(luaStatePointer, lua_upvalueindex(1));
+	if (!contextPointer)
+	{
+		lua_pushboolean(luaStatePointer, 0);
+		return 1;
+	}
+
+	// Remove the given batch listener.
+	bool wasSuccessful = contextPointer->RemoveLuaBatchListener(luaStatePointer, 1);
+	lua_pushboolean(luaStatePointer, wasSuccessful ? 1 : 0);
+	return 1;
 }
 
 /** steamworks.removeEventListener(eventName, listener) */
@@ -2550,12 +3427,9 @@ int OnRemoveEventListener(lua_State* luaStatePointer)
 	}
 
 	// Remove the given listener from the global Steam event.
-	auto luaEventDispatcherPointer = contextPointer->GetLuaEventDispatcher();
-	if (luaEventDispatcherPointer)
-	{
-		luaEventDispatcherPointer->RemoveEventListener(luaStatePointer, eventName, 2);
-	}
-	return 0;
+	bool wasRemoved = contextPointer->RemoveLuaEventListener(luaStatePointer, eventName, 2);
+	lua_pushboolean(luaStatePointer, wasRemoved ? 1 : 0);
+	return 1;
 }
 
 /** Called when a property field is being read from the plugin's Lua table. */
@@ -2601,7 +3475,7 @@ int OnAccessingField(lua_State* luaStatePointer)
 		// Note: This is a 64-bit int which exceeds the digits of precision a Lua number can store.
 		//       So, we must return Steam IDs in string form to preserve all of the digits.
 		uint64 integerId = 0;
-		auto steamAppsPointer = SteamApps();
+		auto steamAppsPointer = SteamApiInitializer::GetApps();
 		if (steamAppsPointer)
 		{
 			integerId = steamAppsPointer->GetAppOwner().ConvertToUint64();
@@ -2626,7 +3500,7 @@ int OnAccessingField(lua_State* luaStatePointer)
 		// Note: This is a 64-bit int which exceeds the digits of precision a Lua number can store.
 		//       So, we must return Steam IDs in string form to preserve all of the digits.
 		uint64 integerId = 0;
-		auto steamUserPointer = SteamUser();
+		auto steamUserPointer = SteamApiInitializer::GetUser();
 		if (steamUserPointer)
 		{
 			integerId = steamUserPointer->GetSteamID().ConvertToUint64();
@@ -2651,7 +3525,7 @@ int OnAccessingField(lua_State* luaStatePointer)
 		// and that the user is currently logged into it.
 		// Note: Do not call SteamUser()->BLoggedOn() since it returns false while in "offline mode".
 		bool isLoggedOn = false;
-		auto steamUserPointer = SteamUser();
+		auto steamUserPointer = SteamApiInitializer::GetUser();
 		if (steamUserPointer)
 		{
 			isLoggedOn = steamUserPointer->GetSteamID().IsValid();
@@ -2659,6 +3533,18 @@ int OnAccessingField(lua_State* luaStatePointer)
 		lua_pushboolean(luaStatePointer, isLoggedOn ? 1 : 0);
 		resultCount = 1;
 	}
+	else if (!strcmp(fieldName, "connectionState"))
+	{
+		// Push a string indicating if Steam is connected to its servers, such as "connected" or "disconnected".
+		auto contextPointer = (RuntimeContext*)lua_touserdata(luaStatePointer, lua_upvalueindex(1));
+		auto connectionState = SteamConnectionState::kConnected;
+		if (contextPointer)
+		{
+			connectionState = contextPointer->GetConnectionState();
+		}
+		lua_pushstring(luaStatePointer, connectionState.GetCoronaStringId());
+		resultCount = 1;
+	}
 	else if (!strcmp(fieldName, "canShowOverlay"))
 	{
 		// Push a boolean indicating if Steam's overlay can be rendered on top of this app.
@@ -2692,17 +3578,20 @@ int OnAssigningField(lua_State* luaStatePointer)
 int OnFinalizing(lua_State* luaStatePointer)
 {
 	// Delete this plugin's runtime context from memory.
+	// Note: Must block the SteamCallbackPump's thread, if running, while the context unregisters its Steam callbacks.
 	auto contextPointer = (RuntimeContext*)lua_touserdata(luaStatePointer, lua_upvalueindex(1));
 	if (contextPointer)
 	{
+		std::lock_guard<std::recursive_mutex> scopedLock(SteamCallbackPump::GetMutex());
 		delete contextPointer;
 	}
 
 	// Shutdown our connection with Steam if this is the last plugin instance.
-	// This must be done after deleting the RuntimeContext above.
+	// This must be done after deleting the RuntimeContext above and after stopping the callback pump's thread.
 	if (RuntimeContext::GetInstanceCount() <= 0)
 	{
-		SteamAPI_Shutdown();
+		SteamCallbackPump::Stop();
+		SteamApiInitializer::Shutdown();
 	}
 	return 0;
 }
@@ -2718,6 +3607,8 @@ int OnFinalizing(lua_State* luaStatePointer)
  */
 CORONA_EXPORT int luaopen_plugin_steamworks(lua_State* luaStatePointer)
 {
+	const auto startTime = std::chrono::steady_clock::now();
+
 	// Validate.
 	if (!luaStatePointer)
 	{
@@ -2742,7 +3633,12 @@ CORONA_EXPORT int luaopen_plugin_steamworks(lua_State* luaStatePointer)
 
 	// Create a new runtime context used to receive Steam's event and dispatch them to Lua.
 	// Also used to ensure that the Steam overlay is rendered when requested on Windows.
-	auto contextPointer = new RuntimeContext(luaStatePointer);
+	// Note: Must block the SteamCallbackPump's thread, if running, while the context registers its Steam callbacks.
+	RuntimeContext* contextPointer = nullptr;
+	{
+		std::lock_guard<std::recursive_mutex> scopedLock(SteamCallbackPump::GetMutex());
+		contextPointer = new RuntimeContext(luaStatePointer);
+	}
 	if (!contextPointer)
 	{
 		return 0;
@@ -2755,6 +3651,7 @@ CORONA_EXPORT int luaopen_plugin_steamworks(lua_State* luaStatePointer)
 		{
 			{ "getAchievementInfo", OnGetAchievementInfo },
 			{ "getAchievementNames", OnGetAchievementNames },
+			{ "getRuntimeStatistics", OnGetRuntimeStatistics },
 			{ "getUserInfo", OnGetUserInfo },
 			{ "getUserStatValue", OnGetUserStatValue },
 			{ "requestActivePlayerCount", OnRequestActivePlayerCount },
@@ -2773,8 +3670,13 @@ CORONA_EXPORT int luaopen_plugin_steamworks(lua_State* luaStatePointer)
 			{ "showUserOverlay", OnShowUserOverlay },
 			{ "showWebOverlay", OnShowWebOverlay },
 			{ "isDlcInstalled", OnIsDlcInstalled },
+			{ "addBatchListener", OnAddBatchListener },
 			{ "addEventListener", OnAddEventListener },
+			{ "removeBatchListener", OnRemoveBatchListener },
 			{ "removeEventListener", OnRemoveEventListener },
+			{ "all", OnAll },
+			{ "any", OnAny },
+			{ "race", OnRace },
 			{ nullptr, nullptr }
 		};
 		lua_createtable(luaStatePointer, 0, 0);
@@ -2820,6 +3722,100 @@ CORONA_EXPORT int luaopen_plugin_steamworks(lua_State* luaStatePointer)
 		lua_setmetatable(luaStatePointer, -2);
 	}
 
+	// Load the plugin's settings from the "config.lua" file and apply them to the runtime context.
+	PluginConfigLuaSettings configLuaSettings;
+	configLuaSettings.LoadFrom(luaStatePointer);
+	contextPointer->SetDispatchTimeBudgetInMicroseconds(configLuaSettings.GetDispatchTimeBudgetInMicroseconds());
+	{
+		auto& handlerPool = contextPointer->GetSteamCallResultHandlerPool();
+		handlerPool.SetMaxHandlerCount(configLuaSettings.GetMaxPendingRequestCount());
+		handlerPool.SetIdleHandlerLimit(configLuaSettings.GetIdleRequestHandlerLimit());
+		handlerPool.SetTrimDelayInFrames(configLuaSettings.GetRequestHandlerTrimDelayInFrames());
+	}
+	contextPointer->SetSuspendedEventCapacity(configLuaSettings.GetSuspendedEventCapacity());
+	{
+		auto policyName = configLuaSettings.GetSuspendedEventOverflowPolicyName();
+		if (policyName && policyName[0])
+		{
+			auto policy = EventOverflowPolicy::FromCoronaStringId(policyName);
+			if (policy != EventOverflowPolicy::kUnknown)
+			{
+				contextPointer->SetSuspendedEventOverflowPolicy(policy);
+			}
+			else
+			{
+				CoronaLuaWarning(
+						luaStatePointer, "config.lua field 'suspendedEventOverflowPolicy' has unknown value '%s'.",
+						policyName);
+			}
+		}
+	}
+	for (auto&& pair : configLuaSettings.GetRequestConcurrencyLimits())
+	{
+		auto category = SteamRequestCategory::FromCoronaStringId(pair.first.c_str());
+		if (category != SteamRequestCategory::kUnknown)
+		{
+			contextPointer->SetRequestConcurrencyLimitFor(category, pair.second);
+		}
+		else
+		{
+			CoronaLuaWarning(
+					luaStatePointer, "config.lua field 'requestConcurrency' has unknown category '%s'.",
+					pair.first.c_str());
+		}
+	}
+	for (auto&& pair : configLuaSettings.GetRequestWeights())
+	{
+		auto category = SteamRequestCategory::FromCoronaStringId(pair.first.c_str());
+		if (category != SteamRequestCategory::kUnknown)
+		{
+			contextPointer->SetRequestWeightFor(category, pair.second);
+		}
+		else
+		{
+			CoronaLuaWarning(
+					luaStatePointer, "config.lua field 'requestWeights' has unknown category '%s'.",
+					pair.first.c_str());
+		}
+	}
+	for (auto&& pair : configLuaSettings.GetRequestRetrySettings())
+	{
+		auto category = SteamRequestCategory::FromCoronaStringId(pair.first.c_str());
+		if (category == SteamRequestCategory::kUnknown)
+		{
+			CoronaLuaWarning(
+					luaStatePointer, "config.lua field 'requestRetry' has unknown category '%s'.", pair.first.c_str());
+			continue;
+		}
+		auto policy = contextPointer->GetRequestRetryPolicyFor(category);
+		for (auto&& settingPair : pair.second)
+		{
+			if (settingPair.first == "maxAttempts")
+			{
+				policy.MaxAttemptCount = settingPair.second;
+			}
+			else if (settingPair.first == "baseDelay")
+			{
+				policy.BaseDelayInMilliseconds = settingPair.second;
+			}
+			else if (settingPair.first == "maxDelay")
+			{
+				policy.MaxDelayInMilliseconds = settingPair.second;
+			}
+			else if (settingPair.first == "budgetPerMinute")
+			{
+				policy.BudgetPerMinute = settingPair.second;
+			}
+			else
+			{
+				CoronaLuaWarning(
+						luaStatePointer, "config.lua field 'requestRetry.%s' has unknown setting '%s'.",
+						pair.first.c_str(), settingPair.first.c_str());
+			}
+		}
+		contextPointer->SetRequestRetryPolicyFor(category, policy);
+	}
+
 	// Acquire and handle the Steam app ID.
 	// This needs to be done before calling the SteamAPI_Init() function.
 	{
@@ -2839,8 +3835,6 @@ CORONA_EXPORT int luaopen_plugin_steamworks(lua_State* luaStatePointer)
 
 		// Fetch the Steam app ID configured in the "config.lua" file.
 		std::string configStringId;
-		PluginConfigLuaSettings configLuaSettings;
-		configLuaSettings.LoadFrom(luaStatePointer);
 		if (configLuaSettings.GetStringAppId())
 		{
 			configStringId = configLuaSettings.GetStringAppId();
@@ -2920,28 +3914,57 @@ CORONA_EXPORT int luaopen_plugin_steamworks(lua_State* luaStatePointer)
 	// Note: This avoid initializing twice in case multiple plugin instances exist at the same time.
 	if (RuntimeContext::GetInstanceCount() == 1)
 	{
-		auto wasInitialized = SteamAPI_Init();
+		// If configured, initialize on another thread so that we don't block the app's startup on the
+		// Steam client's handshake. Requests made in the meantime are sent once initialization has finished.
+		bool wasInitialized = false;
+		if (configLuaSettings.IsAsyncInitEnabled())
+		{
+			wasInitialized = SteamApiInitializer::InitializeAsync(OnSteamWarningMessageReceived);
+		}
 		if (!wasInitialized)
 		{
-			CoronaLuaError(luaStatePointer, "Failed to initialize connection with Steam client.");
+			wasInitialized = SteamApiInitializer::Initialize(OnSteamWarningMessageReceived);
+			if (!wasInitialized)
+			{
+				CoronaLuaError(luaStatePointer, "Failed to initialize connection with Steam client.");
+			}
 		}
 	}
-
-	// Set up a callback to receive Steam's info/warning messages to be outputted to Corona's logging functions.
-	// Also allows for Steam warning messages to be properly highlighted in the Corona Simulator's logging window.
-	auto steamClientPointer = SteamClient();
-	if (steamClientPointer)
+	if (SteamApiInitializer::IsInitializing())
+	{
+		// Park this context's requests until the above asynchronous initialization has finished.
+		// The context will log an error if it fails.
+		contextPointer->WaitForSteamInitialization();
+	}
+	else
 	{
-		steamClientPointer->SetWarningMessageHook(OnSteamWarningMessageReceived);
+		// Set up a callback to receive Steam's info/warning messages to be outputted to Corona's logging functions.
+		// Also allows for Steam warning messages to be properly highlighted in the Corona Simulator's logging window.
+		auto steamClientPointer = SteamClient();
+		if (steamClientPointer)
+		{
+			steamClientPointer->SetWarningMessageHook(OnSteamWarningMessageReceived);
+		}
+
+		// Request the current logged in user's stats and achievement info.
+		auto steamUserStatsPointer = SteamApiInitializer::GetUserStats();
+		if (steamUserStatsPointer)
+		{
+			steamUserStatsPointer->RequestCurrentStats();
+		}
 	}
 
-	// Request the current logged in user's stats and achievement info.
-	auto steamUserStatsPointer = SteamUserStats();
-	if (steamUserStatsPointer)
+	// Poll Steam for events on a dedicated thread instead of on every "enterFrame", if configured.
+	// Note: Since Steam's callbacks are global, the first plugin instance to enable this applies to all instances.
+	if (configLuaSettings.GetCallbackPumpFrequencyInHertz() > 0)
 	{
-		steamUserStatsPointer->RequestCurrentStats();
+		SteamCallbackPump::Start(configLuaSettings.GetCallbackPumpFrequencyInHertz());
 	}
 
+	// Record how long it took to load this plugin instance, which includes SteamAPI_Init() if done synchronously.
+	contextPointer->SetStartupDurationInMicroseconds((uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now() - startTime).count());
+
 	// We're returning 1 Lua plugin table.
 	return 1;
 }